@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bench_common.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Vertex shader: writes a constant vec4 to gl_Position.
+static const uint32_t bench_vs_spv[] = {
+    0x07230203, 0x00010000, 0x00000000, 12, 0,
+    // OpCapability Shader
+    (2 << 16) | 17, 1,
+    // OpMemoryModel Logical GLSL450
+    (3 << 16) | 14, 0, 1,
+    // OpEntryPoint Vertex %1 "main" %5
+    (6 << 16) | 15, 0, 1, 0x6e69616d, 0, 5,
+    // OpDecorate %5 BuiltIn Position
+    (4 << 16) | 71, 5, 11, 0,
+    // %2 = OpTypeVoid; %3 = OpTypeFunction %2
+    (2 << 16) | 19, 2, (3 << 16) | 33, 3, 2,
+    // %6 = OpTypeFloat 32; %7 = OpTypeVector %6 4; %4 = OpTypePointer Output %7
+    (3 << 16) | 22, 6, 32, (4 << 16) | 23, 7, 6, 4, (4 << 16) | 32, 4, 3, 7,
+    // %5 = OpVariable %4 Output
+    (4 << 16) | 59, 4, 5, 3,
+    // %8 = OpConstant %6 0.0; %9 = OpConstant %6 1.0
+    (4 << 16) | 43, 6, 8, 0x00000000, (4 << 16) | 43, 6, 9, 0x3f800000,
+    // %10 = OpConstantComposite %7 %8 %8 %8 %9
+    (7 << 16) | 44, 7, 10, 8, 8, 8, 9,
+    // %1 = OpFunction %2 None %3; %11 = OpLabel
+    (5 << 16) | 54, 2, 1, 0, 3, (2 << 16) | 248, 11,
+    // OpStore %5 %10; OpReturn; OpFunctionEnd
+    (3 << 16) | 62, 5, 10, (1 << 16) | 253, (1 << 16) | 56,
+};
+
+// Fragment shader: empty main, the render pass has no color attachments.
+static const uint32_t bench_fs_spv[] = {
+    0x07230203, 0x00010000, 0x00000000, 5, 0,
+    // OpCapability Shader
+    (2 << 16) | 17, 1,
+    // OpMemoryModel Logical GLSL450
+    (3 << 16) | 14, 0, 1,
+    // OpEntryPoint Fragment %1 "main"
+    (5 << 16) | 15, 4, 1, 0x6e69616d, 0,
+    // OpExecutionMode %1 OriginUpperLeft
+    (3 << 16) | 16, 1, 7,
+    // %2 = OpTypeVoid; %3 = OpTypeFunction %2
+    (2 << 16) | 19, 2, (3 << 16) | 33, 3, 2,
+    // %1 = OpFunction %2 None %3; %4 = OpLabel; OpReturn; OpFunctionEnd
+    (5 << 16) | 54, 2, 1, 0, 3, (2 << 16) | 248, 4, (1 << 16) | 253, (1 << 16) | 56,
+};
+
+bool bench_create_context(bench_context *ctx, const std::vector<const char *> &layers,
+                          const std::vector<const char *> &instance_extensions, uint32_t queue_count) {
+    memset(ctx, 0, sizeof(*ctx));
+
+    VkApplicationInfo app = {};
+    app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app.pApplicationName = "vk_benchmark";
+    app.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+
+    VkInstanceCreateInfo inst_info = {};
+    inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    inst_info.pApplicationInfo = &app;
+    inst_info.enabledLayerCount = (uint32_t)layers.size();
+    inst_info.ppEnabledLayerNames = layers.empty() ? NULL : layers.data();
+    inst_info.enabledExtensionCount = (uint32_t)instance_extensions.size();
+    inst_info.ppEnabledExtensionNames = instance_extensions.empty() ? NULL : instance_extensions.data();
+
+    VkResult err = vkCreateInstance(&inst_info, NULL, &ctx->instance);
+    if (err != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateInstance failed (%d)\n", err);
+        return false;
+    }
+
+    uint32_t gpu_count = 1;
+    err = vkEnumeratePhysicalDevices(ctx->instance, &gpu_count, &ctx->gpu);
+    if ((err != VK_SUCCESS && err != VK_INCOMPLETE) || gpu_count == 0) {
+        fprintf(stderr, "No physical devices found (%d)\n", err);
+        return false;
+    }
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx->gpu, &family_count, NULL);
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx->gpu, &family_count, families.data());
+    ctx->graphics_queue_family = UINT32_MAX;
+    for (uint32_t i = 0; i < family_count; i++) {
+        if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            ctx->graphics_queue_family = i;
+            break;
+        }
+    }
+    if (ctx->graphics_queue_family == UINT32_MAX) {
+        fprintf(stderr, "No graphics queue family\n");
+        return false;
+    }
+
+    if (queue_count > families[ctx->graphics_queue_family].queueCount) {
+        fprintf(stderr, "Graphics queue family has only %u queues\n", families[ctx->graphics_queue_family].queueCount);
+        return false;
+    }
+    std::vector<float> priorities(queue_count, 1.0f);
+    VkDeviceQueueCreateInfo queue_info = {};
+    queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_info.queueFamilyIndex = ctx->graphics_queue_family;
+    queue_info.queueCount = queue_count;
+    queue_info.pQueuePriorities = priorities.data();
+
+    VkDeviceCreateInfo dev_info = {};
+    dev_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    dev_info.queueCreateInfoCount = 1;
+    dev_info.pQueueCreateInfos = &queue_info;
+    dev_info.enabledLayerCount = inst_info.enabledLayerCount;
+    dev_info.ppEnabledLayerNames = inst_info.ppEnabledLayerNames;
+
+    err = vkCreateDevice(ctx->gpu, &dev_info, NULL, &ctx->device);
+    if (err != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateDevice failed (%d)\n", err);
+        return false;
+    }
+    return true;
+}
+
+void bench_destroy_context(bench_context *ctx) {
+    if (ctx->device)
+        vkDestroyDevice(ctx->device, NULL);
+    if (ctx->instance)
+        vkDestroyInstance(ctx->instance, NULL);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void bench_vertex_shader_code(uint32_t variant, uint32_t constants, std::vector<uint32_t> *code) {
+    const size_t count = sizeof(bench_vs_spv) / sizeof(bench_vs_spv[0]);
+    // The padding goes in front of the OpConstantComposite, the last declaration
+    const uint32_t composite_op = (7 << 16) | 44;
+    const uint32_t *composite = std::find(bench_vs_spv, bench_vs_spv + count, composite_op);
+    const uint32_t first_id = bench_vs_spv[3];
+    code->assign(bench_vs_spv, composite);
+    (*code)[3] = first_id + constants;
+    for (uint32_t i = 0; i < constants; i++) {
+        // %(first_id + i) = OpConstant %6 <variant * constants + i>
+        float value = (float)variant * constants + i;
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const uint32_t insn[] = {(4 << 16) | 43, 6, first_id + i, bits};
+        code->insert(code->end(), insn, insn + 4);
+    }
+    code->insert(code->end(), composite, bench_vs_spv + count);
+}
+
+// Vertex shader that loads a vec4 from each of `blocks` uniform blocks at set
+// 0, binding b, so every binding is statically used, and writes the last one
+// to gl_Position.
+static void uniform_vertex_shader_code(uint32_t blocks, std::vector<uint32_t> *code) {
+    // Fixed ids as in bench_vs_spv, plus %8 = struct, %9 = Uniform struct
+    // pointer, %10 = Uniform vec4 pointer, %11 = int, %12 = int 0, %13 = label.
+    // Per block b: %(14 + b) variable, %(14 + blocks + b) access chain and
+    // %(14 + 2 * blocks + b) load.
+    const uint32_t var_base = 14, chain_base = var_base + blocks, load_base = chain_base + blocks;
+    const uint32_t header[] = {
+        0x07230203, 0x00010000, 0x00000000, load_base + blocks, 0,
+        // OpCapability Shader; OpMemoryModel Logical GLSL450
+        (2 << 16) | 17, 1, (3 << 16) | 14, 0, 1,
+        // OpEntryPoint Vertex %1 "main" %5
+        (6 << 16) | 15, 0, 1, 0x6e69616d, 0, 5,
+        // OpDecorate %5 BuiltIn Position; OpDecorate %8 Block; OpMemberDecorate %8 0 Offset 0
+        (4 << 16) | 71, 5, 11, 0, (3 << 16) | 71, 8, 2, (5 << 16) | 72, 8, 0, 35, 0,
+    };
+    code->assign(header, header + sizeof(header) / sizeof(header[0]));
+    for (uint32_t b = 0; b < blocks; b++) {
+        // OpDecorate %var DescriptorSet 0; OpDecorate %var Binding b
+        const uint32_t insn[] = {(4 << 16) | 71, var_base + b, 34, 0, (4 << 16) | 71, var_base + b, 33, b};
+        code->insert(code->end(), insn, insn + 8);
+    }
+    const uint32_t types[] = {
+        // %2 = OpTypeVoid; %3 = OpTypeFunction %2
+        (2 << 16) | 19, 2, (3 << 16) | 33, 3, 2,
+        // %6 = OpTypeFloat 32; %7 = OpTypeVector %6 4; %4 = OpTypePointer Output %7
+        (3 << 16) | 22, 6, 32, (4 << 16) | 23, 7, 6, 4, (4 << 16) | 32, 4, 3, 7,
+        // %8 = OpTypeStruct %7; %9 = OpTypePointer Uniform %8; %10 = OpTypePointer Uniform %7
+        (3 << 16) | 30, 8, 7, (4 << 16) | 32, 9, 2, 8, (4 << 16) | 32, 10, 2, 7,
+        // %11 = OpTypeInt 32 1; %12 = OpConstant %11 0
+        (4 << 16) | 21, 11, 32, 1, (4 << 16) | 43, 11, 12, 0,
+        // %5 = OpVariable %4 Output
+        (4 << 16) | 59, 4, 5, 3,
+    };
+    code->insert(code->end(), types, types + sizeof(types) / sizeof(types[0]));
+    for (uint32_t b = 0; b < blocks; b++) {
+        // %var = OpVariable %9 Uniform
+        const uint32_t insn[] = {(4 << 16) | 59, 9, var_base + b, 2};
+        code->insert(code->end(), insn, insn + 4);
+    }
+    // %1 = OpFunction %2 None %3; %13 = OpLabel
+    const uint32_t function[] = {(5 << 16) | 54, 2, 1, 0, 3, (2 << 16) | 248, 13};
+    code->insert(code->end(), function, function + 7);
+    for (uint32_t b = 0; b < blocks; b++) {
+        // %chain = OpAccessChain %10 %var %12; %load = OpLoad %7 %chain
+        const uint32_t insn[] = {(5 << 16) | 65, 10, chain_base + b, var_base + b, 12,
+                                 (4 << 16) | 61, 7, load_base + b, chain_base + b};
+        code->insert(code->end(), insn, insn + 9);
+    }
+    // OpStore %5 %last_load; OpReturn; OpFunctionEnd
+    const uint32_t tail[] = {(3 << 16) | 62, 5, load_base + blocks - 1, (1 << 16) | 253, (1 << 16) | 56};
+    code->insert(code->end(), tail, tail + 5);
+}
+
+static VkShaderModule create_shader(VkDevice device, const uint32_t *code, size_t size) {
+    VkShaderModuleCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    info.codeSize = size;
+    info.pCode = code;
+    VkShaderModule module = VK_NULL_HANDLE;
+    vkCreateShaderModule(device, &info, NULL, &module);
+    return module;
+}
+
+bool bench_create_draw_setup(const bench_context &ctx, bench_draw_setup *setup, uint32_t uniform_buffers) {
+    memset(setup, 0, sizeof(*setup));
+    const uint32_t extent = 64;
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    VkRenderPassCreateInfo rp_info = {};
+    rp_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rp_info.subpassCount = 1;
+    rp_info.pSubpasses = &subpass;
+    if (vkCreateRenderPass(ctx.device, &rp_info, NULL, &setup->render_pass) != VK_SUCCESS)
+        return false;
+
+    VkFramebufferCreateInfo fb_info = {};
+    fb_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fb_info.renderPass = setup->render_pass;
+    fb_info.width = extent;
+    fb_info.height = extent;
+    fb_info.layers = 1;
+    if (vkCreateFramebuffer(ctx.device, &fb_info, NULL, &setup->framebuffer) != VK_SUCCESS)
+        return false;
+
+    VkPipelineLayoutCreateInfo pl_info = {};
+    pl_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    VkPushConstantRange push_range = {VK_SHADER_STAGE_VERTEX_BIT, 0, 16};
+    if (uniform_buffers) {
+        std::vector<VkDescriptorSetLayoutBinding> bindings(uniform_buffers);
+        for (uint32_t b = 0; b < uniform_buffers; b++) {
+            bindings[b].binding = b;
+            bindings[b].descriptorType = b ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            bindings[b].descriptorCount = 1;
+            bindings[b].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        }
+        VkDescriptorSetLayoutCreateInfo dsl_info = {};
+        dsl_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl_info.bindingCount = uniform_buffers;
+        dsl_info.pBindings = bindings.data();
+        if (vkCreateDescriptorSetLayout(ctx.device, &dsl_info, NULL, &setup->set_layout) != VK_SUCCESS)
+            return false;
+        pl_info.setLayoutCount = 1;
+        pl_info.pSetLayouts = &setup->set_layout;
+        pl_info.pushConstantRangeCount = 1;
+        pl_info.pPushConstantRanges = &push_range;
+    }
+    if (vkCreatePipelineLayout(ctx.device, &pl_info, NULL, &setup->pipeline_layout) != VK_SUCCESS)
+        return false;
+
+    if (uniform_buffers) {
+        std::vector<uint32_t> vs_code;
+        uniform_vertex_shader_code(uniform_buffers, &vs_code);
+        setup->vs = create_shader(ctx.device, vs_code.data(), vs_code.size() * sizeof(uint32_t));
+    } else {
+        setup->vs = create_shader(ctx.device, bench_vs_spv, sizeof(bench_vs_spv));
+    }
+    setup->fs = create_shader(ctx.device, bench_fs_spv, sizeof(bench_fs_spv));
+    if (!setup->vs || !setup->fs)
+        return false;
+
+    VkPipelineShaderStageCreateInfo stages[2] = {};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = setup->vs;
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = setup->fs;
+    stages[1].pName = "main";
+
+    VkPipelineVertexInputStateCreateInfo vi = {};
+    vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo ia = {};
+    ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkViewport viewport = {0.0f, 0.0f, (float)extent, (float)extent, 0.0f, 1.0f};
+    VkRect2D scissor = {{0, 0}, {extent, extent}};
+    VkPipelineViewportStateCreateInfo vp = {};
+    vp.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    vp.viewportCount = 1;
+    vp.pViewports = &viewport;
+    vp.scissorCount = 1;
+    vp.pScissors = &scissor;
+
+    VkPipelineRasterizationStateCreateInfo rs = {};
+    rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rs.polygonMode = VK_POLYGON_MODE_FILL;
+    rs.cullMode = VK_CULL_MODE_NONE;
+    rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rs.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo ms = {};
+    ms.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendStateCreateInfo cb = {};
+    cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+
+    VkGraphicsPipelineCreateInfo gp_info = {};
+    gp_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    gp_info.stageCount = 2;
+    gp_info.pStages = stages;
+    gp_info.pVertexInputState = &vi;
+    gp_info.pInputAssemblyState = &ia;
+    gp_info.pViewportState = &vp;
+    gp_info.pRasterizationState = &rs;
+    gp_info.pMultisampleState = &ms;
+    gp_info.pColorBlendState = &cb;
+    gp_info.layout = setup->pipeline_layout;
+    gp_info.renderPass = setup->render_pass;
+    return vkCreateGraphicsPipelines(ctx.device, VK_NULL_HANDLE, 1, &gp_info, NULL, &setup->pipeline) == VK_SUCCESS;
+}
+
+void bench_destroy_draw_setup(const bench_context &ctx, bench_draw_setup *setup) {
+    if (setup->pipeline)
+        vkDestroyPipeline(ctx.device, setup->pipeline, NULL);
+    if (setup->vs)
+        vkDestroyShaderModule(ctx.device, setup->vs, NULL);
+    if (setup->fs)
+        vkDestroyShaderModule(ctx.device, setup->fs, NULL);
+    if (setup->pipeline_layout)
+        vkDestroyPipelineLayout(ctx.device, setup->pipeline_layout, NULL);
+    if (setup->set_layout)
+        vkDestroyDescriptorSetLayout(ctx.device, setup->set_layout, NULL);
+    if (setup->framebuffer)
+        vkDestroyFramebuffer(ctx.device, setup->framebuffer, NULL);
+    if (setup->render_pass)
+        vkDestroyRenderPass(ctx.device, setup->render_pass, NULL);
+    memset(setup, 0, sizeof(*setup));
+}
+
+uint32_t bench_arg_uint(int argc, char **argv, const char *name, uint32_t def) {
+    size_t len = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0 && strncmp(argv[i] + 2, name, len) == 0 && argv[i][2 + len] == '=')
+            return (uint32_t)strtoul(argv[i] + 3 + len, NULL, 0);
+    }
+    return def;
+}
+
+const char *bench_arg_str(int argc, char **argv, const char *name, const char *def) {
+    size_t len = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0 && strncmp(argv[i] + 2, name, len) == 0 && argv[i][2 + len] == '=')
+            return argv[i] + 3 + len;
+    }
+    return def;
+}
+
+// Counts operator new calls for bench_allocation_count()
+static std::atomic<uint64_t> bench_allocations(0);
+
+void *operator new(size_t size) {
+    bench_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+uint64_t bench_allocation_count() { return bench_allocations.load(std::memory_order_relaxed); }
+
+uint64_t bench_peak_rss_kb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Shared scaffolding for the layer/loader benchmarks.  Everything here is
+// deliberately minimal: one instance, one device, and a render pass with no
+// attachments so a draw can be recorded without any images or memory.
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <chrono>
+#include <stdint.h>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+struct bench_context {
+    VkInstance instance;
+    VkPhysicalDevice gpu;
+    VkDevice device;
+    uint32_t graphics_queue_family;
+};
+
+// Create an instance and device with the given layers enabled at both levels
+// and queue_count queues from the graphics queue family.
+// Prints the reason and returns false on failure.
+bool bench_create_context(bench_context *ctx, const std::vector<const char *> &layers,
+                          const std::vector<const char *> &instance_extensions = std::vector<const char *>(),
+                          uint32_t queue_count = 1);
+void bench_destroy_context(bench_context *ctx);
+
+// Objects needed to record draws: an attachment-less render pass, a matching
+// framebuffer and a trivial graphics pipeline built from hand-assembled SPIR-V.
+// set_layout is only created when the pipeline reads uniform buffers.
+struct bench_draw_setup {
+    VkRenderPass render_pass;
+    VkFramebuffer framebuffer;
+    VkDescriptorSetLayout set_layout;
+    VkPipelineLayout pipeline_layout;
+    VkPipeline pipeline;
+    VkShaderModule vs;
+    VkShaderModule fs;
+};
+
+// With uniform_buffers non-zero the vertex shader reads that many uniform
+// blocks from set 0, bindings 0 to uniform_buffers - 1, binding 0 being a
+// UNIFORM_BUFFER_DYNAMIC and the rest UNIFORM_BUFFERs, and the pipeline layout
+// also has a 16 byte vertex push constant range.
+bool bench_create_draw_setup(const bench_context &ctx, bench_draw_setup *setup, uint32_t uniform_buffers = 0);
+void bench_destroy_draw_setup(const bench_context &ctx, bench_draw_setup *setup);
+
+// Build a vertex shader like the one bench_create_draw_setup uses, padded with
+// `constants` extra float constants whose values depend on `variant`, so each
+// variant is a distinct module of a chosen size.
+void bench_vertex_shader_code(uint32_t variant, uint32_t constants, std::vector<uint32_t> *code);
+
+class bench_timer {
+  public:
+    bench_timer() : start_(std::chrono::steady_clock::now()) {}
+    void restart() { start_ = std::chrono::steady_clock::now(); }
+    double elapsed_seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Parse "--name=value" style arguments; return def when absent.
+uint32_t bench_arg_uint(int argc, char **argv, const char *name, uint32_t def);
+const char *bench_arg_str(int argc, char **argv, const char *name, const char *def);
+
+// Number of operator new calls made so far, including those from the layers
+// where the platform lets this process replace operator new for them (ELF).
+uint64_t bench_allocation_count();
+
+// Peak resident set size of this process so far, in KiB (0 if unknown).
+uint64_t bench_peak_rss_kb();
+
+#endif // BENCH_COMMON_H
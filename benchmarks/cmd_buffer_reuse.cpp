@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of re-recording many transient command buffers every
+// frame, and how many heap allocations it makes.  Each frame records
+// --cmdbufs command buffers, each a render pass with a pipeline and descriptor
+// set bound and --draws draws, submits them together and waits for them.  The
+// command buffers are then recycled in one of three ways:
+//   free    vkFreeCommandBuffers, and allocate them again next frame
+//   reset   vkResetCommandBuffer on each
+//   pool    vkResetCommandPool
+//
+// Usage: vk_cmd_buffer_reuse [--frames=N] [--cmdbufs=N] [--draws=N] [--mode=free|reset|pool] [--layer=0|1]
+//   --frames   frames recorded and submitted (default 500)
+//   --cmdbufs  command buffers recorded each frame (default 200)
+//   --draws    draws in each command buffer (default 8)
+//   --mode     how command buffers are recycled between frames (default pool)
+//   --layer    0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+enum recycle_mode { RECYCLE_FREE, RECYCLE_RESET, RECYCLE_POOL };
+
+int main(int argc, char **argv) {
+    const uint32_t frames = bench_arg_uint(argc, argv, "frames", 500);
+    const uint32_t cmdbuf_count = bench_arg_uint(argc, argv, "cmdbufs", 200);
+    const uint32_t draws = bench_arg_uint(argc, argv, "draws", 8);
+    const char *mode_name = bench_arg_str(argc, argv, "mode", "pool");
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+    recycle_mode mode;
+    if (!strcmp(mode_name, "free")) {
+        mode = RECYCLE_FREE;
+    } else if (!strcmp(mode_name, "reset")) {
+        mode = RECYCLE_RESET;
+    } else if (!strcmp(mode_name, "pool")) {
+        mode = RECYCLE_POOL;
+    } else {
+        fprintf(stderr, "--mode must be free, reset or pool\n");
+        return 1;
+    }
+    if (!frames || !cmdbuf_count) {
+        fprintf(stderr, "--frames and --cmdbufs must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup, 1)) {
+        fprintf(stderr, "Failed to create draw objects\n");
+        return 1;
+    }
+    VkQueue queue;
+    vkGetDeviceQueue(ctx.device, ctx.graphics_queue_family, 0, &queue);
+
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.size = 256;
+    buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    VkBuffer buffer;
+    vkCreateBuffer(ctx.device, &buf_info, NULL, &buffer);
+    VkMemoryRequirements reqs;
+    vkGetBufferMemoryRequirements(ctx.device, buffer, &reqs);
+    VkMemoryAllocateInfo mem_info = {};
+    mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_info.allocationSize = reqs.size;
+    mem_info.memoryTypeIndex = 0;
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(ctx.device, &mem_info, NULL, &memory) != VK_SUCCESS ||
+        vkBindBufferMemory(ctx.device, buffer, memory, 0) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to back the uniform buffer\n");
+        return 1;
+    }
+
+    VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1};
+    VkDescriptorPoolCreateInfo dp_info = {};
+    dp_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    dp_info.maxSets = 1;
+    dp_info.poolSizeCount = 1;
+    dp_info.pPoolSizes = &pool_size;
+    VkDescriptorPool desc_pool;
+    vkCreateDescriptorPool(ctx.device, &dp_info, NULL, &desc_pool);
+    VkDescriptorSetAllocateInfo set_alloc = {};
+    set_alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    set_alloc.descriptorPool = desc_pool;
+    set_alloc.descriptorSetCount = 1;
+    set_alloc.pSetLayouts = &setup.set_layout;
+    VkDescriptorSet set;
+    if (vkAllocateDescriptorSets(ctx.device, &set_alloc, &set) != VK_SUCCESS) {
+        fprintf(stderr, "vkAllocateDescriptorSets failed\n");
+        return 1;
+    }
+    const VkDescriptorBufferInfo buffer_desc = {buffer, 0, 256};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.pBufferInfo = &buffer_desc;
+    vkUpdateDescriptorSets(ctx.device, 1, &write, 0, NULL);
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    if (mode == RECYCLE_RESET)
+        pool_info.flags |= VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    VkCommandPool pool;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = cmdbuf_count;
+    std::vector<VkCommandBuffer> cmds(cmdbuf_count);
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, cmds.data());
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    vkCreateFence(ctx.device, &fence_info, NULL, &fence);
+
+    printf("core_validation %s, %u frames of %u command buffers with %u draws, recycled by %s\n",
+           use_layer ? "enabled" : "disabled", frames, cmdbuf_count, draws, mode_name);
+    printf("%12s %14s %14s %14s %14s\n", "frames", "us/record", "us/submit", "us/recycle", "allocs/frame");
+    const VkCommandBufferBeginInfo begin = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, NULL};
+    VkRenderPassBeginInfo rp_begin = {};
+    rp_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp_begin.renderPass = setup.render_pass;
+    rp_begin.framebuffer = setup.framebuffer;
+    rp_begin.renderArea.extent.width = 64;
+    rp_begin.renderArea.extent.height = 64;
+    const uint32_t slices = frames < 10 ? 1 : 10;
+    double record_total = 0.0;
+    double submit_total = 0.0;
+    double recycle_total = 0.0;
+    uint64_t allocs_total = 0;
+    uint32_t frame = 0;
+    for (uint32_t slice = 0; slice < slices; slice++) {
+        const uint32_t slice_end = (slice == slices - 1) ? frames : frames / slices * (slice + 1);
+        const uint32_t slice_start = frame;
+        double record_seconds = 0.0;
+        double submit_seconds = 0.0;
+        double recycle_seconds = 0.0;
+        const uint64_t allocs_start = bench_allocation_count();
+        for (; frame < slice_end; frame++) {
+            bench_timer timer;
+            for (uint32_t i = 0; i < cmdbuf_count; i++) {
+                VkCommandBuffer cmd = cmds[i];
+                vkBeginCommandBuffer(cmd, &begin);
+                vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline);
+                const uint32_t offset = 0;
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline_layout, 0, 1, &set, 1, &offset);
+                for (uint32_t draw = 0; draw < draws; draw++) {
+                    const float push[4] = {(float)i, (float)draw, 0.0f, 1.0f};
+                    vkCmdPushConstants(cmd, setup.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push), push);
+                    vkCmdDraw(cmd, 3, 1, 0, 0);
+                }
+                vkCmdEndRenderPass(cmd);
+                vkEndCommandBuffer(cmd);
+            }
+            record_seconds += timer.elapsed_seconds();
+
+            timer.restart();
+            VkSubmitInfo submit = {};
+            submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit.commandBufferCount = cmdbuf_count;
+            submit.pCommandBuffers = cmds.data();
+            vkQueueSubmit(queue, 1, &submit, fence);
+            vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(ctx.device, 1, &fence);
+            submit_seconds += timer.elapsed_seconds();
+
+            timer.restart();
+            switch (mode) {
+            case RECYCLE_FREE:
+                vkFreeCommandBuffers(ctx.device, pool, cmdbuf_count, cmds.data());
+                vkAllocateCommandBuffers(ctx.device, &alloc_info, cmds.data());
+                break;
+            case RECYCLE_RESET:
+                for (uint32_t i = 0; i < cmdbuf_count; i++)
+                    vkResetCommandBuffer(cmds[i], 0);
+                break;
+            case RECYCLE_POOL:
+                vkResetCommandPool(ctx.device, pool, 0);
+                break;
+            }
+            recycle_seconds += timer.elapsed_seconds();
+        }
+        const uint32_t slice_frames = slice_end - slice_start;
+        const uint64_t slice_allocs = bench_allocation_count() - allocs_start;
+        record_total += record_seconds;
+        submit_total += submit_seconds;
+        recycle_total += recycle_seconds;
+        allocs_total += slice_allocs;
+        printf("%12u %14.1f %14.1f %14.1f %14.1f\n", slice_end, record_seconds * 1e6 / slice_frames,
+               submit_seconds * 1e6 / slice_frames, recycle_seconds * 1e6 / slice_frames, (double)slice_allocs / slice_frames);
+    }
+    printf("record total   %10.3f ms\n", record_total * 1e3);
+    printf("submit total   %10.3f ms\n", submit_total * 1e3);
+    printf("recycle total  %10.3f ms\n", recycle_total * 1e3);
+    printf("allocations    %10llu\n", (unsigned long long)allocs_total);
+    printf("peak rss       %10llu kB\n", (unsigned long long)bench_peak_rss_kb());
+
+    vkDestroyFence(ctx.device, fence, NULL);
+    vkFreeCommandBuffers(ctx.device, pool, cmdbuf_count, cmds.data());
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    vkDestroyDescriptorPool(ctx.device, desc_pool, NULL);
+    vkDestroyBuffer(ctx.device, buffer, NULL);
+    vkFreeMemory(ctx.device, memory, NULL);
+    bench_destroy_draw_setup(ctx, &setup);
+    bench_destroy_context(&ctx);
+    return 0;
+}
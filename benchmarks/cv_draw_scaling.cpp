@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how vkCmdDraw recording through core_validation scales with the
+// number of threads recording into separate command buffers on one device.
+//
+// Usage: vk_cv_draw_scaling [--threads=N] [--draws=N] [--layer=0|1]
+//   --threads  highest thread count to run (1..N are all measured, default 8)
+//   --draws    draws recorded per thread per run (default 200000)
+//   --layer    0 runs without core_validation for a baseline (default 1)
+
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+#include "bench_common.h"
+
+struct thread_cmd {
+    VkCommandPool pool;
+    VkCommandBuffer cmd;
+};
+
+// Releases every waiting thread at once so setup cost is not measured.
+class start_gate {
+  public:
+    start_gate() : open_(false) {}
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return open_; });
+    }
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_;
+};
+
+static void record_draws(const bench_context &ctx, const bench_draw_setup &setup, const thread_cmd &tc, uint32_t draws,
+                         start_gate *gate) {
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(tc.cmd, &begin);
+
+    VkRenderPassBeginInfo rp_begin = {};
+    rp_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp_begin.renderPass = setup.render_pass;
+    rp_begin.framebuffer = setup.framebuffer;
+    rp_begin.renderArea.extent.width = 64;
+    rp_begin.renderArea.extent.height = 64;
+    vkCmdBeginRenderPass(tc.cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(tc.cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline);
+
+    gate->wait();
+    for (uint32_t i = 0; i < draws; i++) {
+        vkCmdDraw(tc.cmd, 3, 1, 0, 0);
+    }
+
+    vkCmdEndRenderPass(tc.cmd);
+    vkEndCommandBuffer(tc.cmd);
+}
+
+int main(int argc, char **argv) {
+    const uint32_t max_threads = bench_arg_uint(argc, argv, "threads", 8);
+    const uint32_t draws = bench_arg_uint(argc, argv, "draws", 200000);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup)) {
+        fprintf(stderr, "Failed to create draw objects\n");
+        return 1;
+    }
+
+    std::vector<thread_cmd> cmds(max_threads);
+    for (uint32_t i = 0; i < max_threads; i++) {
+        VkCommandPoolCreateInfo pool_info = {};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+        vkCreateCommandPool(ctx.device, &pool_info, NULL, &cmds[i].pool);
+
+        VkCommandBufferAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = cmds[i].pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        vkAllocateCommandBuffers(ctx.device, &alloc_info, &cmds[i].cmd);
+    }
+
+    printf("core_validation %s, %u draws per thread\n", use_layer ? "enabled" : "disabled", draws);
+    printf("%8s %14s %10s\n", "threads", "draws/sec", "speedup");
+    double single_rate = 0.0;
+    for (uint32_t thread_count = 1; thread_count <= max_threads; thread_count++) {
+        start_gate gate;
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < thread_count; t++) {
+            threads.push_back(std::thread(record_draws, std::cref(ctx), std::cref(setup), std::cref(cmds[t]), draws, &gate));
+        }
+        // Give every thread time to reach the gate before timing starts
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        bench_timer timer;
+        gate.open();
+        for (auto &th : threads)
+            th.join();
+        double elapsed = timer.elapsed_seconds();
+
+        double rate = (double)draws * thread_count / elapsed;
+        if (thread_count == 1)
+            single_rate = rate;
+        printf("%8u %14.0f %9.2fx\n", thread_count, rate, rate / single_rate);
+
+        for (uint32_t t = 0; t < thread_count; t++)
+            vkResetCommandBuffer(cmds[t].cmd, 0);
+    }
+
+    vkDeviceWaitIdle(ctx.device);
+    for (uint32_t i = 0; i < max_threads; i++) {
+        vkFreeCommandBuffers(ctx.device, cmds[i].pool, 1, &cmds[i].cmd);
+        vkDestroyCommandPool(ctx.device, cmds[i].pool, NULL);
+    }
+    bench_destroy_draw_setup(ctx, &setup);
+    bench_destroy_context(&ctx);
+    return 0;
+}
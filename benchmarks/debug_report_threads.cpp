@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how well the loader delivers debug report messages when several
+// threads send them at once.  Every thread sends --messages messages with
+// vkDebugReportMessageEXT to --callbacks app callbacks; the run is repeated
+// with 1, 2, 4, ... threads up to --threads.  With --churn=1 another thread
+// keeps creating and destroying a callback during each run, so delivery races
+// with changes to the callback list.
+//
+// Usage: vk_debug_report_threads [--threads=N] [--messages=N] [--callbacks=N]
+//                                [--churn=0|1]
+//   --threads    most threads to run (default 8)
+//   --messages   messages each thread sends (default 200000)
+//   --callbacks  callbacks each message is delivered to (default 2)
+//   --churn      1 creates and destroys a callback during the runs (default 0)
+
+#include <atomic>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+
+#include "bench_common.h"
+
+static std::atomic<uint64_t> delivered(0);
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL count_messages(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT objType,
+                                                     uint64_t srcObject, size_t location, int32_t msgCode,
+                                                     const char *pLayerPrefix, const char *pMsg, void *pUserData) {
+    delivered.fetch_add(1, std::memory_order_relaxed);
+    return VK_FALSE;
+}
+
+struct debug_report_funcs {
+    PFN_vkCreateDebugReportCallbackEXT create_callback;
+    PFN_vkDestroyDebugReportCallbackEXT destroy_callback;
+    PFN_vkDebugReportMessageEXT message;
+};
+
+static bool create_callback(VkInstance instance, const debug_report_funcs &funcs, VkDebugReportCallbackEXT *callback) {
+    VkDebugReportCallbackCreateInfoEXT info = {};
+    info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+    info.flags = VK_DEBUG_REPORT_WARNING_BIT_EXT;
+    info.pfnCallback = count_messages;
+    return funcs.create_callback(instance, &info, NULL, callback) == VK_SUCCESS;
+}
+
+static void send_loop(VkInstance instance, const debug_report_funcs *funcs, uint32_t messages) {
+    for (uint32_t i = 0; i < messages; i++)
+        funcs->message(instance, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_INSTANCE_EXT,
+                       (uint64_t)instance, 0, 1, "bench", "vk_debug_report_threads message");
+}
+
+static void churn_loop(VkInstance instance, const debug_report_funcs *funcs, const std::atomic<bool> *stop,
+                       uint64_t *changes) {
+    while (!stop->load()) {
+        VkDebugReportCallbackEXT callback;
+        if (create_callback(instance, *funcs, &callback)) {
+            funcs->destroy_callback(instance, callback, NULL);
+            (*changes)++;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const uint32_t max_threads = bench_arg_uint(argc, argv, "threads", 8);
+    const uint32_t messages = bench_arg_uint(argc, argv, "messages", 200000);
+    const uint32_t callbacks = bench_arg_uint(argc, argv, "callbacks", 2);
+    const bool churn = bench_arg_uint(argc, argv, "churn", 0) != 0;
+    if (!max_threads || !messages) {
+        fprintf(stderr, "--threads and --messages must be non-zero\n");
+        return 1;
+    }
+
+    const char *extension = VK_EXT_DEBUG_REPORT_EXTENSION_NAME;
+    VkApplicationInfo app = {};
+    app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app.pApplicationName = "vk_debug_report_threads";
+    app.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    info.pApplicationInfo = &app;
+    info.enabledExtensionCount = 1;
+    info.ppEnabledExtensionNames = &extension;
+    VkInstance instance;
+    if (vkCreateInstance(&info, NULL, &instance) != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateInstance failed\n");
+        return 1;
+    }
+
+    debug_report_funcs funcs;
+    funcs.create_callback =
+        (PFN_vkCreateDebugReportCallbackEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugReportCallbackEXT");
+    funcs.destroy_callback =
+        (PFN_vkDestroyDebugReportCallbackEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugReportCallbackEXT");
+    funcs.message = (PFN_vkDebugReportMessageEXT)vkGetInstanceProcAddr(instance, "vkDebugReportMessageEXT");
+    if (!funcs.create_callback || !funcs.destroy_callback || !funcs.message) {
+        fprintf(stderr, "%s entrypoints not found\n", extension);
+        return 1;
+    }
+    std::vector<VkDebugReportCallbackEXT> app_callbacks(callbacks);
+    for (uint32_t i = 0; i < callbacks; i++) {
+        if (!create_callback(instance, funcs, &app_callbacks[i])) {
+            fprintf(stderr, "vkCreateDebugReportCallbackEXT failed\n");
+            return 1;
+        }
+    }
+
+    printf("%u callbacks, %u messages sent per thread%s\n", callbacks, messages,
+           churn ? ", a callback created and destroyed meanwhile" : "");
+    // ns/message is how long each message took a thread
+    printf("%8s %14s %16s %14s %12s\n", "threads", "total ms", "messages/s", "ns/message", "changes");
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        delivered = 0;
+        std::atomic<bool> stop(false);
+        uint64_t changes = 0;
+        std::thread churner;
+        if (churn)
+            churner = std::thread(churn_loop, instance, &funcs, &stop, &changes);
+        std::vector<std::thread> workers;
+        bench_timer timer;
+        for (uint32_t t = 0; t < threads; t++)
+            workers.push_back(std::thread(send_loop, instance, &funcs, messages));
+        for (std::thread &worker : workers)
+            worker.join();
+        const double seconds = timer.elapsed_seconds();
+        stop = true;
+        if (churn)
+            churner.join();
+        const double total = (double)threads * messages;
+        if (delivered < (uint64_t)total * callbacks) {
+            fprintf(stderr, "only %llu of %.0f messages reached the callbacks\n", (unsigned long long)delivered.load(),
+                    total * callbacks);
+            return 1;
+        }
+        printf("%8u %14.2f %16.0f %14.1f %12llu\n", threads, seconds * 1e3, total / seconds, seconds * 1e9 / messages,
+               (unsigned long long)changes);
+    }
+
+    for (uint32_t i = 0; i < callbacks; i++)
+        funcs.destroy_callback(instance, app_callbacks[i], NULL);
+    vkDestroyInstance(instance, NULL);
+    return 0;
+}
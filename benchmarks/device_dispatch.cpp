@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures what the loader's trampoline costs a device command.  The same
+// draws are recorded into a render pass three ways: through the vkCmdDraw the
+// loader exports, through the pointer vkGetInstanceProcAddr returns for it
+// (also the trampoline), and through the pointer vkGetDeviceProcAddr returns,
+// which goes straight to the ICD, or to the top layer with --layer=1.
+//
+// Usage: vk_device_dispatch [--draws=N] [--cmdbufs=N] [--layer=0|1]
+//   --draws    draws recorded into each command buffer (default 1000000)
+//   --cmdbufs  command buffers recorded each way (default 10)
+//   --layer    1 enables core_validation (default 0)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+// Record draws into cmd cmdbufs times with the given vkCmdDraw, returning the
+// fastest ns/draw, which is the least disturbed by the rest of the system.
+static double record(PFN_vkCmdDraw draw_fn, VkCommandBuffer cmd, const bench_draw_setup &setup, uint32_t draws,
+                     uint32_t cmdbufs) {
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VkRenderPassBeginInfo rp_begin = {};
+    rp_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp_begin.renderPass = setup.render_pass;
+    rp_begin.framebuffer = setup.framebuffer;
+    rp_begin.renderArea.extent.width = 64;
+    rp_begin.renderArea.extent.height = 64;
+    double best = 0.0;
+    for (uint32_t i = 0; i < cmdbufs; i++) {
+        vkBeginCommandBuffer(cmd, &begin);
+        vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline);
+        bench_timer timer;
+        for (uint32_t draw = 0; draw < draws; draw++)
+            draw_fn(cmd, 3, 1, 0, 0);
+        const double ns = timer.elapsed_seconds() * 1e9 / draws;
+        vkCmdEndRenderPass(cmd);
+        vkEndCommandBuffer(cmd);
+        if (!i || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t draws = bench_arg_uint(argc, argv, "draws", 1000000);
+    const uint32_t cmdbufs = bench_arg_uint(argc, argv, "cmdbufs", 10);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 0) != 0;
+    if (!draws || !cmdbufs) {
+        fprintf(stderr, "--draws and --cmdbufs must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup)) {
+        fprintf(stderr, "Failed to create draw objects\n");
+        return 1;
+    }
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    VkCommandPool pool;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    VkCommandBuffer cmd;
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, &cmd);
+
+    const PFN_vkCmdDraw gipa_draw = (PFN_vkCmdDraw)vkGetInstanceProcAddr(ctx.instance, "vkCmdDraw");
+    const PFN_vkCmdDraw gdpa_draw = (PFN_vkCmdDraw)vkGetDeviceProcAddr(ctx.device, "vkCmdDraw");
+    if (!gipa_draw || !gdpa_draw) {
+        fprintf(stderr, "vkCmdDraw not found\n");
+        return 1;
+    }
+
+    printf("core_validation %s, %u draws per command buffer, fastest of %u\n", use_layer ? "enabled" : "disabled", draws,
+           cmdbufs);
+    if (gdpa_draw == (PFN_vkCmdDraw)vkCmdDraw)
+        printf("vkGetDeviceProcAddr returned the loader's trampoline\n");
+    printf("%-28s %14s\n", "vkCmdDraw via", "ns/draw");
+    const double exported = record(vkCmdDraw, cmd, setup, draws, cmdbufs);
+    printf("%-28s %14.2f\n", "exported symbol", exported);
+    printf("%-28s %14.2f\n", "vkGetInstanceProcAddr", record(gipa_draw, cmd, setup, draws, cmdbufs));
+    const double direct = record(gdpa_draw, cmd, setup, draws, cmdbufs);
+    printf("%-28s %14.2f\n", "vkGetDeviceProcAddr", direct);
+    printf("trampoline cost %.2f ns/draw\n", exported - direct);
+
+    vkFreeCommandBuffers(ctx.device, pool, 1, &cmd);
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    bench_destroy_draw_setup(ctx, &setup);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures core_validation's draw-time checks in a draw-heavy recording: the
+// pipeline and a descriptor set with --bindings uniform buffers are bound once
+// per command buffer, then every draw is preceded only by a vkCmdPushConstants,
+// so nothing the draw-time checks depend on changes between draws.  With
+// --rebind-every=N the set is rebound with a new dynamic offset every N draws,
+// which shows the cost of the checks that do have to run again.
+//
+// Usage: vk_draw_state [--draws=N] [--cmdbufs=N] [--bindings=N] [--rebind-every=N] [--layer=0|1]
+//   --draws         draws recorded into each command buffer (default 50000)
+//   --cmdbufs       command buffers recorded (default 10)
+//   --bindings      uniform buffer bindings in the set, the first dynamic (default 8)
+//   --rebind-every  rebind the set every N draws, 0 never (default 0)
+//   --layer         0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+static const VkDeviceSize uniform_range = 256;
+static const uint32_t dynamic_offsets = 16;
+
+int main(int argc, char **argv) {
+    const uint32_t draws = bench_arg_uint(argc, argv, "draws", 50000);
+    const uint32_t cmdbufs = bench_arg_uint(argc, argv, "cmdbufs", 10);
+    const uint32_t bindings = bench_arg_uint(argc, argv, "bindings", 8);
+    const uint32_t rebind_every = bench_arg_uint(argc, argv, "rebind-every", 0);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+    if (!draws || !cmdbufs || !bindings) {
+        fprintf(stderr, "--draws, --cmdbufs and --bindings must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup, bindings)) {
+        fprintf(stderr, "Failed to create draw objects\n");
+        return 1;
+    }
+
+    // One buffer backs every binding; the dynamic binding moves through it
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.size = uniform_range * dynamic_offsets;
+    buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    VkBuffer buffer;
+    vkCreateBuffer(ctx.device, &buf_info, NULL, &buffer);
+    VkMemoryRequirements reqs;
+    vkGetBufferMemoryRequirements(ctx.device, buffer, &reqs);
+    VkMemoryAllocateInfo mem_info = {};
+    mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_info.allocationSize = reqs.size;
+    mem_info.memoryTypeIndex = 0;
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(ctx.device, &mem_info, NULL, &memory) != VK_SUCCESS ||
+        vkBindBufferMemory(ctx.device, buffer, memory, 0) != VK_SUCCESS) {
+        fprintf(stderr, "Failed to back the uniform buffer\n");
+        return 1;
+    }
+
+    VkDescriptorPoolSize pool_sizes[2] = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
+                                          {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, bindings - 1}};
+    VkDescriptorPoolCreateInfo dp_info = {};
+    dp_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    dp_info.maxSets = 1;
+    dp_info.poolSizeCount = bindings > 1 ? 2 : 1;
+    dp_info.pPoolSizes = pool_sizes;
+    VkDescriptorPool desc_pool;
+    vkCreateDescriptorPool(ctx.device, &dp_info, NULL, &desc_pool);
+
+    VkDescriptorSetAllocateInfo set_alloc = {};
+    set_alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    set_alloc.descriptorPool = desc_pool;
+    set_alloc.descriptorSetCount = 1;
+    set_alloc.pSetLayouts = &setup.set_layout;
+    VkDescriptorSet set;
+    if (vkAllocateDescriptorSets(ctx.device, &set_alloc, &set) != VK_SUCCESS) {
+        fprintf(stderr, "vkAllocateDescriptorSets failed\n");
+        return 1;
+    }
+
+    const VkDescriptorBufferInfo buffer_desc = {buffer, 0, uniform_range};
+    std::vector<VkWriteDescriptorSet> writes(bindings);
+    for (uint32_t b = 0; b < bindings; b++) {
+        writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[b].dstSet = set;
+        writes[b].dstBinding = b;
+        writes[b].descriptorCount = 1;
+        writes[b].descriptorType = b ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        writes[b].pBufferInfo = &buffer_desc;
+    }
+    vkUpdateDescriptorSets(ctx.device, bindings, writes.data(), 0, NULL);
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    VkCommandPool pool;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    VkCommandBuffer cmd;
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, &cmd);
+
+    printf("core_validation %s, %u draws per command buffer, %u bindings, rebind every %u draws\n",
+           use_layer ? "enabled" : "disabled", draws, bindings, rebind_every);
+    printf("%12s %14s\n", "cmdbufs", "ns/draw");
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VkRenderPassBeginInfo rp_begin = {};
+    rp_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp_begin.renderPass = setup.render_pass;
+    rp_begin.framebuffer = setup.framebuffer;
+    rp_begin.renderArea.extent.width = 64;
+    rp_begin.renderArea.extent.height = 64;
+    float push[4] = {};
+    double total = 0.0;
+    for (uint32_t i = 0; i < cmdbufs; i++) {
+        bench_timer timer;
+        vkBeginCommandBuffer(cmd, &begin);
+        vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline);
+        uint32_t offset = 0;
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline_layout, 0, 1, &set, 1, &offset);
+        for (uint32_t draw = 0; draw < draws; draw++) {
+            if (rebind_every && draw && draw % rebind_every == 0) {
+                offset = (uint32_t)((draw / rebind_every) % dynamic_offsets * uniform_range);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline_layout, 0, 1, &set, 1, &offset);
+            }
+            push[0] = (float)draw;
+            vkCmdPushConstants(cmd, setup.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push), push);
+            vkCmdDraw(cmd, 3, 1, 0, 0);
+        }
+        vkCmdEndRenderPass(cmd);
+        vkEndCommandBuffer(cmd);
+        const double seconds = timer.elapsed_seconds();
+        total += seconds;
+        printf("%12u %14.1f\n", i + 1, seconds * 1e9 / draws);
+    }
+    printf("record total   %10.3f ms\n", total * 1e3);
+    printf("peak rss       %10llu kB\n", (unsigned long long)bench_peak_rss_kb());
+
+    vkFreeCommandBuffers(ctx.device, pool, 1, &cmd);
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    vkDestroyDescriptorPool(ctx.device, desc_pool, NULL);
+    vkDestroyBuffer(ctx.device, buffer, NULL);
+    vkFreeMemory(ctx.device, memory, NULL);
+    bench_destroy_draw_setup(ctx, &setup);
+    bench_destroy_context(&ctx);
+    return 0;
+}
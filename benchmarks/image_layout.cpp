@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures core_validation's image layout tracking on an image with many
+// subresources, such as a mipmapped cube array.  Each frame records the
+// barriers of a mip chain generation into one command buffer: the whole image
+// moves to TRANSFER_DST, each level in turn moves to TRANSFER_SRC, then the
+// whole image moves to SHADER_READ_ONLY.  With --whole-only the per-level
+// barriers are left out so only whole-image transitions are recorded.  The
+// command buffer is submitted and waited on each frame, so the layer checks
+// and updates the image's layouts at every submit.
+//
+// Usage: vk_image_layout [--frames=N] [--levels=N] [--layers=N] [--whole-only=0|1] [--layer=0|1]
+//   --frames      frames recorded and submitted (default 2000)
+//   --levels      mip levels of the image (default 12)
+//   --layers      array layers of the image (default 6)
+//   --whole-only  1 records only whole-image barriers (default 0)
+//   --layer       0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+static VkAccessFlags layout_access(VkImageLayout layout) {
+    switch (layout) {
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        return VK_ACCESS_TRANSFER_WRITE_BIT;
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        return VK_ACCESS_TRANSFER_READ_BIT;
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        return VK_ACCESS_SHADER_READ_BIT;
+    default:
+        return 0;
+    }
+}
+
+static VkImageMemoryBarrier image_barrier(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout,
+                                          uint32_t base_level, uint32_t level_count) {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = layout_access(old_layout);
+    barrier.dstAccessMask = layout_access(new_layout);
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = base_level;
+    barrier.subresourceRange.levelCount = level_count;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+    return barrier;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t frames = bench_arg_uint(argc, argv, "frames", 2000);
+    const uint32_t levels = bench_arg_uint(argc, argv, "levels", 12);
+    const uint32_t array_layers = bench_arg_uint(argc, argv, "layers", 6);
+    const bool whole_only = bench_arg_uint(argc, argv, "whole-only", 0) != 0;
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+    if (!frames || !levels || !array_layers) {
+        fprintf(stderr, "--frames, --levels and --layers must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+
+    VkQueue queue;
+    vkGetDeviceQueue(ctx.device, ctx.graphics_queue_family, 0, &queue);
+
+    VkImageCreateInfo image_info = {};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_info.extent.width = 1u << (levels - 1);
+    image_info.extent.height = 1u << (levels - 1);
+    image_info.extent.depth = 1;
+    image_info.mipLevels = levels;
+    image_info.arrayLayers = array_layers;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImage image;
+    if (vkCreateImage(ctx.device, &image_info, NULL, &image) != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateImage failed\n");
+        return 1;
+    }
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    VkCommandPool pool;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    VkCommandBuffer cmd;
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, &cmd);
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    vkCreateFence(ctx.device, &fence_info, NULL, &fence);
+
+    printf("core_validation %s, %u frames on a %u level, %u layer image%s\n", use_layer ? "enabled" : "disabled", frames, levels,
+           array_layers, whole_only ? ", whole-image barriers only" : "");
+    printf("%12s %14s %14s\n", "frames", "us/record", "us/submit");
+    const VkCommandBufferBeginInfo begin = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, NULL};
+    const VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    const uint32_t slices = frames < 10 ? 1 : 10;
+    double record_total = 0.0;
+    double submit_total = 0.0;
+    uint32_t frame = 0;
+    for (uint32_t slice = 0; slice < slices; slice++) {
+        const uint32_t slice_end = (slice == slices - 1) ? frames : frames / slices * (slice + 1);
+        const uint32_t slice_start = frame;
+        double record_seconds = 0.0;
+        double submit_seconds = 0.0;
+        for (; frame < slice_end; frame++) {
+            bench_timer timer;
+            vkBeginCommandBuffer(cmd, &begin);
+            VkImageMemoryBarrier barrier =
+                image_barrier(image, frame ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_REMAINING_MIP_LEVELS);
+            vkCmdPipelineBarrier(cmd, stages, stages, 0, 0, NULL, 0, NULL, 1, &barrier);
+            if (!whole_only) {
+                for (uint32_t level = 0; level < levels; level++) {
+                    barrier = image_barrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                            level, 1);
+                    vkCmdPipelineBarrier(cmd, stages, stages, 0, 0, NULL, 0, NULL, 1, &barrier);
+                }
+            }
+            barrier = image_barrier(image, whole_only ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_REMAINING_MIP_LEVELS);
+            vkCmdPipelineBarrier(cmd, stages, stages, 0, 0, NULL, 0, NULL, 1, &barrier);
+            vkEndCommandBuffer(cmd);
+            record_seconds += timer.elapsed_seconds();
+
+            timer.restart();
+            VkSubmitInfo submit = {};
+            submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit.commandBufferCount = 1;
+            submit.pCommandBuffers = &cmd;
+            vkQueueSubmit(queue, 1, &submit, fence);
+            vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(ctx.device, 1, &fence);
+            submit_seconds += timer.elapsed_seconds();
+        }
+        const uint32_t slice_frames = slice_end - slice_start;
+        record_total += record_seconds;
+        submit_total += submit_seconds;
+        printf("%12u %14.2f %14.2f\n", slice_end, record_seconds * 1e6 / slice_frames, submit_seconds * 1e6 / slice_frames);
+    }
+    printf("record total   %10.3f ms\n", record_total * 1e3);
+    printf("submit total   %10.3f ms\n", submit_total * 1e3);
+    printf("peak rss       %10llu kB\n", (unsigned long long)bench_peak_rss_kb());
+
+    vkDestroyFence(ctx.device, fence, NULL);
+    vkFreeCommandBuffers(ctx.device, pool, 1, &cmd);
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    vkDestroyImage(ctx.device, image, NULL);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how well vkCreateInstance/vkDestroyInstance scale when several
+// threads create instances at once.  Every thread creates and destroys
+// --instances instances back to back; the run is repeated with 1, 2, 4, ...
+// threads up to --threads.  An instance created up front stays alive for the
+// whole run, so the ICD and layer libraries stay loaded and the timings show
+// manifest scanning, library lookup and chain creation rather than the
+// platform loading the libraries from scratch each time.
+//
+// Usage: vk_instance_create_threads [--threads=N] [--instances=N] [--layer=0|1]
+//   --threads    most threads to run (default 8)
+//   --instances  instances each thread creates and destroys (default 200)
+//   --layer      1 enables core_validation on every instance (default 0)
+
+#include <memory>
+#include <stdio.h>
+#include <thread>
+
+#include "bench_common.h"
+
+static bool create_instance(bool use_layer, VkInstance *instance) {
+    const char *layer = "VK_LAYER_LUNARG_core_validation";
+    VkApplicationInfo app = {};
+    app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app.pApplicationName = "vk_instance_create_threads";
+    app.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    info.pApplicationInfo = &app;
+    info.enabledLayerCount = use_layer ? 1 : 0;
+    info.ppEnabledLayerNames = &layer;
+    return vkCreateInstance(&info, NULL, instance) == VK_SUCCESS;
+}
+
+static void create_destroy_loop(bool use_layer, uint32_t instances, bool *ok) {
+    for (uint32_t i = 0; i < instances; i++) {
+        VkInstance instance;
+        if (!create_instance(use_layer, &instance)) {
+            *ok = false;
+            return;
+        }
+        vkDestroyInstance(instance, NULL);
+    }
+    *ok = true;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t max_threads = bench_arg_uint(argc, argv, "threads", 8);
+    const uint32_t instances = bench_arg_uint(argc, argv, "instances", 200);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 0) != 0;
+    if (!max_threads || !instances) {
+        fprintf(stderr, "--threads and --instances must be non-zero\n");
+        return 1;
+    }
+
+    VkInstance keep_loaded;
+    if (!create_instance(use_layer, &keep_loaded)) {
+        fprintf(stderr, "vkCreateInstance failed\n");
+        return 1;
+    }
+
+    printf("core_validation %s, %u instances created and destroyed per thread\n", use_layer ? "enabled" : "disabled",
+           instances);
+    // us/instance is how long each create and destroy took a thread
+    printf("%8s %14s %16s %14s\n", "threads", "total ms", "instances/s", "us/instance");
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::vector<std::thread> workers;
+        std::unique_ptr<bool[]> ok(new bool[threads]());
+        bench_timer timer;
+        for (uint32_t t = 0; t < threads; t++)
+            workers.push_back(std::thread(create_destroy_loop, use_layer, instances, &ok[t]));
+        for (std::thread &worker : workers)
+            worker.join();
+        const double seconds = timer.elapsed_seconds();
+        for (uint32_t t = 0; t < threads; t++) {
+            if (!ok[t]) {
+                fprintf(stderr, "vkCreateInstance failed on thread %u\n", t);
+                return 1;
+            }
+        }
+        const double total = (double)threads * instances;
+        printf("%8u %14.2f %16.0f %14.1f\n", threads, seconds * 1e3, total / seconds, seconds * 1e6 / instances);
+    }
+
+    vkDestroyInstance(keep_loaded, NULL);
+    return 0;
+}
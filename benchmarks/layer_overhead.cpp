@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Drives the same API stream (instance/device creation, draw and descriptor
+// binding recording, submits and fences) through no layers, each validation
+// layer on its own and the standard_validation stack, and reports ns/call per
+// entrypoint plus peak memory for each configuration as JSON.
+//
+// Each configuration runs in a fresh child process so peak memory is its own.
+// Per-call timings of the submit/fence loop include one steady_clock read per
+// call; the recording entrypoints are timed in batches.
+//
+// Usage: vk_layer_overhead [--draws=N] [--submits=N] [--instances=N]
+//                          [--only=NAME] [--output=FILE]
+//   --draws      vkCmdDraw and vkCmdBindDescriptorSets calls recorded (default 100000)
+//   --submits    submit/fence loop iterations (default 1000)
+//   --instances  instance and device create/destroy pairs (default 10)
+//   --only       run a single configuration, e.g. --only=core_validation
+//   --output     JSON results file (default vk_layer_overhead.json)
+//
+// With no driver installed, run it against the null ICD via VK_ICD_FILENAMES.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <vector>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "bench_common.h"
+
+struct layer_config {
+    const char *name;
+    std::vector<const char *> layers;
+};
+
+static std::vector<layer_config> all_configs() {
+    std::vector<layer_config> configs;
+    configs.push_back({"none", {}});
+    configs.push_back({"core_validation", {"VK_LAYER_LUNARG_core_validation"}});
+    configs.push_back({"object_tracker", {"VK_LAYER_LUNARG_object_tracker"}});
+    configs.push_back({"threading", {"VK_LAYER_GOOGLE_threading"}});
+    configs.push_back({"unique_objects", {"VK_LAYER_GOOGLE_unique_objects"}});
+    configs.push_back({"parameter_validation", {"VK_LAYER_LUNARG_parameter_validation"}});
+    configs.push_back({"image", {"VK_LAYER_LUNARG_image"}});
+    configs.push_back({"swapchain", {"VK_LAYER_LUNARG_swapchain"}});
+    configs.push_back({"device_limits", {"VK_LAYER_LUNARG_device_limits"}});
+    configs.push_back({"standard_validation", {"VK_LAYER_LUNARG_standard_validation"}});
+    return configs;
+}
+
+// Accumulated time and call count for one entrypoint, reported in the order
+// first seen.
+class call_timings {
+  public:
+    void add(const char *name, double seconds, uint64_t calls) {
+        for (auto &e : entries_) {
+            if (e.name == name) {
+                e.seconds += seconds;
+                e.calls += calls;
+                return;
+            }
+        }
+        entries_.push_back({name, seconds, calls});
+    }
+
+    void write_json(FILE *out) const {
+        fprintf(out, "{");
+        for (size_t i = 0; i < entries_.size(); i++) {
+            const entry &e = entries_[i];
+            fprintf(out, "%s\n        \"%s\": {\"calls\": %llu, \"ns_per_call\": %.1f}", i ? "," : "",
+                    e.name.c_str(), (unsigned long long)e.calls, e.calls ? e.seconds * 1e9 / e.calls : 0.0);
+        }
+        fprintf(out, "\n      }");
+    }
+
+  private:
+    struct entry {
+        std::string name;
+        double seconds;
+        uint64_t calls;
+    };
+    std::vector<entry> entries_;
+};
+
+// Time a single call into t under name.
+#define TIMED_CALL(t, name, call)                                                                                                  \
+    do {                                                                                                                           \
+        bench_timer timer_;                                                                                                        \
+        call;                                                                                                                      \
+        (t).add(name, timer_.elapsed_seconds(), 1);                                                                                \
+    } while (0)
+
+static uint32_t validation_messages = 0;
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL count_messages(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT objType,
+                                                     uint64_t srcObject, size_t location, int32_t msgCode,
+                                                     const char *pLayerPrefix, const char *pMsg, void *pUserData) {
+    if (validation_messages++ < 5)
+        fprintf(stderr, "  %s: %s\n", pLayerPrefix, pMsg);
+    return VK_FALSE;
+}
+
+static uint32_t find_memory_type(const bench_context &ctx, uint32_t type_bits, VkMemoryPropertyFlags flags) {
+    VkPhysicalDeviceMemoryProperties props;
+    vkGetPhysicalDeviceMemoryProperties(ctx.gpu, &props);
+    for (uint32_t i = 0; i < props.memoryTypeCount; i++) {
+        if ((type_bits & (1u << i)) && (props.memoryTypes[i].propertyFlags & flags) == flags)
+            return i;
+    }
+    return UINT32_MAX;
+}
+
+static void time_instances(const layer_config &config, uint32_t count, call_timings *t) {
+    VkInstanceCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    info.enabledLayerCount = (uint32_t)config.layers.size();
+    info.ppEnabledLayerNames = config.layers.empty() ? NULL : config.layers.data();
+    for (uint32_t i = 0; i < count; i++) {
+        VkInstance instance = VK_NULL_HANDLE;
+        TIMED_CALL(*t, "vkCreateInstance", vkCreateInstance(&info, NULL, &instance));
+        if (instance)
+            TIMED_CALL(*t, "vkDestroyInstance", vkDestroyInstance(instance, NULL));
+    }
+}
+
+static void time_devices(const bench_context &ctx, const layer_config &config, uint32_t count, call_timings *t) {
+    float priority = 1.0f;
+    VkDeviceQueueCreateInfo queue_info = {};
+    queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_info.queueFamilyIndex = ctx.graphics_queue_family;
+    queue_info.queueCount = 1;
+    queue_info.pQueuePriorities = &priority;
+
+    VkDeviceCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    info.queueCreateInfoCount = 1;
+    info.pQueueCreateInfos = &queue_info;
+    info.enabledLayerCount = (uint32_t)config.layers.size();
+    info.ppEnabledLayerNames = config.layers.empty() ? NULL : config.layers.data();
+    for (uint32_t i = 0; i < count; i++) {
+        VkDevice device = VK_NULL_HANDLE;
+        TIMED_CALL(*t, "vkCreateDevice", vkCreateDevice(ctx.gpu, &info, NULL, &device));
+        if (device)
+            TIMED_CALL(*t, "vkDestroyDevice", vkDestroyDevice(device, NULL));
+    }
+}
+
+// A uniform buffer descriptor set and a pipeline layout to bind it with.
+struct descriptor_setup {
+    VkDescriptorSetLayout set_layout;
+    VkPipelineLayout pipeline_layout;
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+};
+
+static bool create_descriptor_setup(const bench_context &ctx, descriptor_setup *ds) {
+    memset(ds, 0, sizeof(*ds));
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+    VkDescriptorSetLayoutCreateInfo dsl_info = {};
+    dsl_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    dsl_info.bindingCount = 1;
+    dsl_info.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(ctx.device, &dsl_info, NULL, &ds->set_layout) != VK_SUCCESS)
+        return false;
+
+    VkPipelineLayoutCreateInfo pl_info = {};
+    pl_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pl_info.setLayoutCount = 1;
+    pl_info.pSetLayouts = &ds->set_layout;
+    if (vkCreatePipelineLayout(ctx.device, &pl_info, NULL, &ds->pipeline_layout) != VK_SUCCESS)
+        return false;
+
+    VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1};
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+    if (vkCreateDescriptorPool(ctx.device, &pool_info, NULL, &ds->pool) != VK_SUCCESS)
+        return false;
+
+    VkDescriptorSetAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = ds->pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &ds->set_layout;
+    if (vkAllocateDescriptorSets(ctx.device, &alloc_info, &ds->set) != VK_SUCCESS)
+        return false;
+
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.size = 256;
+    buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    if (vkCreateBuffer(ctx.device, &buf_info, NULL, &ds->buffer) != VK_SUCCESS)
+        return false;
+
+    VkMemoryRequirements reqs;
+    vkGetBufferMemoryRequirements(ctx.device, ds->buffer, &reqs);
+    VkMemoryAllocateInfo mem_info = {};
+    mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_info.allocationSize = reqs.size;
+    mem_info.memoryTypeIndex = find_memory_type(ctx, reqs.memoryTypeBits, 0);
+    if (mem_info.memoryTypeIndex == UINT32_MAX ||
+        vkAllocateMemory(ctx.device, &mem_info, NULL, &ds->memory) != VK_SUCCESS ||
+        vkBindBufferMemory(ctx.device, ds->buffer, ds->memory, 0) != VK_SUCCESS)
+        return false;
+
+    VkDescriptorBufferInfo buffer_desc = {ds->buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = ds->set;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.pBufferInfo = &buffer_desc;
+    vkUpdateDescriptorSets(ctx.device, 1, &write, 0, NULL);
+    return true;
+}
+
+static void destroy_descriptor_setup(const bench_context &ctx, descriptor_setup *ds) {
+    if (ds->pool)
+        vkDestroyDescriptorPool(ctx.device, ds->pool, NULL);
+    if (ds->buffer)
+        vkDestroyBuffer(ctx.device, ds->buffer, NULL);
+    if (ds->memory)
+        vkFreeMemory(ctx.device, ds->memory, NULL);
+    if (ds->pipeline_layout)
+        vkDestroyPipelineLayout(ctx.device, ds->pipeline_layout, NULL);
+    if (ds->set_layout)
+        vkDestroyDescriptorSetLayout(ctx.device, ds->set_layout, NULL);
+}
+
+static void begin_render_pass(VkCommandBuffer cmd, const bench_draw_setup &setup) {
+    VkRenderPassBeginInfo rp_begin = {};
+    rp_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp_begin.renderPass = setup.render_pass;
+    rp_begin.framebuffer = setup.framebuffer;
+    rp_begin.renderArea.extent.width = 64;
+    rp_begin.renderArea.extent.height = 64;
+    vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline);
+}
+
+static int run_config(const layer_config &config, uint32_t draws, uint32_t submits, uint32_t instances,
+                      const char *output) {
+    call_timings t;
+
+    time_instances(config, instances, &t);
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, config.layers, std::vector<const char *>(1, VK_EXT_DEBUG_REPORT_EXTENSION_NAME)))
+        return 1;
+    VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+    PFN_vkCreateDebugReportCallbackEXT create_callback =
+        (PFN_vkCreateDebugReportCallbackEXT)vkGetInstanceProcAddr(ctx.instance, "vkCreateDebugReportCallbackEXT");
+    PFN_vkDestroyDebugReportCallbackEXT destroy_callback =
+        (PFN_vkDestroyDebugReportCallbackEXT)vkGetInstanceProcAddr(ctx.instance, "vkDestroyDebugReportCallbackEXT");
+    if (create_callback && destroy_callback) {
+        VkDebugReportCallbackCreateInfoEXT cb_info = {};
+        cb_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+        cb_info.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
+        cb_info.pfnCallback = count_messages;
+        create_callback(ctx.instance, &cb_info, NULL, &callback);
+    }
+
+    time_devices(ctx, config, instances, &t);
+
+    bench_draw_setup setup;
+    descriptor_setup ds;
+    if (!bench_create_draw_setup(ctx, &setup) || !create_descriptor_setup(ctx, &ds)) {
+        fprintf(stderr, "Failed to create draw objects\n");
+        return 1;
+    }
+    VkQueue queue;
+    vkGetDeviceQueue(ctx.device, ctx.graphics_queue_family, 0, &queue);
+
+    VkCommandPool pool;
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    VkCommandBuffer cmds[2]; // [0] = long recording, [1] = per-submit
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 2;
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, cmds);
+
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    // Long recording: batches of binds and draws
+    vkBeginCommandBuffer(cmds[0], &begin);
+    begin_render_pass(cmds[0], setup);
+    bench_timer timer;
+    for (uint32_t i = 0; i < draws; i++)
+        vkCmdBindDescriptorSets(cmds[0], VK_PIPELINE_BIND_POINT_GRAPHICS, ds.pipeline_layout, 0, 1, &ds.set, 0, NULL);
+    t.add("vkCmdBindDescriptorSets", timer.elapsed_seconds(), draws);
+    timer.restart();
+    for (uint32_t i = 0; i < draws; i++)
+        vkCmdDraw(cmds[0], 3, 1, 0, 0);
+    t.add("vkCmdDraw", timer.elapsed_seconds(), draws);
+    vkCmdEndRenderPass(cmds[0]);
+    vkEndCommandBuffer(cmds[0]);
+
+    VkSubmitInfo submit = {};
+    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &cmds[0];
+    TIMED_CALL(t, "vkQueueSubmit(long)", vkQueueSubmit(queue, 1, &submit, VK_NULL_HANDLE));
+    TIMED_CALL(t, "vkQueueWaitIdle", vkQueueWaitIdle(queue));
+
+    // Short command buffers, each re-recorded and submitted with a fence
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    submit.pCommandBuffers = &cmds[1];
+    for (uint32_t i = 0; i < submits; i++) {
+        TIMED_CALL(t, "vkBeginCommandBuffer", vkBeginCommandBuffer(cmds[1], &begin));
+        begin_render_pass(cmds[1], setup);
+        vkCmdBindDescriptorSets(cmds[1], VK_PIPELINE_BIND_POINT_GRAPHICS, ds.pipeline_layout, 0, 1, &ds.set, 0, NULL);
+        vkCmdDraw(cmds[1], 3, 1, 0, 0);
+        vkCmdEndRenderPass(cmds[1]);
+        TIMED_CALL(t, "vkEndCommandBuffer", vkEndCommandBuffer(cmds[1]));
+
+        VkFence fence = VK_NULL_HANDLE;
+        TIMED_CALL(t, "vkCreateFence", vkCreateFence(ctx.device, &fence_info, NULL, &fence));
+        TIMED_CALL(t, "vkQueueSubmit", vkQueueSubmit(queue, 1, &submit, fence));
+        TIMED_CALL(t, "vkWaitForFences", vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX));
+        TIMED_CALL(t, "vkResetFences", vkResetFences(ctx.device, 1, &fence));
+        TIMED_CALL(t, "vkDestroyFence", vkDestroyFence(ctx.device, fence, NULL));
+    }
+
+    vkDeviceWaitIdle(ctx.device);
+    vkFreeCommandBuffers(ctx.device, pool, 2, cmds);
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    destroy_descriptor_setup(ctx, &ds);
+    bench_destroy_draw_setup(ctx, &setup);
+    if (callback)
+        destroy_callback(ctx.instance, callback, NULL);
+    bench_destroy_context(&ctx);
+
+    FILE *out = fopen(output, "w");
+    if (!out) {
+        fprintf(stderr, "Couldn't write %s\n", output);
+        return 1;
+    }
+    fprintf(out, "{\n      \"name\": \"%s\",\n      \"layers\": [", config.name);
+    for (size_t i = 0; i < config.layers.size(); i++)
+        fprintf(out, "%s\"%s\"", i ? ", " : "", config.layers[i]);
+    fprintf(out, "],\n      \"peak_rss_kb\": %llu,\n", (unsigned long long)bench_peak_rss_kb());
+    fprintf(out, "      \"validation_messages\": %u,\n", validation_messages);
+    fprintf(out, "      \"entrypoints\": ");
+    t.write_json(out);
+    fprintf(out, "\n    }");
+    return fclose(out) == 0 ? 0 : 1;
+}
+
+static bool read_file(const std::string &path, std::string *contents) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+        contents->append(buf, n);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t draws = bench_arg_uint(argc, argv, "draws", 100000);
+    const uint32_t submits = bench_arg_uint(argc, argv, "submits", 1000);
+    const uint32_t instances = bench_arg_uint(argc, argv, "instances", 10);
+    const char *only = bench_arg_str(argc, argv, "only", NULL);
+    const char *output = bench_arg_str(argc, argv, "output", "vk_layer_overhead.json");
+    const std::vector<layer_config> configs = all_configs();
+
+    const char *child = bench_arg_str(argc, argv, "child", NULL);
+    if (child) {
+        uint32_t index = (uint32_t)strtoul(child, NULL, 0);
+        if (index >= configs.size())
+            return 1;
+        return run_config(configs[index], draws, submits, instances, bench_arg_str(argc, argv, "child-output", ""));
+    }
+
+#if defined(_WIN32)
+    int pid = _getpid();
+#else
+    int pid = (int)getpid();
+#endif
+    std::string results;
+    uint32_t run = 0;
+    for (uint32_t i = 0; i < configs.size(); i++) {
+        if (only && strcmp(only, configs[i].name))
+            continue;
+        printf("%s\n", configs[i].name);
+        fflush(stdout);
+
+        char child_output[64];
+        snprintf(child_output, sizeof(child_output), "vk_layer_overhead.%d.%u.tmp", pid, i);
+        char cmd[1024];
+        snprintf(cmd, sizeof(cmd), "\"%s\" --child=%u --child-output=%s --draws=%u --submits=%u --instances=%u", argv[0], i,
+                 child_output, draws, submits, instances);
+        std::string result;
+        if (system(cmd) != 0 || !read_file(child_output, &result)) {
+            fprintf(stderr, "  %s failed, skipping it\n", configs[i].name);
+            result = std::string("{\"name\": \"") + configs[i].name + "\", \"error\": \"run failed\"}";
+        }
+        remove(child_output);
+        results += (run++ ? ",\n    " : "    ") + result;
+    }
+
+    FILE *out = fopen(output, "w");
+    if (!out) {
+        fprintf(stderr, "Couldn't write %s\n", output);
+        return 1;
+    }
+    fprintf(out, "{\n  \"benchmark\": \"vk_layer_overhead\",\n");
+    fprintf(out, "  \"header_version\": %u,\n", VK_HEADER_VERSION);
+    fprintf(out, "  \"draws\": %u,\n  \"submits\": %u,\n  \"instances\": %u,\n", draws, submits, instances);
+    fprintf(out, "  \"configurations\": [\n%s\n  ]\n}\n", results.c_str());
+    fclose(out);
+    printf("Results written to %s\n", output);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Resolves every entrypoint name the loader knows about through
+// vkGetInstanceProcAddr and vkGetDeviceProcAddr and reports ns/lookup.
+//
+// Usage: vk_loader_gpa_lookup [--iterations=N]
+//   --iterations  passes over the full name list (default 2000)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+#include "loader_entrypoint_hash.h"
+
+template <typename GPA> static double time_lookups(GPA gpa, uint32_t iterations, uint32_t *resolved) {
+    volatile uintptr_t sink = 0;
+    *resolved = 0;
+    for (uint32_t i = 0; i < LOADER_EP_COUNT; i++) {
+        if (gpa(loader_entrypoint_names[i]))
+            (*resolved)++;
+    }
+
+    bench_timer timer;
+    for (uint32_t it = 0; it < iterations; it++) {
+        for (uint32_t i = 0; i < LOADER_EP_COUNT; i++) {
+            sink += (uintptr_t)gpa(loader_entrypoint_names[i]);
+        }
+    }
+    double elapsed = timer.elapsed_seconds();
+    return elapsed * 1e9 / ((double)iterations * LOADER_EP_COUNT);
+}
+
+int main(int argc, char **argv) {
+    const uint32_t iterations = bench_arg_uint(argc, argv, "iterations", 2000);
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, std::vector<const char *>()))
+        return 1;
+
+    uint32_t resolved;
+    double ns = time_lookups([&](const char *name) { return vkGetInstanceProcAddr(ctx.instance, name); }, iterations,
+                             &resolved);
+    printf("vkGetInstanceProcAddr: %u names (%u resolved), %.1f ns/lookup\n", LOADER_EP_COUNT, resolved, ns);
+
+    ns = time_lookups([&](const char *name) { return vkGetDeviceProcAddr(ctx.device, name); }, iterations, &resolved);
+    printf("vkGetDeviceProcAddr:   %u names (%u resolved), %.1f ns/lookup\n", LOADER_EP_COUNT, resolved, ns);
+
+    bench_destroy_context(&ctx);
+    return 0;
+}
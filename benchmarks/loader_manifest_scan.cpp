@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares layer manifest scanning with and without VK_LOADER_MANIFEST_CACHE.
+// A few hundred synthetic layer manifests are written to a scratch directory
+// that VK_LAYER_PATH points at, then each mode runs in a fresh child process
+// (the cache is loaded once per process) timing vkEnumerateInstanceLayerProperties.
+//
+// Usage: vk_loader_manifest_scan [--manifests=N] [--iterations=N]
+//   --manifests   synthetic manifests to generate (default 300)
+//   --iterations  enumerations timed per child after the first (default 20)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <thread>
+#if defined(_WIN32)
+#include <direct.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "bench_common.h"
+
+static void set_env(const char *name, const char *value) {
+#if defined(_WIN32)
+    _putenv_s(name, value ? value : "");
+#else
+    if (value)
+        setenv(name, value, 1);
+    else
+        unsetenv(name);
+#endif
+}
+
+static std::string make_scratch_dir() {
+#if defined(_WIN32)
+    char templ[] = "vkmcXXXXXX";
+    if (_mktemp_s(templ, sizeof(templ)) != 0 || _mkdir(templ) != 0)
+        return std::string();
+    return std::string(templ);
+#else
+    char templ[] = "/tmp/vkmcXXXXXX";
+    if (!mkdtemp(templ))
+        return std::string();
+    return std::string(templ);
+#endif
+}
+
+static bool write_manifest(const std::string &path, uint32_t index) {
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    fprintf(file, "{\n"
+                  "    \"file_format_version\" : \"1.0.0\",\n"
+                  "    \"layer\": {\n"
+                  "        \"name\": \"VK_LAYER_BENCH_synthetic_%u\",\n"
+                  "        \"type\": \"GLOBAL\",\n"
+                  "        \"library_path\": \"./libVkLayer_bench_%u.so\",\n"
+                  "        \"api_version\": \"1.0.8\",\n"
+                  "        \"implementation_version\": \"1\",\n"
+                  "        \"description\": \"Synthetic layer %u for manifest scan timing\",\n"
+                  "        \"instance_extensions\": [\n"
+                  "            { \"name\": \"VK_EXT_debug_report\", \"spec_version\": \"2\" }\n"
+                  "        ],\n"
+                  "        \"device_extensions\": [\n"
+                  "            { \"name\": \"VK_BENCH_synthetic_%u\", \"spec_version\": \"1\",\n"
+                  "              \"entrypoints\": [\"vkBenchFirst%u\", \"vkBenchSecond%u\"] }\n"
+                  "        ]\n"
+                  "    }\n"
+                  "}\n",
+            index, index, index, index, index, index);
+    return fclose(file) == 0;
+}
+
+static int run_child(uint32_t iterations) {
+    uint32_t count = 0;
+    bench_timer timer;
+    vkEnumerateInstanceLayerProperties(&count, NULL);
+    double first = timer.elapsed_seconds();
+
+    timer.restart();
+    for (uint32_t i = 0; i < iterations; i++)
+        vkEnumerateInstanceLayerProperties(&count, NULL);
+    double steady = iterations ? timer.elapsed_seconds() / iterations : 0.0;
+
+    printf("    first enumerate %8.3f ms, then %8.3f ms/enumerate (%u layers)\n", first * 1e3, steady * 1e3, count);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t manifests = bench_arg_uint(argc, argv, "manifests", 300);
+    const uint32_t iterations = bench_arg_uint(argc, argv, "iterations", 20);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--child"))
+            return run_child(iterations);
+    }
+
+    std::string dir = make_scratch_dir();
+    if (dir.empty()) {
+        fprintf(stderr, "Couldn't create scratch directory\n");
+        return 1;
+    }
+    std::vector<std::string> files;
+    for (uint32_t i = 0; i < manifests; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "/layer_%04u.json", i);
+        files.push_back(dir + name);
+        if (!write_manifest(files.back(), i)) {
+            fprintf(stderr, "Couldn't write %s\n", files.back().c_str());
+            return 1;
+        }
+    }
+    // The cache distrusts files modified in the second they were parsed
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    std::string cache_file = dir + "/manifest_cache.bin";
+    char cmd[1024];
+    snprintf(cmd, sizeof(cmd), "\"%s\" --child --iterations=%u", argv[0], iterations);
+    set_env("VK_LAYER_PATH", dir.c_str());
+
+    printf("%u synthetic layer manifests in %s\n", manifests, dir.c_str());
+    printf("  uncached:\n");
+    fflush(stdout);
+    set_env("VK_LOADER_MANIFEST_CACHE", NULL);
+    if (system(cmd) != 0)
+        fprintf(stderr, "child failed\n");
+
+    printf("  cache cold (populating %s):\n", cache_file.c_str());
+    fflush(stdout);
+    set_env("VK_LOADER_MANIFEST_CACHE", cache_file.c_str());
+    if (system(cmd) != 0)
+        fprintf(stderr, "child failed\n");
+
+    printf("  cache warm:\n");
+    fflush(stdout);
+    if (system(cmd) != 0)
+        fprintf(stderr, "child failed\n");
+
+    for (size_t i = 0; i < files.size(); i++)
+        remove(files[i].c_str());
+    remove(cache_file.c_str());
+#if defined(_WIN32)
+    _rmdir(dir.c_str());
+#else
+    rmdir(dir.c_str());
+#endif
+    return 0;
+}
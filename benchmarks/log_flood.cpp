@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of a layer reporting the same error over and over: every
+// draw is recorded outside of a render pass, so core_validation reports the same
+// message for the same command buffer on each one.  An app callback counts what
+// reaches it.  Run it from a directory whose
+// vk_layer_settings.txt sets lunarg_core_validation.duplicate_message_limit to
+// see the effect of the limit; without one every message is formatted and
+// passed to the callback.
+//
+// Usage: vk_log_flood [--draws=N] [--cmdbufs=N] [--layer=0|1]
+//   --draws    draws recorded into each command buffer (default 100000)
+//   --cmdbufs  command buffers recorded (default 10)
+//   --layer    0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+static uint64_t messages = 0;
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL count_messages(VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT objType,
+                                                     uint64_t srcObject, size_t location, int32_t msgCode,
+                                                     const char *pLayerPrefix, const char *pMsg, void *pUserData) {
+    if (messages++ < 3)
+        fprintf(stderr, "  %s: %s\n", pLayerPrefix, pMsg);
+    return VK_FALSE;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t draws = bench_arg_uint(argc, argv, "draws", 100000);
+    const uint32_t cmdbufs = bench_arg_uint(argc, argv, "cmdbufs", 10);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+    if (!draws || !cmdbufs) {
+        fprintf(stderr, "--draws and --cmdbufs must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers, std::vector<const char *>(1, VK_EXT_DEBUG_REPORT_EXTENSION_NAME)))
+        return 1;
+    VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+    PFN_vkCreateDebugReportCallbackEXT create_callback =
+        (PFN_vkCreateDebugReportCallbackEXT)vkGetInstanceProcAddr(ctx.instance, "vkCreateDebugReportCallbackEXT");
+    PFN_vkDestroyDebugReportCallbackEXT destroy_callback =
+        (PFN_vkDestroyDebugReportCallbackEXT)vkGetInstanceProcAddr(ctx.instance, "vkDestroyDebugReportCallbackEXT");
+    if (create_callback && destroy_callback) {
+        VkDebugReportCallbackCreateInfoEXT cb_info = {};
+        cb_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+        cb_info.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
+        cb_info.pfnCallback = count_messages;
+        create_callback(ctx.instance, &cb_info, NULL, &callback);
+    }
+
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup)) {
+        fprintf(stderr, "Failed to create draw objects\n");
+        return 1;
+    }
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    VkCommandPool pool;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    VkCommandBuffer cmd;
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, &cmd);
+
+    printf("core_validation %s, %u draws outside a render pass per command buffer\n",
+           use_layer ? "enabled" : "disabled", draws);
+    printf("%12s %14s %14s\n", "cmdbufs", "ns/draw", "messages");
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    double total = 0.0;
+    for (uint32_t i = 0; i < cmdbufs; i++) {
+        bench_timer timer;
+        vkBeginCommandBuffer(cmd, &begin);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, setup.pipeline);
+        for (uint32_t draw = 0; draw < draws; draw++)
+            vkCmdDraw(cmd, 3, 1, 0, 0);
+        vkEndCommandBuffer(cmd);
+        const double seconds = timer.elapsed_seconds();
+        total += seconds;
+        printf("%12u %14.1f %14llu\n", i + 1, seconds * 1e9 / draws, (unsigned long long)messages);
+    }
+    printf("record total   %10.3f ms\n", total * 1e3);
+
+    vkFreeCommandBuffers(ctx.device, pool, 1, &cmd);
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    bench_destroy_draw_setup(ctx, &setup);
+    vkDestroyDevice(ctx.device, NULL);
+    ctx.device = VK_NULL_HANDLE;
+    printf("messages after vkDestroyDevice %llu\n", (unsigned long long)messages);
+    if (callback)
+        destroy_callback(ctx.instance, callback, NULL);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures vkBindBufferMemory/vkBindImageMemory through core_validation when
+// many resources are sub-allocated from one VkDeviceMemory, the way engines
+// pool memory.  Every --image-every'th resource is an image so both the buffer
+// and image range sets of the allocation grow.  Bind cost is reported for each
+// tenth of the run so growth with the number of bound ranges is visible, and
+// destruction (which removes the ranges again) is timed as a whole.
+//
+// Usage: vk_memory_bind [--binds=N] [--image-every=N] [--layer=0|1]
+//   --binds        resources bound into the allocation (default 50000)
+//   --image-every  make every Nth resource an image, 0 for none (default 8)
+//   --layer        0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+struct bound_resource {
+    VkBuffer buffer;
+    VkImage image;
+};
+
+static const VkDeviceSize slot_size = 256;
+
+int main(int argc, char **argv) {
+    const uint32_t binds = bench_arg_uint(argc, argv, "binds", 50000);
+    const uint32_t image_every = bench_arg_uint(argc, argv, "image-every", 8);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = slot_size * binds;
+    alloc_info.memoryTypeIndex = 0;
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(ctx.device, &alloc_info, NULL, &memory) != VK_SUCCESS) {
+        fprintf(stderr, "vkAllocateMemory failed\n");
+        return 1;
+    }
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = slot_size;
+    buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkImageCreateInfo image_info = {};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_info.extent.width = 4;
+    image_info.extent.height = 4;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Creation is not what is being measured, so do it all up front
+    std::vector<bound_resource> resources(binds);
+    for (uint32_t i = 0; i < binds; i++) {
+        resources[i].buffer = VK_NULL_HANDLE;
+        resources[i].image = VK_NULL_HANDLE;
+        if (image_every && (i % image_every) == image_every - 1)
+            vkCreateImage(ctx.device, &image_info, NULL, &resources[i].image);
+        else
+            vkCreateBuffer(ctx.device, &buffer_info, NULL, &resources[i].buffer);
+    }
+
+    printf("core_validation %s, %u binds into one %llu byte allocation\n", use_layer ? "enabled" : "disabled", binds,
+           (unsigned long long)alloc_info.allocationSize);
+    printf("%12s %14s\n", "bound", "ns/bind");
+    const uint32_t slices = binds < 10 ? 1 : 10;
+    double total = 0.0;
+    uint32_t i = 0;
+    for (uint32_t slice = 0; slice < slices; slice++) {
+        const uint32_t slice_end = (slice == slices - 1) ? binds : binds / slices * (slice + 1);
+        const uint32_t slice_start = i;
+        bench_timer timer;
+        for (; i < slice_end; i++) {
+            if (resources[i].image != VK_NULL_HANDLE)
+                vkBindImageMemory(ctx.device, resources[i].image, memory, slot_size * i);
+            else
+                vkBindBufferMemory(ctx.device, resources[i].buffer, memory, slot_size * i);
+        }
+        double elapsed = timer.elapsed_seconds();
+        total += elapsed;
+        printf("%12u %14.1f\n", slice_end, elapsed * 1e9 / (slice_end - slice_start));
+    }
+    printf("bind total     %10.3f ms\n", total * 1e3);
+
+    bench_timer timer;
+    for (uint32_t r = 0; r < binds; r++) {
+        if (resources[r].image != VK_NULL_HANDLE)
+            vkDestroyImage(ctx.device, resources[r].image, NULL);
+        else
+            vkDestroyBuffer(ctx.device, resources[r].buffer, NULL);
+    }
+    printf("destroy total  %10.3f ms\n", timer.elapsed_seconds() * 1e3);
+
+    vkFreeMemory(ctx.device, memory, NULL);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures vkMapMemory, vkFlushMappedMemoryRanges and vkUnmapMemory through
+// core_validation on host-visible memory that is not coherent, where the layer
+// hands the app a guarded shadow copy and moves flushed data to the driver's
+// mapping.  Each flush writes and flushes one small range of a large mapping,
+// the way streaming uploads do.  Run it from a directory whose
+// vk_layer_settings.txt sets lunarg_core_validation.noncoherent_memory_guard
+// to compare the guard modes.
+//
+// Usage: vk_noncoherent_flush [--size-mb=N] [--flush-bytes=N] [--flushes=N] [--layer=0|1]
+//   --size-mb      size of the mapped allocation in MiB (default 64)
+//   --flush-bytes  bytes written and flushed per flush (default 4096)
+//   --flushes      flushes timed (default 2000)
+//   --layer        0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_common.h"
+
+static uint32_t find_noncoherent_type(const bench_context &ctx) {
+    VkPhysicalDeviceMemoryProperties props;
+    vkGetPhysicalDeviceMemoryProperties(ctx.gpu, &props);
+    for (uint32_t i = 0; i < props.memoryTypeCount; i++) {
+        const VkMemoryPropertyFlags flags = props.memoryTypes[i].propertyFlags;
+        if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+            return i;
+    }
+    return UINT32_MAX;
+}
+
+int main(int argc, char **argv) {
+    const VkDeviceSize size = (VkDeviceSize)bench_arg_uint(argc, argv, "size-mb", 64) << 20;
+    const uint32_t flush_bytes = bench_arg_uint(argc, argv, "flush-bytes", 4096);
+    const uint32_t flushes = bench_arg_uint(argc, argv, "flushes", 2000);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = size;
+    alloc_info.memoryTypeIndex = find_noncoherent_type(ctx);
+    if (alloc_info.memoryTypeIndex == UINT32_MAX || flush_bytes == 0 || flush_bytes > size) {
+        fprintf(stderr, "No host-visible, non-coherent memory type or bad --flush-bytes\n");
+        return 1;
+    }
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(ctx.device, &alloc_info, NULL, &memory) != VK_SUCCESS) {
+        fprintf(stderr, "vkAllocateMemory failed\n");
+        return 1;
+    }
+
+    printf("core_validation %s, %llu byte mapping, %u bytes per flush\n", use_layer ? "enabled" : "disabled",
+           (unsigned long long)size, flush_bytes);
+
+    bench_timer timer;
+    void *mapped = NULL;
+    if (vkMapMemory(ctx.device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+        fprintf(stderr, "vkMapMemory failed\n");
+        return 1;
+    }
+    printf("map            %10.3f ms\n", timer.elapsed_seconds() * 1e3);
+
+    const uint32_t slots = (uint32_t)(size / flush_bytes);
+    VkMappedMemoryRange range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = memory;
+    range.size = flush_bytes;
+    timer.restart();
+    for (uint32_t i = 0; i < flushes; i++) {
+        range.offset = (VkDeviceSize)(i % slots) * flush_bytes;
+        memset(static_cast<char *>(mapped) + range.offset, (int)i, flush_bytes);
+        vkFlushMappedMemoryRanges(ctx.device, 1, &range);
+    }
+    printf("flush          %10.1f us/flush\n", timer.elapsed_seconds() * 1e6 / (flushes ? flushes : 1));
+
+    timer.restart();
+    vkUnmapMemory(ctx.device, memory);
+    printf("unmap          %10.3f ms\n", timer.elapsed_seconds() * 1e3);
+    printf("peak rss       %10llu kB\n", (unsigned long long)bench_peak_rss_kb());
+
+    vkFreeMemory(ctx.device, memory, NULL);
+    bench_destroy_context(&ctx);
+    return 0;
+}
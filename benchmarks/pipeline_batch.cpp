@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures vkCreateGraphicsPipelines through core_validation when pipelines
+// are created in large batches, the way engines do while streaming in a level.
+// Every pipeline of a batch uses one of --modules vertex shaders padded to
+// --constants constants, so the per-pipeline shader walks have some size.
+//
+// Usage: vk_pipeline_batch [--pipelines=N] [--batches=N] [--modules=N] [--constants=N] [--layer=0|1]
+//   --pipelines  pipelines per vkCreateGraphicsPipelines call (default 500)
+//   --batches    calls timed (default 10)
+//   --modules    distinct vertex shaders the pipelines use (default 50)
+//   --constants  constants padding each vertex shader (default 2000)
+//   --layer      0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+int main(int argc, char **argv) {
+    const uint32_t pipelines = bench_arg_uint(argc, argv, "pipelines", 500);
+    const uint32_t batches = bench_arg_uint(argc, argv, "batches", 10);
+    const uint32_t modules = bench_arg_uint(argc, argv, "modules", 50);
+    const uint32_t constants = bench_arg_uint(argc, argv, "constants", 2000);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+    if (!pipelines || !modules) {
+        fprintf(stderr, "--pipelines and --modules must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup)) {
+        fprintf(stderr, "Failed to create draw setup\n");
+        return 1;
+    }
+
+    std::vector<VkShaderModule> vs(modules);
+    std::vector<uint32_t> code;
+    for (uint32_t i = 0; i < modules; i++) {
+        bench_vertex_shader_code(i, constants, &code);
+        VkShaderModuleCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        info.codeSize = code.size() * sizeof(uint32_t);
+        info.pCode = code.data();
+        vkCreateShaderModule(ctx.device, &info, NULL, &vs[i]);
+    }
+
+    // Same fixed-function state as bench_create_draw_setup's pipeline
+    VkPipelineVertexInputStateCreateInfo vi = {};
+    vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    VkPipelineInputAssemblyStateCreateInfo ia = {};
+    ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkViewport viewport = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+    VkRect2D scissor = {{0, 0}, {64, 64}};
+    VkPipelineViewportStateCreateInfo vp = {};
+    vp.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    vp.viewportCount = 1;
+    vp.pViewports = &viewport;
+    vp.scissorCount = 1;
+    vp.pScissors = &scissor;
+    VkPipelineRasterizationStateCreateInfo rs = {};
+    rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rs.polygonMode = VK_POLYGON_MODE_FILL;
+    rs.cullMode = VK_CULL_MODE_NONE;
+    rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rs.lineWidth = 1.0f;
+    VkPipelineMultisampleStateCreateInfo ms = {};
+    ms.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkPipelineColorBlendStateCreateInfo cb = {};
+    cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages(pipelines * 2);
+    std::vector<VkGraphicsPipelineCreateInfo> infos(pipelines);
+    for (uint32_t i = 0; i < pipelines; i++) {
+        VkPipelineShaderStageCreateInfo *stage = &stages[i * 2];
+        stage[0] = VkPipelineShaderStageCreateInfo();
+        stage[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stage[0].module = vs[i % modules];
+        stage[0].pName = "main";
+        stage[1] = stage[0];
+        stage[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stage[1].module = setup.fs;
+
+        infos[i] = VkGraphicsPipelineCreateInfo();
+        infos[i].sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        infos[i].stageCount = 2;
+        infos[i].pStages = stage;
+        infos[i].pVertexInputState = &vi;
+        infos[i].pInputAssemblyState = &ia;
+        infos[i].pViewportState = &vp;
+        infos[i].pRasterizationState = &rs;
+        infos[i].pMultisampleState = &ms;
+        infos[i].pColorBlendState = &cb;
+        infos[i].layout = setup.pipeline_layout;
+        infos[i].renderPass = setup.render_pass;
+    }
+
+    printf("core_validation %s, %u batches of %u pipelines, vertex shaders of %u words\n", use_layer ? "enabled" : "disabled",
+           batches, pipelines, (uint32_t)code.size());
+    std::vector<VkPipeline> handles(pipelines);
+    double total = 0.0;
+    for (uint32_t batch = 0; batch < batches; batch++) {
+        bench_timer timer;
+        if (vkCreateGraphicsPipelines(ctx.device, VK_NULL_HANDLE, pipelines, infos.data(), NULL, handles.data()) != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateGraphicsPipelines failed\n");
+            return 1;
+        }
+        total += timer.elapsed_seconds();
+        for (uint32_t i = 0; i < pipelines; i++)
+            vkDestroyPipeline(ctx.device, handles[i], NULL);
+    }
+    printf("create         %10.2f us/pipeline\n", total * 1e6 / ((double)pipelines * (batches ? batches : 1)));
+
+    for (uint32_t i = 0; i < modules; i++)
+        vkDestroyShaderModule(ctx.device, vs[i], NULL);
+    bench_destroy_draw_setup(ctx, &setup);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how core_validation's completion tracking scales with submission
+// history.  Each frame makes --submits submits spread round-robin over
+// --queues queues, each submit waiting on a semaphore the previous one
+// signaled, and only the last submit of a frame carries a fence.  With
+// --in-flight frames outstanding, each frame first waits on the fence of the
+// frame that used its slot before, which retires that frame's work on every
+// queue through the semaphore chain.  vkQueueSubmit and vkWaitForFences cost
+// is reported for each tenth of the run so growth with history is visible.
+//
+// Usage: vk_queue_retire [--frames=N] [--submits=N] [--queues=N] [--in-flight=N] [--layer=0|1]
+//   --frames     frames submitted (default 20000)
+//   --submits    submits per frame (default 6)
+//   --queues     queues submitted to (default 3)
+//   --in-flight  frames in flight (default 2)
+//   --layer      0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+int main(int argc, char **argv) {
+    const uint32_t frames = bench_arg_uint(argc, argv, "frames", 20000);
+    const uint32_t submits = bench_arg_uint(argc, argv, "submits", 6);
+    const uint32_t queue_count = bench_arg_uint(argc, argv, "queues", 3);
+    const uint32_t in_flight = bench_arg_uint(argc, argv, "in-flight", 2);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+    if (!frames || !submits || !queue_count || !in_flight) {
+        fprintf(stderr, "--frames, --submits, --queues and --in-flight must be non-zero\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers, std::vector<const char *>(), queue_count))
+        return 1;
+
+    std::vector<VkQueue> queues(queue_count);
+    for (uint32_t q = 0; q < queue_count; q++)
+        vkGetDeviceQueue(ctx.device, ctx.graphics_queue_family, q, &queues[q]);
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.queueFamilyIndex = ctx.graphics_queue_family;
+    VkCommandPool pool;
+    vkCreateCommandPool(ctx.device, &pool_info, NULL, &pool);
+
+    // One command buffer and one semaphore per submit slot of each in-flight frame
+    const uint32_t slots = submits * in_flight;
+    std::vector<VkCommandBuffer> cmds(slots);
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = slots;
+    vkAllocateCommandBuffers(ctx.device, &alloc_info, cmds.data());
+    VkCommandBufferBeginInfo begin = {};
+    begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    for (uint32_t i = 0; i < slots; i++) {
+        vkBeginCommandBuffer(cmds[i], &begin);
+        vkEndCommandBuffer(cmds[i]);
+    }
+
+    std::vector<VkSemaphore> semaphores(slots);
+    VkSemaphoreCreateInfo sem_info = {};
+    sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    for (uint32_t i = 0; i < slots; i++)
+        vkCreateSemaphore(ctx.device, &sem_info, NULL, &semaphores[i]);
+
+    std::vector<VkFence> fences(in_flight);
+    std::vector<bool> fence_pending(in_flight, false);
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    for (uint32_t i = 0; i < in_flight; i++)
+        vkCreateFence(ctx.device, &fence_info, NULL, &fences[i]);
+
+    printf("core_validation %s, %u frames of %u submits over %u queues, %u in flight\n", use_layer ? "enabled" : "disabled",
+           frames, submits, queue_count, in_flight);
+    printf("%12s %14s %14s\n", "frames", "ns/submit", "ns/wait");
+    const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    const uint32_t slices = frames < 10 ? 1 : 10;
+    uint32_t frame = 0;
+    uint32_t submit_index = 0;
+    VkSemaphore last_signaled = VK_NULL_HANDLE;
+    for (uint32_t slice = 0; slice < slices; slice++) {
+        const uint32_t slice_end = (slice == slices - 1) ? frames : frames / slices * (slice + 1);
+        const uint32_t slice_start = frame;
+        double submit_seconds = 0.0;
+        double wait_seconds = 0.0;
+        for (; frame < slice_end; frame++) {
+            const uint32_t slot = frame % in_flight;
+            if (fence_pending[slot]) {
+                bench_timer timer;
+                vkWaitForFences(ctx.device, 1, &fences[slot], VK_TRUE, UINT64_MAX);
+                wait_seconds += timer.elapsed_seconds();
+                vkResetFences(ctx.device, 1, &fences[slot]);
+            }
+            bench_timer timer;
+            for (uint32_t s = 0; s < submits; s++) {
+                const uint32_t index = slot * submits + s;
+                VkSubmitInfo submit = {};
+                submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                if (last_signaled != VK_NULL_HANDLE) {
+                    submit.waitSemaphoreCount = 1;
+                    submit.pWaitSemaphores = &last_signaled;
+                    submit.pWaitDstStageMask = &wait_stage;
+                }
+                submit.commandBufferCount = 1;
+                submit.pCommandBuffers = &cmds[index];
+                submit.signalSemaphoreCount = 1;
+                submit.pSignalSemaphores = &semaphores[index];
+                vkQueueSubmit(queues[submit_index++ % queue_count], 1, &submit,
+                              s == submits - 1 ? fences[slot] : VK_NULL_HANDLE);
+                last_signaled = semaphores[index];
+            }
+            submit_seconds += timer.elapsed_seconds();
+            fence_pending[slot] = true;
+        }
+        const uint32_t slice_frames = slice_end - slice_start;
+        printf("%12u %14.1f %14.1f\n", slice_end, submit_seconds * 1e9 / (slice_frames * submits),
+               wait_seconds * 1e9 / slice_frames);
+    }
+    printf("peak rss       %10llu kB\n", (unsigned long long)bench_peak_rss_kb());
+
+    vkDeviceWaitIdle(ctx.device);
+    for (uint32_t i = 0; i < in_flight; i++)
+        vkDestroyFence(ctx.device, fences[i], NULL);
+    for (uint32_t i = 0; i < slots; i++)
+        vkDestroySemaphore(ctx.device, semaphores[i], NULL);
+    vkFreeCommandBuffers(ctx.device, pool, slots, cmds.data());
+    vkDestroyCommandPool(ctx.device, pool, NULL);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the SPIR-V work core_validation does for a corpus of shader
+// modules: decoding each module at vkCreateShaderModule, and the entrypoint
+// interface, descriptor and capability checks at pipeline creation.
+//
+// The corpus is a text file listing one .spv path per line.  Vertex shaders
+// are paired with the trivial fragment shader from bench_create_draw_setup,
+// fragment shaders with its vertex shader, and compute shaders get a compute
+// pipeline.  Modules with any other first entrypoint are skipped.  The
+// pipeline layout is empty, so shaders that use descriptors are reported as
+// errors and not created, but they are still walked in full.  Without
+// --corpus, --modules generated vertex shaders padded to --constants
+// constants are used instead.
+//
+// Usage: vk_shader_interface [--corpus=FILE] [--modules=N] [--constants=N] [--iterations=N] [--layer=0|1]
+//   --corpus      file listing the .spv modules to use (default none)
+//   --modules     generated modules when there is no corpus (default 100)
+//   --constants   constants padding each generated module (default 2000)
+//   --iterations  times every pipeline is created (default 20)
+//   --layer       0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "bench_common.h"
+
+// SPIR-V opcode and execution models, from the spec
+static const uint32_t SPV_MAGIC = 0x07230203;
+static const uint32_t SPV_OP_ENTRY_POINT = 15;
+static const uint32_t SPV_EXECUTION_MODEL_VERTEX = 0;
+static const uint32_t SPV_EXECUTION_MODEL_FRAGMENT = 4;
+static const uint32_t SPV_EXECUTION_MODEL_GL_COMPUTE = 5;
+
+struct corpus_module {
+    std::string name;
+    std::vector<uint32_t> code;
+    VkShaderStageFlagBits stage;
+    std::string entrypoint;
+    VkShaderModule module;
+};
+
+static bool read_spv(const char *path, std::vector<uint32_t> *code) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bool ok = size > 0 && size % 4 == 0;
+    if (ok) {
+        code->resize(size / 4);
+        ok = fread(code->data(), 4, code->size(), file) == code->size();
+    }
+    fclose(file);
+    return ok && (*code)[0] == SPV_MAGIC;
+}
+
+// Find the stage and name of the module's first entrypoint we can build a pipeline for
+static bool find_stage(corpus_module *m) {
+    for (size_t offset = 5; offset < m->code.size();) {
+        uint32_t len = m->code[offset] >> 16;
+        uint32_t opcode = m->code[offset] & 0xffff;
+        if (len == 0 || offset + len > m->code.size())
+            return false;
+        if (opcode == SPV_OP_ENTRY_POINT && len > 3) {
+            switch (m->code[offset + 1]) {
+            case SPV_EXECUTION_MODEL_VERTEX:
+                m->stage = VK_SHADER_STAGE_VERTEX_BIT;
+                break;
+            case SPV_EXECUTION_MODEL_FRAGMENT:
+                m->stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+                break;
+            case SPV_EXECUTION_MODEL_GL_COMPUTE:
+                m->stage = VK_SHADER_STAGE_COMPUTE_BIT;
+                break;
+            default:
+                offset += len;
+                continue;
+            }
+            const char *name = (const char *)&m->code[offset + 3];
+            m->entrypoint.assign(name, strnlen(name, (len - 3) * 4));
+            return true;
+        }
+        offset += len;
+    }
+    return false;
+}
+
+static bool load_corpus(const char *list, std::vector<corpus_module> *corpus) {
+    FILE *file = fopen(list, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open corpus list %s\n", list);
+        return false;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (!line[0] || line[0] == '#')
+            continue;
+        corpus_module m;
+        m.name = line;
+        m.module = VK_NULL_HANDLE;
+        if (!read_spv(line, &m.code)) {
+            fprintf(stderr, "Skipping %s: not a SPIR-V module\n", line);
+            continue;
+        }
+        if (!find_stage(&m)) {
+            fprintf(stderr, "Skipping %s: no vertex, fragment or compute entrypoint\n", line);
+            continue;
+        }
+        corpus->push_back(m);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *corpus_list = bench_arg_str(argc, argv, "corpus", NULL);
+    const uint32_t modules = bench_arg_uint(argc, argv, "modules", 100);
+    const uint32_t constants = bench_arg_uint(argc, argv, "constants", 2000);
+    const uint32_t iterations = bench_arg_uint(argc, argv, "iterations", 20);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+
+    std::vector<corpus_module> corpus;
+    if (corpus_list) {
+        if (!load_corpus(corpus_list, &corpus))
+            return 1;
+    } else {
+        corpus.resize(modules);
+        for (uint32_t i = 0; i < modules; i++) {
+            corpus[i].name = "generated";
+            bench_vertex_shader_code(i, constants, &corpus[i].code);
+            corpus[i].stage = VK_SHADER_STAGE_VERTEX_BIT;
+            corpus[i].entrypoint = "main";
+            corpus[i].module = VK_NULL_HANDLE;
+        }
+    }
+    if (corpus.empty()) {
+        fprintf(stderr, "No usable modules\n");
+        return 1;
+    }
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    bench_context ctx;
+    if (!bench_create_context(&ctx, layers))
+        return 1;
+    bench_draw_setup setup;
+    if (!bench_create_draw_setup(ctx, &setup)) {
+        fprintf(stderr, "Failed to create draw setup\n");
+        return 1;
+    }
+
+    size_t total_words = 0;
+    bench_timer timer;
+    for (auto &m : corpus) {
+        VkShaderModuleCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        info.codeSize = m.code.size() * sizeof(uint32_t);
+        info.pCode = m.code.data();
+        if (vkCreateShaderModule(ctx.device, &info, NULL, &m.module) != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateShaderModule failed for %s\n", m.name.c_str());
+            return 1;
+        }
+        total_words += m.code.size();
+    }
+    double create_time = timer.elapsed_seconds();
+
+    // Same fixed-function state as bench_create_draw_setup's pipeline
+    VkPipelineVertexInputStateCreateInfo vi = {};
+    vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    VkPipelineInputAssemblyStateCreateInfo ia = {};
+    ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkViewport viewport = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+    VkRect2D scissor = {{0, 0}, {64, 64}};
+    VkPipelineViewportStateCreateInfo vp = {};
+    vp.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    vp.viewportCount = 1;
+    vp.pViewports = &viewport;
+    vp.scissorCount = 1;
+    vp.pScissors = &scissor;
+    VkPipelineRasterizationStateCreateInfo rs = {};
+    rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rs.polygonMode = VK_POLYGON_MODE_FILL;
+    rs.cullMode = VK_CULL_MODE_NONE;
+    rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rs.lineWidth = 1.0f;
+    VkPipelineMultisampleStateCreateInfo ms = {};
+    ms.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkPipelineColorBlendStateCreateInfo cb = {};
+    cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+
+    uint32_t rejected = 0;
+    timer.restart();
+    for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+        for (auto const &m : corpus) {
+            VkPipelineShaderStageCreateInfo stages[2] = {};
+            stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[0].stage = m.stage;
+            stages[0].module = m.module;
+            stages[0].pName = m.entrypoint.c_str();
+
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            VkResult err;
+            if (m.stage == VK_SHADER_STAGE_COMPUTE_BIT) {
+                VkComputePipelineCreateInfo info = {};
+                info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+                info.stage = stages[0];
+                info.layout = setup.pipeline_layout;
+                err = vkCreateComputePipelines(ctx.device, VK_NULL_HANDLE, 1, &info, NULL, &pipeline);
+            } else {
+                stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+                stages[1].pName = "main";
+                if (m.stage == VK_SHADER_STAGE_VERTEX_BIT) {
+                    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+                    stages[1].module = setup.fs;
+                } else {
+                    // The vertex stage comes first
+                    stages[1] = stages[0];
+                    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+                    stages[0].module = setup.vs;
+                    stages[0].pName = "main";
+                }
+                VkGraphicsPipelineCreateInfo info = {};
+                info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+                info.stageCount = 2;
+                info.pStages = stages;
+                info.pVertexInputState = &vi;
+                info.pInputAssemblyState = &ia;
+                info.pViewportState = &vp;
+                info.pRasterizationState = &rs;
+                info.pMultisampleState = &ms;
+                info.pColorBlendState = &cb;
+                info.layout = setup.pipeline_layout;
+                info.renderPass = setup.render_pass;
+                err = vkCreateGraphicsPipelines(ctx.device, VK_NULL_HANDLE, 1, &info, NULL, &pipeline);
+            }
+            if (err == VK_SUCCESS)
+                vkDestroyPipeline(ctx.device, pipeline, NULL);
+            else if (iteration == 0)
+                rejected++;
+        }
+    }
+    double pipeline_time = timer.elapsed_seconds();
+
+    printf("core_validation %s, %u modules, %llu words in total\n", use_layer ? "enabled" : "disabled",
+           (uint32_t)corpus.size(), (unsigned long long)total_words);
+    printf("module create  %10.2f us/module\n", create_time * 1e6 / corpus.size());
+    printf("pipeline       %10.2f us/pipeline (%u of %u rejected)\n",
+           pipeline_time * 1e6 / ((double)corpus.size() * (iterations ? iterations : 1)), rejected, (uint32_t)corpus.size());
+
+    for (auto const &m : corpus)
+        vkDestroyShaderModule(ctx.device, m.module, NULL);
+    bench_destroy_draw_setup(ctx, &setup);
+    bench_destroy_context(&ctx);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures vkCreateShaderModule through core_validation when an application
+// creates the same set of modules again, the way engines do on every launch
+// and on every device they create.  Each round creates a device, creates
+// --modules distinct modules, destroys them and destroys the device.  Run it
+// twice from a directory whose vk_layer_settings.txt sets
+// lunarg_core_validation.shader_cache_file to see the cost of a later launch.
+//
+// Usage: vk_shader_module_create [--modules=N] [--constants=N] [--rounds=N] [--layer=0|1]
+//   --modules    distinct modules created per round (default 2000)
+//   --constants  constants padding each module, to set its size (default 200)
+//   --rounds     device create/destroy rounds (default 3)
+//   --layer      0 runs without core_validation for a baseline (default 1)
+
+#include <stdio.h>
+
+#include "bench_common.h"
+
+int main(int argc, char **argv) {
+    const uint32_t modules = bench_arg_uint(argc, argv, "modules", 2000);
+    const uint32_t constants = bench_arg_uint(argc, argv, "constants", 200);
+    const uint32_t rounds = bench_arg_uint(argc, argv, "rounds", 3);
+    const bool use_layer = bench_arg_uint(argc, argv, "layer", 1) != 0;
+
+    std::vector<const char *> layers;
+    if (use_layer)
+        layers.push_back("VK_LAYER_LUNARG_core_validation");
+
+    // Generating the SPIR-V is not what is being measured, so do it all up front
+    std::vector<std::vector<uint32_t>> code(modules);
+    for (uint32_t i = 0; i < modules; i++)
+        bench_vertex_shader_code(i, constants, &code[i]);
+
+    printf("core_validation %s, %u modules of %u words per round\n", use_layer ? "enabled" : "disabled", modules,
+           modules ? (uint32_t)code[0].size() : 0);
+    printf("%12s %14s\n", "round", "us/module");
+    std::vector<VkShaderModule> handles(modules);
+    for (uint32_t round = 0; round < rounds; round++) {
+        bench_context ctx;
+        if (!bench_create_context(&ctx, layers))
+            return 1;
+        bench_timer timer;
+        for (uint32_t i = 0; i < modules; i++) {
+            VkShaderModuleCreateInfo info = {};
+            info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            info.codeSize = code[i].size() * sizeof(uint32_t);
+            info.pCode = code[i].data();
+            if (vkCreateShaderModule(ctx.device, &info, NULL, &handles[i]) != VK_SUCCESS) {
+                fprintf(stderr, "vkCreateShaderModule failed for module %u\n", i);
+                return 1;
+            }
+        }
+        printf("%12u %14.2f\n", round + 1, timer.elapsed_seconds() * 1e6 / (modules ? modules : 1));
+        for (uint32_t i = 0; i < modules; i++)
+            vkDestroyShaderModule(ctx.device, handles[i], NULL);
+        bench_destroy_context(&ctx);
+    }
+    printf("peak rss       %10llu kB\n", (unsigned long long)bench_peak_rss_kb());
+    return 0;
+}
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016 The Khronos Group Inc.
+# Copyright (c) 2016 Valve Corporation
+# Copyright (c) 2016 LunarG, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Perfect hash over entrypoint names, shared by the loader's entrypoint-hash
+# (loader/vk-loader-generate.py) and the layers' entrypoint_table
+# (vk-layer-generate.py) so the two lookups are always built the same way.
+#
+# A name is hashed with 32-bit FNV-1a.  Its bucket (hash % buckets) holds a
+# displacement d, and the name sits in slot mix(hash ^ d) & (slots - 1), mix
+# being murmur3's fmix32.  Displacements are chosen so every slot holds at most
+# one name; a lookup then costs one pass over the string and one strcmp.
+
+def fnv1a(name):
+    h = 2166136261
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * 16777619) & 0xffffffff
+    return h
+
+def mix(h):
+    # murmur3 fmix32, must match the <prefix>_mix() emitted below
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & 0xffffffff
+    h ^= h >> 16
+    return h
+
+def wrap(values, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(values[i:i + per_line]) + ",")
+    return lines
+
+class EntrypointHash:
+    # names are the full entrypoint names ("vkCreateInstance"); the id of a
+    # name is its index in the list.  what names the generator in errors.
+    def __init__(self, names, what):
+        self.names = names
+        hashes = [fnv1a(n) for n in names]
+        if len(set(hashes)) != len(hashes):
+            raise Exception("%s: FNV-1a collision, change the hash" % what)
+        self.slot_count = 1
+        while self.slot_count < len(names):
+            self.slot_count *= 2
+        self.bucket_count = max(1, len(names) // 3)
+
+        buckets = [[] for _ in range(self.bucket_count)]
+        for i, h in enumerate(hashes):
+            buckets[h % self.bucket_count].append(i)
+
+        self.displacements = [0] * self.bucket_count
+        self.slots = [-1] * self.slot_count
+        order = sorted(range(self.bucket_count), key=lambda b: -len(buckets[b]))
+        for b in order:
+            if not buckets[b]:
+                continue
+            for d in range(1, 0x10000):
+                placed = [mix(hashes[i] ^ d) & (self.slot_count - 1) for i in buckets[b]]
+                if len(set(placed)) == len(placed) and all(self.slots[s] < 0 for s in placed):
+                    break
+            else:
+                raise Exception("%s: no displacement found for bucket %d" % (what, b))
+            self.displacements[b] = d
+            for i, s in zip(buckets[b], placed):
+                self.slots[s] = i
+
+    # C (and C++) for the tables and <prefix>_lookup(name), which returns a
+    # name's id or <PREFIX>_UNKNOWN.  The caller defines <PREFIX>_UNKNOWN and
+    # <PREFIX>_COUNT; this defines <PREFIX>_HASH_BUCKETS and _HASH_SLOTS.
+    def generate(self, prefix, macro_prefix, id_type):
+        body = []
+        body.append("#define %s_HASH_BUCKETS %d" % (macro_prefix, self.bucket_count))
+        body.append("#define %s_HASH_SLOTS %d" % (macro_prefix, self.slot_count))
+        body.append("")
+        body.append("static const char *const %s_names[%s_COUNT] = {" % (prefix, macro_prefix))
+        body.extend(["    \"%s\"," % n for n in self.names])
+        body.append("};")
+        body.append("")
+        body.append("static const uint16_t %s_displacements[%s_HASH_BUCKETS] = {" % (prefix, macro_prefix))
+        body.extend(wrap(["%d" % d for d in self.displacements], 12))
+        body.append("};")
+        body.append("")
+        body.append("static const int16_t %s_slots[%s_HASH_SLOTS] = {" % (prefix, macro_prefix))
+        body.extend(wrap(["%d" % s for s in self.slots], 16))
+        body.append("};")
+        body.append("")
+        body.append("static inline uint32_t %s_mix(uint32_t h) {" % prefix)
+        body.append("    h ^= h >> 16;")
+        body.append("    h *= 0x85ebca6bu;")
+        body.append("    h ^= h >> 13;")
+        body.append("    h *= 0xc2b2ae35u;")
+        body.append("    h ^= h >> 16;")
+        body.append("    return h;")
+        body.append("}")
+        body.append("")
+        body.append("// Returns the %s for name, or %s_UNKNOWN." % (id_type, macro_prefix))
+        body.append("static inline int %s_lookup(const char *name) {" % prefix)
+        body.append("    uint32_t h = 2166136261u;")
+        body.append("    const char *p;")
+        body.append("    int id;")
+        body.append("")
+        body.append("    if (!name)")
+        body.append("        return %s_UNKNOWN;" % macro_prefix)
+        body.append("    for (p = name; *p; p++) {")
+        body.append("        h ^= (uint8_t)*p;")
+        body.append("        h *= 16777619u;")
+        body.append("    }")
+        body.append("    id = %s_slots[%s_mix(" % (prefix, prefix))
+        body.append("             h ^ %s_displacements[h %% %s_HASH_BUCKETS]) &" % (prefix, macro_prefix))
+        body.append("         (%s_HASH_SLOTS - 1)];" % macro_prefix)
+        body.append("    if (id < 0 || strcmp(%s_names[id], name))" % prefix)
+        body.append("        return %s_UNKNOWN;" % macro_prefix)
+        body.append("    return id;")
+        body.append("}")
+        body.append("")
+        return body
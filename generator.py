@@ -2640,7 +2640,7 @@ class ThreadOutputGenerator(OutputGenerator):
         self.newline()
         # record intercepted procedures
         write('// intercepts', file=self.outFile)
-        write('struct { const char* name; PFN_vkVoidFunction pFunc;} procmap[] = {', file=self.outFile)
+        write('static const layer_intercept_table procmap = {', file=self.outFile)
         write('\n'.join(self.intercepts), file=self.outFile)
         write('};\n', file=self.outFile)
         self.newline()
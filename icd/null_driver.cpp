@@ -0,0 +1,681 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Null ICD: a driver that accepts every call and does no work, so the loader
+// and layers can be exercised and benchmarked on machines without a GPU.
+// Point VK_ICD_FILENAMES at VkICD_null_driver.json to use it.
+//
+// Dispatchable objects carry the loader magic, buffers, images, memory and
+// command pools are small host structs, and every other handle is a unique
+// counter value.  Entry points without state of their own are generated into
+// null_driver_entrypoints.h by vk-generate.py.
+
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_set>
+
+#include "vulkan/vk_icd.h"
+
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define NULL_DRIVER_EXPORT __attribute__((visibility("default")))
+#elif defined(__SUNPRO_C) && (__SUNPRO_C >= 0x590)
+#define NULL_DRIVER_EXPORT __attribute__((visibility("default")))
+#else
+#define NULL_DRIVER_EXPORT
+#endif
+
+static const uint32_t NULL_QUEUE_COUNT = 4;
+static const VkDeviceSize NULL_RESOURCE_ALIGNMENT = 256;
+// Every memory type is allowed for every resource
+static const uint32_t NULL_MEMORY_TYPE_BITS = 0x7;
+static const uint8_t null_pipeline_cache_uuid[VK_UUID_SIZE] = {'n', 'u', 'l', 'l', '-', 'd', 'r', 'i',
+                                                               'v', 'e', 'r', 0,   0,   0,   0,   1};
+
+struct null_physical_device {
+    VK_LOADER_DATA loader_data;
+};
+
+struct null_instance {
+    VK_LOADER_DATA loader_data;
+    null_physical_device physical_device;
+};
+
+struct null_queue {
+    VK_LOADER_DATA loader_data;
+};
+
+struct null_device {
+    VK_LOADER_DATA loader_data;
+    null_queue queues[NULL_QUEUE_COUNT];
+};
+
+struct null_command_buffer {
+    VK_LOADER_DATA loader_data;
+};
+
+struct null_command_pool {
+    std::unordered_set<null_command_buffer *> command_buffers;
+};
+
+struct null_memory {
+    VkDeviceSize size;
+    void *data; // allocated on first map
+};
+
+struct null_buffer {
+    VkDeviceSize size;
+};
+
+struct null_image {
+    VkExtent3D extent;
+    VkDeviceSize size;
+};
+
+// Counter handles start above any 32-bit pointer so they can't collide with
+// the struct-backed handles on 32-bit builds.
+static std::atomic<uint64_t> null_next_handle(0x100000000ull);
+
+template <typename T> static T null_new_handle() { return (T)null_next_handle++; }
+
+template <typename T, typename S> static T null_to_handle(S *object) { return (T)(uintptr_t)object; }
+
+template <typename S, typename T> static S *null_from_handle(T handle) { return (S *)(uintptr_t)handle; }
+
+static VkDeviceSize null_align(VkDeviceSize size) {
+    return (size + NULL_RESOURCE_ALIGNMENT - 1) & ~(NULL_RESOURCE_ALIGNMENT - 1);
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL null_GetInstanceProcAddr(VkInstance instance, const char *pName);
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL null_GetDeviceProcAddr(VkDevice device, const char *pName);
+
+/* Instance and physical device */
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateInstance(const VkInstanceCreateInfo *pCreateInfo,
+                                                          const VkAllocationCallbacks *pAllocator, VkInstance *pInstance) {
+    null_instance *instance = new null_instance;
+    set_loader_magic_value(instance);
+    set_loader_magic_value(&instance->physical_device);
+    *pInstance = reinterpret_cast<VkInstance>(instance);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_DestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator) {
+    delete reinterpret_cast<null_instance *>(instance);
+}
+
+// Calls to vkEnumeratePhysicalDevices on any instance, read by the loader tests
+static std::atomic<uint64_t> null_enumerate_physical_devices_calls(0);
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_EnumeratePhysicalDevices(VkInstance instance, uint32_t *pPhysicalDeviceCount,
+                                                                    VkPhysicalDevice *pPhysicalDevices) {
+    null_enumerate_physical_devices_calls++;
+    if (!pPhysicalDevices) {
+        *pPhysicalDeviceCount = 1;
+        return VK_SUCCESS;
+    }
+    if (*pPhysicalDeviceCount < 1)
+        return VK_INCOMPLETE;
+    pPhysicalDevices[0] = reinterpret_cast<VkPhysicalDevice>(&reinterpret_cast<null_instance *>(instance)->physical_device);
+    *pPhysicalDeviceCount = 1;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice,
+                                                                 VkPhysicalDeviceFeatures *pFeatures) {
+    // Every member is a VkBool32; claim them all
+    VkBool32 *features = reinterpret_cast<VkBool32 *>(pFeatures);
+    for (size_t i = 0; i < sizeof(*pFeatures) / sizeof(VkBool32); i++)
+        features[i] = VK_TRUE;
+}
+
+static bool null_is_depth_format(VkFormat format) {
+    return format >= VK_FORMAT_D16_UNORM && format <= VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetPhysicalDeviceFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format,
+                                                                         VkFormatProperties *pFormatProperties) {
+    memset(pFormatProperties, 0, sizeof(*pFormatProperties));
+    if (format == VK_FORMAT_UNDEFINED)
+        return;
+    if (null_is_depth_format(format)) {
+        pFormatProperties->optimalTilingFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                                   VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                   VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+        return;
+    }
+    VkFormatFeatureFlags image_features =
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_ATOMIC_BIT |
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+        VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    pFormatProperties->linearTilingFeatures = image_features;
+    pFormatProperties->optimalTilingFeatures = image_features;
+    pFormatProperties->bufferFeatures = VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT | VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_BIT |
+                                        VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_ATOMIC_BIT |
+                                        VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_GetPhysicalDeviceImageFormatProperties(
+    VkPhysicalDevice physicalDevice, VkFormat format, VkImageType type, VkImageTiling tiling, VkImageUsageFlags usage,
+    VkImageCreateFlags flags, VkImageFormatProperties *pImageFormatProperties) {
+    memset(pImageFormatProperties, 0, sizeof(*pImageFormatProperties));
+    if (format == VK_FORMAT_UNDEFINED)
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+
+    switch (type) {
+    case VK_IMAGE_TYPE_1D:
+        pImageFormatProperties->maxExtent = {16384, 1, 1};
+        break;
+    case VK_IMAGE_TYPE_3D:
+        pImageFormatProperties->maxExtent = {2048, 2048, 2048};
+        break;
+    default:
+        pImageFormatProperties->maxExtent = {16384, 16384, 1};
+        break;
+    }
+    pImageFormatProperties->maxMipLevels = 15;
+    pImageFormatProperties->maxArrayLayers = (type == VK_IMAGE_TYPE_3D) ? 1 : 2048;
+    pImageFormatProperties->sampleCounts = VK_SAMPLE_COUNT_1_BIT;
+    if (type == VK_IMAGE_TYPE_2D && tiling == VK_IMAGE_TILING_OPTIMAL)
+        pImageFormatProperties->sampleCounts |= VK_SAMPLE_COUNT_2_BIT | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+    pImageFormatProperties->maxResourceSize = 1ull << 31;
+    return VK_SUCCESS;
+}
+
+static void null_fill_limits(VkPhysicalDeviceLimits *limits) {
+    const VkSampleCountFlags samples =
+        VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_2_BIT | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+
+    memset(limits, 0, sizeof(*limits));
+    limits->maxImageDimension1D = 16384;
+    limits->maxImageDimension2D = 16384;
+    limits->maxImageDimension3D = 2048;
+    limits->maxImageDimensionCube = 16384;
+    limits->maxImageArrayLayers = 2048;
+    limits->maxTexelBufferElements = 1u << 27;
+    limits->maxUniformBufferRange = 65536;
+    limits->maxStorageBufferRange = 1u << 30;
+    limits->maxPushConstantsSize = 256;
+    limits->maxMemoryAllocationCount = 4096;
+    limits->maxSamplerAllocationCount = 4000;
+    limits->bufferImageGranularity = 1;
+    limits->sparseAddressSpaceSize = 0;
+    limits->maxBoundDescriptorSets = 8;
+    limits->maxPerStageDescriptorSamplers = 64;
+    limits->maxPerStageDescriptorUniformBuffers = 64;
+    limits->maxPerStageDescriptorStorageBuffers = 64;
+    limits->maxPerStageDescriptorSampledImages = 128;
+    limits->maxPerStageDescriptorStorageImages = 64;
+    limits->maxPerStageDescriptorInputAttachments = 8;
+    limits->maxPerStageResources = 256;
+    limits->maxDescriptorSetSamplers = 256;
+    limits->maxDescriptorSetUniformBuffers = 256;
+    limits->maxDescriptorSetUniformBuffersDynamic = 8;
+    limits->maxDescriptorSetStorageBuffers = 256;
+    limits->maxDescriptorSetStorageBuffersDynamic = 8;
+    limits->maxDescriptorSetSampledImages = 512;
+    limits->maxDescriptorSetStorageImages = 256;
+    limits->maxDescriptorSetInputAttachments = 8;
+    limits->maxVertexInputAttributes = 32;
+    limits->maxVertexInputBindings = 32;
+    limits->maxVertexInputAttributeOffset = 2047;
+    limits->maxVertexInputBindingStride = 2048;
+    limits->maxVertexOutputComponents = 128;
+    limits->maxTessellationGenerationLevel = 64;
+    limits->maxTessellationPatchSize = 32;
+    limits->maxTessellationControlPerVertexInputComponents = 128;
+    limits->maxTessellationControlPerVertexOutputComponents = 128;
+    limits->maxTessellationControlPerPatchOutputComponents = 120;
+    limits->maxTessellationControlTotalOutputComponents = 4096;
+    limits->maxTessellationEvaluationInputComponents = 128;
+    limits->maxTessellationEvaluationOutputComponents = 128;
+    limits->maxGeometryShaderInvocations = 32;
+    limits->maxGeometryInputComponents = 64;
+    limits->maxGeometryOutputComponents = 128;
+    limits->maxGeometryOutputVertices = 256;
+    limits->maxGeometryTotalOutputComponents = 1024;
+    limits->maxFragmentInputComponents = 128;
+    limits->maxFragmentOutputAttachments = 8;
+    limits->maxFragmentDualSrcAttachments = 1;
+    limits->maxFragmentCombinedOutputResources = 16;
+    limits->maxComputeSharedMemorySize = 32768;
+    limits->maxComputeWorkGroupCount[0] = 65535;
+    limits->maxComputeWorkGroupCount[1] = 65535;
+    limits->maxComputeWorkGroupCount[2] = 65535;
+    limits->maxComputeWorkGroupInvocations = 1024;
+    limits->maxComputeWorkGroupSize[0] = 1024;
+    limits->maxComputeWorkGroupSize[1] = 1024;
+    limits->maxComputeWorkGroupSize[2] = 64;
+    limits->subPixelPrecisionBits = 8;
+    limits->subTexelPrecisionBits = 8;
+    limits->mipmapPrecisionBits = 8;
+    limits->maxDrawIndexedIndexValue = UINT32_MAX;
+    limits->maxDrawIndirectCount = UINT32_MAX;
+    limits->maxSamplerLodBias = 16.0f;
+    limits->maxSamplerAnisotropy = 16.0f;
+    limits->maxViewports = 16;
+    limits->maxViewportDimensions[0] = 16384;
+    limits->maxViewportDimensions[1] = 16384;
+    limits->viewportBoundsRange[0] = -32768.0f;
+    limits->viewportBoundsRange[1] = 32767.0f;
+    limits->viewportSubPixelBits = 8;
+    limits->minMemoryMapAlignment = 64;
+    limits->minTexelBufferOffsetAlignment = 16;
+    limits->minUniformBufferOffsetAlignment = 256;
+    limits->minStorageBufferOffsetAlignment = 256;
+    limits->minTexelOffset = -8;
+    limits->maxTexelOffset = 7;
+    limits->minTexelGatherOffset = -32;
+    limits->maxTexelGatherOffset = 31;
+    limits->minInterpolationOffset = -0.5f;
+    limits->maxInterpolationOffset = 0.4375f;
+    limits->subPixelInterpolationOffsetBits = 4;
+    limits->maxFramebufferWidth = 16384;
+    limits->maxFramebufferHeight = 16384;
+    limits->maxFramebufferLayers = 2048;
+    limits->framebufferColorSampleCounts = samples;
+    limits->framebufferDepthSampleCounts = samples;
+    limits->framebufferStencilSampleCounts = samples;
+    limits->framebufferNoAttachmentsSampleCounts = samples;
+    limits->maxColorAttachments = 8;
+    limits->sampledImageColorSampleCounts = samples;
+    limits->sampledImageIntegerSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+    limits->sampledImageDepthSampleCounts = samples;
+    limits->sampledImageStencilSampleCounts = samples;
+    limits->storageImageSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+    limits->maxSampleMaskWords = 1;
+    limits->timestampComputeAndGraphics = VK_TRUE;
+    limits->timestampPeriod = 1.0f;
+    limits->maxClipDistances = 8;
+    limits->maxCullDistances = 8;
+    limits->maxCombinedClipAndCullDistances = 8;
+    limits->discreteQueuePriorities = 2;
+    limits->pointSizeRange[0] = 1.0f;
+    limits->pointSizeRange[1] = 64.0f;
+    limits->lineWidthRange[0] = 1.0f;
+    limits->lineWidthRange[1] = 8.0f;
+    limits->pointSizeGranularity = 1.0f;
+    limits->lineWidthGranularity = 1.0f;
+    limits->strictLines = VK_FALSE;
+    limits->standardSampleLocations = VK_TRUE;
+    limits->optimalBufferCopyOffsetAlignment = 1;
+    limits->optimalBufferCopyRowPitchAlignment = 1;
+    limits->nonCoherentAtomSize = 64;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice,
+                                                                   VkPhysicalDeviceProperties *pProperties) {
+    memset(pProperties, 0, sizeof(*pProperties));
+    pProperties->apiVersion = VK_MAKE_VERSION(1, 0, VK_HEADER_VERSION);
+    pProperties->driverVersion = 1;
+    pProperties->deviceType = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+    strncpy(pProperties->deviceName, "Vulkan null driver", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+    memcpy(pProperties->pipelineCacheUUID, null_pipeline_cache_uuid, VK_UUID_SIZE);
+    null_fill_limits(&pProperties->limits);
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice,
+                                                                              uint32_t *pQueueFamilyPropertyCount,
+                                                                              VkQueueFamilyProperties *pQueueFamilyProperties) {
+    if (!pQueueFamilyProperties) {
+        *pQueueFamilyPropertyCount = 1;
+        return;
+    }
+    if (*pQueueFamilyPropertyCount < 1)
+        return;
+    pQueueFamilyProperties[0].queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+    pQueueFamilyProperties[0].queueCount = NULL_QUEUE_COUNT;
+    pQueueFamilyProperties[0].timestampValidBits = 64;
+    pQueueFamilyProperties[0].minImageTransferGranularity = {1, 1, 1};
+    *pQueueFamilyPropertyCount = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice,
+                                                                         VkPhysicalDeviceMemoryProperties *pMemoryProperties) {
+    // Laid out like a discrete GPU: device local memory plus coherent and
+    // cached (non-coherent) host visible types.
+    memset(pMemoryProperties, 0, sizeof(*pMemoryProperties));
+    pMemoryProperties->memoryTypeCount = 3;
+    pMemoryProperties->memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    pMemoryProperties->memoryTypes[0].heapIndex = 0;
+    pMemoryProperties->memoryTypes[1].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    pMemoryProperties->memoryTypes[1].heapIndex = 1;
+    pMemoryProperties->memoryTypes[2].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    pMemoryProperties->memoryTypes[2].heapIndex = 1;
+    pMemoryProperties->memoryHeapCount = 2;
+    pMemoryProperties->memoryHeaps[0].size = 4ull << 30;
+    pMemoryProperties->memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    pMemoryProperties->memoryHeaps[1].size = 4ull << 30;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_EnumerateInstanceExtensionProperties(const char *pLayerName, uint32_t *pPropertyCount,
+                                                                                VkExtensionProperties *pProperties) {
+    if (pLayerName)
+        return VK_ERROR_LAYER_NOT_PRESENT;
+    *pPropertyCount = 0;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_EnumerateDeviceExtensionProperties(VkPhysicalDevice physicalDevice,
+                                                                              const char *pLayerName, uint32_t *pPropertyCount,
+                                                                              VkExtensionProperties *pProperties) {
+    if (pLayerName)
+        return VK_ERROR_LAYER_NOT_PRESENT;
+    *pPropertyCount = 0;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_EnumerateInstanceLayerProperties(uint32_t *pPropertyCount,
+                                                                            VkLayerProperties *pProperties) {
+    *pPropertyCount = 0;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_EnumerateDeviceLayerProperties(VkPhysicalDevice physicalDevice,
+                                                                          uint32_t *pPropertyCount,
+                                                                          VkLayerProperties *pProperties) {
+    *pPropertyCount = 0;
+    return VK_SUCCESS;
+}
+
+/* Device and queues */
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo *pCreateInfo,
+                                                        const VkAllocationCallbacks *pAllocator, VkDevice *pDevice) {
+    null_device *device = new null_device;
+    set_loader_magic_value(device);
+    for (uint32_t i = 0; i < NULL_QUEUE_COUNT; i++)
+        set_loader_magic_value(&device->queues[i]);
+    *pDevice = reinterpret_cast<VkDevice>(device);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_DestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
+    delete reinterpret_cast<null_device *>(device);
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex,
+                                                      VkQueue *pQueue) {
+    null_device *dev = reinterpret_cast<null_device *>(device);
+    *pQueue = reinterpret_cast<VkQueue>(&dev->queues[queueIndex % NULL_QUEUE_COUNT]);
+}
+
+/* Memory and resources */
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_AllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo,
+                                                          const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory) {
+    null_memory *memory = new null_memory;
+    memory->size = pAllocateInfo->allocationSize;
+    memory->data = NULL;
+    *pMemory = null_to_handle<VkDeviceMemory>(memory);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_FreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *pAllocator) {
+    null_memory *mem = null_from_handle<null_memory>(memory);
+    if (!mem)
+        return;
+    free(mem->data);
+    delete mem;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_MapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset,
+                                                     VkDeviceSize size, VkMemoryMapFlags flags, void **ppData) {
+    null_memory *mem = null_from_handle<null_memory>(memory);
+    if (!mem->data) {
+        mem->data = calloc(1, (size_t)mem->size);
+        if (!mem->data)
+            return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    *ppData = static_cast<char *>(mem->data) + offset;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetDeviceMemoryCommitment(VkDevice device, VkDeviceMemory memory,
+                                                                 VkDeviceSize *pCommittedMemoryInBytes) {
+    *pCommittedMemoryInBytes = null_from_handle<null_memory>(memory)->size;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo,
+                                                        const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer) {
+    null_buffer *buffer = new null_buffer;
+    buffer->size = pCreateInfo->size;
+    *pBuffer = null_to_handle<VkBuffer>(buffer);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_DestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks *pAllocator) {
+    delete null_from_handle<null_buffer>(buffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetBufferMemoryRequirements(VkDevice device, VkBuffer buffer,
+                                                                   VkMemoryRequirements *pMemoryRequirements) {
+    pMemoryRequirements->size = null_align(null_from_handle<null_buffer>(buffer)->size);
+    pMemoryRequirements->alignment = NULL_RESOURCE_ALIGNMENT;
+    pMemoryRequirements->memoryTypeBits = NULL_MEMORY_TYPE_BITS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo,
+                                                       const VkAllocationCallbacks *pAllocator, VkImage *pImage) {
+    null_image *image = new null_image;
+    image->extent = pCreateInfo->extent;
+    // Size every texel as the widest format (16 bytes) and allow a third
+    // extra for the mip chain.
+    image->size = (VkDeviceSize)pCreateInfo->extent.width * pCreateInfo->extent.height * pCreateInfo->extent.depth *
+                  pCreateInfo->arrayLayers * pCreateInfo->samples * 16;
+    if (pCreateInfo->mipLevels > 1)
+        image->size += image->size / 3;
+    *pImage = null_to_handle<VkImage>(image);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks *pAllocator) {
+    delete null_from_handle<null_image>(image);
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetImageMemoryRequirements(VkDevice device, VkImage image,
+                                                                  VkMemoryRequirements *pMemoryRequirements) {
+    pMemoryRequirements->size = null_align(null_from_handle<null_image>(image)->size);
+    pMemoryRequirements->alignment = NULL_RESOURCE_ALIGNMENT;
+    pMemoryRequirements->memoryTypeBits = NULL_MEMORY_TYPE_BITS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetImageSubresourceLayout(VkDevice device, VkImage image,
+                                                                 const VkImageSubresource *pSubresource,
+                                                                 VkSubresourceLayout *pLayout) {
+    null_image *img = null_from_handle<null_image>(image);
+    pLayout->offset = 0;
+    pLayout->size = img->size;
+    pLayout->rowPitch = (VkDeviceSize)img->extent.width * 16;
+    pLayout->arrayPitch = pLayout->rowPitch * img->extent.height;
+    pLayout->depthPitch = pLayout->arrayPitch;
+}
+
+/* Queries, events and caches */
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_GetEventStatus(VkDevice device, VkEvent event) { return VK_EVENT_SET; }
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_GetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery,
+                                                               uint32_t queryCount, size_t dataSize, void *pData,
+                                                               VkDeviceSize stride, VkQueryResultFlags flags) {
+    if (pData)
+        memset(pData, 0, dataSize);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_GetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache,
+                                                                size_t *pDataSize, void *pData) {
+    // Just the header required by the spec
+    const size_t header_size = 16 + VK_UUID_SIZE;
+    if (!pData) {
+        *pDataSize = header_size;
+        return VK_SUCCESS;
+    }
+    if (*pDataSize < header_size) {
+        *pDataSize = 0;
+        return VK_INCOMPLETE;
+    }
+    uint32_t header[4] = {(uint32_t)header_size, VK_PIPELINE_CACHE_HEADER_VERSION_ONE, 0, 0};
+    memcpy(pData, header, sizeof(header));
+    memcpy(static_cast<char *>(pData) + sizeof(header), null_pipeline_cache_uuid, VK_UUID_SIZE);
+    *pDataSize = header_size;
+    return VK_SUCCESS;
+}
+
+/* Pipelines and descriptors */
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache,
+                                                                   uint32_t createInfoCount,
+                                                                   const VkGraphicsPipelineCreateInfo *pCreateInfos,
+                                                                   const VkAllocationCallbacks *pAllocator,
+                                                                   VkPipeline *pPipelines) {
+    for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = null_new_handle<VkPipeline>();
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache,
+                                                                  uint32_t createInfoCount,
+                                                                  const VkComputePipelineCreateInfo *pCreateInfos,
+                                                                  const VkAllocationCallbacks *pAllocator,
+                                                                  VkPipeline *pPipelines) {
+    for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = null_new_handle<VkPipeline>();
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_AllocateDescriptorSets(VkDevice device,
+                                                                  const VkDescriptorSetAllocateInfo *pAllocateInfo,
+                                                                  VkDescriptorSet *pDescriptorSets) {
+    for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++)
+        pDescriptorSets[i] = null_new_handle<VkDescriptorSet>();
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_GetRenderAreaGranularity(VkDevice device, VkRenderPass renderPass,
+                                                                VkExtent2D *pGranularity) {
+    pGranularity->width = 1;
+    pGranularity->height = 1;
+}
+
+/* Command pools and buffers */
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_CreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo *pCreateInfo,
+                                                             const VkAllocationCallbacks *pAllocator,
+                                                             VkCommandPool *pCommandPool) {
+    *pCommandPool = null_to_handle<VkCommandPool>(new null_command_pool);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_DestroyCommandPool(VkDevice device, VkCommandPool commandPool,
+                                                          const VkAllocationCallbacks *pAllocator) {
+    null_command_pool *pool = null_from_handle<null_command_pool>(commandPool);
+    if (!pool)
+        return;
+    for (auto cb : pool->command_buffers)
+        delete cb;
+    delete pool;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL null_AllocateCommandBuffers(VkDevice device,
+                                                                  const VkCommandBufferAllocateInfo *pAllocateInfo,
+                                                                  VkCommandBuffer *pCommandBuffers) {
+    // Command pools are externally synchronized, so no lock is needed here
+    null_command_pool *pool = null_from_handle<null_command_pool>(pAllocateInfo->commandPool);
+    for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++) {
+        null_command_buffer *cb = new null_command_buffer;
+        set_loader_magic_value(cb);
+        pool->command_buffers.insert(cb);
+        pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(cb);
+    }
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL null_FreeCommandBuffers(VkDevice device, VkCommandPool commandPool,
+                                                          uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers) {
+    null_command_pool *pool = null_from_handle<null_command_pool>(commandPool);
+    for (uint32_t i = 0; i < commandBufferCount; i++) {
+        null_command_buffer *cb = reinterpret_cast<null_command_buffer *>(pCommandBuffers[i]);
+        if (cb && pool->command_buffers.erase(cb))
+            delete cb;
+    }
+}
+
+#include "null_driver_entrypoints.h"
+
+// Not part of any extension: vkNullDriverTestEntrypoint<N>, for every decimal N, is a device entrypoint taking
+// (VkDevice, uint32_t *pValue) that stores N % NULL_TEST_ENTRYPOINT_COUNT in *pValue.  Tests use them to give the
+// loader as many unknown device entrypoints as they like and check each call reaches the function looked up.
+static const char null_test_entrypoint_prefix[] = "vkNullDriverTestEntrypoint";
+static const uint32_t NULL_TEST_ENTRYPOINT_COUNT = 8;
+
+template <uint32_t N> static VKAPI_ATTR void VKAPI_CALL null_TestEntrypoint(VkDevice device, uint32_t *pValue) { *pValue = N; }
+
+static const PFN_vkVoidFunction null_test_entrypoints[NULL_TEST_ENTRYPOINT_COUNT] = {
+    (PFN_vkVoidFunction)null_TestEntrypoint<0>, (PFN_vkVoidFunction)null_TestEntrypoint<1>,
+    (PFN_vkVoidFunction)null_TestEntrypoint<2>, (PFN_vkVoidFunction)null_TestEntrypoint<3>,
+    (PFN_vkVoidFunction)null_TestEntrypoint<4>, (PFN_vkVoidFunction)null_TestEntrypoint<5>,
+    (PFN_vkVoidFunction)null_TestEntrypoint<6>, (PFN_vkVoidFunction)null_TestEntrypoint<7>,
+};
+
+static PFN_vkVoidFunction null_test_entrypoint(const char *pName) {
+    const size_t prefix_len = sizeof(null_test_entrypoint_prefix) - 1;
+    if (strncmp(pName, null_test_entrypoint_prefix, prefix_len) || !pName[prefix_len])
+        return NULL;
+    char *end;
+    const unsigned long n = strtoul(pName + prefix_len, &end, 10);
+    return *end ? NULL : null_test_entrypoints[n % NULL_TEST_ENTRYPOINT_COUNT];
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL null_GetInstanceProcAddr(VkInstance instance, const char *pName) {
+    for (size_t i = 0; i < sizeof(null_entrypoints) / sizeof(null_entrypoints[0]); i++) {
+        if (!strcmp(pName, null_entrypoints[i].name))
+            return null_entrypoints[i].func;
+    }
+    return null_test_entrypoint(pName);
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL null_GetDeviceProcAddr(VkDevice device, const char *pName) {
+    for (size_t i = 0; i < sizeof(null_entrypoints) / sizeof(null_entrypoints[0]); i++) {
+        if (!strcmp(pName, null_entrypoints[i].name))
+            return null_entrypoints[i].is_device ? null_entrypoints[i].func : NULL;
+    }
+    return null_test_entrypoint(pName);
+}
+
+extern "C" {
+
+NULL_DRIVER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vk_icdNegotiateLoaderICDInterfaceVersion(uint32_t *pSupportedVersion) {
+    // Version 1 (vk_icdGetInstanceProcAddr) is the oldest we implement
+    if (*pSupportedVersion < 1)
+        return VK_ERROR_INCOMPATIBLE_DRIVER;
+    if (*pSupportedVersion > CURRENT_LOADER_ICD_INTERFACE_VERSION)
+        *pSupportedVersion = CURRENT_LOADER_ICD_INTERFACE_VERSION;
+    return VK_SUCCESS;
+}
+
+NULL_DRIVER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetInstanceProcAddr(VkInstance instance, const char *pName) {
+    return null_GetInstanceProcAddr(instance, pName);
+}
+
+// Not part of the ICD interface: lets tests that load the driver themselves see how often the loader calls into it
+NULL_DRIVER_EXPORT uint64_t VKAPI_CALL vk_nullDriverEnumeratePhysicalDevicesCalls() {
+    return null_enumerate_physical_devices_calls.load();
+}
+
+} // extern "C"
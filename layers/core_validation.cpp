@@ -34,8 +34,10 @@
 #include <algorithm>
 #include <assert.h>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <stdio.h>
@@ -44,6 +46,11 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#else
+#include <process.h>
+#endif
 
 #include "vk_loader_platform.h"
 #include "vk_dispatch_table_helper.h"
@@ -60,6 +67,9 @@
 #include "vk_layer_data.h"
 #include "vk_layer_extension_utils.h"
 #include "vk_layer_utils.h"
+#include "vk_layer_entrypoint_table.h"
+#include "vk_layer_task_pool.h"
+#include "vk_layer_profile.h"
 #include "spirv-tools/libspirv.h"
 
 #if defined __ANDROID__
@@ -80,7 +90,10 @@ static const VkDeviceMemory MEMTRACKER_SWAP_CHAIN_IMAGE_KEY = (VkDeviceMemory)(-
 struct CMD_POOL_INFO {
     VkCommandPoolCreateFlags createFlags;
     uint32_t queueFamilyIndex;
-    list<VkCommandBuffer> commandBuffers; // list container of cmd buffers allocated from this pool
+    vector<GLOBAL_CB_NODE *> commandBuffers; // nodes of the cmd buffers allocated from this pool
+    // Nodes of cmd buffers freed back to this pool, already reset. Allocations from the pool reuse these so the
+    //  containers in them keep their capacity from one frame's cmd buffers to the next. Deleted with the pool.
+    vector<GLOBAL_CB_NODE *> freeNodes;
 };
 
 struct devExts {
@@ -124,23 +137,29 @@ struct layer_data {
     unordered_map<VkSemaphore, SEMAPHORE_NODE> semaphoreMap;
     unordered_map<VkCommandBuffer, GLOBAL_CB_NODE *> commandBufferMap;
     unordered_map<VkFramebuffer, FRAMEBUFFER_NODE> frameBufferMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
-    unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> imageLayoutMap;
     unordered_map<VkRenderPass, RENDER_PASS_NODE *> renderPassMap;
-    unordered_map<VkShaderModule, unique_ptr<shader_module>> shaderModuleMap;
+    unordered_map<VkShaderModule, std::shared_ptr<shader_module>> shaderModuleMap;
     VkDevice device;
+    // Bumped whenever a buffer, descriptor set or event node is freed, which makes every
+    //  GLOBAL_CB_NODE::inFlightResources gathered before then stale
+    uint64_t stateNodeGeneration;
+    // Bumped whenever a descriptor set is updated or freed, or a buffer, buffer view or memory object is
+    //  destroyed, which makes every LAST_BOUND_STATE's descriptor set checks stale
+    uint64_t drawStateGeneration;
 
     // Device specific data
     PHYS_DEV_PROPERTIES_NODE phys_dev_properties;
     VkPhysicalDeviceMemoryProperties phys_dev_mem_props;
+    // Validates the pipelines of one vkCreate*Pipelines call in parallel
+    unique_ptr<task_pool> pipeline_validation_pool;
 
     layer_data()
         : report_data(nullptr), device_dispatch_table(nullptr), instance_dispatch_table(nullptr), device_extensions(),
-          device(VK_NULL_HANDLE), phys_dev_properties{}, phys_dev_mem_props{} {};
+          device(VK_NULL_HANDLE), stateNodeGeneration(1), drawStateGeneration(1),
+          phys_dev_properties{}, phys_dev_mem_props{} {};
 };
 
-// TODO : Do we need to guard access to layer_data_map w/ lock?
-static unordered_map<void *, layer_data *> layer_data_map;
+static dispatch_key_map<layer_data> layer_data_map;
 
 static const VkLayerProperties cv_global_layers[] = {{
     "VK_LAYER_LUNARG_core_validation", VK_LAYER_API_VERSION, 1, "LunarG Validation Layer",
@@ -161,7 +180,8 @@ template <class TCreateInfo> void ValidateLayerOrdering(const TCreateInfo &creat
 }
 
 // Code imported from shader_checker
-static void build_def_index(shader_module *);
+struct shader_module_index;
+static void build_module_index(shader_module_index *index, vector<uint32_t> const &words);
 
 // A forward iterator over spirv instructions. Provides easy access to len, opcode, and content words
 // without the caller needing to care too much about the physical SPIRV module layout.
@@ -198,21 +218,68 @@ struct spirv_inst_iter {
     spirv_inst_iter const &operator*() const { return *this; }
 };
 
-struct shader_module {
+/* what OpDecorate says about one <id>; ids without decorations share the all-defaults entry 0 */
+struct decoration_set {
+    enum {
+        location_bit = 1 << 0,
+        patch_bit = 1 << 1,
+        block_bit = 1 << 2,
+        buffer_block_bit = 1 << 3,
+        builtin_bit = 1 << 4,
+    };
+    uint32_t flags;
+    uint32_t location;
+    uint32_t component;
+    uint32_t builtin;
+    uint32_t descriptor_set;
+    uint32_t binding;
+    /* this struct type's OpMemberDecorates are member_decorations[first_member_decoration, +member_decoration_count) */
+    uint32_t first_member_decoration;
+    uint32_t member_decoration_count;
+};
+
+/* one OpMemberDecorate; value is the decoration's first literal, or 0 if it has none */
+struct member_decoration {
+    uint32_t member;
+    uint32_t decoration;
+    uint32_t value;
+};
+
+/* Everything decoded from a module in the single pass made when it is created. Per-<id> data is kept in arrays
+ * indexed by the id itself, so the interface walks at pipeline creation are array lookups rather than rescans of
+ * the instruction stream. Nothing in here points into the words, so the shader cache can store it on its own.
+ */
+struct shader_module_index {
+    /* offset of the first word of each <id>'s def, or 0 for ids defined by instructions we don't track.
+     * this is useful because walking type trees, constant expressions, etc requires jumping all over
+     * the instruction stream.
+     */
+    vector<uint32_t> def_index;
+    /* for each <id>, its entry in decorations */
+    vector<uint32_t> decoration_index;
+    vector<decoration_set> decorations;
+    /* grouped by struct type, in module order within each type */
+    vector<member_decoration> member_decorations;
+    /* offsets of every OpEntryPoint and OpCapability */
+    vector<uint32_t> entrypoints;
+    vector<uint32_t> capabilities;
+};
+
+struct shader_module : shader_module_index {
     /* the spirv image itself */
     vector<uint32_t> words;
-    /* a mapping of <id> to the first word of its def. this is useful because walking type
-     * trees, constant expressions, etc requires jumping all over the instruction stream.
-     */
-    unordered_map<unsigned, unsigned> def_index;
 
     shader_module(VkShaderModuleCreateInfo const *pCreateInfo)
-        : words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)),
-          def_index() {
+        : words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)) {
 
-        build_def_index(this);
+        build_module_index(this, words);
     }
 
+    /* for a module whose index is already known, from the shader cache */
+    shader_module(VkShaderModuleCreateInfo const *pCreateInfo, shader_module_index const &known_index)
+        : shader_module_index(known_index),
+          words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)) {}
+
     /* expose begin() / end() to enable range-based for */
     spirv_inst_iter begin() const { return spirv_inst_iter(words.begin(), words.begin() + 5); } /* first insn */
     spirv_inst_iter end() const { return spirv_inst_iter(words.begin(), words.end()); }         /* just past last insn */
@@ -221,18 +288,312 @@ struct shader_module {
 
     /* gets an iterator to the definition of an id */
     spirv_inst_iter get_def(unsigned id) const {
-        auto it = def_index.find(id);
-        if (it == def_index.end()) {
+        if (id >= def_index.size() || !def_index[id]) {
             return end();
         }
-        return at(it->second);
+        return at(def_index[id]);
+    }
+
+    /* gets the decorations of an id */
+    decoration_set const &get_decorations(unsigned id) const {
+        return decorations[id < decoration_index.size() ? decoration_index[id] : 0];
     }
 };
 
-// TODO : This can be much smarter, using separate locks for separate global data
-static std::mutex global_lock;
+/*
+ * Cache of the SPIR-V modules spvValidate has passed, kept only when lunarg_core_validation.shader_cache_file names
+ *  a file. Each entry is keyed on a hash of a module's words and holds just what build_module_index derived from
+ *  them, so creating the same module again, on any device or in a later run, skips both validation and indexing.
+ *  The cache never holds a module itself. Entries are loaded from the file at startup and written back at
+ *  vkDestroyDevice; the least recently used are dropped once the indices exceed SHADER_CACHE_MAX_BYTES. Modules
+ *  spvValidate rejects or warns about are never cached, so they are reported every time.
+ */
+struct shader_cache_key {
+    uint64_t lo;
+    uint64_t hi;
+    bool operator==(shader_cache_key const &other) const { return lo == other.lo && hi == other.hi; }
+};
+
+struct shader_cache_key_hash {
+    size_t operator()(shader_cache_key const &key) const { return static_cast<size_t>(key.lo); }
+};
+
+struct shader_cache_entry {
+    size_t word_count;
+    shader_module_index index;
+    /* bytes held by index */
+    size_t size;
+    /* this entry's place in shader_cache_lru */
+    std::list<shader_cache_key>::iterator lru;
+};
+
+// Bump when the file layout, what spvValidate accepts or what build_module_index records changes, so stale cache
+//  files are ignored. The SPIRV-Tools revision the layer was built against is also checked.
+static const uint32_t SHADER_CACHE_FILE_VERSION = 3;
+static const char SHADER_CACHE_FILE_MAGIC[8] = {'C', 'V', 'S', 'P', 'V', 'C', 'H', 'E'};
+#if !defined(SPIRV_TOOLS_REVISION)
+#define SPIRV_TOOLS_REVISION "unknown"
+#endif
+static const char shader_cache_spirv_tools_revision[] = SPIRV_TOOLS_REVISION;
+static const size_t SHADER_CACHE_MAX_BYTES = 64 * 1024 * 1024;
+// SPIR-V's own limit on the <id> bound; no per-id array in a valid index is longer
+static const uint32_t SHADER_CACHE_MAX_IDS = 0x3fffff;
+
+static std::mutex shader_cache_lock;
+static unordered_map<shader_cache_key, shader_cache_entry, shader_cache_key_hash> shader_cache;
+/* most recently used first */
+static std::list<shader_cache_key> shader_cache_lru;
+static size_t shader_cache_bytes = 0;
+static std::string shader_cache_file;
+static bool shader_cache_loaded = false;
+static bool shader_cache_dirty = false;
+
+static uint64_t shader_cache_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 128-bit hash of a module's words; the two lanes are mixed independently so an accidental collision is negligible
+static shader_cache_key hash_spirv(const uint32_t *words, size_t count) {
+    uint64_t lo = 0xcbf29ce484222325ULL ^ count;
+    uint64_t hi = 0x9e3779b97f4a7c15ULL + count;
+    for (size_t i = 0; i < count; i++) {
+        lo = (lo ^ words[i]) * 0x100000001b3ULL;
+        hi = (hi ^ words[i]) * 0x9fb21c651e98df25ULL;
+        hi ^= hi >> 29;
+    }
+    shader_cache_key key;
+    key.lo = shader_cache_mix(lo ^ shader_cache_mix(hi));
+    key.hi = shader_cache_mix(hi + key.lo);
+    return key;
+}
+
+static size_t shaderModuleIndexSize(shader_module_index const &index) {
+    return index.def_index.size() * sizeof(uint32_t) + index.decoration_index.size() * sizeof(uint32_t) +
+           index.decorations.size() * sizeof(decoration_set) + index.member_decorations.size() * sizeof(member_decoration) +
+           index.entrypoints.size() * sizeof(uint32_t) + index.capabilities.size() * sizeof(uint32_t);
+}
+
+// NOTE : Calls to this function should be wrapped in shader_cache_lock
+static void dropLeastRecentlyUsedShaders() {
+    while (shader_cache_bytes > SHADER_CACHE_MAX_BYTES && !shader_cache_lru.empty()) {
+        auto entry = shader_cache.find(shader_cache_lru.back());
+        shader_cache_bytes -= entry->second.size;
+        shader_cache.erase(entry);
+        shader_cache_lru.pop_back();
+    }
+}
+
+// Remember the index of a module; entries already cached keep theirs. least_recent puts the new entry last in
+//  line rather than first, for filling the cache from a file written most recent first.
+// NOTE : Calls to this function should be wrapped in shader_cache_lock
+static void addShaderCacheEntry(shader_cache_key const &key, size_t word_count, shader_module_index &&index,
+                                bool least_recent) {
+    auto inserted = shader_cache.emplace(key, shader_cache_entry());
+    if (!inserted.second)
+        return;
+    shader_cache_entry &entry = inserted.first->second;
+    entry.word_count = word_count;
+    entry.index = std::move(index);
+    entry.size = shaderModuleIndexSize(entry.index);
+    entry.lru = least_recent ? shader_cache_lru.insert(shader_cache_lru.end(), key)
+                             : shader_cache_lru.insert(shader_cache_lru.begin(), key);
+    shader_cache_bytes += entry.size;
+    dropLeastRecentlyUsedShaders();
+}
+
+// Bounds-checked reads from a cache file held in memory; any read past the end fails this and every later read
+struct shader_cache_reader {
+    const char *pos;
+    const char *end;
+
+    bool read(void *out, size_t size) {
+        if (size > static_cast<size_t>(end - pos)) {
+            pos = end;
+            return false;
+        }
+        memcpy(out, pos, size);
+        pos += size;
+        return true;
+    }
+
+    size_t left() const { return static_cast<size_t>(end - pos); }
+};
+
+template <typename T> static bool readShaderCacheArray(shader_cache_reader *reader, vector<T> *out) {
+    uint32_t count;
+    // A corrupt count must not be allowed to allocate more than the file could hold
+    if (!reader->read(&count, sizeof(count)) || count > SHADER_CACHE_MAX_IDS || count > reader->left() / sizeof(T))
+        return false;
+    out->resize(count);
+    return count == 0 || reader->read(out->data(), sizeof(T) * count);
+}
+
+template <typename T> static bool writeShaderCacheArray(FILE *file, vector<T> const &in) {
+    uint32_t count = static_cast<uint32_t>(in.size());
+    return fwrite(&count, sizeof(count), 1, file) == 1 && (count == 0 || fwrite(in.data(), sizeof(T), count, file) == count);
+}
+
+// Check that an index read from the cache file only refers to words and entries that exist
+static bool isShaderModuleIndexConsistent(shader_module_index const &index, size_t word_count) {
+    if (index.decoration_index.size() != index.def_index.size() || index.decorations.empty())
+        return false;
+    for (auto offset : index.def_index) {
+        if (offset >= word_count)
+            return false;
+    }
+    for (auto decoration : index.decoration_index) {
+        if (decoration >= index.decorations.size())
+            return false;
+    }
+    for (auto const &decorations : index.decorations) {
+        if (decorations.first_member_decoration > index.member_decorations.size() ||
+            decorations.member_decoration_count > index.member_decorations.size() - decorations.first_member_decoration)
+            return false;
+    }
+    for (auto offset : index.entrypoints) {
+        if (offset >= word_count)
+            return false;
+    }
+    for (auto offset : index.capabilities) {
+        if (offset >= word_count)
+            return false;
+    }
+    return true;
+}
+
+// Read the cache file named in the layer settings. A missing, truncated, corrupt or out of date file just leaves the
+//  cache empty.
+// NOTE : Calls to this function should be wrapped in shader_cache_lock
+static void loadShaderCache() {
+    FILE *file = fopen(shader_cache_file.c_str(), "rb");
+    if (!file)
+        return;
+    vector<char> contents;
+    long file_size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        file_size = ftell(file);
+    }
+    // A valid file is never much bigger than the cache it was written from
+    if (file_size > 0 && static_cast<unsigned long>(file_size) <= 2 * SHADER_CACHE_MAX_BYTES && fseek(file, 0, SEEK_SET) == 0) {
+        contents.resize(static_cast<size_t>(file_size));
+        if (fread(contents.data(), 1, contents.size(), file) != contents.size())
+            contents.clear();
+    }
+    fclose(file);
+    if (contents.empty())
+        return;
+
+    shader_cache_reader reader = {contents.data(), contents.data() + contents.size()};
+    char magic[sizeof(SHADER_CACHE_FILE_MAGIC)];
+    uint32_t version = 0;
+    uint32_t header_version = 0;
+    uint32_t revision_length = 0;
+    uint64_t entry_count = 0;
+    if (!reader.read(magic, sizeof(magic)) || memcmp(magic, SHADER_CACHE_FILE_MAGIC, sizeof(magic)) ||
+        !reader.read(&version, sizeof(version)) || version != SHADER_CACHE_FILE_VERSION ||
+        !reader.read(&header_version, sizeof(header_version)) || header_version != VK_HEADER_VERSION ||
+        !reader.read(&revision_length, sizeof(revision_length)) ||
+        revision_length != sizeof(shader_cache_spirv_tools_revision) - 1 || reader.left() < revision_length ||
+        memcmp(reader.pos, shader_cache_spirv_tools_revision, revision_length)) {
+        return;
+    }
+    reader.pos += revision_length;
+    // Every entry takes at least its key, word count and six array counts
+    const size_t min_entry_size = sizeof(shader_cache_key) + 7 * sizeof(uint32_t);
+    if (!reader.read(&entry_count, sizeof(entry_count)) || entry_count > reader.left() / min_entry_size)
+        return;
+
+    for (uint64_t i = 0; i < entry_count; i++) {
+        shader_cache_key key;
+        uint32_t word_count;
+        shader_module_index index;
+        if (!reader.read(&key, sizeof(key)) || !reader.read(&word_count, sizeof(word_count)) ||
+            !readShaderCacheArray(&reader, &index.def_index) || !readShaderCacheArray(&reader, &index.decoration_index) ||
+            !readShaderCacheArray(&reader, &index.decorations) || !readShaderCacheArray(&reader, &index.member_decorations) ||
+            !readShaderCacheArray(&reader, &index.entrypoints) || !readShaderCacheArray(&reader, &index.capabilities) ||
+            !isShaderModuleIndexConsistent(index, word_count)) {
+            return;
+        }
+        // The file lists the most recently used first; anything already created in this process stays ahead of it
+        addShaderCacheEntry(key, word_count, std::move(index), true);
+    }
+}
+
+// Write every cached module's key and index to the cache file, most recently used first. The file is written under
+//  a name private to this process and renamed into place, so neither a concurrent reader nor another process
+//  saving at the same time ever sees it half written.
+// NOTE : Calls to this function should be wrapped in shader_cache_lock
+static void saveShaderCache() {
+    char pid[32];
+#if defined(_WIN32)
+    snprintf(pid, sizeof(pid), ".%d.tmp", _getpid());
+#else
+    snprintf(pid, sizeof(pid), ".%d.tmp", (int)getpid());
+#endif
+    std::string temp_name = shader_cache_file + pid;
+    FILE *file = fopen(temp_name.c_str(), "wb");
+    if (!file)
+        return;
+    uint32_t header_version = VK_HEADER_VERSION;
+    uint32_t revision_length = sizeof(shader_cache_spirv_tools_revision) - 1;
+    uint64_t entry_count = shader_cache.size();
+    bool ok = fwrite(SHADER_CACHE_FILE_MAGIC, sizeof(SHADER_CACHE_FILE_MAGIC), 1, file) == 1 &&
+              fwrite(&SHADER_CACHE_FILE_VERSION, sizeof(SHADER_CACHE_FILE_VERSION), 1, file) == 1 &&
+              fwrite(&header_version, sizeof(header_version), 1, file) == 1 &&
+              fwrite(&revision_length, sizeof(revision_length), 1, file) == 1 &&
+              fwrite(shader_cache_spirv_tools_revision, 1, revision_length, file) == revision_length &&
+              fwrite(&entry_count, sizeof(entry_count), 1, file) == 1;
+    for (auto it = shader_cache_lru.begin(); ok && it != shader_cache_lru.end(); ++it) {
+        const shader_cache_entry &entry = shader_cache[*it];
+        const shader_module_index &index = entry.index;
+        uint32_t word_count = static_cast<uint32_t>(entry.word_count);
+        ok = fwrite(&*it, sizeof(*it), 1, file) == 1 && fwrite(&word_count, sizeof(word_count), 1, file) == 1 &&
+             writeShaderCacheArray(file, index.def_index) && writeShaderCacheArray(file, index.decoration_index) &&
+             writeShaderCacheArray(file, index.decorations) && writeShaderCacheArray(file, index.member_decorations) &&
+             writeShaderCacheArray(file, index.entrypoints) && writeShaderCacheArray(file, index.capabilities);
+    }
+    ok = (fclose(file) == 0) && ok;
+#if defined(_WIN32)
+    // rename() does not replace an existing file on Windows
+    if (ok)
+        remove(shader_cache_file.c_str());
+#endif
+    if (!ok || rename(temp_name.c_str(), shader_cache_file.c_str()) != 0) {
+        remove(temp_name.c_str());
+        return;
+    }
+    shader_cache_dirty = false;
+}
+
+// Lock order is global_lock, then cb_binding_lock.
+// Command recording entrypoints that only modify their own GLOBAL_CB_NODE take global_lock shared, so recording into
+//  distinct command buffers proceeds in parallel. Everything that creates, destroys or retires state, and every
+//  cross-object operation such as vkQueueSubmit, takes global_lock exclusively.
+static rw_lock global_lock;
+// Guards the back-references from shared objects (memory, descriptor sets) to the command buffers that use them,
+//  which the shared-mode recording paths update. Exclusive holders of global_lock may ignore it.
+static std::mutex cb_binding_lock;
+// Call counts and times of the entrypoints, the main checks and the waits for global_lock. Only collected when
+//  lunarg_core_validation.profile_report names the files to write them to; the report covers every device since the
+//  layer was loaded and is rewritten at each vkDestroyDevice.
+static profiler validation_profiler;
+static std::mutex profile_report_lock;
+static std::string profile_report_file;
 #if MTMERGESOURCE
 // MTMERGESOURCE - start of direct pull
+// How the shadow copy of mapped non-coherent memory is protected, set by
+//  lunarg_core_validation.noncoherent_memory_guard in vk_layer_settings.txt
+enum NONCOHERENT_MEMORY_GUARD {
+    NONCOHERENT_MEMORY_GUARD_FILL,  // Fill bands around the copy, checked at each flush
+    NONCOHERENT_MEMORY_GUARD_PAGES, // Inaccessible pages around the copy, so overflows fault where they happen
+};
+static NONCOHERENT_MEMORY_GUARD noncoherentMemoryGuard = NONCOHERENT_MEMORY_GUARD_FILL;
+
 static VkDeviceMemory *get_object_mem_binding(layer_data *my_data, uint64_t handle, VkDebugReportObjectTypeEXT type) {
     switch (type) {
     case VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT: {
@@ -254,7 +615,7 @@ static VkDeviceMemory *get_object_mem_binding(layer_data *my_data, uint64_t hand
 }
 // MTMERGESOURCE - end section
 #endif
-template layer_data *get_my_data_ptr<layer_data>(void *data_key, std::unordered_map<void *, layer_data *> &data_map);
+template layer_data *get_my_data_ptr<layer_data>(void *data_key, dispatch_key_map<layer_data> &data_map);
 
 // prototype
 static GLOBAL_CB_NODE *getCBNode(layer_data *, const VkCommandBuffer);
@@ -335,6 +696,10 @@ static void add_mem_obj_info(layer_data *my_data, void *object, const VkDeviceMe
     my_data->memObjMap[mem].memRange.size = 0;
     my_data->memObjMap[mem].pData = 0;
     my_data->memObjMap[mem].pDriverData = 0;
+    my_data->memObjMap[mem].shadowSize = 0;
+    my_data->memObjMap[mem].shadowPad = 0;
+    my_data->memObjMap[mem].shadowGuardSize = 0;
+    my_data->memObjMap[mem].shadowAllocSize = 0;
     my_data->memObjMap[mem].valid = false;
 }
 
@@ -386,7 +751,10 @@ static bool update_cmd_buf_and_mem_references(layer_data *dev_data, const VkComm
         // First update CB binding in MemObj mini CB list
         DEVICE_MEM_INFO *pMemInfo = get_mem_obj_info(dev_data, mem);
         if (pMemInfo) {
-            pMemInfo->commandBufferBindings.insert(cb);
+            {
+                std::lock_guard<std::mutex> binding_lock(cb_binding_lock);
+                pMemInfo->commandBufferBindings.insert(cb);
+            }
             // Now update CBInfo's Mem reference list
             GLOBAL_CB_NODE *pCBNode = getCBNode(dev_data, cb);
             // TODO: keep track of all destroyed CBs so we know if this is a stale or simply invalid object
@@ -458,6 +826,7 @@ static bool deleteMemObjInfo(layer_data *my_data, void *object, VkDeviceMemory m
     auto item = my_data->memObjMap.find(mem);
     if (item != my_data->memObjMap.end()) {
         my_data->memObjMap.erase(item);
+        my_data->drawStateGeneration++;
     } else {
         skipCall = log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT,
                            (uint64_t)mem, __LINE__, MEMTRACK_INVALID_MEM_OBJ, "MEM",
@@ -740,7 +1109,7 @@ static void printCBList(layer_data *my_data) {
 #endif
 
 // Return a string representation of CMD_TYPE enum
-static string cmdTypeToString(CMD_TYPE cmd) {
+static const char *cmdTypeToString(CMD_TYPE cmd) {
     switch (cmd) {
     case CMD_BINDPIPELINE:
         return "CMD_BINDPIPELINE";
@@ -838,9 +1207,96 @@ static string cmdTypeToString(CMD_TYPE cmd) {
 }
 
 // SPIRV utility functions
-static void build_def_index(shader_module *module) {
-    for (auto insn : *module) {
+
+/* the universal limit on <id> bound from the SPIR-V spec; a larger bound in a module header is not trusted to size arrays */
+static const uint32_t SPIRV_MAX_ID_BOUND = 0x400000;
+
+/* the decorations entry of id, giving it its own entry if it only had the shared defaults so far */
+static uint32_t decorations_for(shader_module_index *index, uint32_t id) {
+    uint32_t &slot = index->decoration_index[id];
+    if (!slot) {
+        slot = static_cast<uint32_t>(index->decorations.size());
+        index->decorations.push_back(decoration_set());
+    }
+    return slot;
+}
+
+/* Decode everything the interface checks need from the module in one pass: where each <id> is defined, the
+ * OpDecorate/OpMemberDecorate state of each <id>, and where the entrypoints and capabilities are.
+ */
+static void build_module_index(shader_module_index *index, vector<uint32_t> const &words) {
+    uint32_t bound = words.size() > 3 ? std::min(words[3], SPIRV_MAX_ID_BOUND) : 0;
+    index->def_index.assign(bound, 0);
+    index->decoration_index.assign(bound, 0);
+    index->decorations.assign(1, decoration_set());
+    index->member_decorations.clear();
+    index->entrypoints.clear();
+    index->capabilities.clear();
+
+    /* member decorations are collected with their struct id, then grouped by it once the pass is done */
+    vector<std::pair<uint32_t, member_decoration>> members;
+
+    spirv_inst_iter end(words.begin(), words.end());
+    for (spirv_inst_iter insn(words.begin(), words.begin() + 5); insn != end; insn++) {
+        uint32_t def_id = 0;
         switch (insn.opcode()) {
+        case spv::OpCapability:
+            index->capabilities.push_back(insn.offset());
+            break;
+
+        case spv::OpEntryPoint:
+            index->entrypoints.push_back(insn.offset());
+            break;
+
+        case spv::OpDecorate: {
+            if (insn.word(1) >= bound)
+                break;
+            decoration_set &d = index->decorations[decorations_for(index, insn.word(1))];
+            uint32_t value = insn.len() > 3 ? insn.word(3) : 0;
+            switch (insn.word(2)) {
+            case spv::DecorationLocation:
+                d.flags |= decoration_set::location_bit;
+                d.location = value;
+                break;
+            case spv::DecorationComponent:
+                d.component = value;
+                break;
+            case spv::DecorationBuiltIn:
+                d.flags |= decoration_set::builtin_bit;
+                d.builtin = value;
+                break;
+            case spv::DecorationPatch:
+                d.flags |= decoration_set::patch_bit;
+                break;
+            case spv::DecorationBlock:
+                d.flags |= decoration_set::block_bit;
+                break;
+            case spv::DecorationBufferBlock:
+                d.flags |= decoration_set::buffer_block_bit;
+                break;
+            case spv::DecorationDescriptorSet:
+                d.descriptor_set = value;
+                break;
+            case spv::DecorationBinding:
+                d.binding = value;
+                break;
+            default:
+                break;
+            }
+            break;
+        }
+
+        case spv::OpMemberDecorate: {
+            if (insn.word(1) >= bound)
+                break;
+            member_decoration m;
+            m.member = insn.word(2);
+            m.decoration = insn.word(3);
+            m.value = insn.len() > 4 ? insn.word(4) : 0;
+            members.push_back(std::make_pair(insn.word(1), m));
+            break;
+        }
+
         /* Types */
         case spv::OpTypeVoid:
         case spv::OpTypeBool:
@@ -862,7 +1318,7 @@ static void build_def_index(shader_module *module) {
         case spv::OpTypeReserveId:
         case spv::OpTypeQueue:
         case spv::OpTypePipe:
-            module->def_index[insn.word(1)] = insn.offset();
+            def_id = insn.word(1);
             break;
 
         /* Fixed constants */
@@ -872,7 +1328,7 @@ static void build_def_index(shader_module *module) {
         case spv::OpConstantComposite:
         case spv::OpConstantSampler:
         case spv::OpConstantNull:
-            module->def_index[insn.word(2)] = insn.offset();
+            def_id = insn.word(2);
             break;
 
         /* Specialization constants */
@@ -881,35 +1337,51 @@ static void build_def_index(shader_module *module) {
         case spv::OpSpecConstant:
         case spv::OpSpecConstantComposite:
         case spv::OpSpecConstantOp:
-            module->def_index[insn.word(2)] = insn.offset();
+            def_id = insn.word(2);
             break;
 
         /* Variables */
         case spv::OpVariable:
-            module->def_index[insn.word(2)] = insn.offset();
+            def_id = insn.word(2);
             break;
 
         /* Functions */
         case spv::OpFunction:
-            module->def_index[insn.word(2)] = insn.offset();
+            def_id = insn.word(2);
             break;
 
         default:
             /* We don't care about any other defs for now. */
             break;
         }
+        if (def_id && def_id < bound) {
+            index->def_index[def_id] = insn.offset();
+        }
+    }
+
+    std::stable_sort(members.begin(), members.end(),
+                     [](std::pair<uint32_t, member_decoration> const &a, std::pair<uint32_t, member_decoration> const &b) {
+                         return a.first < b.first;
+                     });
+    index->member_decorations.reserve(members.size());
+    for (size_t i = 0; i < members.size(); i++) {
+        if (i == 0 || members[i].first != members[i - 1].first) {
+            decoration_set &d = index->decorations[decorations_for(index, members[i].first)];
+            d.first_member_decoration = static_cast<uint32_t>(i);
+        }
+        index->decorations[index->decoration_index[members[i].first]].member_decoration_count++;
+        index->member_decorations.push_back(members[i].second);
     }
 }
 
 static spirv_inst_iter find_entrypoint(shader_module *src, char const *name, VkShaderStageFlagBits stageBits) {
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpEntryPoint) {
-            auto entrypointName = (char const *)&insn.word(3);
-            auto entrypointStageBits = 1u << insn.word(1);
+    for (auto offset : src->entrypoints) {
+        auto insn = src->at(offset);
+        auto entrypointName = (char const *)&insn.word(3);
+        auto entrypointStageBits = 1u << insn.word(1);
 
-            if (!strcmp(entrypointName, name) && (entrypointStageBits & stageBits)) {
-                return insn;
-            }
+        if (!strcmp(entrypointName, name) && (entrypointStageBits & stageBits)) {
+            return insn;
         }
     }
 
@@ -1122,14 +1594,6 @@ static bool types_match(shader_module const *a, shader_module const *b, unsigned
     }
 }
 
-static int value_or_default(std::unordered_map<unsigned, unsigned> const &map, unsigned id, int def) {
-    auto it = map.find(id);
-    if (it == map.end())
-        return def;
-    else
-        return it->second;
-}
-
 static unsigned get_locations_consumed_by_type(shader_module const *src, unsigned type, bool strip_array_level) {
     auto insn = src->get_def(type);
     assert(insn != src->end());
@@ -1223,52 +1687,53 @@ static spirv_inst_iter get_struct_type(shader_module const *src, spirv_inst_iter
 }
 
 static void collect_interface_block_members(layer_data *my_data, shader_module const *src,
-                                            std::map<location_t, interface_var> &out,
-                                            std::unordered_map<unsigned, unsigned> const &blocks, bool is_array_of_verts,
-                                            uint32_t id, uint32_t type_id, bool is_patch) {
+                                            std::map<location_t, interface_var> &out, bool is_array_of_verts, uint32_t id,
+                                            uint32_t type_id, bool is_patch) {
     /* Walk down the type_id presented, trying to determine whether it's actually an interface block. */
     auto type = get_struct_type(src, src->get_def(type_id), is_array_of_verts && !is_patch);
-    if (type == src->end() || blocks.find(type.word(1)) == blocks.end()) {
+    if (type == src->end()) {
         /* this isn't an interface block. */
         return;
     }
+    decoration_set const &decorations = src->get_decorations(type.word(1));
+    if (!(decorations.flags & decoration_set::block_bit)) {
+        return;
+    }
 
-    std::unordered_map<unsigned, unsigned> member_components;
-
-    /* Walk all the OpMemberDecorate for type's result id -- first pass, collect components. */
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
-            unsigned member_index = insn.word(2);
+    auto first = src->member_decorations.begin() + decorations.first_member_decoration;
+    auto last = first + decorations.member_decoration_count;
 
-            if (insn.word(3) == spv::DecorationComponent) {
-                unsigned component = insn.word(4);
-                member_components[member_index] = component;
-            }
+    /* First pass over the type's OpMemberDecorates -- collect components. */
+    std::vector<std::pair<unsigned, unsigned>> member_components;
+    for (auto it = first; it != last; ++it) {
+        if (it->decoration == spv::DecorationComponent) {
+            member_components.push_back(std::make_pair(it->member, it->value));
         }
     }
 
     /* Second pass -- produce the output, from Location decorations */
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
-            unsigned member_index = insn.word(2);
+    for (auto it = first; it != last; ++it) {
+        if (it->decoration == spv::DecorationLocation) {
+            unsigned member_index = it->member;
             unsigned member_type_id = type.word(2 + member_index);
+            unsigned location = it->value;
+            unsigned num_locations = get_locations_consumed_by_type(src, member_type_id, false);
+            /* the last Component decoration for the member wins */
+            unsigned component = 0;
+            for (auto const &member_component : member_components) {
+                if (member_component.first == member_index)
+                    component = member_component.second;
+            }
 
-            if (insn.word(3) == spv::DecorationLocation) {
-                unsigned location = insn.word(4);
-                unsigned num_locations = get_locations_consumed_by_type(src, member_type_id, false);
-                auto component_it = member_components.find(member_index);
-                unsigned component = component_it == member_components.end() ? 0 : component_it->second;
-
-                for (unsigned int offset = 0; offset < num_locations; offset++) {
-                    interface_var v;
-                    v.id = id;
-                    /* TODO: member index in interface_var too? */
-                    v.type_id = member_type_id;
-                    v.offset = offset;
-                    v.is_patch = is_patch;
-                    v.is_block_member = true;
-                    out[std::make_pair(location + offset, component)] = v;
-                }
+            for (unsigned int offset = 0; offset < num_locations; offset++) {
+                interface_var v;
+                v.id = id;
+                /* TODO: member index in interface_var too? */
+                v.type_id = member_type_id;
+                v.offset = offset;
+                v.is_patch = is_patch;
+                v.is_block_member = true;
+                out[std::make_pair(location + offset, component)] = v;
             }
         }
     }
@@ -1277,39 +1742,9 @@ static void collect_interface_block_members(layer_data *my_data, shader_module c
 static void collect_interface_by_location(layer_data *my_data, shader_module const *src, spirv_inst_iter entrypoint,
                                           spv::StorageClass sinterface, std::map<location_t, interface_var> &out,
                                           bool is_array_of_verts) {
-    std::unordered_map<unsigned, unsigned> var_locations;
-    std::unordered_map<unsigned, unsigned> var_builtins;
-    std::unordered_map<unsigned, unsigned> var_components;
-    std::unordered_map<unsigned, unsigned> blocks;
-    std::unordered_map<unsigned, unsigned> var_patch;
-
-    for (auto insn : *src) {
-
-        /* We consider two interface models: SSO rendezvous-by-location, and
-         * builtins. Complain about anything that fits neither model.
-         */
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationLocation) {
-                var_locations[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBuiltIn) {
-                var_builtins[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationComponent) {
-                var_components[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBlock) {
-                blocks[insn.word(1)] = 1;
-            }
-
-            if (insn.word(2) == spv::DecorationPatch) {
-                var_patch[insn.word(1)] = 1;
-            }
-        }
-    }
+    /* We consider two interface models: SSO rendezvous-by-location, and
+     * builtins. Complain about anything that fits neither model.
+     */
 
     /* TODO: handle grouped decorations */
     /* TODO: handle index=1 dual source outputs from FS -- two vars will
@@ -1333,10 +1768,9 @@ static void collect_interface_by_location(layer_data *my_data, shader_module con
             unsigned id = insn.word(2);
             unsigned type = insn.word(1);
 
-            int location = value_or_default(var_locations, id, -1);
-            int builtin = value_or_default(var_builtins, id, -1);
-            unsigned component = value_or_default(var_components, id, 0); /* unspecified is OK, is 0 */
-            bool is_patch = var_patch.find(id) != var_patch.end();
+            decoration_set const &decorations = src->get_decorations(id);
+            unsigned component = decorations.component; /* unspecified is OK, is 0 */
+            bool is_patch = (decorations.flags & decoration_set::patch_bit) != 0;
 
             /* All variables and interface block members in the Input or Output storage classes
              * must be decorated with either a builtin or an explicit location.
@@ -1346,9 +1780,10 @@ static void collect_interface_by_location(layer_data *my_data, shader_module con
              * individual members of the type are decorated, rather than variable declarations.
              */
 
-            if (location != -1) {
+            if (decorations.flags & decoration_set::location_bit) {
                 /* A user-defined interface variable, with a location. Where a variable
                  * occupied multiple locations, emit one result for each. */
+                unsigned location = decorations.location;
                 unsigned num_locations = get_locations_consumed_by_type(src, type, is_array_of_verts && !is_patch);
                 for (unsigned int offset = 0; offset < num_locations; offset++) {
                     interface_var v;
@@ -1359,44 +1794,30 @@ static void collect_interface_by_location(layer_data *my_data, shader_module con
                     v.is_block_member = false;
                     out[std::make_pair(location + offset, component)] = v;
                 }
-            } else if (builtin == -1) {
+            } else if (!(decorations.flags & decoration_set::builtin_bit)) {
                 /* An interface block instance */
-                collect_interface_block_members(my_data, src, out, blocks, is_array_of_verts, id, type, is_patch);
+                collect_interface_block_members(my_data, src, out, is_array_of_verts, id, type, is_patch);
             }
         }
     }
 }
 
 static void collect_interface_by_descriptor_slot(layer_data *my_data, shader_module const *src,
-                                                 std::unordered_set<uint32_t> const &accessible_ids,
+                                                 std::vector<uint32_t> const &accessible_ids,
                                                  std::map<descriptor_slot_t, interface_var> &out) {
 
-    std::unordered_map<unsigned, unsigned> var_sets;
-    std::unordered_map<unsigned, unsigned> var_bindings;
-
-    for (auto insn : *src) {
-        /* All variables in the Uniform or UniformConstant storage classes are required to be decorated with both
-         * DecorationDescriptorSet and DecorationBinding.
-         */
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationDescriptorSet) {
-                var_sets[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBinding) {
-                var_bindings[insn.word(1)] = insn.word(3);
-            }
-        }
-    }
-
     for (auto id : accessible_ids) {
         auto insn = src->get_def(id);
         assert(insn != src->end());
 
         if (insn.opcode() == spv::OpVariable &&
             (insn.word(3) == spv::StorageClassUniform || insn.word(3) == spv::StorageClassUniformConstant)) {
-            unsigned set = value_or_default(var_sets, insn.word(2), 0);
-            unsigned binding = value_or_default(var_bindings, insn.word(2), 0);
+            /* All variables in the Uniform or UniformConstant storage classes are required to be decorated with both
+             * DecorationDescriptorSet and DecorationBinding.
+             */
+            decoration_set const &decorations = src->get_decorations(insn.word(2));
+            unsigned set = decorations.descriptor_set;
+            unsigned binding = decorations.binding;
 
             auto existing_it = out.find(std::make_pair(set, binding));
             if (existing_it != out.end()) {
@@ -1741,26 +2162,29 @@ static bool validate_fs_outputs_against_render_pass(layer_data *my_data, shader_
  * TODO: The set of interesting opcodes here was determined by eyeballing the SPIRV spec. It might be worth
  * converting parts of this to be generated from the machine-readable spec instead.
  */
-static void mark_accessible_ids(shader_module const *src, spirv_inst_iter entrypoint, std::unordered_set<uint32_t> &ids) {
-    std::unordered_set<uint32_t> worklist;
-    worklist.insert(entrypoint.word(2));
+static void mark_accessible_ids(shader_module const *src, spirv_inst_iter entrypoint, std::vector<uint32_t> &ids) {
+    std::vector<uint32_t> worklist;
+    worklist.push_back(entrypoint.word(2));
+    /* ids are dense, so which ones have been output already is a flag per id */
+    std::vector<char> seen(src->def_index.size(), 0);
 
     while (!worklist.empty()) {
-        auto id_iter = worklist.begin();
-        auto id = *id_iter;
-        worklist.erase(id_iter);
+        auto id = worklist.back();
+        worklist.pop_back();
 
         auto insn = src->get_def(id);
         if (insn == src->end()) {
-            /* id is something we didn't collect in build_def_index. that's OK -- we'll stumble
+            /* id is something we didn't collect in build_module_index. that's OK -- we'll stumble
              * across all kinds of things here that we may not care about. */
             continue;
         }
 
         /* try to add to the output set */
-        if (!ids.insert(id).second) {
+        if (seen[id]) {
             continue; /* if we already saw this id, we don't want to walk it again. */
         }
+        seen[id] = 1;
+        ids.push_back(id);
 
         switch (insn.opcode()) {
         case spv::OpFunction:
@@ -1783,15 +2207,15 @@ static void mark_accessible_ids(shader_module const *src, spirv_inst_iter entryp
                 case spv::OpAtomicAnd:
                 case spv::OpAtomicOr:
                 case spv::OpAtomicXor:
-                    worklist.insert(insn.word(3)); /* ptr */
+                    worklist.push_back(insn.word(3)); /* ptr */
                     break;
                 case spv::OpStore:
                 case spv::OpAtomicStore:
-                    worklist.insert(insn.word(1)); /* ptr */
+                    worklist.push_back(insn.word(1)); /* ptr */
                     break;
                 case spv::OpAccessChain:
                 case spv::OpInBoundsAccessChain:
-                    worklist.insert(insn.word(3)); /* base ptr */
+                    worklist.push_back(insn.word(3)); /* base ptr */
                     break;
                 case spv::OpSampledImage:
                 case spv::OpImageSampleImplicitLod:
@@ -1826,20 +2250,20 @@ static void mark_accessible_ids(shader_module const *src, spirv_inst_iter entryp
                 case spv::OpImageSparseGather:
                 case spv::OpImageSparseDrefGather:
                 case spv::OpImageTexelPointer:
-                    worklist.insert(insn.word(3)); /* image or sampled image */
+                    worklist.push_back(insn.word(3)); /* image or sampled image */
                     break;
                 case spv::OpImageWrite:
-                    worklist.insert(insn.word(1)); /* image -- different operand order to above */
+                    worklist.push_back(insn.word(1)); /* image -- different operand order to above */
                     break;
                 case spv::OpFunctionCall:
                     for (uint32_t i = 3; i < insn.len(); i++) {
-                        worklist.insert(insn.word(i)); /* fn itself, and all args */
+                        worklist.push_back(insn.word(i)); /* fn itself, and all args */
                     }
                     break;
 
                 case spv::OpExtInst:
                     for (uint32_t i = 5; i < insn.len(); i++) {
-                        worklist.insert(insn.word(i)); /* operands to ext inst */
+                        worklist.push_back(insn.word(i)); /* operands to ext inst */
                     }
                     break;
                 }
@@ -1862,40 +2286,40 @@ static bool validate_push_constant_block_against_pipeline(layer_data *my_data,
     /* validate directly off the offsets. this isn't quite correct for arrays
      * and matrices, but is a good first step. TODO: arrays, matrices, weird
      * sizes */
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
-
-            if (insn.word(3) == spv::DecorationOffset) {
-                unsigned offset = insn.word(4);
-                auto size = 4; /* bytes; TODO: calculate this based on the type */
-
-                bool found_range = false;
-                for (auto const &range : *pushConstantRanges) {
-                    if (range.offset <= offset && range.offset + range.size >= offset + size) {
-                        found_range = true;
-
-                        if ((range.stageFlags & stage) == 0) {
-                            if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VkDebugReportObjectTypeEXT(0), 0,
-                                        __LINE__, SHADER_CHECKER_PUSH_CONSTANT_NOT_ACCESSIBLE_FROM_STAGE, "SC",
-                                        "Push constant range covering variable starting at "
-                                        "offset %u not accessible from stage %s",
-                                        offset, string_VkShaderStageFlagBits(stage))) {
-                                pass = false;
-                            }
+    decoration_set const &decorations = src->get_decorations(type.word(1));
+    auto first = src->member_decorations.begin() + decorations.first_member_decoration;
+    auto last = first + decorations.member_decoration_count;
+    for (auto it = first; it != last; ++it) {
+        if (it->decoration == spv::DecorationOffset) {
+            unsigned offset = it->value;
+            auto size = 4; /* bytes; TODO: calculate this based on the type */
+
+            bool found_range = false;
+            for (auto const &range : *pushConstantRanges) {
+                if (range.offset <= offset && range.offset + range.size >= offset + size) {
+                    found_range = true;
+
+                    if ((range.stageFlags & stage) == 0) {
+                        if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VkDebugReportObjectTypeEXT(0), 0,
+                                    __LINE__, SHADER_CHECKER_PUSH_CONSTANT_NOT_ACCESSIBLE_FROM_STAGE, "SC",
+                                    "Push constant range covering variable starting at "
+                                    "offset %u not accessible from stage %s",
+                                    offset, string_VkShaderStageFlagBits(stage))) {
+                            pass = false;
                         }
-
-                        break;
                     }
+
+                    break;
                 }
+            }
 
-                if (!found_range) {
-                    if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VkDebugReportObjectTypeEXT(0), 0,
-                                __LINE__, SHADER_CHECKER_PUSH_CONSTANT_OUT_OF_RANGE, "SC",
-                                "Push constant range covering variable starting at "
-                                "offset %u not declared in layout",
-                                offset)) {
-                        pass = false;
-                    }
+            if (!found_range) {
+                if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VkDebugReportObjectTypeEXT(0), 0,
+                            __LINE__, SHADER_CHECKER_PUSH_CONSTANT_OUT_OF_RANGE, "SC",
+                            "Push constant range covering variable starting at "
+                            "offset %u not declared in layout",
+                            offset)) {
+                    pass = false;
                 }
             }
         }
@@ -1906,7 +2330,7 @@ static bool validate_push_constant_block_against_pipeline(layer_data *my_data,
 
 static bool validate_push_constant_usage(layer_data *my_data,
                                          std::vector<VkPushConstantRange> const *pushConstantRanges, shader_module const *src,
-                                         std::unordered_set<uint32_t> accessible_ids, VkShaderStageFlagBits stage) {
+                                         std::vector<uint32_t> const &accessible_ids, VkShaderStageFlagBits stage) {
     bool pass = true;
 
     for (auto id : accessible_ids) {
@@ -1930,13 +2354,16 @@ static VkDescriptorSetLayoutBinding const * get_descriptor_binding(layer_data *m
     if (slot.first >= pipelineLayout->descriptorSetLayouts.size())
         return nullptr;
 
-    const auto & layout_node = my_data->descriptorSetLayoutMap[pipelineLayout->descriptorSetLayouts[slot.first]];
-    return layout_node->GetDescriptorSetLayoutBindingPtrFromBinding(slot.second);
+    auto layout_node = my_data->descriptorSetLayoutMap.find(pipelineLayout->descriptorSetLayouts[slot.first]);
+    if (layout_node == my_data->descriptorSetLayoutMap.end())
+        return nullptr;
+    return layout_node->second->GetDescriptorSetLayoutBindingPtrFromBinding(slot.second);
 }
 
 // Block of code at start here for managing/tracking Pipeline state that this layer cares about
 
-static uint64_t g_drawCount[NUM_DRAW_TYPES] = {0, 0, 0, 0};
+// Bumped from shared-mode draw intercepts, so kept atomic
+static std::atomic<uint64_t> g_drawCount[NUM_DRAW_TYPES];
 
 // TODO : Should be tracking lastBound per commandBuffer and when draws occur, report based on that cmd buffer lastBound
 //   Then need to synchronize the accesses based on cmd buffer so that if I'm reading state on one cmd buffer, updates
@@ -1964,10 +2391,11 @@ static bool validate_status(layer_data *my_data, GLOBAL_CB_NODE *pNode, CBStatus
 
 // Retrieve pipeline node ptr for given pipeline object
 static PIPELINE_NODE *getPipeline(layer_data *my_data, const VkPipeline pipeline) {
-    if (my_data->pipelineMap.find(pipeline) == my_data->pipelineMap.end()) {
+    auto it = my_data->pipelineMap.find(pipeline);
+    if (it == my_data->pipelineMap.end()) {
         return NULL;
     }
-    return my_data->pipelineMap[pipeline];
+    return it->second;
 }
 
 // Return true if for a given PSO, the given state enum is dynamic, else return false
@@ -1982,7 +2410,7 @@ static bool isDynamic(const PIPELINE_NODE *pPipeline, const VkDynamicState state
 }
 
 // Validate state stored as flags at time of draw call
-static bool validate_draw_state_flags(layer_data *dev_data, GLOBAL_CB_NODE *pCB, const PIPELINE_NODE *pPipe, bool indexedDraw) {
+static bool validate_draw_state_flags(layer_data *dev_data, GLOBAL_CB_NODE *pCB, const PIPELINE_NODE *pPipe) {
     bool result;
     result = validate_status(dev_data, pCB, CBSTATUS_VIEWPORT_SET, VK_DEBUG_REPORT_ERROR_BIT_EXT, DRAWSTATE_VIEWPORT_NOT_BOUND,
                              "Dynamic viewport state not set for this command buffer");
@@ -2017,11 +2445,6 @@ static bool validate_draw_state_flags(layer_data *dev_data, GLOBAL_CB_NODE *pCB,
         result |= validate_status(dev_data, pCB, CBSTATUS_STENCIL_REFERENCE_SET, VK_DEBUG_REPORT_ERROR_BIT_EXT,
                                   DRAWSTATE_STENCIL_NOT_BOUND, "Dynamic stencil reference state not set for this command buffer");
     }
-    if (indexedDraw) {
-        result |= validate_status(dev_data, pCB, CBSTATUS_INDEX_BUFFER_BOUND, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                  DRAWSTATE_INDEX_BUFFER_NOT_BOUND,
-                                  "Index buffer object not bound to this command buffer when Indexed Draw attempted");
-    }
     return result;
 }
 
@@ -2148,8 +2571,14 @@ static bool verify_set_layout_compatibility(layer_data *my_data, const SET_NODE
         errorMsg = errorStr.str();
         return false;
     }
-    auto layout_node = my_data->descriptorSetLayoutMap[pipeline_layout_it->second.descriptorSetLayouts[layoutIndex]];
-    return layout_node->IsCompatible(pSet->p_layout, &errorMsg);
+    auto layout_it = my_data->descriptorSetLayoutMap.find(pipeline_layout_it->second.descriptorSetLayouts[layoutIndex]);
+    if (layout_it == my_data->descriptorSetLayoutMap.end()) {
+        stringstream errorStr;
+        errorStr << "invalid VkDescriptorSetLayout at index " << layoutIndex << " of VkPipelineLayout (" << layout << ")";
+        errorMsg = errorStr.str();
+        return false;
+    }
+    return layout_it->second->IsCompatible(pSet->p_layout, &errorMsg);
 }
 
 // Validate that data for each specialization entry is fully contained within the buffer.
@@ -2198,16 +2627,13 @@ static bool descriptor_type_match(layer_data *my_data, shader_module const *modu
 
     switch (type.opcode()) {
     case spv::OpTypeStruct: {
-        for (auto insn : *module) {
-            if (insn.opcode() == spv::OpDecorate && insn.word(1) == type.word(1)) {
-                if (insn.word(2) == spv::DecorationBlock) {
-                    return descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
-                           descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-                } else if (insn.word(2) == spv::DecorationBufferBlock) {
-                    return descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
-                           descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-                }
-            }
+        auto flags = module->get_decorations(type.word(1)).flags;
+        if (flags & decoration_set::block_bit) {
+            return descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+                   descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        } else if (flags & decoration_set::buffer_block_bit) {
+            return descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+                   descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
         }
 
         /* Invalid */
@@ -2281,134 +2707,133 @@ static bool validate_shader_capabilities(layer_data *my_data, shader_module cons
 
     auto enabledFeatures = &my_data->phys_dev_properties.features;
 
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpCapability) {
-            switch (insn.word(1)) {
-            case spv::CapabilityMatrix:
-            case spv::CapabilityShader:
-            case spv::CapabilityInputAttachment:
-            case spv::CapabilitySampled1D:
-            case spv::CapabilityImage1D:
-            case spv::CapabilitySampledBuffer:
-            case spv::CapabilityImageBuffer:
-            case spv::CapabilityImageQuery:
-            case spv::CapabilityDerivativeControl:
-                // Always supported by a Vulkan 1.0 implementation -- no feature bits.
-                break;
+    for (auto offset : src->capabilities) {
+        auto insn = src->at(offset);
+        switch (insn.word(1)) {
+        case spv::CapabilityMatrix:
+        case spv::CapabilityShader:
+        case spv::CapabilityInputAttachment:
+        case spv::CapabilitySampled1D:
+        case spv::CapabilityImage1D:
+        case spv::CapabilitySampledBuffer:
+        case spv::CapabilityImageBuffer:
+        case spv::CapabilityImageQuery:
+        case spv::CapabilityDerivativeControl:
+            // Always supported by a Vulkan 1.0 implementation -- no feature bits.
+            break;
 
-            case spv::CapabilityGeometry:
-                pass &= require_feature(my_data, enabledFeatures->geometryShader, "geometryShader");
-                break;
+        case spv::CapabilityGeometry:
+            pass &= require_feature(my_data, enabledFeatures->geometryShader, "geometryShader");
+            break;
 
-            case spv::CapabilityTessellation:
-                pass &= require_feature(my_data, enabledFeatures->tessellationShader, "tessellationShader");
-                break;
+        case spv::CapabilityTessellation:
+            pass &= require_feature(my_data, enabledFeatures->tessellationShader, "tessellationShader");
+            break;
 
-            case spv::CapabilityFloat64:
-                pass &= require_feature(my_data, enabledFeatures->shaderFloat64, "shaderFloat64");
-                break;
+        case spv::CapabilityFloat64:
+            pass &= require_feature(my_data, enabledFeatures->shaderFloat64, "shaderFloat64");
+            break;
 
-            case spv::CapabilityInt64:
-                pass &= require_feature(my_data, enabledFeatures->shaderInt64, "shaderInt64");
-                break;
+        case spv::CapabilityInt64:
+            pass &= require_feature(my_data, enabledFeatures->shaderInt64, "shaderInt64");
+            break;
 
-            case spv::CapabilityTessellationPointSize:
-            case spv::CapabilityGeometryPointSize:
-                pass &= require_feature(my_data, enabledFeatures->shaderTessellationAndGeometryPointSize,
-                                        "shaderTessellationAndGeometryPointSize");
-                break;
+        case spv::CapabilityTessellationPointSize:
+        case spv::CapabilityGeometryPointSize:
+            pass &= require_feature(my_data, enabledFeatures->shaderTessellationAndGeometryPointSize,
+                                    "shaderTessellationAndGeometryPointSize");
+            break;
 
-            case spv::CapabilityImageGatherExtended:
-                pass &= require_feature(my_data, enabledFeatures->shaderImageGatherExtended, "shaderImageGatherExtended");
-                break;
+        case spv::CapabilityImageGatherExtended:
+            pass &= require_feature(my_data, enabledFeatures->shaderImageGatherExtended, "shaderImageGatherExtended");
+            break;
 
-            case spv::CapabilityStorageImageMultisample:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageImageMultisample, "shaderStorageImageMultisample");
-                break;
+        case spv::CapabilityStorageImageMultisample:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageImageMultisample, "shaderStorageImageMultisample");
+            break;
 
-            case spv::CapabilityUniformBufferArrayDynamicIndexing:
-                pass &= require_feature(my_data, enabledFeatures->shaderUniformBufferArrayDynamicIndexing,
-                                        "shaderUniformBufferArrayDynamicIndexing");
-                break;
+        case spv::CapabilityUniformBufferArrayDynamicIndexing:
+            pass &= require_feature(my_data, enabledFeatures->shaderUniformBufferArrayDynamicIndexing,
+                                    "shaderUniformBufferArrayDynamicIndexing");
+            break;
 
-            case spv::CapabilitySampledImageArrayDynamicIndexing:
-                pass &= require_feature(my_data, enabledFeatures->shaderSampledImageArrayDynamicIndexing,
-                                        "shaderSampledImageArrayDynamicIndexing");
-                break;
+        case spv::CapabilitySampledImageArrayDynamicIndexing:
+            pass &= require_feature(my_data, enabledFeatures->shaderSampledImageArrayDynamicIndexing,
+                                    "shaderSampledImageArrayDynamicIndexing");
+            break;
 
-            case spv::CapabilityStorageBufferArrayDynamicIndexing:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageBufferArrayDynamicIndexing,
-                                        "shaderStorageBufferArrayDynamicIndexing");
-                break;
+        case spv::CapabilityStorageBufferArrayDynamicIndexing:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageBufferArrayDynamicIndexing,
+                                    "shaderStorageBufferArrayDynamicIndexing");
+            break;
 
-            case spv::CapabilityStorageImageArrayDynamicIndexing:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageImageArrayDynamicIndexing,
-                                        "shaderStorageImageArrayDynamicIndexing");
-                break;
+        case spv::CapabilityStorageImageArrayDynamicIndexing:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageImageArrayDynamicIndexing,
+                                    "shaderStorageImageArrayDynamicIndexing");
+            break;
 
-            case spv::CapabilityClipDistance:
-                pass &= require_feature(my_data, enabledFeatures->shaderClipDistance, "shaderClipDistance");
-                break;
+        case spv::CapabilityClipDistance:
+            pass &= require_feature(my_data, enabledFeatures->shaderClipDistance, "shaderClipDistance");
+            break;
 
-            case spv::CapabilityCullDistance:
-                pass &= require_feature(my_data, enabledFeatures->shaderCullDistance, "shaderCullDistance");
-                break;
+        case spv::CapabilityCullDistance:
+            pass &= require_feature(my_data, enabledFeatures->shaderCullDistance, "shaderCullDistance");
+            break;
 
-            case spv::CapabilityImageCubeArray:
-                pass &= require_feature(my_data, enabledFeatures->imageCubeArray, "imageCubeArray");
-                break;
+        case spv::CapabilityImageCubeArray:
+            pass &= require_feature(my_data, enabledFeatures->imageCubeArray, "imageCubeArray");
+            break;
 
-            case spv::CapabilitySampleRateShading:
-                pass &= require_feature(my_data, enabledFeatures->sampleRateShading, "sampleRateShading");
-                break;
+        case spv::CapabilitySampleRateShading:
+            pass &= require_feature(my_data, enabledFeatures->sampleRateShading, "sampleRateShading");
+            break;
 
-            case spv::CapabilitySparseResidency:
-                pass &= require_feature(my_data, enabledFeatures->shaderResourceResidency, "shaderResourceResidency");
-                break;
+        case spv::CapabilitySparseResidency:
+            pass &= require_feature(my_data, enabledFeatures->shaderResourceResidency, "shaderResourceResidency");
+            break;
 
-            case spv::CapabilityMinLod:
-                pass &= require_feature(my_data, enabledFeatures->shaderResourceMinLod, "shaderResourceMinLod");
-                break;
+        case spv::CapabilityMinLod:
+            pass &= require_feature(my_data, enabledFeatures->shaderResourceMinLod, "shaderResourceMinLod");
+            break;
 
-            case spv::CapabilitySampledCubeArray:
-                pass &= require_feature(my_data, enabledFeatures->imageCubeArray, "imageCubeArray");
-                break;
+        case spv::CapabilitySampledCubeArray:
+            pass &= require_feature(my_data, enabledFeatures->imageCubeArray, "imageCubeArray");
+            break;
 
-            case spv::CapabilityImageMSArray:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageImageMultisample, "shaderStorageImageMultisample");
-                break;
+        case spv::CapabilityImageMSArray:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageImageMultisample, "shaderStorageImageMultisample");
+            break;
 
-            case spv::CapabilityStorageImageExtendedFormats:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageImageExtendedFormats,
-                                        "shaderStorageImageExtendedFormats");
-                break;
+        case spv::CapabilityStorageImageExtendedFormats:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageImageExtendedFormats,
+                                    "shaderStorageImageExtendedFormats");
+            break;
 
-            case spv::CapabilityInterpolationFunction:
-                pass &= require_feature(my_data, enabledFeatures->sampleRateShading, "sampleRateShading");
-                break;
+        case spv::CapabilityInterpolationFunction:
+            pass &= require_feature(my_data, enabledFeatures->sampleRateShading, "sampleRateShading");
+            break;
 
-            case spv::CapabilityStorageImageReadWithoutFormat:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageImageReadWithoutFormat,
-                                        "shaderStorageImageReadWithoutFormat");
-                break;
+        case spv::CapabilityStorageImageReadWithoutFormat:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageImageReadWithoutFormat,
+                                    "shaderStorageImageReadWithoutFormat");
+            break;
 
-            case spv::CapabilityStorageImageWriteWithoutFormat:
-                pass &= require_feature(my_data, enabledFeatures->shaderStorageImageWriteWithoutFormat,
-                                        "shaderStorageImageWriteWithoutFormat");
-                break;
+        case spv::CapabilityStorageImageWriteWithoutFormat:
+            pass &= require_feature(my_data, enabledFeatures->shaderStorageImageWriteWithoutFormat,
+                                    "shaderStorageImageWriteWithoutFormat");
+            break;
 
-            case spv::CapabilityMultiViewport:
-                pass &= require_feature(my_data, enabledFeatures->multiViewport, "multiViewport");
-                break;
+        case spv::CapabilityMultiViewport:
+            pass &= require_feature(my_data, enabledFeatures->multiViewport, "multiViewport");
+            break;
 
-            default:
-                if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VkDebugReportObjectTypeEXT(0), 0,
-                            __LINE__, SHADER_CHECKER_BAD_CAPABILITY, "SC",
-                            "Shader declares capability %u, not supported in Vulkan.",
-                            insn.word(1)))
-                    pass = false;
-                break;
-            }
+        default:
+            if (log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VkDebugReportObjectTypeEXT(0), 0,
+                        __LINE__, SHADER_CHECKER_BAD_CAPABILITY, "SC",
+                        "Shader declares capability %u, not supported in Vulkan.",
+                        insn.word(1)))
+                pass = false;
+            break;
         }
     }
 
@@ -2419,7 +2844,12 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
                                            PIPELINE_NODE *pipeline, PIPELINE_LAYOUT_NODE *pipelineLayout,
                                            shader_module **out_module, spirv_inst_iter *out_entrypoint) {
     bool pass = true;
-    auto module = *out_module = dev_data->shaderModuleMap[pStage->module].get();
+    auto module_it = dev_data->shaderModuleMap.find(pStage->module);
+    auto module = *out_module = module_it != dev_data->shaderModuleMap.end() ? module_it->second.get() : nullptr;
+    if (!module) {
+        // Unknown module handles are object_tracker's to report; there is nothing to check it against here
+        return pass;
+    }
     pass &= validate_specialization_offsets(dev_data, pStage);
 
     /* find the entrypoint */
@@ -2437,7 +2867,7 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
     pass &= validate_shader_capabilities(dev_data, module);
 
     /* mark accessible ids */
-    std::unordered_set<uint32_t> accessible_ids;
+    std::vector<uint32_t> accessible_ids;
     mark_accessible_ids(module, entrypoint, accessible_ids);
 
     /* validate descriptor set layout against what the entrypoint actually uses */
@@ -2445,7 +2875,8 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
     collect_interface_by_descriptor_slot(dev_data, module, accessible_ids, descriptor_uses);
 
     /* validate push constant usage */
-    pass &= validate_push_constant_usage(dev_data, &pipelineLayout->pushConstantRanges,
+    std::vector<VkPushConstantRange> const noPushConstantRanges;
+    pass &= validate_push_constant_usage(dev_data, pipelineLayout ? &pipelineLayout->pushConstantRanges : &noPushConstantRanges,
                                         module, accessible_ids, pStage->stage);
 
     /* validate descriptor use */
@@ -2499,9 +2930,20 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
 }
 
 
+// Return pipeline layout node for the given layout, or nullptr if it is not known.  Unlike operator[] this never
+//  inserts, so it is safe while other threads read pipelineLayoutMap.
+static PIPELINE_LAYOUT_NODE *getPipelineLayout(layer_data *my_data, VkPipelineLayout layout) {
+    auto it = my_data->pipelineLayoutMap.find(layout);
+    if (it == my_data->pipelineLayoutMap.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
 // Validate that the shaders used by the given pipeline and store the active_slots
 //  that are actually used by the pipeline into pPipeline->active_slots
 static bool validate_and_capture_pipeline_shader_state(layer_data *my_data, PIPELINE_NODE *pPipeline) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     auto pCreateInfo = pPipeline->graphicsPipelineCI.ptr();
     int vertex_stage = get_shader_stage_id(VK_SHADER_STAGE_VERTEX_BIT);
     int fragment_stage = get_shader_stage_id(VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -2513,7 +2955,7 @@ static bool validate_and_capture_pipeline_shader_state(layer_data *my_data, PIPE
     VkPipelineVertexInputStateCreateInfo const *vi = 0;
     bool pass = true;
 
-    auto pipelineLayout = pCreateInfo->layout != VK_NULL_HANDLE ? &my_data->pipelineLayoutMap[pCreateInfo->layout] : nullptr;
+    auto pipelineLayout = getPipelineLayout(my_data, pCreateInfo->layout);
 
     for (uint32_t i = 0; i < pCreateInfo->stageCount; i++) {
         auto pStage = &pCreateInfo->pStages[i];
@@ -2551,7 +2993,8 @@ static bool validate_and_capture_pipeline_shader_state(layer_data *my_data, PIPE
         }
     }
 
-    auto rp = pCreateInfo->renderPass != VK_NULL_HANDLE ? my_data->renderPassMap[pCreateInfo->renderPass] : nullptr;
+    auto rp_it = my_data->renderPassMap.find(pCreateInfo->renderPass);
+    auto rp = rp_it != my_data->renderPassMap.end() ? rp_it->second : nullptr;
 
     if (shaders[fragment_stage] && rp) {
         pass &= validate_fs_outputs_against_render_pass(my_data, shaders[fragment_stage], entrypoints[fragment_stage], rp,
@@ -2564,7 +3007,7 @@ static bool validate_and_capture_pipeline_shader_state(layer_data *my_data, PIPE
 static bool validate_compute_pipeline(layer_data *my_data, PIPELINE_NODE *pPipeline) {
     auto pCreateInfo = pPipeline->computePipelineCI.ptr();
 
-    auto pipelineLayout = pCreateInfo->layout != VK_NULL_HANDLE ? &my_data->pipelineLayoutMap[pCreateInfo->layout] : nullptr;
+    auto pipelineLayout = getPipelineLayout(my_data, pCreateInfo->layout);
 
     shader_module *module;
     spirv_inst_iter entrypoint;
@@ -2575,10 +3018,11 @@ static bool validate_compute_pipeline(layer_data *my_data, PIPELINE_NODE *pPipel
 
 // Return Set node ptr for specified set or else NULL
 static SET_NODE *getSetNode(layer_data *my_data, const VkDescriptorSet set) {
-    if (my_data->setMap.find(set) == my_data->setMap.end()) {
+    auto it = my_data->setMap.find(set);
+    if (it == my_data->setMap.end()) {
         return NULL;
     }
-    return my_data->setMap[set];
+    return it->second;
 }
 // For the given command buffer, verify and update the state for activeSetBindingsPairs
 //  This includes:
@@ -2656,7 +3100,9 @@ static bool validate_and_update_drawtime_descriptor_state(
                                     // If it's a dynamic buffer, make sure the offsets are within the buffer.
                                     if ((pWDS->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) ||
                                         (pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
-                                        bufferSize = dev_data->bufferMap[pWDS->pBufferInfo[j].buffer].createInfo.size;
+                                        bufferSize = (buffer_node == dev_data->bufferMap.end())
+                                                         ? 0
+                                                         : buffer_node->second.createInfo.size;
                                         uint32_t dynOffset =
                                             pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dynamicOffsets[dynOffsetIndex];
                                         if (pWDS->pBufferInfo[j].range == VK_WHOLE_SIZE) {
@@ -2700,8 +3146,10 @@ static bool validate_and_update_drawtime_descriptor_state(
                                 }
                             } else if (pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER) {
                                 for (uint32_t j = 0; j < pWDS->descriptorCount; ++j) {
-                                    assert(dev_data->bufferViewMap.find(pWDS->pTexelBufferView[j]) != dev_data->bufferViewMap.end());
-                                    pCB->updateBuffers.insert(dev_data->bufferViewMap[pWDS->pTexelBufferView[j]].buffer);
+                                    auto bv_data = dev_data->bufferViewMap.find(pWDS->pTexelBufferView[j]);
+                                    assert(bv_data != dev_data->bufferViewMap.end());
+                                    if (bv_data != dev_data->bufferViewMap.end())
+                                        pCB->updateBuffers.insert(bv_data->second.buffer);
                                 }
                             } else if (pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
                                        pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
@@ -2735,6 +3183,8 @@ static void update_shader_storage_images_and_buffers(layer_data *dev_data, GLOBA
     for (auto set : pCB->lastBound[VK_PIPELINE_BIND_POINT_COMPUTE].uniqueBoundSets) {
         // Get the set node
         pSet = getSetNode(dev_data, set);
+        if (!pSet)
+            continue;
         // For each update in the set
         for (auto pUpdate : pSet->pDescriptorUpdates) {
             // If it's a write update to STORAGE type capture image/buffer being updated
@@ -2746,7 +3196,9 @@ static void update_shader_storage_images_and_buffers(layer_data *dev_data, GLOBA
                     }
                 } else if (pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER) {
                     for (uint32_t j = 0; j < pWDS->descriptorCount; ++j) {
-                        pCB->updateBuffers.insert(dev_data->bufferViewMap[pWDS->pTexelBufferView[j]].buffer);
+                        auto bv_data = dev_data->bufferViewMap.find(pWDS->pTexelBufferView[j]);
+                        if (bv_data != dev_data->bufferViewMap.end())
+                            pCB->updateBuffers.insert(bv_data->second.buffer);
                     }
                 } else if (pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
                            pWDS->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
@@ -2760,10 +3212,17 @@ static void update_shader_storage_images_and_buffers(layer_data *dev_data, GLOBA
 }
 
 // Validate overall state at the time of a draw call
+//  Checks on bound state that hasn't changed since they last passed in this command buffer are not repeated,
+//  see LAST_BOUND_STATE::dirty. Checks that failed are repeated at every draw until they pass.
 static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *pCB, const bool indexedDraw,
                                            const VkPipelineBindPoint bindPoint) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool result = false;
-    auto const &state = pCB->lastBound[bindPoint];
+    // Whether the checks on dynamic state and on descriptor sets logged anything during this draw
+    bool dynamicStateLogged = false;
+    bool descriptorSetsLogged = false;
+    uint64_t logged;
+    auto &state = pCB->lastBound[bindPoint];
     PIPELINE_NODE *pPipe = getPipeline(my_data, state.pipeline);
     if (nullptr == pPipe) {
         result |= log_msg(
@@ -2774,10 +3233,22 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
         if (result)
             return true;
     }
+    // Descriptor set contents and the buffers and memory they point at may have changed since the last check
+    if (state.validatedGeneration != my_data->drawStateGeneration)
+        state.dirty |= LAST_BOUND_DIRTY_DESCRIPTOR_SETS;
     // First check flag states
-    if (VK_PIPELINE_BIND_POINT_GRAPHICS == bindPoint)
-        result = validate_draw_state_flags(my_data, pCB, pPipe, indexedDraw);
-    else {
+    if (VK_PIPELINE_BIND_POINT_GRAPHICS == bindPoint) {
+        if (state.dirty & (LAST_BOUND_DIRTY_PIPELINE | LAST_BOUND_DIRTY_DYNAMIC_STATE)) {
+            logged = debug_report_thread_logged;
+            result = validate_draw_state_flags(my_data, pCB, pPipe);
+            dynamicStateLogged = debug_report_thread_logged != logged;
+        }
+        if (indexedDraw) {
+            result |= validate_status(my_data, pCB, CBSTATUS_INDEX_BUFFER_BOUND, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                      DRAWSTATE_INDEX_BUFFER_NOT_BOUND,
+                                      "Index buffer object not bound to this command buffer when Indexed Draw attempted");
+        }
+    } else {
         // First block of code below to validate active sets should eventually
         //  work for the compute case but currently doesn't so return early for now
         // TODO : When active sets in compute shaders are correctly parsed,
@@ -2787,10 +3258,12 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
 
     // Now complete other state checks
     // TODO : When Compute shaders are properly parsed, fix this section to validate them as well
-    if (state.pipelineLayout) {
+    logged = debug_report_thread_logged;
+    if (state.pipelineLayout && (state.dirty & (LAST_BOUND_DIRTY_PIPELINE | LAST_BOUND_DIRTY_DESCRIPTOR_SETS))) {
         string errorString;
         // Need a vector (vs. std::set) of active Sets for dynamicOffset validation in case same set bound w/ different offsets
-        vector<std::pair<SET_NODE *, unordered_set<uint32_t>>> activeSetBindingsPairs;
+        vector<std::pair<SET_NODE *, unordered_set<uint32_t>>> &activeSetBindingsPairs = state.activeSetBindingsPairs;
+        activeSetBindingsPairs.clear();
         for (auto setBindingPair : pPipe->active_slots) {
             uint32_t setIndex = setBindingPair.first;
             // If valid set is not bound throw an error
@@ -2799,10 +3272,15 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
                                   DRAWSTATE_DESCRIPTOR_SET_NOT_BOUND, "DS",
                                   "VkPipeline %#" PRIxLEAST64 " uses set #%u but that set is not bound.", (uint64_t)pPipe->pipeline,
                                   setIndex);
-            } else if (!verify_set_layout_compatibility(my_data, my_data->setMap[state.boundDescriptorSets[setIndex]],
+            } else if (!getSetNode(my_data, state.boundDescriptorSets[setIndex])) {
+                result |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                                  (uint64_t)state.boundDescriptorSets[setIndex], __LINE__, DRAWSTATE_INVALID_SET, "DS",
+                                  "VkDescriptorSet %#" PRIxLEAST64 " bound as set #%u no longer exists.",
+                                  (uint64_t)state.boundDescriptorSets[setIndex], setIndex);
+            } else if (!verify_set_layout_compatibility(my_data, getSetNode(my_data, state.boundDescriptorSets[setIndex]),
                                                         pPipe->graphicsPipelineCI.layout, setIndex, errorString)) {
                 // Set is bound but not compatible w/ overlapping pipelineLayout from PSO
-                VkDescriptorSet setHandle = my_data->setMap[state.boundDescriptorSets[setIndex]]->set;
+                VkDescriptorSet setHandle = state.boundDescriptorSets[setIndex];
                 result |=
                     log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
                             (uint64_t)setHandle, __LINE__, DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE, "DS",
@@ -2811,7 +3289,7 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
                             (uint64_t)setHandle, setIndex, (uint64_t)pPipe->graphicsPipelineCI.layout, errorString.c_str());
             } else { // Valid set is bound and layout compatible, validate that it's updated
                 // Pull the set node
-                SET_NODE *pSet = my_data->setMap[state.boundDescriptorSets[setIndex]];
+                SET_NODE *pSet = getSetNode(my_data, state.boundDescriptorSets[setIndex]);
                 // Save vector of all active sets to verify dynamicOffsets below
                 activeSetBindingsPairs.push_back(std::make_pair(pSet, setBindingPair.second));
                 // Make sure set has been updated if it has no immutable samplers
@@ -2832,7 +3310,11 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
         }
         // For given active slots, verify any dynamic descriptors and record updated images & buffers
         result |= validate_and_update_drawtime_descriptor_state(my_data, pCB, activeSetBindingsPairs);
+    } else if (state.pipelineLayout && (state.dirty & LAST_BOUND_DIRTY_DYNAMIC_OFFSETS)) {
+        // Same sets as last time, only the dynamic offsets need checking again
+        result |= validate_and_update_drawtime_descriptor_state(my_data, pCB, state.activeSetBindingsPairs);
     }
+    descriptorSetsLogged = debug_report_thread_logged != logged;
     // TODO : If/when compute pipelines/shaders are handled above, code below is only for gfx bind poing
     //if (VK_PIPELINE_BIND_POINT_GRAPHICS == bindPoint) {
     // Verify Vtx binding
@@ -2858,7 +3340,9 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
     }
     // If Viewport or scissors are dynamic, verify that dynamic count matches PSO count.
     // Skip check if rasterization is disabled or there is no viewport.
-    if ((!pPipe->graphicsPipelineCI.pRasterizationState ||
+    logged = debug_report_thread_logged;
+    if ((state.dirty & (LAST_BOUND_DIRTY_PIPELINE | LAST_BOUND_DIRTY_DYNAMIC_STATE)) &&
+        (!pPipe->graphicsPipelineCI.pRasterizationState ||
          (pPipe->graphicsPipelineCI.pRasterizationState->rasterizerDiscardEnable == VK_FALSE)) &&
         pPipe->graphicsPipelineCI.pViewportState) {
         bool dynViewport = isDynamic(pPipe, VK_DYNAMIC_STATE_VIEWPORT);
@@ -2882,7 +3366,17 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
             }
         }
     }
+    dynamicStateLogged |= debug_report_thread_logged != logged;
     //} // end of "if (VK_PIPELINE_BIND_POINT_GRAPHICS == bindPoint) {" block
+    // Checks that logged anything run again at the next draw, so a problem is reported at every draw it affects even
+    //  when the callbacks did not ask for the draw to be skipped
+    state.dirty = LAST_BOUND_DIRTY_NONE;
+    if (dynamicStateLogged)
+        state.dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
+    if (descriptorSetsLogged)
+        state.dirty |= LAST_BOUND_DIRTY_DESCRIPTOR_SETS;
+    else
+        state.validatedGeneration = my_data->drawStateGeneration;
     return result;
 }
 
@@ -2912,8 +3406,9 @@ static bool verifyLineWidth(layer_data *my_data, DRAW_STATE_ERROR dsError, const
 }
 
 // Verify that create state for a pipeline is valid
-static bool verifyPipelineCreateState(layer_data *my_data, const VkDevice device, std::vector<PIPELINE_NODE *> pPipelines,
-                                      int pipelineIndex) {
+static bool verifyPipelineCreateState(layer_data *my_data, const VkDevice device,
+                                      const std::vector<PIPELINE_NODE *> &pPipelines, int pipelineIndex) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
 
     PIPELINE_NODE *pPipeline = pPipelines[pipelineIndex];
@@ -3135,8 +3630,8 @@ static void deletePipelines(layer_data *my_data) {
 
 // For given pipeline, return number of MSAA samples, or one if MSAA disabled
 static VkSampleCountFlagBits getNumSamples(layer_data *my_data, const VkPipeline pipeline) {
-    PIPELINE_NODE *pPipe = my_data->pipelineMap[pipeline];
-    if (pPipe->graphicsPipelineCI.pMultisampleState &&
+    PIPELINE_NODE *pPipe = getPipeline(my_data, pipeline);
+    if (pPipe && pPipe->graphicsPipelineCI.pMultisampleState &&
         (VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO == pPipe->graphicsPipelineCI.pMultisampleState->sType)) {
         return pPipe->graphicsPipelineCI.pMultisampleState->rasterizationSamples;
     }
@@ -3146,16 +3641,18 @@ static VkSampleCountFlagBits getNumSamples(layer_data *my_data, const VkPipeline
 // Validate state related to the PSO
 static bool validatePipelineState(layer_data *my_data, const GLOBAL_CB_NODE *pCB, const VkPipelineBindPoint pipelineBindPoint,
                                   const VkPipeline pipeline) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     if (VK_PIPELINE_BIND_POINT_GRAPHICS == pipelineBindPoint) {
         // Verify that any MSAA request in PSO matches sample# in bound FB
         // Skip the check if rasterization is disabled.
-        PIPELINE_NODE *pPipeline = my_data->pipelineMap[pipeline];
-        if (!pPipeline->graphicsPipelineCI.pRasterizationState ||
-            (pPipeline->graphicsPipelineCI.pRasterizationState->rasterizerDiscardEnable == VK_FALSE)) {
+        PIPELINE_NODE *pPipeline = getPipeline(my_data, pipeline);
+        auto rp_data = my_data->renderPassMap.find(pCB->activeRenderPass);
+        if (pPipeline && (!pPipeline->graphicsPipelineCI.pRasterizationState ||
+                          (pPipeline->graphicsPipelineCI.pRasterizationState->rasterizerDiscardEnable == VK_FALSE))) {
             VkSampleCountFlagBits psoNumSamples = getNumSamples(my_data, pipeline);
-            if (pCB->activeRenderPass) {
-                const VkRenderPassCreateInfo *pRPCI = my_data->renderPassMap[pCB->activeRenderPass]->pCreateInfo;
+            if (rp_data != my_data->renderPassMap.end()) {
+                const VkRenderPassCreateInfo *pRPCI = rp_data->second->pCreateInfo;
                 const VkSubpassDescription *pSD = &pRPCI->pSubpasses[pCB->activeSubpass];
                 VkSampleCountFlagBits subpassNumSamples = (VkSampleCountFlagBits)0;
                 uint32_t i;
@@ -3216,10 +3713,11 @@ static bool validatePipelineState(layer_data *my_data, const GLOBAL_CB_NODE *pCB
 
 // Return Pool node ptr for specified pool or else NULL
 static DESCRIPTOR_POOL_NODE *getPoolNode(layer_data *my_data, const VkDescriptorPool pool) {
-    if (my_data->descriptorPoolMap.find(pool) == my_data->descriptorPoolMap.end()) {
+    auto it = my_data->descriptorPoolMap.find(pool);
+    if (it == my_data->descriptorPoolMap.end()) {
         return NULL;
     }
-    return my_data->descriptorPoolMap[pool];
+    return it->second;
 }
 
 // Return false if update struct is of valid type, otherwise flag error and return code from callback
@@ -3373,193 +3871,165 @@ static bool validateSampler(const layer_data *my_data, const VkSampler *pSampler
     return skipCall;
 }
 
-//TODO: Consolidate functions
-bool FindLayout(const GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, IMAGE_CMD_BUF_LAYOUT_NODE &node, const VkImageAspectFlags aspectMask) {
-    layer_data *my_data = get_my_data_ptr(get_dispatch_key(pCB->commandBuffer), layer_data_map);
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-    if (imgsubIt == pCB->imageLayoutMap.end()) {
-        return false;
-    }
-    if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != imgsubIt->second.layout) {
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
-                reinterpret_cast<uint64_t&>(imgpair.image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                reinterpret_cast<uint64_t&>(imgpair.image), oldAspectMask, string_VkImageLayout(node.layout), string_VkImageLayout(imgsubIt->second.layout));
-    }
-    if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != imgsubIt->second.initialLayout) {
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
-                reinterpret_cast<uint64_t&>(imgpair.image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
-                reinterpret_cast<uint64_t&>(imgpair.image), oldAspectMask, string_VkImageLayout(node.initialLayout), string_VkImageLayout(imgsubIt->second.initialLayout));
+static const IMAGE_CMD_BUF_LAYOUT_NODE unusedCBLayout(VK_IMAGE_LAYOUT_MAX_ENUM, VK_IMAGE_LAYOUT_MAX_ENUM);
+
+// Get the cmd buf level layouts of image, sized to the image the first time the cmd buf uses it.  An image the
+//  device doesn't know gets an empty map, which is flagged when the cmd buf is submitted.
+static CB_IMAGE_LAYOUT_MAP &GetCBImageLayouts(const layer_data *my_data, GLOBAL_CB_NODE *pCB, VkImage image) {
+    auto cb_image_data = pCB->imageLayoutMap.find(image);
+    if (cb_image_data != pCB->imageLayoutMap.end())
+        return cb_image_data->second;
+    CB_IMAGE_LAYOUT_MAP &layouts = pCB->imageLayoutMap[image];
+    auto image_node = my_data->imageMap.find(image);
+    if (image_node != my_data->imageMap.end()) {
+        layouts.init(image_node->second.createInfo.mipLevels, image_node->second.createInfo.arrayLayers, unusedCBLayout);
+    } else {
+        layouts.init(0, 0, unusedCBLayout);
     }
-    node = imgsubIt->second;
-    return true;
+    return layouts;
 }
 
-bool FindLayout(const layer_data *my_data, ImageSubresourcePair imgpair, VkImageLayout &layout, const VkImageAspectFlags aspectMask) {
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = my_data->imageLayoutMap.find(imgpair);
-    if (imgsubIt == my_data->imageLayoutMap.end()) {
+// find layout(s) on the cmd buf level, over the aspects of sub the cmd buf has used
+static bool FindLayout(const layer_data *my_data, VkImage image, const CB_IMAGE_LAYOUT_MAP &layouts, const VkImageSubresource &sub,
+                       IMAGE_CMD_BUF_LAYOUT_NODE &node) {
+    node = unusedCBLayout;
+    if (!layouts.contains(sub.mipLevel, sub.arrayLayer))
         return false;
+    for (uint32_t aspect = 0; aspect < CB_IMAGE_LAYOUT_MAP::ASPECT_COUNT; ++aspect) {
+        if (!(sub.aspectMask & (1u << aspect)))
+            continue;
+        const IMAGE_CMD_BUF_LAYOUT_NODE &found = layouts.get(aspect, sub.mipLevel, sub.arrayLayer);
+        if (found.layout == VK_IMAGE_LAYOUT_MAX_ENUM)
+            continue;
+        if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != found.layout) {
+            log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
+                    reinterpret_cast<uint64_t &>(image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                    "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
+                    reinterpret_cast<uint64_t &>(image), sub.aspectMask, string_VkImageLayout(node.layout),
+                    string_VkImageLayout(found.layout));
+        }
+        if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != found.initialLayout) {
+            log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
+                    reinterpret_cast<uint64_t &>(image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                    "Cannot query for VkImage 0x%" PRIx64
+                    " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
+                    reinterpret_cast<uint64_t &>(image), sub.aspectMask, string_VkImageLayout(node.initialLayout),
+                    string_VkImageLayout(found.initialLayout));
+        }
+        node = found;
+    }
+    return node.layout != VK_IMAGE_LAYOUT_MAX_ENUM;
+}
+
+// Set the layout on the cmdbuf level, of sub or, if whole is set, of every subresource of sub's aspects
+static void SetLayout(CB_IMAGE_LAYOUT_MAP &layouts, const VkImageSubresource &sub, const IMAGE_CMD_BUF_LAYOUT_NODE &node,
+                      bool whole) {
+    if (!whole && !layouts.contains(sub.mipLevel, sub.arrayLayer))
+        return;
+    for (uint32_t aspect = 0; aspect < CB_IMAGE_LAYOUT_MAP::ASPECT_COUNT; ++aspect) {
+        if (!(sub.aspectMask & (1u << aspect)))
+            continue;
+        if (whole) {
+            layouts.setAll(aspect, node);
+        } else {
+            layouts.set(aspect, sub.mipLevel, sub.arrayLayer, node);
+        }
     }
-    if (layout != VK_IMAGE_LAYOUT_MAX_ENUM && layout != imgsubIt->second.layout) {
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
-                reinterpret_cast<uint64_t&>(imgpair.image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                reinterpret_cast<uint64_t&>(imgpair.image), oldAspectMask, string_VkImageLayout(layout), string_VkImageLayout(imgsubIt->second.layout));
-    }
-    layout = imgsubIt->second.layout;
-    return true;
 }
 
-// find layout(s) on the cmd buf level
-bool FindLayout(const GLOBAL_CB_NODE *pCB, VkImage image, VkImageSubresource range, IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    node = IMAGE_CMD_BUF_LAYOUT_NODE(VK_IMAGE_LAYOUT_MAX_ENUM, VK_IMAGE_LAYOUT_MAX_ENUM);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {image, false, VkImageSubresource()};
-        auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-        if (imgsubIt == pCB->imageLayoutMap.end())
-            return false;
-        node = imgsubIt->second;
+// As above, keeping the initial layout of aspects the cmd buf has already used
+static void SetLayout(CB_IMAGE_LAYOUT_MAP &layouts, const VkImageSubresource &sub, VkImageLayout layout, bool whole) {
+    if (!whole && !layouts.contains(sub.mipLevel, sub.arrayLayer))
+        return;
+    for (uint32_t aspect = 0; aspect < CB_IMAGE_LAYOUT_MAP::ASPECT_COUNT; ++aspect) {
+        if (!(sub.aspectMask & (1u << aspect)))
+            continue;
+        IMAGE_CMD_BUF_LAYOUT_NODE node = layouts.get(aspect, sub.mipLevel, sub.arrayLayer);
+        if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM)
+            node.initialLayout = layout;
+        node.layout = layout;
+        if (whole) {
+            layouts.setAll(aspect, node);
+        } else {
+            layouts.set(aspect, sub.mipLevel, sub.arrayLayer, node);
+        }
     }
-    return true;
 }
 
-// find layout(s) on the global level
-bool FindLayout(const layer_data *my_data, ImageSubresourcePair imgpair, VkImageLayout &layout) {
-    layout = VK_IMAGE_LAYOUT_MAX_ENUM;
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        auto imgsubIt = my_data->imageLayoutMap.find(imgpair);
-        if (imgsubIt == my_data->imageLayoutMap.end())
-            return false;
-        layout = imgsubIt->second.layout;
+// Call fn(sub, whole) for the subresources of range that layouts holds.  When range covers the image and each of
+//  its aspects is in one layout, fn is called once with whole set, since every subresource would get the same
+//  answer; otherwise it is called for each subresource in turn.
+template <typename Fn> static void ForEachSubresource(const CB_IMAGE_LAYOUT_MAP &layouts, const VkImageSubresourceRange &range, Fn fn) {
+    if (layouts.levels() && layouts.covers(range.baseMipLevel, range.levelCount, range.baseArrayLayer, range.layerCount) &&
+        layouts.isUniform(range.aspectMask)) {
+        VkImageSubresource sub = {range.aspectMask, 0, 0};
+        fn(sub, true);
+        return;
     }
-    return true;
+    // VK_REMAINING_MIP_LEVELS and VK_REMAINING_ARRAY_LAYERS end up clamped here too
+    const uint32_t levelEnd = static_cast<uint32_t>(std::min<uint64_t>(uint64_t(range.baseMipLevel) + range.levelCount, layouts.levels()));
+    const uint32_t layerEnd =
+        static_cast<uint32_t>(std::min<uint64_t>(uint64_t(range.baseArrayLayer) + range.layerCount, layouts.layers()));
+    for (uint32_t level = range.baseMipLevel; level < levelEnd; ++level) {
+        for (uint32_t layer = range.baseArrayLayer; layer < layerEnd; ++layer) {
+            VkImageSubresource sub = {range.aspectMask, level, layer};
+            fn(sub, false);
+        }
+    }
+}
+
+// Layout of one aspect of a subresource on the global level
+static VkImageLayout GetGlobalLayout(const IMAGE_NODE &image_node, uint32_t aspect, uint32_t level, uint32_t layer) {
+    VkImageLayout layout = image_node.layouts.get(aspect, level, layer);
+    return layout == VK_IMAGE_LAYOUT_MAX_ENUM ? image_node.createInfo.initialLayout : layout;
 }
 
-bool FindLayout(const layer_data *my_data, VkImage image, VkImageSubresource range, VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    return FindLayout(my_data, imgpair, layout);
+static void AddLayout(std::vector<VkImageLayout> &layouts, VkImageLayout layout) {
+    if (std::find(layouts.begin(), layouts.end(), layout) == layouts.end())
+        layouts.push_back(layout);
 }
 
+// Gather the layouts the subresources of image are in on the global level.  Aspects no submitted cmd buf has
+//  used are skipped, as is the initial layout once every subresource of the used aspects has moved on from it.
 bool FindLayouts(const layer_data *my_data, VkImage image, std::vector<VkImageLayout> &layouts) {
-    auto sub_data = my_data->imageSubresourceMap.find(image);
-    if (sub_data == my_data->imageSubresourceMap.end())
-        return false;
     auto imgIt = my_data->imageMap.find(image);
     if (imgIt == my_data->imageMap.end())
         return false;
-    bool ignoreGlobal = false;
-    // TODO: Make this robust for >1 aspect mask. Now it will just say ignore
-    // potential errors in this case.
-    if (sub_data->second.size() >= (imgIt->second.createInfo.arrayLayers * imgIt->second.createInfo.mipLevels + 1)) {
-        ignoreGlobal = true;
-    }
-    for (auto imgsubpair : sub_data->second) {
-        if (ignoreGlobal && !imgsubpair.hasSubresource)
+    const IMAGE_NODE &image_node = imgIt->second;
+    bool used = false;
+    bool initial = false;
+    for (uint32_t aspect = 0; aspect < SUBRESOURCE_LAYOUT_MAP<VkImageLayout>::ASPECT_COUNT; ++aspect) {
+        if (image_node.layouts.isUniform(1u << aspect)) {
+            VkImageLayout layout = image_node.layouts.uniformValue(aspect);
+            if (layout != VK_IMAGE_LAYOUT_MAX_ENUM) {
+                used = true;
+                AddLayout(layouts, layout);
+            }
             continue;
-        auto img_data = my_data->imageLayoutMap.find(imgsubpair);
-        if (img_data != my_data->imageLayoutMap.end()) {
-            layouts.push_back(img_data->second.layout);
         }
-    }
-    return true;
-}
-
-// Set the layout on the global level
-void SetLayout(layer_data *my_data, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    VkImage &image = imgpair.image;
-    // TODO (mlentine): Maybe set format if new? Not used atm.
-    my_data->imageLayoutMap[imgpair].layout = layout;
-    // TODO (mlentine): Maybe make vector a set?
-    auto subresource = std::find(my_data->imageSubresourceMap[image].begin(), my_data->imageSubresourceMap[image].end(), imgpair);
-    if (subresource == my_data->imageSubresourceMap[image].end()) {
-        my_data->imageSubresourceMap[image].push_back(imgpair);
-    }
-}
-
-// Set the layout on the cmdbuf level
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    pCB->imageLayoutMap[imgpair] = node;
-    // TODO (mlentine): Maybe make vector a set?
-    auto subresource =
-        std::find(pCB->imageSubresourceMap[imgpair.image].begin(), pCB->imageSubresourceMap[imgpair.image].end(), imgpair);
-    if (subresource == pCB->imageSubresourceMap[imgpair.image].end()) {
-        pCB->imageSubresourceMap[imgpair.image].push_back(imgpair);
-    }
-}
-
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    // TODO (mlentine): Maybe make vector a set?
-    if (std::find(pCB->imageSubresourceMap[imgpair.image].begin(), pCB->imageSubresourceMap[imgpair.image].end(), imgpair) !=
-        pCB->imageSubresourceMap[imgpair.image].end()) {
-        pCB->imageLayoutMap[imgpair].layout = layout;
-    } else {
-        // TODO (mlentine): Could be expensive and might need to be removed.
-        assert(imgpair.hasSubresource);
-        IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindLayout(pCB, imgpair.image, imgpair.subresource, node)) {
-            node.initialLayout = layout;
+        used = true;
+        for (uint32_t level = 0; level < image_node.layouts.levels(); ++level) {
+            for (uint32_t layer = 0; layer < image_node.layouts.layers(); ++layer) {
+                VkImageLayout layout = image_node.layouts.get(aspect, level, layer);
+                if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
+                    initial = true;
+                } else {
+                    AddLayout(layouts, layout);
+                }
+            }
         }
-        SetLayout(pCB, imgpair, {node.initialLayout, layout});
-    }
-}
-
-template <class OBJECT, class LAYOUT>
-void SetLayout(OBJECT *pObject, ImageSubresourcePair imgpair, const LAYOUT &layout, VkImageAspectFlags aspectMask) {
-    if (imgpair.subresource.aspectMask & aspectMask) {
-        imgpair.subresource.aspectMask = aspectMask;
-        SetLayout(pObject, imgpair, layout);
     }
-}
-
-template <class OBJECT, class LAYOUT>
-void SetLayout(OBJECT *pObject, VkImage image, VkImageSubresource range, const LAYOUT &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-}
-
-template <class OBJECT, class LAYOUT> void SetLayout(OBJECT *pObject, VkImage image, const LAYOUT &layout) {
-    ImageSubresourcePair imgpair = {image, false, VkImageSubresource()};
-    SetLayout(pObject, image, imgpair, layout);
+    if (initial || !used)
+        AddLayout(layouts, image_node.createInfo.initialLayout);
+    return true;
 }
 
 void SetLayout(const layer_data *dev_data, GLOBAL_CB_NODE *pCB, VkImageView imageView, const VkImageLayout &layout) {
     auto image_view_data = dev_data->imageViewMap.find(imageView);
     assert(image_view_data != dev_data->imageViewMap.end());
-    const VkImage &image = image_view_data->second.image;
-    const VkImageSubresourceRange &subRange = image_view_data->second.subresourceRange;
-    // TODO: Do not iterate over every possibility - consolidate where possible
-    for (uint32_t j = 0; j < subRange.levelCount; j++) {
-        uint32_t level = subRange.baseMipLevel + j;
-        for (uint32_t k = 0; k < subRange.layerCount; k++) {
-            uint32_t layer = subRange.baseArrayLayer + k;
-            VkImageSubresource sub = {subRange.aspectMask, level, layer};
-            SetLayout(pCB, image, sub, layout);
-        }
-    }
+    CB_IMAGE_LAYOUT_MAP &layouts = GetCBImageLayouts(dev_data, pCB, image_view_data->second.image);
+    ForEachSubresource(layouts, image_view_data->second.subresourceRange,
+                       [&](const VkImageSubresource &sub, bool whole) { SetLayout(layouts, sub, layout, whole); });
 }
 
 // Verify that given imageView is valid
@@ -3799,6 +4269,7 @@ static void invalidateBoundCmdBuffers(layer_data *dev_data, const SET_NODE *pSet
 // update DS mappings based on write and copy update arrays
 static bool dsUpdate(layer_data *my_data, VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet *pWDS,
                      uint32_t descriptorCopyCount, const VkCopyDescriptorSet *pCDS) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     // Validate Write updates
     uint32_t i = 0;
@@ -4099,6 +4570,8 @@ static void clearDescriptorPool(layer_data *my_data, const VkDevice device, cons
         while (pSet) {
             clearDescriptorSet(my_data, pSet->set);
             my_data->setMap.erase(pSet->set);
+            my_data->stateNodeGeneration++;
+            my_data->drawStateGeneration++;
             pFreeSet = pSet;
             pSet = pSet->pNext;
             delete pFreeSet;
@@ -4114,25 +4587,29 @@ static void clearDescriptorPool(layer_data *my_data, const VkDevice device, cons
 
 // For given CB object, fetch associated CB Node from map
 static GLOBAL_CB_NODE *getCBNode(layer_data *my_data, const VkCommandBuffer cb) {
-    if (my_data->commandBufferMap.count(cb) == 0) {
+    auto it = my_data->commandBufferMap.find(cb);
+    if (it == my_data->commandBufferMap.end()) {
         log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                 reinterpret_cast<const uint64_t &>(cb), __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER, "DS",
                 "Attempt to use CommandBuffer %#" PRIxLEAST64 " that doesn't exist!", (uint64_t)(cb));
         return NULL;
     }
-    return my_data->commandBufferMap[cb];
+    return it->second;
 }
 
-// Free all CB Nodes
+// Free all CB Nodes, including those kept for reuse by command pools
 // NOTE : Calls to this function should be wrapped in mutex
 static void deleteCommandBuffers(layer_data *my_data) {
-    if (my_data->commandBufferMap.empty()) {
-        return;
-    }
     for (auto ii = my_data->commandBufferMap.begin(); ii != my_data->commandBufferMap.end(); ++ii) {
         delete (*ii).second;
     }
     my_data->commandBufferMap.clear();
+    for (auto &pool : my_data->commandPoolMap) {
+        for (auto node : pool.second.freeNodes) {
+            delete node;
+        }
+    }
+    my_data->commandPoolMap.clear();
 }
 
 static bool report_error_no_cb_begin(const layer_data *dev_data, const VkCommandBuffer cb, const char *caller_name) {
@@ -4202,7 +4679,7 @@ static bool addCmd(const layer_data *my_data, GLOBAL_CB_NODE *pCB, const CMD_TYP
         case CMD_RESETQUERYPOOL:
         case CMD_COPYQUERYPOOLRESULTS:
         case CMD_WRITETIMESTAMP:
-            skipCall |= checkGraphicsOrComputeBit(my_data, flags, cmdTypeToString(cmd).c_str());
+            skipCall |= checkGraphicsOrComputeBit(my_data, flags, cmdTypeToString(cmd));
             break;
         case CMD_SETVIEWPORTSTATE:
         case CMD_SETSCISSORSTATE:
@@ -4226,11 +4703,11 @@ static bool addCmd(const layer_data *my_data, GLOBAL_CB_NODE *pCB, const CMD_TYP
         case CMD_BEGINRENDERPASS:
         case CMD_NEXTSUBPASS:
         case CMD_ENDRENDERPASS:
-            skipCall |= checkGraphicsBit(my_data, flags, cmdTypeToString(cmd).c_str());
+            skipCall |= checkGraphicsBit(my_data, flags, cmdTypeToString(cmd));
             break;
         case CMD_DISPATCH:
         case CMD_DISPATCHINDIRECT:
-            skipCall |= checkComputeBit(my_data, flags, cmdTypeToString(cmd).c_str());
+            skipCall |= checkComputeBit(my_data, flags, cmdTypeToString(cmd));
             break;
         case CMD_COPYBUFFER:
         case CMD_COPYIMAGE:
@@ -4258,13 +4735,12 @@ static bool addCmd(const layer_data *my_data, GLOBAL_CB_NODE *pCB, const CMD_TYP
 }
 // Reset the command buffer state
 //  Maintain the createInfo and set state to CB_NEW, but clear all other state
-static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
-    GLOBAL_CB_NODE *pCB = dev_data->commandBufferMap[cb];
+// Containers are cleared rather than replaced so they keep their capacity for the next recording
+static void resetCB(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
     if (pCB) {
         pCB->in_use.store(0);
         pCB->cmds.clear();
-        // Reset CB state (note that createInfo is not cleared)
-        pCB->commandBuffer = cb;
+        // Reset CB state (note that createInfo and commandBuffer are not cleared)
         memset(&pCB->beginInfo, 0, sizeof(VkCommandBufferBeginInfo));
         memset(&pCB->inheritanceInfo, 0, sizeof(VkCommandBufferInheritanceInfo));
         pCB->numCmds = 0;
@@ -4302,11 +4778,12 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
         pCB->queryToStateMap.clear();
         pCB->activeQueries.clear();
         pCB->startedQueries.clear();
-        pCB->imageSubresourceMap.clear();
         pCB->imageLayoutMap.clear();
         pCB->eventToStageMap.clear();
         pCB->drawData.clear();
         pCB->currentDrawData.buffers.clear();
+        pCB->inFlightResources.clear();
+        pCB->inFlightResourceGeneration = 0;
         pCB->primaryCommandBuffer = VK_NULL_HANDLE;
         // Make sure any secondaryCommandBuffers are removed from globalInFlight
         for (auto secondary_cb : pCB->secondaryCommandBuffers) {
@@ -4329,6 +4806,13 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
 
     }
 }
+// Overloaded call to above function when GLOBAL_CB_NODE has not already been looked-up
+static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
+    auto it = dev_data->commandBufferMap.find(cb);
+    if (it != dev_data->commandBufferMap.end()) {
+        resetCB(dev_data, it->second);
+    }
+}
 
 // Set PSO-related status bits for CB, including dynamic state set via PSO
 static void set_cb_pso_status(GLOBAL_CB_NODE *pCB, const PIPELINE_NODE *pPipe) {
@@ -4407,7 +4891,7 @@ static void printCB(layer_data *my_data, const VkCommandBuffer cb) {
         for (auto ii = cmds.begin(); ii != cmds.end(); ++ii) {
             // TODO : Need to pass cb as srcObj here
             log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
-                    __LINE__, DRAWSTATE_NONE, "DS", "  CMD#%" PRIu64 ": %s", (*ii).cmdNumber, cmdTypeToString((*ii).type).c_str());
+                    __LINE__, DRAWSTATE_NONE, "DS", "  CMD#%" PRIu64 ": %s", (*ii).cmdNumber, cmdTypeToString((*ii).type));
         }
     } else {
         // Nothing to print
@@ -4415,6 +4899,7 @@ static void printCB(layer_data *my_data, const VkCommandBuffer cb) {
 }
 
 static bool synchAndPrintDSConfig(layer_data *my_data, const VkCommandBuffer cb) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     if (!(my_data->report_data->active_flags & VK_DEBUG_REPORT_INFORMATION_BIT_EXT)) {
         return skipCall;
@@ -4450,14 +4935,50 @@ static bool outsideRenderPass(const layer_data *my_data, GLOBAL_CB_NODE *pCB, co
     return outside;
 }
 
+// Worker threads validating batched pipelines, set by lunarg_core_validation.pipeline_validation_threads; negative
+//  means one fewer than the hardware threads
+static int pipelineValidationThreads = -1;
+
 static void init_core_validation(layer_data *instance_data, const VkAllocationCallbacks *pAllocator) {
 
     layer_debug_actions(instance_data->report_data, instance_data->logging_callback, pAllocator, "lunarg_core_validation");
 
+#if MTMERGESOURCE
+    const char *guard = getLayerOption("lunarg_core_validation.noncoherent_memory_guard");
+    if (guard && !strcmp(guard, "pages")) {
+        noncoherentMemoryGuard = NONCOHERENT_MEMORY_GUARD_PAGES;
+    }
+#endif
+
+    const char *report = getLayerOption("lunarg_core_validation.profile_report");
+    if (report && *report) {
+        std::lock_guard<std::mutex> lock(profile_report_lock);
+        if (!validation_profiler.enabled()) {
+            profile_report_file = report;
+            global_lock.set_wait_counters(validation_profiler.counter("global_lock exclusive wait"),
+                                          validation_profiler.counter("global_lock shared wait"));
+            validation_profiler.enable();
+        }
+    }
+
+    const char *threads = getLayerOption("lunarg_core_validation.pipeline_validation_threads");
+    if (threads && *threads) {
+        pipelineValidationThreads = atoi(threads);
+    }
+
+    const char *cache_file = getLayerOption("lunarg_core_validation.shader_cache_file");
+    std::lock_guard<std::mutex> lock(shader_cache_lock);
+    if (!shader_cache_loaded && cache_file && *cache_file) {
+        shader_cache_file = cache_file;
+        loadShaderCache();
+        shader_cache_loaded = true;
+    }
+
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkInstance *pInstance) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     VkLayerInstanceCreateInfo *chain_info = get_chain_info(pCreateInfo, VK_LAYER_LINK_INFO);
 
     assert(chain_info->u.pLayerInfo);
@@ -4490,6 +5011,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCall
 
 /* hook DestroyInstance to remove tableInstanceMap entry */
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     // TODOSC : Shouldn't need any customization here
     dispatch_key key = get_dispatch_key(instance);
     // TBD: Need any locking this early, in case this function is called at the
@@ -4498,7 +5020,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyInstance(instance, pAllocator);
 
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     // Clean up logging callback, if any
     while (my_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = my_data->logging_callback.back();
@@ -4534,6 +5056,7 @@ static void createDeviceRegisterExtensions(const VkDeviceCreateInfo *pCreateInfo
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice gpu, const VkDeviceCreateInfo *pCreateInfo,
                                                               const VkAllocationCallbacks *pAllocator, VkDevice *pDevice) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     VkLayerDeviceCreateInfo *chain_info = get_chain_info(pCreateInfo, VK_LAYER_LINK_INFO);
 
     assert(chain_info->u.pLayerInfo);
@@ -4552,7 +5075,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice g
         return result;
     }
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     layer_data *my_instance_data = get_my_data_ptr(get_dispatch_key(gpu), layer_data_map);
     layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(*pDevice), layer_data_map);
 
@@ -4578,6 +5101,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice g
     }
     // Store physical device mem limits into device layer_data struct
     my_instance_data->instance_dispatch_table->GetPhysicalDeviceMemoryProperties(gpu, &my_device_data->phys_dev_mem_props);
+    // By default leave one hardware thread for the app; the workers only start once a batch of pipelines needs them
+    uint32_t workers = static_cast<uint32_t>(pipelineValidationThreads);
+    if (pipelineValidationThreads < 0) {
+        uint32_t hardware_threads = std::thread::hardware_concurrency();
+        workers = hardware_threads > 1 ? hardware_threads - 1 : 0;
+    }
+    my_device_data->pipeline_validation_pool.reset(new task_pool(workers));
     lock.unlock();
 
     ValidateLayerOrdering(*pCreateInfo);
@@ -4588,11 +5118,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice g
 // prototype
 static void deleteRenderPasses(layer_data *);
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     // TODOSC : Shouldn't need any customization here
     dispatch_key key = get_dispatch_key(device);
     layer_data *dev_data = get_my_data_ptr(key, layer_data_map);
     // Free all the memory
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     deletePipelines(dev_data);
     deleteRenderPasses(dev_data);
     deleteCommandBuffers(dev_data);
@@ -4603,8 +5134,6 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, cons
     dev_data->descriptorSetLayoutMap.clear();
     dev_data->imageViewMap.clear();
     dev_data->imageMap.clear();
-    dev_data->imageSubresourceMap.clear();
-    dev_data->imageLayoutMap.clear();
     dev_data->bufferViewMap.clear();
     dev_data->bufferMap.clear();
     // Queues persist until device is destroyed
@@ -4635,7 +5164,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, cons
             }
         }
     }
-    layer_debug_report_destroy_device(device);
+    layer_debug_report_destroy_device(dev_data->report_data, device);
     lock.unlock();
 
 #if DISPATCH_MAP_DEBUG
@@ -4650,6 +5179,16 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, cons
 #endif
     delete dev_data->device_dispatch_table;
     layer_data_map.erase(key);
+
+    if (validation_profiler.enabled()) {
+        std::lock_guard<std::mutex> report_lock(profile_report_lock);
+        validation_profiler.write_report("core_validation", profile_report_file);
+    }
+
+    std::lock_guard<std::mutex> cache_lock(shader_cache_lock);
+    if (shader_cache_dirty && !shader_cache_file.empty()) {
+        saveShaderCache();
+    }
 }
 
 static const VkExtensionProperties instance_extensions[] = {{VK_EXT_DEBUG_REPORT_EXTENSION_NAME, VK_EXT_DEBUG_REPORT_SPEC_VERSION}};
@@ -4687,61 +5226,105 @@ vkEnumerateDeviceLayerProperties(VkPhysicalDevice physicalDevice, uint32_t *pCou
     return util_GetLayerProperties(ARRAY_SIZE(cv_device_layers), cv_device_layers, pCount, pProperties);
 }
 
+static bool ValidateSubmittedImageLayout(const layer_data *dev_data, VkCommandBuffer cmdBuffer, VkImage image,
+                                         const VkImageSubresource *sub, VkImageLayout imageLayout, VkImageLayout initialLayout) {
+    if (initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        // TODO: Set memory invalid which is in mem_tracker currently
+        return false;
+    }
+    if (imageLayout == initialLayout)
+        return false;
+    if (sub) {
+        return log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                       reinterpret_cast<uint64_t &>(cmdBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                       "Cannot submit cmd buffer using image (%" PRIx64 ") [sub-resource: array layer %u, mip level %u], "
+                       "with layout %s when first use is %s.",
+                       reinterpret_cast<uint64_t &>(image), sub->arrayLayer, sub->mipLevel, string_VkImageLayout(imageLayout),
+                       string_VkImageLayout(initialLayout));
+    }
+    return log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                   reinterpret_cast<uint64_t &>(cmdBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                   "Cannot submit cmd buffer using image (%" PRIx64 ") with layout %s when "
+                   "first use is %s.",
+                   reinterpret_cast<uint64_t &>(image), string_VkImageLayout(imageLayout), string_VkImageLayout(initialLayout));
+}
+
 // This validates that the initial layout specified in the command buffer for
 // the IMAGE is the same
 // as the global IMAGE layout
 static bool ValidateCmdBufImageLayouts(VkCommandBuffer cmdBuffer) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-        if (!FindLayout(dev_data, cb_image_data.first, imageLayout)) {
+    for (auto &cb_image_data : pCB->imageLayoutMap) {
+        VkImage image = cb_image_data.first;
+        const CB_IMAGE_LAYOUT_MAP &cb_layouts = cb_image_data.second;
+        auto image_node_it = dev_data->imageMap.find(image);
+        if (image_node_it == dev_data->imageMap.end()) {
             skip_call |=
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
                         __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "Cannot submit cmd buffer using deleted image %" PRIu64 ".",
-                        reinterpret_cast<const uint64_t &>(cb_image_data.first));
-        } else {
-            if (cb_image_data.second.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-                // TODO: Set memory invalid which is in mem_tracker currently
-            } else if (imageLayout != cb_image_data.second.initialLayout) {
-                if (cb_image_data.first.hasSubresource) {
-                    skip_call |= log_msg(
-                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                        reinterpret_cast<uint64_t &>(cmdBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                        "Cannot submit cmd buffer using image (%" PRIx64 ") [sub-resource: array layer %u, mip level %u], "
-                        "with layout %s when first use is %s.",
-                        reinterpret_cast<const uint64_t &>(cb_image_data.first.image), cb_image_data.first.subresource.arrayLayer,
-                        cb_image_data.first.subresource.mipLevel, string_VkImageLayout(imageLayout),
-                        string_VkImageLayout(cb_image_data.second.initialLayout));
-                } else {
-                    skip_call |= log_msg(
-                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                        reinterpret_cast<uint64_t &>(cmdBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                        "Cannot submit cmd buffer using image (%" PRIx64 ") with layout %s when "
-                        "first use is %s.",
-                        reinterpret_cast<const uint64_t &>(cb_image_data.first.image), string_VkImageLayout(imageLayout),
-                        string_VkImageLayout(cb_image_data.second.initialLayout));
+                        reinterpret_cast<uint64_t &>(image));
+            continue;
+        }
+        IMAGE_NODE &image_node = image_node_it->second;
+        const bool sameShape =
+            cb_layouts.levels() == image_node.layouts.levels() && cb_layouts.layers() == image_node.layouts.layers();
+        for (uint32_t aspect = 0; aspect < CB_IMAGE_LAYOUT_MAP::ASPECT_COUNT; ++aspect) {
+            const VkImageAspectFlags aspectMask = 1u << aspect;
+            // An aspect the cmd buf moved as a whole from an image layout the whole aspect is in takes one check
+            if (cb_layouts.isUniform(aspectMask)) {
+                const IMAGE_CMD_BUF_LAYOUT_NODE &node = cb_layouts.uniformValue(aspect);
+                if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM)
+                    continue;
+                if (sameShape && image_node.layouts.isUniform(aspectMask)) {
+                    skip_call |= ValidateSubmittedImageLayout(dev_data, cmdBuffer, image, nullptr,
+                                                              GetGlobalLayout(image_node, aspect, 0, 0), node.initialLayout);
+                    image_node.layouts.setAll(aspect, node.layout);
+                    continue;
+                }
+            }
+            // A cmd buf that moved the whole aspect leaves it in one layout again, so later submits take the single check
+            const bool wholeAspect = sameShape && cb_layouts.isUniform(aspectMask);
+            for (uint32_t level = 0; level < cb_layouts.levels(); ++level) {
+                for (uint32_t layer = 0; layer < cb_layouts.layers(); ++layer) {
+                    const IMAGE_CMD_BUF_LAYOUT_NODE &node = cb_layouts.get(aspect, level, layer);
+                    if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM || !image_node.layouts.contains(level, layer))
+                        continue;
+                    VkImageSubresource sub = {aspectMask, level, layer};
+                    skip_call |= ValidateSubmittedImageLayout(dev_data, cmdBuffer, image, &sub,
+                                                              GetGlobalLayout(image_node, aspect, level, layer), node.initialLayout);
+                    if (!wholeAspect)
+                        image_node.layouts.set(aspect, level, layer, node.layout);
                 }
             }
-            SetLayout(dev_data, cb_image_data.first, cb_image_data.second.layout);
+            if (wholeAspect)
+                image_node.layouts.setAll(aspect, cb_layouts.uniformValue(aspect).layout);
         }
     }
     return skip_call;
 }
 
-// Track which resources are in-flight by atomically incrementing their "in_use" count
-static bool validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB) {
+// Gather the buffer, descriptor set and event nodes pCB's commands reference into pCB->inFlightResources,
+//  each once.  If any of them no longer exists the list is left stale so the next submit gathers it again,
+//  and when report is set that submit is flagged.
+static bool gatherInFlightResources(layer_data *my_data, GLOBAL_CB_NODE *pCB, bool report) {
     bool skip_call = false;
+    bool complete = true;
+    pCB->inFlightResources.clear();
     for (auto drawDataElement : pCB->drawData) {
         for (auto buffer : drawDataElement.buffers) {
             auto buffer_data = my_data->bufferMap.find(buffer);
             if (buffer_data == my_data->bufferMap.end()) {
-                skip_call |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT,
-                                     (uint64_t)(buffer), __LINE__, DRAWSTATE_INVALID_BUFFER, "DS",
-                                     "Cannot submit cmd buffer using deleted buffer %" PRIu64 ".", (uint64_t)(buffer));
+                complete = false;
+                if (report) {
+                    skip_call |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT,
+                                         (uint64_t)(buffer), __LINE__, DRAWSTATE_INVALID_BUFFER, "DS",
+                                         "Cannot submit cmd buffer using deleted buffer %" PRIu64 ".", (uint64_t)(buffer));
+                }
             } else {
-                buffer_data->second.in_use.fetch_add(1);
+                pCB->inFlightResources.push_back(&buffer_data->second);
             }
         }
     }
@@ -4749,15 +5332,49 @@ static bool validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *p
         for (auto set : pCB->lastBound[i].uniqueBoundSets) {
             auto setNode = my_data->setMap.find(set);
             if (setNode == my_data->setMap.end()) {
+                complete = false;
+                if (report) {
+                    skip_call |=
+                        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                                (uint64_t)(set), __LINE__, DRAWSTATE_INVALID_DESCRIPTOR_SET, "DS",
+                                "Cannot submit cmd buffer using deleted descriptor set %" PRIu64 ".", (uint64_t)(set));
+                }
+            } else {
+                pCB->inFlightResources.push_back(setNode->second);
+            }
+        }
+    }
+    for (auto event : pCB->events) {
+        auto eventNode = my_data->eventMap.find(event);
+        if (eventNode == my_data->eventMap.end()) {
+            complete = false;
+            if (report) {
                 skip_call |=
                     log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
-                            (uint64_t)(set), __LINE__, DRAWSTATE_INVALID_DESCRIPTOR_SET, "DS",
-                            "Cannot submit cmd buffer using deleted descriptor set %" PRIu64 ".", (uint64_t)(set));
-            } else {
-                setNode->second->in_use.fetch_add(1);
+                            reinterpret_cast<uint64_t &>(event), __LINE__, DRAWSTATE_INVALID_EVENT, "DS",
+                            "Cannot submit cmd buffer using deleted event %" PRIu64 ".", reinterpret_cast<uint64_t &>(event));
             }
+        } else {
+            pCB->inFlightResources.push_back(&eventNode->second);
         }
     }
+    std::sort(pCB->inFlightResources.begin(), pCB->inFlightResources.end());
+    pCB->inFlightResources.erase(std::unique(pCB->inFlightResources.begin(), pCB->inFlightResources.end()),
+                                 pCB->inFlightResources.end());
+    pCB->inFlightResourceGeneration = complete ? my_data->stateNodeGeneration : 0;
+    return skip_call;
+}
+
+// Track which resources are in-flight by atomically incrementing their "in_use" count
+static bool validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
+    bool skip_call = false;
+    if (pCB->inFlightResourceGeneration != my_data->stateNodeGeneration) {
+        skip_call |= gatherInFlightResources(my_data, pCB, true);
+    }
+    for (auto node : pCB->inFlightResources) {
+        node->in_use.fetch_add(1);
+    }
     for (auto semaphore : pCB->semaphores) {
         auto semaphoreNode = my_data->semaphoreMap.find(semaphore);
         if (semaphoreNode == my_data->semaphoreMap.end()) {
@@ -4769,17 +5386,6 @@ static bool validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *p
             semaphoreNode->second.in_use.fetch_add(1);
         }
     }
-    for (auto event : pCB->events) {
-        auto eventNode = my_data->eventMap.find(event);
-        if (eventNode == my_data->eventMap.end()) {
-            skip_call |=
-                log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
-                        reinterpret_cast<uint64_t &>(event), __LINE__, DRAWSTATE_INVALID_EVENT, "DS",
-                        "Cannot submit cmd buffer using deleted event %" PRIu64 ".", reinterpret_cast<uint64_t &>(event));
-        } else {
-            eventNode->second.in_use.fetch_add(1);
-        }
-    }
     return skip_call;
 }
 
@@ -4815,21 +5421,12 @@ static inline void removeInFlightCmdBuffer(layer_data *dev_data, VkCommandBuffer
 
 static void decrementResources(layer_data *my_data, VkCommandBuffer cmdBuffer) {
     GLOBAL_CB_NODE *pCB = getCBNode(my_data, cmdBuffer);
-    for (auto drawDataElement : pCB->drawData) {
-        for (auto buffer : drawDataElement.buffers) {
-            auto buffer_data = my_data->bufferMap.find(buffer);
-            if (buffer_data != my_data->bufferMap.end()) {
-                buffer_data->second.in_use.fetch_sub(1);
-            }
-        }
+    // Drop any nodes freed while pCB was in flight before touching the rest
+    if (pCB->inFlightResourceGeneration != my_data->stateNodeGeneration) {
+        gatherInFlightResources(my_data, pCB, false);
     }
-    for (uint32_t i = 0; i < VK_PIPELINE_BIND_POINT_RANGE_SIZE; ++i) {
-        for (auto set : pCB->lastBound[i].uniqueBoundSets) {
-            auto setNode = my_data->setMap.find(set);
-            if (setNode != my_data->setMap.end()) {
-                setNode->second->in_use.fetch_sub(1);
-            }
-        }
+    for (auto node : pCB->inFlightResources) {
+        node->in_use.fetch_sub(1);
     }
     for (auto semaphore : pCB->semaphores) {
         auto semaphoreNode = my_data->semaphoreMap.find(semaphore);
@@ -4837,12 +5434,6 @@ static void decrementResources(layer_data *my_data, VkCommandBuffer cmdBuffer) {
             semaphoreNode->second.in_use.fetch_sub(1);
         }
     }
-    for (auto event : pCB->events) {
-        auto eventNode = my_data->eventMap.find(event);
-        if (eventNode != my_data->eventMap.end()) {
-            eventNode->second.in_use.fetch_sub(1);
-        }
-    }
     for (auto queryStatePair : pCB->queryToStateMap) {
         my_data->queryToStateMap[queryStatePair.first] = queryStatePair.second;
     }
@@ -4850,61 +5441,82 @@ static void decrementResources(layer_data *my_data, VkCommandBuffer cmdBuffer) {
         my_data->eventMap[eventStagePair.first].stageMask = eventStagePair.second;
     }
 }
-// For fenceCount fences in pFences, mark fence signaled, decrement in_use, and call
-//  decrementResources for all priorFences and cmdBuffers associated with fence.
-static bool decrementResources(layer_data *my_data, uint32_t fenceCount, const VkFence *pFences) {
+// Command buffers are tracked by the queue submission they went in with.  Every submission to a
+//  queue takes the next sequence number, and a fence or semaphore remembers the queue and number
+//  of the submission that signals it, so waiting on a fence retires that queue up to its number.
+//
+// Retire the submissions on pQueue up to and including number seq: release what their command
+//  buffers hold and signal their fences.  Work a retired submission waited on through a semaphore
+//  has completed as well, so the signaling queues are retired up to that point afterwards.  The cost
+//  is proportional to the number of submissions retired, not to the history of the queue.
+static bool retireWorkOnQueue(layer_data *my_data, QUEUE_NODE *pQueue, uint64_t seq) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
-    std::vector<VkFence> fences;
-    for (uint32_t i = 0; i < fenceCount; ++i) {
-        auto fence_data = my_data->fenceMap.find(pFences[i]);
-        if (fence_data == my_data->fenceMap.end() || !fence_data->second.needsSignaled)
-            return skip_call;
-        fence_data->second.needsSignaled = false;
-        if (fence_data->second.in_use.load()) {
-            fences.push_back(pFences[i]);
-            fence_data->second.in_use.fetch_sub(1);
-        }
-        decrementResources(my_data, static_cast<uint32_t>(fence_data->second.priorFences.size()),
-                           fence_data->second.priorFences.data());
-        for (auto cmdBuffer : fence_data->second.cmdBuffers) {
+    unordered_map<VkQueue, uint64_t> otherQueueSeqs;
+    while (pQueue->seq < seq && !pQueue->submissions.empty()) {
+        CB_SUBMISSION &submission = pQueue->submissions.front();
+        for (auto &wait : submission.waitSemaphores) {
+            uint64_t &other_seq = otherQueueSeqs[wait.queue];
+            other_seq = std::max(other_seq, wait.seq);
+        }
+        for (auto cmdBuffer : submission.cbs) {
             decrementResources(my_data, cmdBuffer);
             skip_call |= cleanInFlightCmdBuffer(my_data, cmdBuffer);
             removeInFlightCmdBuffer(my_data, cmdBuffer);
         }
-    }
-    for (auto fence : fences) {
-        for (auto queue_data : my_data->queueMap) {
-            auto last_fence_data = std::find(queue_data.second.lastFences.begin(), queue_data.second.lastFences.end(), fence);
-            if (last_fence_data != queue_data.second.lastFences.end()) {
-                queue_data.second.lastFences.erase(last_fence_data);
-                break;
+        pQueue->seq++;
+        if (submission.fence != VK_NULL_HANDLE) {
+            auto fence_data = my_data->fenceMap.find(submission.fence);
+            if (fence_data != my_data->fenceMap.end() && fence_data->second.seq == pQueue->seq &&
+                fence_data->second.needsSignaled) {
+                fence_data->second.needsSignaled = false;
+                if (fence_data->second.in_use.load()) {
+                    fence_data->second.in_use.fetch_sub(1);
+                }
             }
         }
+        pQueue->submissions.pop_front();
+    }
+    for (auto &other : otherQueueSeqs) {
+        auto other_queue_data = my_data->queueMap.find(other.first);
+        if (other_queue_data != my_data->queueMap.end()) {
+            skip_call |= retireWorkOnQueue(my_data, &other_queue_data->second, other.second);
+        }
+    }
+    return skip_call;
+}
+
+// For fenceCount fences in pFences, retire the work up to the submission that signals each fence.
+//  Fences from vkAcquireNextImageKHR have no queue work behind them and are simply marked signaled.
+static bool retireFences(layer_data *my_data, uint32_t fenceCount, const VkFence *pFences) {
+    bool skip_call = false;
+    for (uint32_t i = 0; i < fenceCount; ++i) {
+        auto fence_data = my_data->fenceMap.find(pFences[i]);
+        if (fence_data == my_data->fenceMap.end() || !fence_data->second.needsSignaled)
+            continue;
+        auto queue_data = my_data->queueMap.find(fence_data->second.queue);
+        if (queue_data != my_data->queueMap.end()) {
+            skip_call |= retireWorkOnQueue(my_data, &queue_data->second, fence_data->second.seq);
+        }
+        fence_data->second.needsSignaled = false;
     }
     return skip_call;
 }
-// Decrement in_use for all outstanding cmd buffers that were submitted on this queue
-static bool decrementResources(layer_data *my_data, VkQueue queue) {
+
+// Retire all outstanding work submitted on this queue
+static bool retireQueue(layer_data *my_data, VkQueue queue) {
     bool skip_call = false;
     auto queue_data = my_data->queueMap.find(queue);
     if (queue_data != my_data->queueMap.end()) {
-        for (auto cmdBuffer : queue_data->second.untrackedCmdBuffers) {
-            decrementResources(my_data, cmdBuffer);
-            skip_call |= cleanInFlightCmdBuffer(my_data, cmdBuffer);
-            removeInFlightCmdBuffer(my_data, cmdBuffer);
-        }
-        queue_data->second.untrackedCmdBuffers.clear();
-        skip_call |= decrementResources(my_data, static_cast<uint32_t>(queue_data->second.lastFences.size()),
-                                        queue_data->second.lastFences.data());
+        QUEUE_NODE *pQueue = &queue_data->second;
+        skip_call |= retireWorkOnQueue(my_data, pQueue, pQueue->seq + pQueue->submissions.size());
     }
     return skip_call;
 }
 
-// This function merges command buffer tracking between queues when there is a semaphore dependency
-// between them (see below for details as to how tracking works). When this happens, the prior
-// fences from the signaling queue are merged into the wait queue as well as any untracked command
-// buffers.
-static void updateTrackedCommandBuffers(layer_data *dev_data, VkQueue queue, VkQueue other_queue, VkFence fence) {
+// When a queue waits on a semaphore signaled by another queue, the event stages the other queue
+//  has set become visible to this one.
+static void mergeQueueEventStages(layer_data *dev_data, VkQueue queue, VkQueue other_queue) {
     if (queue == other_queue) {
         return;
     }
@@ -4913,82 +5525,25 @@ static void updateTrackedCommandBuffers(layer_data *dev_data, VkQueue queue, VkQ
     if (queue_data == dev_data->queueMap.end() || other_queue_data == dev_data->queueMap.end()) {
         return;
     }
-    for (auto fenceInner : other_queue_data->second.lastFences) {
-        queue_data->second.lastFences.push_back(fenceInner);
-    }
-    if (fence != VK_NULL_HANDLE) {
-        auto fence_data = dev_data->fenceMap.find(fence);
-        if (fence_data == dev_data->fenceMap.end()) {
-            return;
-        }
-        for (auto cmdbuffer : other_queue_data->second.untrackedCmdBuffers) {
-            fence_data->second.cmdBuffers.push_back(cmdbuffer);
-        }
-        other_queue_data->second.untrackedCmdBuffers.clear();
-    } else {
-        for (auto cmdbuffer : other_queue_data->second.untrackedCmdBuffers) {
-            queue_data->second.untrackedCmdBuffers.push_back(cmdbuffer);
-        }
-        other_queue_data->second.untrackedCmdBuffers.clear();
-    }
     for (auto eventStagePair : other_queue_data->second.eventToStageMap) {
         queue_data->second.eventToStageMap[eventStagePair.first] = eventStagePair.second;
     }
 }
 
-// This is the core function for tracking command buffers. There are two primary ways command
-// buffers are tracked. When submitted they are stored in the command buffer list associated
-// with a fence or the untracked command buffer list associated with a queue if no fence is used.
-// Each queue also stores the last fence that was submitted onto the queue. This allows us to
-// create a linked list of fences and their associated command buffers so if one fence is
-// waited on, prior fences on that queue are also considered to have been waited on. When a fence is
-// waited on (either via a queue, device or fence), we free the cmd buffers for that fence and
-// recursively call with the prior fences.
-static void trackCommandBuffers(layer_data *my_data, VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
-                                VkFence fence) {
-    auto queue_data = my_data->queueMap.find(queue);
-    if (fence != VK_NULL_HANDLE) {
-        vector<VkFence> prior_fences;
-        auto fence_data = my_data->fenceMap.find(fence);
-        if (fence_data == my_data->fenceMap.end()) {
-            return;
-        }
-        fence_data->second.cmdBuffers.clear();
-        if (queue_data != my_data->queueMap.end()) {
-            prior_fences = queue_data->second.lastFences;
-            queue_data->second.lastFences.clear();
-            queue_data->second.lastFences.push_back(fence);
-            for (auto cmdbuffer : queue_data->second.untrackedCmdBuffers) {
-                fence_data->second.cmdBuffers.push_back(cmdbuffer);
-            }
-            queue_data->second.untrackedCmdBuffers.clear();
-        }
-        fence_data->second.priorFences = prior_fences;
-        fence_data->second.needsSignaled = true;
-        fence_data->second.queue = queue;
-        fence_data->second.in_use.fetch_add(1);
-        for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
-            const VkSubmitInfo *submit = &pSubmits[submit_idx];
-            for (uint32_t i = 0; i < submit->commandBufferCount; ++i) {
-                for (auto secondaryCmdBuffer : my_data->commandBufferMap[submit->pCommandBuffers[i]]->secondaryCommandBuffers) {
-                    fence_data->second.cmdBuffers.push_back(secondaryCmdBuffer);
-                }
-                fence_data->second.cmdBuffers.push_back(submit->pCommandBuffers[i]);
-            }
-        }
-    } else {
-        if (queue_data != my_data->queueMap.end()) {
-            for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
-                const VkSubmitInfo *submit = &pSubmits[submit_idx];
-                for (uint32_t i = 0; i < submit->commandBufferCount; ++i) {
-                    for (auto secondaryCmdBuffer : my_data->commandBufferMap[submit->pCommandBuffers[i]]->secondaryCommandBuffers) {
-                        queue_data->second.untrackedCmdBuffers.push_back(secondaryCmdBuffer);
-                    }
-                    queue_data->second.untrackedCmdBuffers.push_back(submit->pCommandBuffers[i]);
-                }
-            }
-        }
+// Record fence as signaled by the latest submission on pQueue, adding an empty submission for it
+//  if nothing else was submitted.
+static void trackFence(layer_data *my_data, VkQueue queue, QUEUE_NODE *pQueue, VkFence fence) {
+    auto fence_data = my_data->fenceMap.find(fence);
+    if (fence_data == my_data->fenceMap.end()) {
+        return;
+    }
+    if (pQueue->submissions.empty() || pQueue->submissions.back().fence != fence) {
+        pQueue->submissions.emplace_back(vector<VkCommandBuffer>(), vector<SEMAPHORE_WAIT>(), fence);
     }
+    fence_data->second.queue = queue;
+    fence_data->second.seq = pQueue->seq + pQueue->submissions.size();
+    fence_data->second.needsSignaled = true;
+    fence_data->second.in_use.fetch_add(1);
 }
 
 static void markCommandBuffersInFlight(layer_data *my_data, VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
@@ -5026,6 +5581,7 @@ static bool validateCommandBufferSimultaneousUse(layer_data *dev_data, GLOBAL_CB
 }
 
 static bool validateCommandBufferState(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     // Validate ONE_TIME_SUBMIT_BIT CB is not being submitted more than once
     if ((pCB->beginInfo.flags & VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) && (pCB->submitCount > 1)) {
@@ -5130,11 +5686,12 @@ static bool validatePrimaryCommandBufferState(layer_data *dev_data, GLOBAL_CB_NO
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     GLOBAL_CB_NODE *pCBNode = NULL;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // First verify that fence is not in use
     if (fence != VK_NULL_HANDLE) {
         dev_data->fenceMap[fence].queue = queue;
@@ -5153,19 +5710,26 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
     // TODO : Review these old print functions and clean up as appropriate
     print_mem_list(dev_data);
     printCBList(dev_data);
-    // Update cmdBuffer-related data structs and mark fence in-use
-    trackCommandBuffers(dev_data, queue, submitCount, pSubmits, fence);
-    // Now verify each individual submit
+    auto queue_data = dev_data->queueMap.find(queue);
+    QUEUE_NODE *pQueue = (queue_data != dev_data->queueMap.end()) ? &queue_data->second : nullptr;
+    // Now verify each individual submit, recording each as a submission on the queue
     std::unordered_set<VkQueue> processed_other_queues;
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         const VkSubmitInfo *submit = &pSubmits[submit_idx];
+        const uint64_t submit_seq = pQueue ? pQueue->seq + pQueue->submissions.size() + 1 : 0;
         vector<VkSemaphore> semaphoreList;
+        vector<SEMAPHORE_WAIT> semaphoreWaits;
+        vector<VkCommandBuffer> cbs;
         for (uint32_t i = 0; i < submit->waitSemaphoreCount; ++i) {
             const VkSemaphore &semaphore = submit->pWaitSemaphores[i];
             semaphoreList.push_back(semaphore);
             if (dev_data->semaphoreMap.find(semaphore) != dev_data->semaphoreMap.end()) {
                 if (dev_data->semaphoreMap[semaphore].signaled) {
                     dev_data->semaphoreMap[semaphore].signaled = false;
+                    if (dev_data->semaphoreMap[semaphore].queue != VK_NULL_HANDLE) {
+                        semaphoreWaits.push_back(
+                            {semaphore, dev_data->semaphoreMap[semaphore].queue, dev_data->semaphoreMap[semaphore].seq});
+                    }
                 } else {
                     skipCall |=
                         log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_SEMAPHORE_EXT,
@@ -5175,7 +5739,7 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
                 }
                 const VkQueue &other_queue = dev_data->semaphoreMap[semaphore].queue;
                 if (other_queue != VK_NULL_HANDLE && !processed_other_queues.count(other_queue)) {
-                    updateTrackedCommandBuffers(dev_data, queue, other_queue, fence);
+                    mergeQueueEventStages(dev_data, queue, other_queue);
                     processed_other_queues.insert(other_queue);
                 }
             }
@@ -5195,6 +5759,7 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
                 } else {
                     dev_data->semaphoreMap[semaphore].signaled = true;
                     dev_data->semaphoreMap[semaphore].queue = queue;
+                    dev_data->semaphoreMap[semaphore].seq = submit_seq;
                 }
             }
         }
@@ -5202,6 +5767,10 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
             skipCall |= ValidateCmdBufImageLayouts(submit->pCommandBuffers[i]);
             pCBNode = getCBNode(dev_data, submit->pCommandBuffers[i]);
             if (pCBNode) {
+                for (auto secondaryCmdBuffer : pCBNode->secondaryCommandBuffers) {
+                    cbs.push_back(secondaryCmdBuffer);
+                }
+                cbs.push_back(submit->pCommandBuffers[i]);
                 pCBNode->semaphores = semaphoreList;
                 pCBNode->submitCount++; // increment submit count
                 pCBNode->lastSubmittedFence = fence;
@@ -5216,6 +5785,13 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
                 }
             }
         }
+        if (pQueue) {
+            pQueue->submissions.emplace_back(cbs, semaphoreWaits, submit_idx == submitCount - 1 ? fence : VK_NULL_HANDLE);
+        }
+    }
+    // Mark fence in-use
+    if (pQueue && fence != VK_NULL_HANDLE) {
+        trackFence(dev_data, queue, pQueue, fence);
     }
     markCommandBuffersInFlight(dev_data, queue, submitCount, pSubmits, fence);
     lock.unlock();
@@ -5228,10 +5804,11 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
 #if MTMERGESOURCE
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo,
                                                                 const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->AllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
     // TODO : Track allocations and overall size here
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     add_mem_obj_info(my_data, device, *pMemory, pAllocateInfo);
     print_mem_list(my_data);
     return result;
@@ -5239,6 +5816,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice device,
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkFreeMemory(VkDevice device, VkDeviceMemory mem, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     // From spec : A memory object is freed by calling vkFreeMemory() when it is no longer needed.
@@ -5248,7 +5826,7 @@ vkFreeMemory(VkDevice device, VkDeviceMemory mem, const VkAllocationCallbacks *p
     // buffers (on host or device) for anything other than destroying those objects will result in
     // undefined behavior.
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     freeMemObjInfo(my_data, device, mem, false);
     print_mem_list(my_data);
     printCBList(my_data);
@@ -5295,6 +5873,77 @@ static bool validateMemRange(layer_data *my_data, VkDeviceMemory mem, VkDeviceSi
     return skipCall;
 }
 
+static const char NoncoherentMemoryFillValue = 0xb;
+
+// Whole pages for the guarded shadow copy; protectPages makes them inaccessible
+#if defined(_WIN32)
+static size_t getPageSize() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+static void *allocPages(size_t size) { return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE); }
+static bool protectPages(void *pages, size_t size) {
+    DWORD old_protect;
+    return VirtualProtect(pages, size, PAGE_NOACCESS, &old_protect) != 0;
+}
+static void freePages(void *pages, size_t) { VirtualFree(pages, 0, MEM_RELEASE); }
+#else
+static size_t getPageSize() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+static void *allocPages(size_t size) {
+    void *pages = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (pages == MAP_FAILED) ? NULL : pages;
+}
+static bool protectPages(void *pages, size_t size) { return mprotect(pages, size, PROT_NONE) == 0; }
+static void freePages(void *pages, size_t size) { munmap(pages, size); }
+#endif
+
+static void freeShadowMemory(DEVICE_MEM_INFO *mem_info) {
+    if (mem_info->pData) {
+        if (mem_info->shadowGuardSize)
+            freePages(mem_info->pData, mem_info->shadowAllocSize);
+        else
+            free(mem_info->pData);
+        mem_info->pData = 0;
+    }
+}
+
+// Check that size bytes at data all still hold NoncoherentMemoryFillValue, a word at a time
+static bool isNoncoherentFillIntact(const char *data, size_t size) {
+    const uint64_t fill = 0x0101010101010101ull * static_cast<uint8_t>(NoncoherentMemoryFillValue);
+    uint64_t diff = 0;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        diff |= word ^ fill;
+    }
+    for (; i < size; ++i) {
+        diff |= static_cast<uint8_t>(data[i] ^ NoncoherentMemoryFillValue);
+    }
+    return diff == 0;
+}
+
+// Fill bytes a flush checks next to either end of the mapping, when the flushed range reaches that end.
+//  Overflows further out are found when the memory is unmapped, which checks the whole of both bands.
+static const size_t NoncoherentFlushFillCheckSize = 256;
+
+// Check the fill before the app's data (low) and after it (high), limited to limit bytes next to the data
+static bool isNoncoherentFillIntact(const DEVICE_MEM_INFO &mem_info, bool low, bool high, size_t limit) {
+    const char *data = static_cast<const char *>(mem_info.pData);
+    const size_t data_end = mem_info.shadowPad + static_cast<size_t>(mem_info.shadowSize);
+    const size_t low_size = std::min(limit, mem_info.shadowPad - mem_info.shadowGuardSize);
+    const size_t high_size = std::min(limit, mem_info.shadowAllocSize - mem_info.shadowGuardSize - data_end);
+    return (!low || isNoncoherentFillIntact(data + mem_info.shadowPad - low_size, low_size)) &&
+           (!high || isNoncoherentFillIntact(data + data_end, high_size));
+}
+
+static bool logNoncoherentOverflow(layer_data *my_data, VkDeviceMemory mem) {
+    return log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT,
+                   (uint64_t)mem, __LINE__, MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64,
+                   (uint64_t)mem);
+}
+
 static void storeMemRanges(layer_data *my_data, VkDeviceMemory mem, VkDeviceSize offset, VkDeviceSize size) {
     auto mem_element = my_data->memObjMap.find(mem);
     if (mem_element != my_data->memObjMap.end()) {
@@ -5316,31 +5965,64 @@ static bool deleteMemRanges(layer_data *my_data, VkDeviceMemory mem) {
                                "Unmapping Memory without memory being mapped: mem obj %#" PRIxLEAST64, (uint64_t)mem);
         }
         mem_element->second.memRange.size = 0;
-        if (mem_element->second.pData) {
-            free(mem_element->second.pData);
-            mem_element->second.pData = 0;
+        // The shadow copy is freed and the memory recorded as unmapped either way, so an overflow is only reported: skipping
+        //  the driver's unmap would leave its mapping behind
+        if (mem_element->second.pData &&
+            !isNoncoherentFillIntact(mem_element->second, true, true, std::numeric_limits<size_t>::max())) {
+            logNoncoherentOverflow(my_data, mem);
         }
+        freeShadowMemory(&mem_element->second);
     }
     return skipCall;
 }
 
-static char NoncoherentMemoryFillValue = 0xb;
+// Place size bytes between two inaccessible guard pages, ending as close to the upper
+//  page as the map alignment allows.  The few bytes of slack either side are filled.
+static bool allocShadowPages(layer_data *dev_data, DEVICE_MEM_INFO *mem_info, size_t size) {
+    const size_t page = getPageSize();
+    size_t alignment = dev_data->phys_dev_properties.properties.limits.minMemoryMapAlignment;
+    if (alignment < 64 || (alignment & (alignment - 1)))
+        alignment = 64;
+    const size_t body = (size + page - 1) / page * page;
+    char *pages = static_cast<char *>(allocPages(body + 2 * page));
+    if (!pages)
+        return false;
+    if (!protectPages(pages, page) || !protectPages(pages + page + body, page)) {
+        freePages(pages, body + 2 * page);
+        return false;
+    }
+    const size_t slack = (body - size) & ~(alignment - 1);
+    memset(pages + page, NoncoherentMemoryFillValue, slack);
+    memset(pages + page + slack + size, NoncoherentMemoryFillValue, body - slack - size);
+    mem_info->pData = pages;
+    mem_info->shadowPad = page + slack;
+    mem_info->shadowGuardSize = page;
+    mem_info->shadowAllocSize = body + 2 * page;
+    return true;
+}
 
 static void initializeAndTrackMemory(layer_data *dev_data, VkDeviceMemory mem, VkDeviceSize size, void **ppData) {
     auto mem_element = dev_data->memObjMap.find(mem);
     if (mem_element != dev_data->memObjMap.end()) {
-        mem_element->second.pDriverData = *ppData;
-        uint32_t index = mem_element->second.allocInfo.memoryTypeIndex;
+        DEVICE_MEM_INFO &mem_info = mem_element->second;
+        mem_info.pDriverData = *ppData;
+        uint32_t index = mem_info.allocInfo.memoryTypeIndex;
         if (dev_data->phys_dev_mem_props.memoryTypes[index].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
-            mem_element->second.pData = 0;
+            mem_info.pData = 0;
         } else {
             if (size == VK_WHOLE_SIZE) {
-                size = mem_element->second.allocInfo.allocationSize;
+                size = mem_info.allocInfo.allocationSize - mem_info.memRange.offset;
             }
             size_t convSize = (size_t)(size);
-            mem_element->second.pData = malloc(2 * convSize);
-            memset(mem_element->second.pData, NoncoherentMemoryFillValue, 2 * convSize);
-            *ppData = static_cast<char *>(mem_element->second.pData) + (convSize / 2);
+            mem_info.shadowSize = size;
+            if (noncoherentMemoryGuard != NONCOHERENT_MEMORY_GUARD_PAGES || !allocShadowPages(dev_data, &mem_info, convSize)) {
+                mem_info.pData = malloc(2 * convSize);
+                memset(mem_info.pData, NoncoherentMemoryFillValue, 2 * convSize);
+                mem_info.shadowPad = convSize / 2;
+                mem_info.shadowGuardSize = 0;
+                mem_info.shadowAllocSize = 2 * convSize;
+            }
+            *ppData = static_cast<char *>(mem_info.pData) + mem_info.shadowPad;
         }
     }
 }
@@ -5376,10 +6058,11 @@ static inline bool verifyWaitFenceState(VkDevice device, VkFence fence, const ch
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBool32 waitAll, uint64_t timeout) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
     // Verify fence status of submitted fences
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     for (uint32_t i = 0; i < fenceCount; i++) {
         skip_call |= verifyWaitFenceState(device, pFences[i], "vkWaitForFences");
     }
@@ -5393,7 +6076,7 @@ vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, Vk
         lock.lock();
         // When we know that all fences are complete we can clean/remove their CBs
         if (waitAll || fenceCount == 1) {
-            skip_call |= decrementResources(dev_data, fenceCount, pFences);
+            skip_call |= retireFences(dev_data, fenceCount, pFences);
         }
         // NOTE : Alternate case not handled here is when some fences have completed. In
         //  this case for app to guarantee which fences completed it will have to call
@@ -5406,10 +6089,11 @@ vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, Vk
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device, VkFence fence) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     skipCall = verifyWaitFenceState(device, fence, "vkGetFenceStatus");
     lock.unlock();
 
@@ -5420,7 +6104,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device,
     bool skip_call = false;
     lock.lock();
     if (result == VK_SUCCESS) {
-        skipCall |= decrementResources(dev_data, 1, &fence);
+        skipCall |= retireFences(dev_data, 1, &fence);
     }
     lock.unlock();
     if (skip_call)
@@ -5430,9 +6114,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device,
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex,
                                                             VkQueue *pQueue) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
 
     // Add queue to tracking set only if it is new
     auto result = dev_data->queues.emplace(*pQueue);
@@ -5443,34 +6128,41 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(VkDevice device, uin
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue queue) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     bool skip_call = false;
-    skip_call |= decrementResources(dev_data, queue);
+    VkResult result = dev_data->device_dispatch_table->QueueWaitIdle(queue);
+    if (result == VK_SUCCESS) {
+        std::lock_guard<rw_lock> lock(global_lock);
+        skip_call |= retireQueue(dev_data, queue);
+    }
     if (skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
-    VkResult result = dev_data->device_dispatch_table->QueueWaitIdle(queue);
     return result;
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice device) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
-    for (auto queue : dev_data->queues) {
-        skip_call |= decrementResources(dev_data, queue);
+    VkResult result = dev_data->device_dispatch_table->DeviceWaitIdle(device);
+    if (result == VK_SUCCESS) {
+        std::lock_guard<rw_lock> lock(global_lock);
+        for (auto queue : dev_data->queues) {
+            skip_call |= retireQueue(dev_data, queue);
+        }
+        dev_data->globalInFlightCmdBuffers.clear();
     }
-    dev_data->globalInFlightCmdBuffers.clear();
-    lock.unlock();
     if (skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
-    VkResult result = dev_data->device_dispatch_table->DeviceWaitIdle(device);
     return result;
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto fence_pair = dev_data->fenceMap.find(fence);
     if (fence_pair != dev_data->fenceMap.end()) {
         if (fence_pair->second.in_use.load()) {
@@ -5488,9 +6180,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice device, VkFen
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroySemaphore(device, semaphore, pAllocator);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     auto item = dev_data->semaphoreMap.find(semaphore);
     if (item != dev_data->semaphoreMap.end()) {
         if (item->second.in_use.load()) {
@@ -5504,9 +6197,10 @@ vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCal
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyEvent(VkDevice device, VkEvent event, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto event_data = dev_data->eventMap.find(event);
     if (event_data != dev_data->eventMap.end()) {
         if (event_data->second.in_use.load()) {
@@ -5516,6 +6210,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyEvent(VkDevice device, VkEve
                 "Cannot delete event %" PRIx64 " which is in use by a command buffer.", reinterpret_cast<uint64_t &>(event));
         }
         dev_data->eventMap.erase(event_data);
+        dev_data->stateNodeGeneration++;
     }
     lock.unlock();
     if (!skip_call)
@@ -5525,6 +6220,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyEvent(VkDevice device, VkEve
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)
         ->device_dispatch_table->DestroyQueryPool(device, queryPool, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
@@ -5533,10 +6229,11 @@ vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCal
 VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery,
                                                      uint32_t queryCount, size_t dataSize, void *pData, VkDeviceSize stride,
                                                      VkQueryResultFlags flags) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     unordered_map<QueryObject, vector<VkCommandBuffer>> queriesInFlight;
     GLOBAL_CB_NODE *pCB = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     for (auto cmdBuffer : dev_data->globalInFlightCmdBuffers) {
         pCB = getCBNode(dev_data, cmdBuffer);
         for (auto queryStatePair : pCB->queryToStateMap) {
@@ -5634,47 +6331,43 @@ static bool print_memory_range_error(layer_data *dev_data, const uint64_t object
     }
 }
 
-static bool validate_memory_range(layer_data *dev_data, const vector<MEMORY_RANGE> &ranges, const MEMORY_RANGE &new_range,
+static bool validate_memory_range(layer_data *dev_data, const MEMORY_RANGE_TREE &ranges, const MEMORY_RANGE &new_range,
                                   VkDebugReportObjectTypeEXT object_type) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
-
-    for (auto range : ranges) {
-        if ((range.end & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)) <
-            (new_range.start & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)))
-            continue;
-        if ((range.start & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)) >
-            (new_range.end & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)))
-            continue;
+    // Ranges conflict when they touch the same bufferImageGranularity-sized page.  Widen the query to the pages
+    //  new_range touches, so [lo, hi] holds exactly the ranges whose aligned start and end straddle it.
+    const VkDeviceSize granularity = dev_data->phys_dev_properties.properties.limits.bufferImageGranularity;
+    const VkDeviceSize lo = new_range.start & ~(granularity - 1);
+    VkDeviceSize hi = (new_range.end & ~(granularity - 1)) + (granularity - 1);
+    if (hi < new_range.end)
+        hi = ~VkDeviceSize(0);
+
+    ranges.for_each_overlap(lo, hi, [&](const MEMORY_RANGE &range) {
         skip_call |= print_memory_range_error(dev_data, new_range.handle, range.handle, object_type);
-    }
+    });
     return skip_call;
 }
 
 static MEMORY_RANGE insert_memory_ranges(uint64_t handle, VkDeviceMemory mem, VkDeviceSize memoryOffset,
-                                         VkMemoryRequirements memRequirements, vector<MEMORY_RANGE> &ranges) {
+                                         VkMemoryRequirements memRequirements, MEMORY_RANGE_TREE &ranges) {
     MEMORY_RANGE range;
     range.handle = handle;
     range.memory = mem;
     range.start = memoryOffset;
     range.end = memoryOffset + memRequirements.size - 1;
-    ranges.push_back(range);
+    ranges.insert(range);
     return range;
 }
 
-static void remove_memory_ranges(uint64_t handle, VkDeviceMemory mem, vector<MEMORY_RANGE> &ranges) {
-    for (uint32_t item = 0; item < ranges.size(); item++) {
-        if ((ranges[item].handle == handle) && (ranges[item].memory == mem)) {
-            ranges.erase(ranges.begin() + item);
-            break;
-        }
-    }
-}
+static void remove_memory_ranges(uint64_t handle, MEMORY_RANGE_TREE &ranges) { ranges.erase(handle); }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice device, VkBuffer buffer,
                                                            const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     if (!validateIdleBuffer(dev_data, buffer) && !skipCall) {
         lock.unlock();
         dev_data->device_dispatch_table->DestroyBuffer(device, buffer, pAllocator);
@@ -5685,59 +6378,58 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice device, VkBu
     if (bufferEntry != dev_data->bufferMap.end()) {
         const auto &memEntry = dev_data->memObjMap.find(bufferEntry->second.mem);
         if (memEntry != dev_data->memObjMap.end()) {
-            remove_memory_ranges(reinterpret_cast<uint64_t &>(buffer), bufferEntry->second.mem, memEntry->second.bufferRanges);
+            remove_memory_ranges(reinterpret_cast<uint64_t &>(buffer), memEntry->second.bufferRanges);
         }
         clear_object_binding(dev_data, reinterpret_cast<uint64_t &>(buffer), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT);
         dev_data->bufferMap.erase(bufferEntry);
+        dev_data->stateNodeGeneration++;
+        dev_data->drawStateGeneration++;
     }
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroyBufferView(device, bufferView, pAllocator);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     auto item = dev_data->bufferViewMap.find(bufferView);
     if (item != dev_data->bufferViewMap.end()) {
         dev_data->bufferViewMap.erase(item);
+        dev_data->drawStateGeneration++;
     }
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
     if (!skipCall) {
         dev_data->device_dispatch_table->DestroyImage(device, image, pAllocator);
     }
 
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     const auto &imageEntry = dev_data->imageMap.find(image);
     if (imageEntry != dev_data->imageMap.end()) {
         // Clean up memory mapping, bindings and range references for image
         auto memEntry = dev_data->memObjMap.find(imageEntry->second.mem);
         if (memEntry != dev_data->memObjMap.end()) {
-            remove_memory_ranges(reinterpret_cast<uint64_t &>(image), imageEntry->second.mem, memEntry->second.imageRanges);
+            remove_memory_ranges(reinterpret_cast<uint64_t &>(image), memEntry->second.imageRanges);
             clear_object_binding(dev_data, reinterpret_cast<uint64_t &>(image), VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT);
             memEntry->second.image = VK_NULL_HANDLE;
         }
         // Remove image from imageMap
         dev_data->imageMap.erase(imageEntry);
     }
-    const auto& subEntry = dev_data->imageSubresourceMap.find(image);
-    if (subEntry != dev_data->imageSubresourceMap.end()) {
-        for (const auto& pair : subEntry->second) {
-            dev_data->imageLayoutMap.erase(pair);
-        }
-        dev_data->imageSubresourceMap.erase(subEntry);
-    }
 }
 
 #if MTMERGESOURCE
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory mem, VkDeviceSize memoryOffset) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Track objects tied to memory
     uint64_t buffer_handle = (uint64_t)(buffer);
     bool skipCall =
@@ -5812,6 +6504,7 @@ vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory mem, VkDevic
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements *pMemoryRequirements) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // TODO : What to track here?
     //   Could potentially save returned mem requirements and validate values passed into BindBufferMemory
@@ -5820,6 +6513,7 @@ vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirem
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkGetImageMemoryRequirements(VkDevice device, VkImage image, VkMemoryRequirements *pMemoryRequirements) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // TODO : What to track here?
     //   Could potentially save returned mem requirements and validate values passed into BindImageMemory
@@ -5828,6 +6522,7 @@ vkGetImageMemoryRequirements(VkDevice device, VkImage image, VkMemoryRequirement
 #endif
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)
         ->device_dispatch_table->DestroyImageView(device, imageView, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
@@ -5835,9 +6530,10 @@ vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCal
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     my_data->shaderModuleMap.erase(shaderModule);
     lock.unlock();
 
@@ -5846,12 +6542,14 @@ vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllo
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)->device_dispatch_table->DestroyPipeline(device, pipeline, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)
         ->device_dispatch_table->DestroyPipelineLayout(device, pipelineLayout, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
@@ -5859,12 +6557,14 @@ vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)->device_dispatch_table->DestroySampler(device, sampler, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)
         ->device_dispatch_table->DestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
@@ -5872,6 +6572,7 @@ vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSe
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     get_my_data_ptr(get_dispatch_key(device), layer_data_map)
         ->device_dispatch_table->DestroyDescriptorPool(device, descriptorPool, pAllocator);
     // TODO : Clean up any internal data structures using this obj.
@@ -5902,9 +6603,9 @@ static bool checkAndClearCommandBuffersInFlight(layer_data *dev_data, const VkCo
     bool skip_call = false;
     auto pool_data = dev_data->commandPoolMap.find(commandPool);
     if (pool_data != dev_data->commandPoolMap.end()) {
-        for (auto cmd_buffer : pool_data->second.commandBuffers) {
-            if (dev_data->globalInFlightCmdBuffers.count(cmd_buffer)) {
-                skip_call |= checkAndClearCommandBufferInFlight(dev_data, getCBNode(dev_data, cmd_buffer), action);
+        for (auto cb_node : pool_data->second.commandBuffers) {
+            if (dev_data->globalInFlightCmdBuffers.count(cb_node->commandBuffer)) {
+                skip_call |= checkAndClearCommandBufferInFlight(dev_data, cb_node, action);
             }
         }
     }
@@ -5913,23 +6614,30 @@ static bool checkAndClearCommandBuffersInFlight(layer_data *dev_data, const VkCo
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
+    CMD_POOL_INFO &pool_info = dev_data->commandPoolMap[commandPool];
     for (uint32_t i = 0; i < commandBufferCount; i++) {
         auto cb_pair = dev_data->commandBufferMap.find(pCommandBuffers[i]);
-        skip_call |= checkAndClearCommandBufferInFlight(dev_data, cb_pair->second, "free");
-        // Delete CB information structure, and remove from commandBufferMap
+        // Return CB information structure to its pool for reuse, and remove from commandBufferMap
         if (cb_pair != dev_data->commandBufferMap.end()) {
-            // reset prior to delete for data clean-up
-            resetCB(dev_data, (*cb_pair).second->commandBuffer);
-            delete (*cb_pair).second;
+            GLOBAL_CB_NODE *cb_node = cb_pair->second;
+            skip_call |= checkAndClearCommandBufferInFlight(dev_data, cb_node, "free");
+            // reset prior to reuse for data clean-up
+            resetCB(dev_data, cb_node);
             dev_data->commandBufferMap.erase(cb_pair);
-        }
 
-        // Remove commandBuffer reference from commandPoolMap
-        dev_data->commandPoolMap[commandPool].commandBuffers.remove(pCommandBuffers[i]);
+            // Remove commandBuffer reference from commandPoolMap
+            auto pool_cb = std::find(pool_info.commandBuffers.begin(), pool_info.commandBuffers.end(), cb_node);
+            if (pool_cb != pool_info.commandBuffers.end()) {
+                *pool_cb = pool_info.commandBuffers.back();
+                pool_info.commandBuffers.pop_back();
+            }
+            pool_info.freeNodes.push_back(cb_node);
+        }
     }
 #if MTMERGESOURCE
     printCBList(dev_data);
@@ -5943,12 +6651,13 @@ vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t comman
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo *pCreateInfo,
                                                                    const VkAllocationCallbacks *pAllocator,
                                                                    VkCommandPool *pCommandPool) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     VkResult result = dev_data->device_dispatch_table->CreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->commandPoolMap[*pCommandPool].createFlags = pCreateInfo->flags;
         dev_data->commandPoolMap[*pCommandPool].queueFamilyIndex = pCreateInfo->queueFamilyIndex;
     }
@@ -5957,11 +6666,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(VkDevice devi
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateQueryPool(VkDevice device, const VkQueryPoolCreateInfo *pCreateInfo,
                                                                  const VkAllocationCallbacks *pAllocator, VkQueryPool *pQueryPool) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
 
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateQueryPool(device, pCreateInfo, pAllocator, pQueryPool);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->queryPoolMap[*pQueryPool].createInfo = *pCreateInfo;
     }
     return result;
@@ -5970,24 +6680,25 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateQueryPool(VkDevice device
 // Destroy commandPool along with all of the commandBuffers allocated from that pool
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Verify that command buffers in pool are complete (not in-flight)
     VkBool32 result = checkAndClearCommandBuffersInFlight(dev_data, commandPool, "destroy command pool with");
     // Must remove cmdpool from cmdpoolmap, after removing all cmdbuffers in its list from the commandPoolMap
-    if (dev_data->commandPoolMap.find(commandPool) != dev_data->commandPoolMap.end()) {
-        for (auto poolCb = dev_data->commandPoolMap[commandPool].commandBuffers.begin();
-             poolCb != dev_data->commandPoolMap[commandPool].commandBuffers.end();) {
-            clear_cmd_buf_and_mem_references(dev_data, *poolCb);
-            auto del_cb = dev_data->commandBufferMap.find(*poolCb);
-            delete (*del_cb).second;                  // delete CB info structure
-            dev_data->commandBufferMap.erase(del_cb); // Remove this command buffer
-            poolCb = dev_data->commandPoolMap[commandPool].commandBuffers.erase(
-                poolCb); // Remove CB reference from commandPoolMap's list
+    auto pool_data = dev_data->commandPoolMap.find(commandPool);
+    if (pool_data != dev_data->commandPoolMap.end()) {
+        for (auto cb_node : pool_data->second.commandBuffers) {
+            clear_cmd_buf_and_mem_references(dev_data, cb_node);
+            dev_data->commandBufferMap.erase(cb_node->commandBuffer); // Remove this command buffer
+            delete cb_node;                                            // delete CB info structure
         }
+        for (auto cb_node : pool_data->second.freeNodes) {
+            delete cb_node;
+        }
+        dev_data->commandPoolMap.erase(pool_data);
     }
-    dev_data->commandPoolMap.erase(commandPool);
 
     lock.unlock();
 
@@ -6000,6 +6711,7 @@ vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocat
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
@@ -6012,21 +6724,29 @@ vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolRese
 
     // Reset all of the CBs allocated from this pool
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        auto it = dev_data->commandPoolMap[commandPool].commandBuffers.begin();
-        while (it != dev_data->commandPoolMap[commandPool].commandBuffers.end()) {
-            resetCB(dev_data, (*it));
-            ++it;
+        std::lock_guard<rw_lock> lock(global_lock);
+        CMD_POOL_INFO &pool_info = dev_data->commandPoolMap[commandPool];
+        for (auto cb_node : pool_info.commandBuffers) {
+            resetCB(dev_data, cb_node);
+        }
+        // Releasing the pool's resources includes the nodes kept for reuse
+        if (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) {
+            for (auto cb_node : pool_info.freeNodes) {
+                delete cb_node;
+            }
+            pool_info.freeNodes.clear();
+            pool_info.freeNodes.shrink_to_fit();
         }
     }
     return result;
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     for (uint32_t i = 0; i < fenceCount; ++i) {
         auto fence_item = dev_data->fenceMap.find(pFences[i]);
         if (fence_item != dev_data->fenceMap.end()) {
@@ -6047,8 +6767,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice device, ui
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto fbNode = dev_data->frameBufferMap.find(framebuffer);
     if (fbNode != dev_data->frameBufferMap.end()) {
         for (auto cb : fbNode->second.referencingCmdBuffers) {
@@ -6068,20 +6789,22 @@ vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocat
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroyRenderPass(device, renderPass, pAllocator);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     dev_data->renderPassMap.erase(renderPass);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo,
                                                               const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     VkResult result = dev_data->device_dispatch_table->CreateBuffer(device, pCreateInfo, pAllocator, pBuffer);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         // TODO : This doesn't create deep copy of pQueueFamilyIndices so need to fix that if/when we want that data to be valid
         dev_data->bufferMap[*pBuffer].createInfo = *pCreateInfo;
         dev_data->bufferMap[*pBuffer].in_use.store(0);
@@ -6091,10 +6814,11 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice device, c
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBufferView(VkDevice device, const VkBufferViewCreateInfo *pCreateInfo,
                                                                   const VkAllocationCallbacks *pAllocator, VkBufferView *pView) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateBufferView(device, pCreateInfo, pAllocator, pView);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->bufferViewMap[*pView] = VkBufferViewCreateInfo(*pCreateInfo);
 #if MTMERGESOURCE
         // In order to create a valid buffer view, the buffer must have been created with at least one of the
@@ -6109,19 +6833,16 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateBufferView(VkDevice devic
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo,
                                                              const VkAllocationCallbacks *pAllocator, VkImage *pImage) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     VkResult result = dev_data->device_dispatch_table->CreateImage(device, pCreateInfo, pAllocator, pImage);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        IMAGE_LAYOUT_NODE image_node;
-        image_node.layout = pCreateInfo->initialLayout;
-        image_node.format = pCreateInfo->format;
-        dev_data->imageMap[*pImage].createInfo = *pCreateInfo;
-        ImageSubresourcePair subpair = {*pImage, false, VkImageSubresource()};
-        dev_data->imageSubresourceMap[*pImage].push_back(subpair);
-        dev_data->imageLayoutMap[subpair] = image_node;
+        std::lock_guard<rw_lock> lock(global_lock);
+        IMAGE_NODE &image_node = dev_data->imageMap[*pImage];
+        image_node.createInfo = *pCreateInfo;
+        image_node.layouts.init(pCreateInfo->mipLevels, pCreateInfo->arrayLayers, VK_IMAGE_LAYOUT_MAX_ENUM);
     }
     return result;
 }
@@ -6145,31 +6866,13 @@ static void ResolveRemainingLevelsLayers(layer_data *dev_data, VkImageSubresourc
     }
 }
 
-// Return the correct layer/level counts if the caller used the special
-// values VK_REMAINING_MIP_LEVELS or VK_REMAINING_ARRAY_LAYERS.
-static void ResolveRemainingLevelsLayers(layer_data *dev_data, uint32_t *levels, uint32_t *layers, VkImageSubresourceRange range,
-                                         VkImage image) {
-    /* expects global_lock to be held by caller */
-
-    *levels = range.levelCount;
-    *layers = range.layerCount;
-    auto image_node_it = dev_data->imageMap.find(image);
-    if (image_node_it != dev_data->imageMap.end()) {
-        if (range.levelCount == VK_REMAINING_MIP_LEVELS) {
-            *levels = image_node_it->second.createInfo.mipLevels - range.baseMipLevel;
-        }
-        if (range.layerCount == VK_REMAINING_ARRAY_LAYERS) {
-            *layers = image_node_it->second.createInfo.arrayLayers - range.baseArrayLayer;
-        }
-    }
-}
-
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(VkDevice device, const VkImageViewCreateInfo *pCreateInfo,
                                                                  const VkAllocationCallbacks *pAllocator, VkImageView *pView) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateImageView(device, pCreateInfo, pAllocator, pView);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         VkImageViewCreateInfo localCI = VkImageViewCreateInfo(*pCreateInfo);
         ResolveRemainingLevelsLayers(dev_data, &localCI.subresourceRange, pCreateInfo->image);
         dev_data->imageViewMap[*pView] = localCI;
@@ -6186,10 +6889,11 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(VkDevice device
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkFence *pFence) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateFence(device, pCreateInfo, pAllocator, pFence);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         auto &fence_node = dev_data->fenceMap[*pFence];
         fence_node.createInfo = *pCreateInfo;
         fence_node.needsSignaled = true;
@@ -6205,6 +6909,7 @@ vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAll
 // TODO handle pipeline caches
 VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineCache(VkDevice device, const VkPipelineCacheCreateInfo *pCreateInfo,
                                                      const VkAllocationCallbacks *pAllocator, VkPipelineCache *pPipelineCache) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreatePipelineCache(device, pCreateInfo, pAllocator, pPipelineCache);
     return result;
@@ -6212,12 +6917,14 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineCache(VkDevice device, const VkPi
 
 VKAPI_ATTR void VKAPI_CALL
 vkDestroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroyPipelineCache(device, pipelineCache, pAllocator);
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vkGetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache, size_t *pDataSize, void *pData) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->GetPipelineCacheData(device, pipelineCache, pDataSize, pData);
     return result;
@@ -6225,6 +6932,7 @@ vkGetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache, size_t *p
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vkMergePipelineCaches(VkDevice device, VkPipelineCache dstCache, uint32_t srcCacheCount, const VkPipelineCache *pSrcCaches) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->MergePipelineCaches(device, dstCache, srcCacheCount, pSrcCaches);
     return result;
@@ -6255,6 +6963,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t count,
                           const VkGraphicsPipelineCreateInfo *pCreateInfos, const VkAllocationCallbacks *pAllocator,
                           VkPipeline *pPipelines) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     VkResult result = VK_SUCCESS;
     // TODO What to do with pipelineCache?
     // The order of operations here is a little convoluted but gets the job done
@@ -6267,29 +6976,45 @@ vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i = 0;
-    std::unique_lock<std::mutex> lock(global_lock);
-
+    // Shadowing only touches the new nodes, and derivatives may refer to any earlier node, so do it all first
     for (i = 0; i < count; i++) {
         pPipeNode[i] = new PIPELINE_NODE;
         pPipeNode[i]->initGraphicsPipeline(&pCreateInfos[i]);
-        skipCall |= verifyPipelineCreateState(dev_data, device, pPipeNode, i);
+        // Collective state is computed once here so binding the pipeline never writes to the shared node
+        set_pipeline_state(pPipeNode[i]);
+    }
+
+    // Validation only reads device state, so the pipelines are validated in parallel under a shared lock, which
+    //  keeps the shader modules, layouts and render passes they refer to from changing meanwhile. Their messages are
+    //  kept and passed to the callbacks afterwards on this thread, in pipeline order, so the app's callbacks run as if
+    //  the pipelines had been validated one by one.
+    vector<char> pipeSkip(count, 0);
+    vector<vector<debug_report_deferred_message>> pipeMessages(count);
+    shared_lock<rw_lock> read_lock(global_lock);
+    dev_data->pipeline_validation_pool->parallel_for(count, [&](uint32_t index) {
+        debug_report_defer defer(&pipeMessages[index]);
+        pipeSkip[index] = verifyPipelineCreateState(dev_data, device, pPipeNode, index);
+    });
+    read_lock.unlock();
+    for (i = 0; i < count; i++) {
+        for (auto &message : pipeMessages[i]) {
+            skipCall |= debug_report_log_deferred(dev_data->report_data, message);
+        }
+        skipCall |= pipeSkip[i] != 0;
     }
 
     if (!skipCall) {
-        lock.unlock();
         result = dev_data->device_dispatch_table->CreateGraphicsPipelines(device, pipelineCache, count, pCreateInfos, pAllocator,
                                                                           pPipelines);
-        lock.lock();
+        std::lock_guard<rw_lock> lock(global_lock);
         for (i = 0; i < count; i++) {
             pPipeNode[i]->pipeline = pPipelines[i];
             dev_data->pipelineMap[pPipeNode[i]->pipeline] = pPipeNode[i];
         }
-        lock.unlock();
     } else {
         for (i = 0; i < count; i++) {
             delete pPipeNode[i];
         }
-        lock.unlock();
         return VK_ERROR_VALIDATION_FAILED_EXT;
     }
     return result;
@@ -6299,6 +7024,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t count,
                          const VkComputePipelineCreateInfo *pCreateInfos, const VkAllocationCallbacks *pAllocator,
                          VkPipeline *pPipelines) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     VkResult result = VK_SUCCESS;
     bool skipCall = false;
 
@@ -6307,7 +7033,6 @@ vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i = 0;
-    std::unique_lock<std::mutex> lock(global_lock);
     for (i = 0; i < count; i++) {
         // TODO: Verify compute stage bits
 
@@ -6315,27 +7040,38 @@ vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_
         pPipeNode[i] = new PIPELINE_NODE;
         pPipeNode[i]->initComputePipeline(&pCreateInfos[i]);
         // memcpy(&pPipeNode[i]->computePipelineCI, (const void *)&pCreateInfos[i], sizeof(VkComputePipelineCreateInfo));
+    }
 
-        // TODO: Add Compute Pipeline Verification
-        // skipCall |= verifyPipelineCreateState(dev_data, device, pPipeNode[i]);
+    // As for graphics pipelines, validate the shader stages in parallel under a shared lock and pass their messages
+    //  on from this thread in pipeline order
+    vector<char> pipeSkip(count, 0);
+    vector<vector<debug_report_deferred_message>> pipeMessages(count);
+    shared_lock<rw_lock> read_lock(global_lock);
+    dev_data->pipeline_validation_pool->parallel_for(count, [&](uint32_t index) {
+        debug_report_defer defer(&pipeMessages[index]);
+        pipeSkip[index] = !validate_compute_pipeline(dev_data, pPipeNode[index]);
+    });
+    read_lock.unlock();
+    for (i = 0; i < count; i++) {
+        for (auto &message : pipeMessages[i]) {
+            skipCall |= debug_report_log_deferred(dev_data->report_data, message);
+        }
+        skipCall |= pipeSkip[i] != 0;
     }
 
     if (!skipCall) {
-        lock.unlock();
         result = dev_data->device_dispatch_table->CreateComputePipelines(device, pipelineCache, count, pCreateInfos, pAllocator,
                                                                          pPipelines);
-        lock.lock();
+        std::lock_guard<rw_lock> lock(global_lock);
         for (i = 0; i < count; i++) {
             pPipeNode[i]->pipeline = pPipelines[i];
             dev_data->pipelineMap[pPipeNode[i]->pipeline] = pPipeNode[i];
         }
-        lock.unlock();
     } else {
         for (i = 0; i < count; i++) {
             // Clean up any locally allocated data structures
             delete pPipeNode[i];
         }
-        lock.unlock();
         return VK_ERROR_VALIDATION_FAILED_EXT;
     }
     return result;
@@ -6343,10 +7079,11 @@ vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSampler(VkDevice device, const VkSamplerCreateInfo *pCreateInfo,
                                                                const VkAllocationCallbacks *pAllocator, VkSampler *pSampler) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSampler(device, pCreateInfo, pAllocator, pSampler);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->sampleMap[*pSampler] = unique_ptr<SAMPLER_NODE>(new SAMPLER_NODE(pSampler, pCreateInfo));
     }
     return result;
@@ -6355,11 +7092,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSampler(VkDevice device,
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo *pCreateInfo,
                             const VkAllocationCallbacks *pAllocator, VkDescriptorSetLayout *pSetLayout) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
     if (VK_SUCCESS == result) {
         // TODOSC : Capture layout bindings set
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->descriptorSetLayoutMap[*pSetLayout] = new DescriptorSetLayout(dev_data->report_data, pCreateInfo, *pSetLayout);
     }
     return result;
@@ -6379,6 +7117,7 @@ static bool validatePushConstantSize(const layer_data *dev_data, const uint32_t
 
 VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice device, const VkPipelineLayoutCreateInfo *pCreateInfo,
                                                       const VkAllocationCallbacks *pAllocator, VkPipelineLayout *pPipelineLayout) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     uint32_t i = 0;
@@ -6396,7 +7135,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice device, const VkP
     }
     VkResult result = dev_data->device_dispatch_table->CreatePipelineLayout(device, pCreateInfo, pAllocator, pPipelineLayout);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         // TODOSC : Merge capture of the setLayouts per pipeline
         PIPELINE_LAYOUT_NODE &plNode = dev_data->pipelineLayoutMap[*pPipelineLayout];
         plNode.descriptorSetLayouts.resize(pCreateInfo->setLayoutCount);
@@ -6414,6 +7153,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice device, const VkP
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
                        VkDescriptorPool *pDescriptorPool) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateDescriptorPool(device, pCreateInfo, pAllocator, pDescriptorPool);
     if (VK_SUCCESS == result) {
@@ -6429,7 +7169,7 @@ vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo *pCreat
                         "Out of memory while attempting to allocate DESCRIPTOR_POOL_NODE in vkCreateDescriptorPool()"))
                 return VK_ERROR_VALIDATION_FAILED_EXT;
         } else {
-            std::lock_guard<std::mutex> lock(global_lock);
+            std::lock_guard<rw_lock> lock(global_lock);
             dev_data->descriptorPoolMap[*pDescriptorPool] = pNewNode;
         }
     } else {
@@ -6440,10 +7180,11 @@ vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo *pCreat
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->ResetDescriptorPool(device, descriptorPool, flags);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         clearDescriptorPool(dev_data, device, descriptorPool, flags);
     }
     return result;
@@ -6451,10 +7192,11 @@ vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescri
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo, VkDescriptorSet *pDescriptorSets) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Verify that requested descriptorSets are available in pool
     DESCRIPTOR_POOL_NODE *pPoolNode = getPoolNode(dev_data, pAllocateInfo->descriptorPool);
     if (!pPoolNode) {
@@ -6531,10 +7273,11 @@ vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAl
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t count, const VkDescriptorSet *pDescriptorSets) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // Make sure that no sets being destroyed are in-flight
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     for (uint32_t i = 0; i < count; ++i)
         skipCall |= validateIdleDescriptorSet(dev_data, pDescriptorSets[i], "vkFreeDescriptorSets");
     DESCRIPTOR_POOL_NODE *pPoolNode = getPoolNode(dev_data, descriptorPool);
@@ -6555,6 +7298,7 @@ vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t
         // Update available descriptor sets in pool
         pPoolNode->availableSets += count;
 
+        dev_data->drawStateGeneration++;
         // For each freed descriptor add it back into the pool as available
         for (uint32_t i = 0; i < count; ++i) {
             SET_NODE *pSet = dev_data->setMap[pDescriptorSets[i]]; // getSetNode() without locking
@@ -6577,10 +7321,12 @@ vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkUpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet *pDescriptorWrites,
                        uint32_t descriptorCopyCount, const VkCopyDescriptorSet *pDescriptorCopies) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     // dsUpdate will return true only if a bailout error occurs, so we want to call down tree when update returns false
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool rtn = dsUpdate(dev_data, device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
+    dev_data->drawStateGeneration++;
     lock.unlock();
     if (!rtn) {
         dev_data->device_dispatch_table->UpdateDescriptorSets(device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount,
@@ -6590,21 +7336,31 @@ vkUpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkW
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *pCreateInfo, VkCommandBuffer *pCommandBuffer) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->AllocateCommandBuffers(device, pCreateInfo, pCommandBuffer);
     if (VK_SUCCESS == result) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         auto const &cp_it = dev_data->commandPoolMap.find(pCreateInfo->commandPool);
         if (cp_it != dev_data->commandPoolMap.end()) {
+            auto &free_nodes = cp_it->second.freeNodes;
             for (uint32_t i = 0; i < pCreateInfo->commandBufferCount; i++) {
+                // Take a node freed back to this pool if there is one; it was reset when freed
+                GLOBAL_CB_NODE *pCB;
+                if (!free_nodes.empty()) {
+                    pCB = free_nodes.back();
+                    free_nodes.pop_back();
+                } else {
+                    pCB = new GLOBAL_CB_NODE;
+                    resetCB(dev_data, pCB);
+                }
+                pCB->commandBuffer = pCommandBuffer[i];
+                pCB->createInfo = *pCreateInfo;
+                pCB->device = device;
                 // Add command buffer to its commandPool map
-                cp_it->second.commandBuffers.push_back(pCommandBuffer[i]);
-                GLOBAL_CB_NODE *pCB = new GLOBAL_CB_NODE;
+                cp_it->second.commandBuffers.push_back(pCB);
                 // Add command buffer to map
                 dev_data->commandBufferMap[pCommandBuffer[i]] = pCB;
-                resetCB(dev_data, pCommandBuffer[i]);
-                pCB->createInfo = *pCreateInfo;
-                pCB->device = device;
             }
         }
 #if MTMERGESOURCE
@@ -6617,9 +7373,10 @@ vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *pCr
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Validate command buffer level
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
@@ -6748,10 +7505,11 @@ vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginIn
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffer commandBuffer) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     VkResult result = VK_SUCCESS;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pCB->state != CB_RECORDING) {
@@ -6772,6 +7530,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffe
             pCB->state = CB_RECORDED;
             // Reset CB status flags
             pCB->status = 0;
+            gatherInFlightResources(dev_data, pCB, false);
             printCB(dev_data, commandBuffer);
         }
     } else {
@@ -6783,9 +7542,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffe
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     VkCommandPool cmdPool = pCB->createInfo.commandPool;
     if (!(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT & dev_data->commandPoolMap[cmdPool].createFlags)) {
@@ -6814,9 +7574,10 @@ vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags fl
 #endif
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_BINDPIPELINE, "vkCmdBindPipeline()");
@@ -6830,9 +7591,10 @@ vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBin
 
         PIPELINE_NODE *pPN = getPipeline(dev_data, pipeline);
         if (pPN) {
+            if (pCB->lastBound[pipelineBindPoint].pipeline != pipeline)
+                pCB->lastBound[pipelineBindPoint].dirty |= LAST_BOUND_DIRTY_PIPELINE;
             pCB->lastBound[pipelineBindPoint].pipeline = pipeline;
             set_cb_pso_status(pCB, pPN);
-            set_pipeline_state(pPN);
             skipCall |= validatePipelineState(dev_data, pCB, pipelineBindPoint, pipeline);
         } else {
             skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT,
@@ -6847,13 +7609,15 @@ vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBin
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport *pViewports) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETVIEWPORTSTATE, "vkCmdSetViewport()");
         pCB->status |= CBSTATUS_VIEWPORT_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
         pCB->viewports.resize(viewportCount);
         memcpy(pCB->viewports.data(), pViewports, viewportCount * sizeof(VkViewport));
     }
@@ -6864,13 +7628,15 @@ vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D *pScissors) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSCISSORSTATE, "vkCmdSetScissor()");
         pCB->status |= CBSTATUS_SCISSOR_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
         pCB->scissors.resize(scissorCount);
         memcpy(pCB->scissors.data(), pScissors, scissorCount * sizeof(VkRect2D));
     }
@@ -6880,13 +7646,15 @@ vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t s
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip_call |= addCmd(dev_data, pCB, CMD_SETLINEWIDTHSTATE, "vkCmdSetLineWidth()");
         pCB->status |= CBSTATUS_LINE_WIDTH_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
 
         PIPELINE_NODE *pPipeTrav = getPipeline(dev_data, pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].pipeline);
         if (pPipeTrav != NULL && !isDynamic(pPipeTrav, VK_DYNAMIC_STATE_LINE_WIDTH)) {
@@ -6905,13 +7673,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetLineWidth(VkCommandBuffer com
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETDEPTHBIASSTATE, "vkCmdSetDepthBias()");
         pCB->status |= CBSTATUS_DEPTH_BIAS_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
     }
     lock.unlock();
     if (!skipCall)
@@ -6920,13 +7690,15 @@ vkCmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFactor,
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4]) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETBLENDSTATE, "vkCmdSetBlendConstants()");
         pCB->status |= CBSTATUS_BLEND_CONSTANTS_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
     }
     lock.unlock();
     if (!skipCall)
@@ -6935,13 +7707,15 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdSetBlendConstants(VkCommandBuffe
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETDEPTHBOUNDSSTATE, "vkCmdSetDepthBounds()");
         pCB->status |= CBSTATUS_DEPTH_BOUNDS_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
     }
     lock.unlock();
     if (!skipCall)
@@ -6950,13 +7724,15 @@ vkCmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float m
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetStencilCompareMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t compareMask) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSTENCILREADMASKSTATE, "vkCmdSetStencilCompareMask()");
         pCB->status |= CBSTATUS_STENCIL_READ_MASK_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
     }
     lock.unlock();
     if (!skipCall)
@@ -6965,13 +7741,15 @@ vkCmdSetStencilCompareMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags fac
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSTENCILWRITEMASKSTATE, "vkCmdSetStencilWriteMask()");
         pCB->status |= CBSTATUS_STENCIL_WRITE_MASK_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
     }
     lock.unlock();
     if (!skipCall)
@@ -6980,13 +7758,15 @@ vkCmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceM
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetStencilReference(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETSTENCILREFERENCESTATE, "vkCmdSetStencilReference()");
         pCB->status |= CBSTATUS_STENCIL_REFERENCE_SET;
+        pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].dirty |= LAST_BOUND_DIRTY_DYNAMIC_STATE;
     }
     lock.unlock();
     if (!skipCall)
@@ -6997,14 +7777,17 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout,
                         uint32_t firstSet, uint32_t setCount, const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount,
                         const uint32_t *pDynamicOffsets) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pCB->state == CB_RECORDING) {
             // Track total count of dynamic descriptor types to make sure we have an offset for each one
             uint32_t totalDynamicDescriptors = 0;
+            // Whether any set binding the draw time checks look at changes
+            bool setsChanged = false;
             string errorString = "";
             uint32_t lastSetIndex = firstSet + setCount - 1;
             if (lastSetIndex >= pCB->lastBound[pipelineBindPoint].boundDescriptorSets.size())
@@ -7014,7 +7797,12 @@ vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipel
                 SET_NODE *pSet = getSetNode(dev_data, pDescriptorSets[i]);
                 if (pSet) {
                     pCB->lastBound[pipelineBindPoint].uniqueBoundSets.insert(pDescriptorSets[i]);
-                    pSet->boundCmdBuffers.insert(commandBuffer);
+                    {
+                        std::lock_guard<std::mutex> binding_lock(cb_binding_lock);
+                        pSet->boundCmdBuffers.insert(commandBuffer);
+                    }
+                    setsChanged |= pCB->lastBound[pipelineBindPoint].pipelineLayout != layout ||
+                                   pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i + firstSet] != pDescriptorSets[i];
                     pCB->lastBound[pipelineBindPoint].pipelineLayout = layout;
                     pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i + firstSet] = pDescriptorSets[i];
                     skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT,
@@ -7098,10 +7886,8 @@ vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipel
                 // For any previously bound sets, need to set them to "invalid" if they were disturbed by this update
                 if (firstSet > 0) { // Check set #s below the first bound set
                     for (uint32_t i = 0; i < firstSet; ++i) {
-                        if (pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i] &&
-                            !verify_set_layout_compatibility(
-                                dev_data, dev_data->setMap[pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i]], layout, i,
-                                errorString)) {
+                        SET_NODE *pOldSet = getSetNode(dev_data, pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i]);
+                        if (pOldSet && !verify_set_layout_compatibility(dev_data, pOldSet, layout, i, errorString)) {
                             skipCall |= log_msg(
                                 dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
                                 VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
@@ -7110,14 +7896,15 @@ vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipel
                                 " previously bound as set #%u was disturbed by newly bound pipelineLayout (%#" PRIxLEAST64 ")",
                                 (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i], i, (uint64_t)layout);
                             pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i] = VK_NULL_HANDLE;
+                            setsChanged = true;
                         }
                     }
                 }
                 // Check if newly last bound set invalidates any remaining bound sets
                 if ((pCB->lastBound[pipelineBindPoint].boundDescriptorSets.size() - 1) > (lastSetIndex)) {
-                    if (oldFinalBoundSet &&
-                        !verify_set_layout_compatibility(dev_data, dev_data->setMap[oldFinalBoundSet], layout, lastSetIndex,
-                                                         errorString)) {
+                    SET_NODE *pOldFinalSet = getSetNode(dev_data, oldFinalBoundSet);
+                    if (pOldFinalSet &&
+                        !verify_set_layout_compatibility(dev_data, pOldFinalSet, layout, lastSetIndex, errorString)) {
                         skipCall |=
                             log_msg(dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
                                     VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)oldFinalBoundSet, __LINE__,
@@ -7129,6 +7916,7 @@ vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipel
                                     (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[lastSetIndex], lastSetIndex,
                                     lastSetIndex + 1, (uint64_t)layout);
                         pCB->lastBound[pipelineBindPoint].boundDescriptorSets.resize(lastSetIndex + 1);
+                        setsChanged = true;
                     }
                 }
             }
@@ -7145,6 +7933,10 @@ vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipel
             for (uint32_t i = 0; i < dynamicOffsetCount; i++) {
                 pCB->lastBound[pipelineBindPoint].dynamicOffsets.emplace_back(pDynamicOffsets[i]);
             }
+            if (setsChanged)
+                pCB->lastBound[pipelineBindPoint].dirty |= LAST_BOUND_DIRTY_DESCRIPTOR_SETS;
+            if (dynamicOffsetCount)
+                pCB->lastBound[pipelineBindPoint].dirty |= LAST_BOUND_DIRTY_DYNAMIC_OFFSETS;
         } else {
             skipCall |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdBindDescriptorSets()");
         }
@@ -7157,9 +7949,10 @@ vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipel
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     skipCall =
@@ -7214,9 +8007,10 @@ static inline void updateResourceTrackingOnDraw(GLOBAL_CB_NODE *pCB) { pCB->draw
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding,
                                                                   uint32_t bindingCount, const VkBuffer *pBuffers,
                                                                   const VkDeviceSize *pOffsets) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     for (uint32_t i = 0; i < bindingCount; ++i) {
         VkDeviceMemory mem;
@@ -7243,6 +8037,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(VkCommandBuffe
 
 /* expects global_lock to be held by caller */
 static bool markStoreImagesAndBuffersAsWritten(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
 
     for (auto imageView : pCB->updateImages) {
@@ -7274,9 +8069,10 @@ static bool markStoreImagesAndBuffersAsWritten(layer_data *dev_data, GLOBAL_CB_N
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount,
                                                      uint32_t firstVertex, uint32_t firstInstance) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DRAW, "vkCmdDraw()");
@@ -7301,9 +8097,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuff
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount,
                                                             uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
                                                             uint32_t firstInstance) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_DRAWINDEXED, "vkCmdDrawIndexed()");
@@ -7328,9 +8125,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer comm
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     // MTMTODO : merge with code below
@@ -7361,9 +8159,10 @@ vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize o
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     // MTMTODO : merge with code below
@@ -7394,9 +8193,10 @@ vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDevic
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uint32_t y, uint32_t z) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= validate_and_update_draw_state(dev_data, pCB, false, VK_PIPELINE_BIND_POINT_COMPUTE);
@@ -7413,9 +8213,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(VkCommandBuffer command
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     skipCall =
@@ -7438,9 +8239,10 @@ vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSi
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer,
                                                            uint32_t regionCount, const VkBufferCopy *pRegions) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7483,13 +8285,13 @@ static bool VerifySourceImageLayout(VkCommandBuffer cmdBuffer, VkImage srcImage,
 
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
-    for (uint32_t i = 0; i < subLayers.layerCount; ++i) {
-        uint32_t layer = i + subLayers.baseArrayLayer;
-        VkImageSubresource sub = {subLayers.aspectMask, subLayers.mipLevel, layer};
+    CB_IMAGE_LAYOUT_MAP &layouts = GetCBImageLayouts(dev_data, pCB, srcImage);
+    VkImageSubresourceRange range = {subLayers.aspectMask, subLayers.mipLevel, 1, subLayers.baseArrayLayer, subLayers.layerCount};
+    ForEachSubresource(layouts, range, [&](const VkImageSubresource &sub, bool whole) {
         IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindLayout(pCB, srcImage, sub, node)) {
-            SetLayout(pCB, srcImage, sub, IMAGE_CMD_BUF_LAYOUT_NODE(srcImageLayout, srcImageLayout));
-            continue;
+        if (!FindLayout(dev_data, srcImage, layouts, sub, node)) {
+            SetLayout(layouts, sub, IMAGE_CMD_BUF_LAYOUT_NODE(srcImageLayout, srcImageLayout), whole);
+            return;
         }
         if (node.layout != srcImageLayout) {
             // TODO: Improve log message in the next pass
@@ -7499,7 +8301,7 @@ static bool VerifySourceImageLayout(VkCommandBuffer cmdBuffer, VkImage srcImage,
                                                                         "and doesn't match the current layout %s.",
                         string_VkImageLayout(srcImageLayout), string_VkImageLayout(node.layout));
         }
-    }
+    });
     if (srcImageLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
         if (srcImageLayout == VK_IMAGE_LAYOUT_GENERAL) {
             // LAYOUT_GENERAL is allowed, but may not be performance optimal, flag as perf warning.
@@ -7522,13 +8324,13 @@ static bool VerifyDestImageLayout(VkCommandBuffer cmdBuffer, VkImage destImage,
 
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
-    for (uint32_t i = 0; i < subLayers.layerCount; ++i) {
-        uint32_t layer = i + subLayers.baseArrayLayer;
-        VkImageSubresource sub = {subLayers.aspectMask, subLayers.mipLevel, layer};
+    CB_IMAGE_LAYOUT_MAP &layouts = GetCBImageLayouts(dev_data, pCB, destImage);
+    VkImageSubresourceRange range = {subLayers.aspectMask, subLayers.mipLevel, 1, subLayers.baseArrayLayer, subLayers.layerCount};
+    ForEachSubresource(layouts, range, [&](const VkImageSubresource &sub, bool whole) {
         IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindLayout(pCB, destImage, sub, node)) {
-            SetLayout(pCB, destImage, sub, IMAGE_CMD_BUF_LAYOUT_NODE(destImageLayout, destImageLayout));
-            continue;
+        if (!FindLayout(dev_data, destImage, layouts, sub, node)) {
+            SetLayout(layouts, sub, IMAGE_CMD_BUF_LAYOUT_NODE(destImageLayout, destImageLayout), whole);
+            return;
         }
         if (node.layout != destImageLayout) {
             skip_call |=
@@ -7537,7 +8339,7 @@ static bool VerifyDestImageLayout(VkCommandBuffer cmdBuffer, VkImage destImage,
                                                                         "doesn't match the current layout %s.",
                         string_VkImageLayout(destImageLayout), string_VkImageLayout(node.layout));
         }
-    }
+    });
     if (destImageLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
         if (destImageLayout == VK_IMAGE_LAYOUT_GENERAL) {
             // LAYOUT_GENERAL is allowed, but may not be performance optimal, flag as perf warning.
@@ -7557,9 +8359,10 @@ static bool VerifyDestImageLayout(VkCommandBuffer cmdBuffer, VkImage destImage,
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage,
                VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageCopy *pRegions) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7603,9 +8406,10 @@ vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout sr
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage,
                VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit *pRegions, VkFilter filter) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7645,9 +8449,10 @@ vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout sr
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer,
                                                                   VkImage dstImage, VkImageLayout dstImageLayout,
                                                                   uint32_t regionCount, const VkBufferImageCopy *pRegions) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7690,9 +8495,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffe
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage,
                                                                   VkImageLayout srcImageLayout, VkBuffer dstBuffer,
                                                                   uint32_t regionCount, const VkBufferImageCopy *pRegions) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7736,9 +8542,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffe
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer,
                                                              VkDeviceSize dstOffset, VkDeviceSize dataSize, const uint32_t *pData) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7768,9 +8575,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdUpdateBuffer(VkCommandBuffer com
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
@@ -7801,9 +8609,10 @@ vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_t attachmentCount,
                                                                  const VkClearAttachment *pAttachments, uint32_t rectCount,
                                                                  const VkClearRect *pRects) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_CLEARATTACHMENTS, "vkCmdClearAttachments()");
@@ -7871,9 +8680,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearAttachments(VkCommandBuffer
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdClearColorImage(VkCommandBuffer commandBuffer, VkImage image,
                                                                 VkImageLayout imageLayout, const VkClearColorValue *pColor,
                                                                 uint32_t rangeCount, const VkImageSubresourceRange *pRanges) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     // TODO : Verify memory is in VK_IMAGE_STATE_CLEAR state
     VkDeviceMemory mem;
@@ -7902,9 +8712,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout,
                             const VkClearDepthStencilValue *pDepthStencil, uint32_t rangeCount,
                             const VkImageSubresourceRange *pRanges) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     // TODO : Verify memory is in VK_IMAGE_STATE_CLEAR state
     VkDeviceMemory mem;
@@ -7933,9 +8744,10 @@ vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, VkImage image, VkImag
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdResolveImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage,
                   VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageResolve *pRegions) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
     VkDeviceMemory mem;
@@ -7982,9 +8794,10 @@ bool setEventStageMask(VkQueue queue, VkCommandBuffer commandBuffer, VkEvent eve
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_SETEVENT, "vkCmdSetEvent()");
@@ -8001,9 +8814,10 @@ vkCmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_RESETEVENT, "vkCmdResetEvent()");
@@ -8020,42 +8834,32 @@ vkCmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFla
 
 static bool TransitionImageLayouts(VkCommandBuffer cmdBuffer, uint32_t memBarrierCount,
                                    const VkImageMemoryBarrier *pImgMemBarriers) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
     bool skip = false;
-    uint32_t levelCount = 0;
-    uint32_t layerCount = 0;
 
     for (uint32_t i = 0; i < memBarrierCount; ++i) {
         auto mem_barrier = &pImgMemBarriers[i];
         if (!mem_barrier)
             continue;
-        // TODO: Do not iterate over every possibility - consolidate where
-        // possible
-        ResolveRemainingLevelsLayers(dev_data, &levelCount, &layerCount, mem_barrier->subresourceRange, mem_barrier->image);
-
-        for (uint32_t j = 0; j < levelCount; j++) {
-            uint32_t level = mem_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < layerCount; k++) {
-                uint32_t layer = mem_barrier->subresourceRange.baseArrayLayer + k;
-                VkImageSubresource sub = {mem_barrier->subresourceRange.aspectMask, level, layer};
-                IMAGE_CMD_BUF_LAYOUT_NODE node;
-                if (!FindLayout(pCB, mem_barrier->image, sub, node)) {
-                    SetLayout(pCB, mem_barrier->image, sub,
-                              IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout));
-                    continue;
-                }
-                if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-                    // TODO: Set memory invalid which is in mem_tracker currently
-                } else if (node.layout != mem_barrier->oldLayout) {
-                    skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0,
-                                    __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "You cannot transition the layout from %s "
-                                                                                    "when current layout is %s.",
-                                    string_VkImageLayout(mem_barrier->oldLayout), string_VkImageLayout(node.layout));
-                }
-                SetLayout(pCB, mem_barrier->image, sub, mem_barrier->newLayout);
+        CB_IMAGE_LAYOUT_MAP &layouts = GetCBImageLayouts(dev_data, pCB, mem_barrier->image);
+        ForEachSubresource(layouts, mem_barrier->subresourceRange, [&](const VkImageSubresource &sub, bool whole) {
+            IMAGE_CMD_BUF_LAYOUT_NODE node;
+            if (!FindLayout(dev_data, mem_barrier->image, layouts, sub, node)) {
+                SetLayout(layouts, sub, IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout), whole);
+                return;
+            }
+            if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+                // TODO: Set memory invalid which is in mem_tracker currently
+            } else if (node.layout != mem_barrier->oldLayout) {
+                skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
+                                DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "You cannot transition the layout from %s "
+                                                                      "when current layout is %s.",
+                                string_VkImageLayout(mem_barrier->oldLayout), string_VkImageLayout(node.layout));
             }
-        }
+            SetLayout(layouts, sub, mem_barrier->newLayout, whole);
+        });
     }
     return skip;
 }
@@ -8178,6 +8982,7 @@ static bool ValidateBarriers(const char *funcName, VkCommandBuffer cmdBuffer, ui
                              const VkMemoryBarrier *pMemBarriers, uint32_t bufferBarrierCount,
                              const VkBufferMemoryBarrier *pBufferMemBarriers, uint32_t imageMemBarrierCount,
                              const VkImageMemoryBarrier *pImageMemBarriers) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
@@ -8390,9 +9195,10 @@ vkCmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEven
                 VkPipelineStageFlags dstStageMask, uint32_t memoryBarrierCount, const VkMemoryBarrier *pMemoryBarriers,
                 uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *pBufferMemoryBarriers,
                 uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         auto firstEventIndex = pCB->events.size();
@@ -8425,9 +9231,10 @@ vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStag
                      VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier *pMemoryBarriers,
                      uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *pBufferMemoryBarriers,
                      uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= addCmd(dev_data, pCB, CMD_PIPELINEBARRIER, "vkCmdPipelineBarrier()");
@@ -8445,9 +9252,10 @@ vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStag
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slot, VkFlags flags) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
@@ -8463,9 +9271,10 @@ vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t s
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slot) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
@@ -8491,9 +9300,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndQuery(VkCommandBuffer command
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         for (uint32_t i = 0; i < queryCount; i++) {
@@ -8516,9 +9326,10 @@ vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount,
                           VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize stride, VkQueryResultFlags flags) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
 #if MTMERGESOURCE
     VkDeviceMemory mem;
@@ -8563,9 +9374,10 @@ vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQueryPool queryPool,
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout,
                                                               VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size,
                                                               const void *pValues) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    shared_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pCB->state == CB_RECORDING) {
@@ -8585,9 +9397,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(VkCommandBuffer co
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t slot) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
@@ -8606,11 +9419,12 @@ vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipel
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo *pCreateInfo,
                                                                    const VkAllocationCallbacks *pAllocator,
                                                                    VkFramebuffer *pFramebuffer) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateFramebuffer(device, pCreateInfo, pAllocator, pFramebuffer);
     if (VK_SUCCESS == result) {
         // Shadow create info and store in map
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
 
         auto & fbNode = dev_data->frameBufferMap[*pFramebuffer];
         fbNode.createInfo = *pCreateInfo;
@@ -8865,6 +9679,7 @@ static bool ValidateDependencies(const layer_data *my_data, const VkRenderPassBe
 }
 
 static bool ValidateLayouts(const layer_data *my_data, VkDevice device, const VkRenderPassCreateInfo *pCreateInfo) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip = false;
 
     for (uint32_t i = 0; i < pCreateInfo->subpassCount; ++i) {
@@ -8954,34 +9769,59 @@ static bool CreatePassDAG(const layer_data *my_data, VkDevice device, const VkRe
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo *pCreateInfo,
                                                                     const VkAllocationCallbacks *pAllocator,
                                                                     VkShaderModule *pShaderModule) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
+    const size_t word_count = pCreateInfo->codeSize / sizeof(uint32_t);
+    const shader_cache_key key = hash_spirv(pCreateInfo->pCode, word_count);
+    std::shared_ptr<shader_module> module;
 
-    /* Use SPIRV-Tools validator to try and catch any issues with the module itself */
-    spv_context ctx = spvContextCreate(SPV_ENV_VULKAN_1_0);
-    spv_const_binary_t binary { pCreateInfo->pCode, pCreateInfo->codeSize / sizeof(uint32_t) };
-    spv_diagnostic diag = nullptr;
-
-    auto result = spvValidate(ctx, &binary, &diag);
-    if (result != SPV_SUCCESS) {
-        skip_call |= log_msg(my_data->report_data,
-                             result == SPV_WARNING ? VK_DEBUG_REPORT_WARNING_BIT_EXT : VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                             VkDebugReportObjectTypeEXT(0), 0,
-                             __LINE__, SHADER_CHECKER_INCONSISTENT_SPIRV, "SC", "SPIR-V module not valid: %s",
-                             diag && diag->error ? diag->error : "(no error text)");
+    std::unique_lock<std::mutex> cache_lock(shader_cache_lock);
+    auto cache_entry = shader_cache.find(key);
+    if (cache_entry != shader_cache.end() && cache_entry->second.word_count == word_count) {
+        module = std::make_shared<shader_module>(pCreateInfo, cache_entry->second.index);
+        shader_cache_lru.splice(shader_cache_lru.begin(), shader_cache_lru, cache_entry->second.lru);
     }
+    cache_lock.unlock();
 
-    spvDiagnosticDestroy(diag);
-    spvContextDestroy(ctx);
+    if (!module) {
+        /* Use SPIRV-Tools validator to try and catch any issues with the module itself */
+        spv_context ctx = spvContextCreate(SPV_ENV_VULKAN_1_0);
+        spv_const_binary_t binary { pCreateInfo->pCode, word_count };
+        spv_diagnostic diag = nullptr;
 
-    if (skip_call)
-        return VK_ERROR_VALIDATION_FAILED_EXT;
+        auto result = spvValidate(ctx, &binary, &diag);
+        if (result != SPV_SUCCESS) {
+            skip_call |= log_msg(my_data->report_data,
+                                 result == SPV_WARNING ? VK_DEBUG_REPORT_WARNING_BIT_EXT : VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                 VkDebugReportObjectTypeEXT(0), 0,
+                                 __LINE__, SHADER_CHECKER_INCONSISTENT_SPIRV, "SC", "SPIR-V module not valid: %s",
+                                 diag && diag->error ? diag->error : "(no error text)");
+        }
+
+        spvDiagnosticDestroy(diag);
+        spvContextDestroy(ctx);
+
+        if (skip_call)
+            return VK_ERROR_VALIDATION_FAILED_EXT;
+
+        // Only modules spvValidate passed without comment are remembered, so anything it reports is reported every time
+        module = std::make_shared<shader_module>(pCreateInfo);
+        if (result == SPV_SUCCESS) {
+            cache_lock.lock();
+            if (!shader_cache_file.empty()) {
+                addShaderCacheEntry(key, word_count, shader_module_index(*module), false);
+                shader_cache_dirty = true;
+            }
+            cache_lock.unlock();
+        }
+    }
 
     VkResult res = my_data->device_dispatch_table->CreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
 
     if (res == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        my_data->shaderModuleMap[*pShaderModule] = unique_ptr<shader_module>(new shader_module(pCreateInfo));
+        std::lock_guard<rw_lock> lock(global_lock);
+        my_data->shaderModuleMap[*pShaderModule] = module;
     }
     return res;
 }
@@ -8989,9 +9829,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(VkDevice dev
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo *pCreateInfo,
                                                                   const VkAllocationCallbacks *pAllocator,
                                                                   VkRenderPass *pRenderPass) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Create DAG
     std::vector<bool> has_self_dependency(pCreateInfo->subpassCount);
     std::vector<DAGNode> subpass_to_node(pCreateInfo->subpassCount);
@@ -9192,31 +10033,25 @@ static bool VerifyFramebufferAndRenderPassLayouts(VkCommandBuffer cmdBuffer, con
         auto image_data = dev_data->imageViewMap.find(image_view);
         assert(image_data != dev_data->imageViewMap.end());
         const VkImage &image = image_data->second.image;
-        const VkImageSubresourceRange &subRange = image_data->second.subresourceRange;
         IMAGE_CMD_BUF_LAYOUT_NODE newNode = {pRenderPassInfo->pAttachments[i].initialLayout,
                                              pRenderPassInfo->pAttachments[i].initialLayout};
-        // TODO: Do not iterate over every possibility - consolidate where possible
-        for (uint32_t j = 0; j < subRange.levelCount; j++) {
-            uint32_t level = subRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < subRange.layerCount; k++) {
-                uint32_t layer = subRange.baseArrayLayer + k;
-                VkImageSubresource sub = {subRange.aspectMask, level, layer};
-                IMAGE_CMD_BUF_LAYOUT_NODE node;
-                if (!FindLayout(pCB, image, sub, node)) {
-                    SetLayout(pCB, image, sub, newNode);
-                    continue;
-                }
-                if (newNode.layout != node.layout) {
-                    skip_call |=
-                        log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
-                                DRAWSTATE_INVALID_RENDERPASS, "DS", "You cannot start a render pass using attachment %i "
-                                                                    "where the "
-                                                                    "initial layout is %s and the layout of the attachment at the "
-                                                                    "start of the render pass is %s. The layouts must match.",
-                                i, string_VkImageLayout(newNode.layout), string_VkImageLayout(node.layout));
-                }
+        CB_IMAGE_LAYOUT_MAP &layouts = GetCBImageLayouts(dev_data, pCB, image);
+        ForEachSubresource(layouts, image_data->second.subresourceRange, [&](const VkImageSubresource &sub, bool whole) {
+            IMAGE_CMD_BUF_LAYOUT_NODE node;
+            if (!FindLayout(dev_data, image, layouts, sub, node)) {
+                SetLayout(layouts, sub, newNode, whole);
+                return;
+            }
+            if (newNode.layout != node.layout) {
+                skip_call |=
+                    log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
+                            DRAWSTATE_INVALID_RENDERPASS, "DS", "You cannot start a render pass using attachment %i "
+                                                                "where the "
+                                                                "initial layout is %s and the layout of the attachment at the "
+                                                                "start of the render pass is %s. The layouts must match.",
+                            i, string_VkImageLayout(newNode.layout), string_VkImageLayout(node.layout));
             }
-        }
+        });
     }
     return skip_call;
 }
@@ -9250,12 +10085,12 @@ static void TransitionSubpassLayouts(VkCommandBuffer cmdBuffer, const VkRenderPa
     }
 }
 
-static bool validatePrimaryCommandBuffer(const layer_data *my_data, const GLOBAL_CB_NODE *pCB, const std::string &cmd_name) {
+static bool validatePrimaryCommandBuffer(const layer_data *my_data, const GLOBAL_CB_NODE *pCB, const char *cmd_name) {
     bool skip_call = false;
     if (pCB->createInfo.level != VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
         skip_call |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
                              DRAWSTATE_INVALID_COMMAND_BUFFER, "DS", "Cannot execute command %s on a secondary command buffer.",
-                             cmd_name.c_str());
+                             cmd_name);
     }
     return skip_call;
 }
@@ -9300,9 +10135,10 @@ static bool VerifyRenderAreaBounds(const layer_data *my_data, const VkRenderPass
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin, VkSubpassContents contents) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pRenderPassBegin && pRenderPassBegin->renderPass) {
@@ -9388,9 +10224,10 @@ vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skipCall |= validatePrimaryCommandBuffer(dev_data, pCB, "vkCmdNextSubpass");
@@ -9410,9 +10247,10 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdNextSubpass(VkCommandBuffer comm
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer commandBuffer) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     auto cb_data = dev_data->commandBufferMap.find(commandBuffer);
     if (cb_data != dev_data->commandBufferMap.end()) {
@@ -9677,9 +10515,10 @@ static bool validateSecondaryCommandBufferState(layer_data *dev_data, GLOBAL_CB_
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBuffersCount, const VkCommandBuffer *pCommandBuffers) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skipCall = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         GLOBAL_CB_NODE *pSubCB = NULL;
@@ -9807,11 +10646,12 @@ static bool ValidateMapImageLayouts(VkDevice device, VkDeviceMemory mem) {
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDeviceSize offset, VkDeviceSize size, VkFlags flags, void **ppData) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     bool skip_call = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 #if MTMERGESOURCE
     DEVICE_MEM_INFO *pMemObj = get_mem_obj_info(dev_data, mem);
     if (pMemObj) {
@@ -9833,9 +10673,11 @@ vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDeviceSize offset, VkDeviceSi
     if (!skip_call) {
         result = dev_data->device_dispatch_table->MapMemory(device, mem, offset, size, flags, ppData);
 #if MTMERGESOURCE
-        lock.lock();
-        initializeAndTrackMemory(dev_data, mem, size, ppData);
-        lock.unlock();
+        if (result == VK_SUCCESS) {
+            lock.lock();
+            initializeAndTrackMemory(dev_data, mem, size, ppData);
+            lock.unlock();
+        }
 #endif
     }
     return result;
@@ -9843,10 +10685,11 @@ vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDeviceSize offset, VkDeviceSi
 
 #if MTMERGESOURCE
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice device, VkDeviceMemory mem) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     skipCall |= deleteMemRanges(my_data, mem);
     lock.unlock();
     if (!skipCall) {
@@ -9887,30 +10730,33 @@ static bool validateMemoryIsMapped(layer_data *my_data, const char *funcName, ui
 static bool validateAndCopyNoncoherentMemoryToDriver(layer_data *my_data, uint32_t memRangeCount,
                                                      const VkMappedMemoryRange *pMemRanges) {
     bool skipCall = false;
+    std::vector<VkDeviceMemory> overflowed;
     for (uint32_t i = 0; i < memRangeCount; ++i) {
         auto mem_element = my_data->memObjMap.find(pMemRanges[i].memory);
         if (mem_element != my_data->memObjMap.end()) {
-            if (mem_element->second.pData) {
-                VkDeviceSize size = mem_element->second.memRange.size;
-                VkDeviceSize half_size = (size / 2);
-                char *data = static_cast<char *>(mem_element->second.pData);
-                for (auto j = 0; j < half_size; ++j) {
-                    if (data[j] != NoncoherentMemoryFillValue) {
-                        skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                            VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t)pMemRanges[i].memory, __LINE__,
-                                            MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64,
-                                            (uint64_t)pMemRanges[i].memory);
-                    }
+            DEVICE_MEM_INFO &mem_info = mem_element->second;
+            if (mem_info.pData) {
+                char *data = static_cast<char *>(mem_info.pData);
+                // Only the flushed bytes need to reach the driver.  Ranges outside the mapping are
+                //  reported by validateMemoryIsMapped; copy just the part that overlaps it.
+                const VkDeviceSize map_offset = mem_info.memRange.offset;
+                VkDeviceSize begin = (pMemRanges[i].offset > map_offset) ? pMemRanges[i].offset - map_offset : 0;
+                VkDeviceSize end = mem_info.shadowSize;
+                if (pMemRanges[i].size != VK_WHOLE_SIZE) {
+                    const VkDeviceSize range_end = pMemRanges[i].offset + pMemRanges[i].size;
+                    end = (range_end > map_offset) ? std::min(end, range_end - map_offset) : 0;
                 }
-                for (auto j = size + half_size; j < 2 * size; ++j) {
-                    if (data[j] != NoncoherentMemoryFillValue) {
-                        skipCall |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                            VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT, (uint64_t)pMemRanges[i].memory, __LINE__,
-                                            MEMTRACK_INVALID_MAP, "MEM", "Memory overflow was detected on mem obj %" PRIxLEAST64,
-                                            (uint64_t)pMemRanges[i].memory);
-                    }
+                // Check the fill next to the ends of the mapping the range reaches, reporting an overflow
+                //  once per memory object however many of its ranges are flushed
+                if (!isNoncoherentFillIntact(mem_info, begin == 0, end == mem_info.shadowSize, NoncoherentFlushFillCheckSize) &&
+                    std::find(overflowed.begin(), overflowed.end(), pMemRanges[i].memory) == overflowed.end()) {
+                    overflowed.push_back(pMemRanges[i].memory);
+                    skipCall |= logNoncoherentOverflow(my_data, pMemRanges[i].memory);
+                }
+                if (begin < end) {
+                    memcpy(static_cast<char *>(mem_info.pDriverData) + begin, data + mem_info.shadowPad + begin,
+                           static_cast<size_t>(end - begin));
                 }
-                memcpy(mem_element->second.pDriverData, static_cast<void *>(data + (size_t)(half_size)), (size_t)(size));
             }
         }
     }
@@ -9919,11 +10765,12 @@ static bool validateAndCopyNoncoherentMemoryToDriver(layer_data *my_data, uint32
 
 VK_LAYER_EXPORT VkResult VKAPI_CALL
 vkFlushMappedMemoryRanges(VkDevice device, uint32_t memRangeCount, const VkMappedMemoryRange *pMemRanges) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skipCall = false;
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     skipCall |= validateAndCopyNoncoherentMemoryToDriver(my_data, memRangeCount, pMemRanges);
     skipCall |= validateMemoryIsMapped(my_data, "vkFlushMappedMemoryRanges", memRangeCount, pMemRanges);
     lock.unlock();
@@ -9935,11 +10782,12 @@ vkFlushMappedMemoryRanges(VkDevice device, uint32_t memRangeCount, const VkMappe
 
 VK_LAYER_EXPORT VkResult VKAPI_CALL
 vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memRangeCount, const VkMappedMemoryRange *pMemRanges) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skipCall = false;
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     skipCall |= validateMemoryIsMapped(my_data, "vkInvalidateMappedMemoryRanges", memRangeCount, pMemRanges);
     lock.unlock();
     if (!skipCall) {
@@ -9950,10 +10798,11 @@ vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memRangeCount, const Vk
 #endif
 
 VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory mem, VkDeviceSize memoryOffset) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skipCall = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto image_node = dev_data->imageMap.find(image);
     if (image_node != dev_data->imageMap.end()) {
         // Track objects tied to memory
@@ -9994,10 +10843,11 @@ VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice device, VkImage image,
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL vkSetEvent(VkDevice device, VkEvent event) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     bool skip_call = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto event_node = dev_data->eventMap.find(event);
     if (event_node != dev_data->eventMap.end()) {
         event_node->second.needsSignaled = false;
@@ -10009,16 +10859,16 @@ VKAPI_ATTR VkResult VKAPI_CALL vkSetEvent(VkDevice device, VkEvent event) {
                                  reinterpret_cast<const uint64_t &>(event));
         }
     }
-    lock.unlock();
     // Host setting event is visible to all queues immediately so update stageMask for any queue that's seen this event
     // TODO : For correctness this needs separate fix to verify that app doesn't make incorrect assumptions about the
     // ordering of this command in relation to vkCmd[Set|Reset]Events (see GH297)
-    for (auto queue_data : dev_data->queueMap) {
+    for (auto &queue_data : dev_data->queueMap) {
         auto event_entry = queue_data.second.eventToStageMap.find(event);
         if (event_entry != queue_data.second.eventToStageMap.end()) {
             event_entry->second |= VK_PIPELINE_STAGE_HOST_BIT;
         }
     }
+    lock.unlock();
     if (!skip_call)
         result = dev_data->device_dispatch_table->SetEvent(device, event);
     return result;
@@ -10026,13 +10876,13 @@ VKAPI_ATTR VkResult VKAPI_CALL vkSetEvent(VkDevice device, VkEvent event) {
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo, VkFence fence) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // First verify that fence is not in use
     if (fence != VK_NULL_HANDLE) {
-        trackCommandBuffers(dev_data, queue, 0, nullptr, fence);
         auto fence_data = dev_data->fenceMap.find(fence);
         if ((bindInfoCount != 0) && fence_data->second.in_use.load()) {
             skip_call |=
@@ -10048,8 +10898,12 @@ vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo
                         reinterpret_cast<uint64_t &>(fence));
         }
     }
+    auto queue_data = dev_data->queueMap.find(queue);
+    QUEUE_NODE *pQueue = (queue_data != dev_data->queueMap.end()) ? &queue_data->second : nullptr;
     for (uint32_t bindIdx = 0; bindIdx < bindInfoCount; ++bindIdx) {
         const VkBindSparseInfo &bindInfo = pBindInfo[bindIdx];
+        const uint64_t bind_seq = pQueue ? pQueue->seq + pQueue->submissions.size() + 1 : 0;
+        vector<SEMAPHORE_WAIT> semaphoreWaits;
         // Track objects tied to memory
         for (uint32_t j = 0; j < bindInfo.bufferBindCount; j++) {
             for (uint32_t k = 0; k < bindInfo.pBufferBinds[j].bindCount; k++) {
@@ -10080,6 +10934,10 @@ vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo
             if (dev_data->semaphoreMap.find(semaphore) != dev_data->semaphoreMap.end()) {
                 if (dev_data->semaphoreMap[semaphore].signaled) {
                     dev_data->semaphoreMap[semaphore].signaled = false;
+                    if (dev_data->semaphoreMap[semaphore].queue != VK_NULL_HANDLE) {
+                        semaphoreWaits.push_back(
+                            {semaphore, dev_data->semaphoreMap[semaphore].queue, dev_data->semaphoreMap[semaphore].seq});
+                    }
                 } else {
                     skip_call |=
                         log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_SEMAPHORE_EXT,
@@ -10102,8 +10960,17 @@ vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo
                                 reinterpret_cast<const uint64_t &>(queue), reinterpret_cast<const uint64_t &>(semaphore));
                 }
                 dev_data->semaphoreMap[semaphore].signaled = true;
+                dev_data->semaphoreMap[semaphore].queue = queue;
+                dev_data->semaphoreMap[semaphore].seq = bind_seq;
             }
         }
+        if (pQueue) {
+            pQueue->submissions.emplace_back(vector<VkCommandBuffer>(), semaphoreWaits,
+                                             bindIdx == bindInfoCount - 1 ? fence : VK_NULL_HANDLE);
+        }
+    }
+    if (pQueue && fence != VK_NULL_HANDLE) {
+        trackFence(dev_data, queue, pQueue, fence);
     }
     print_mem_list(dev_data);
     lock.unlock();
@@ -10116,13 +10983,15 @@ vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo
 
 VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(VkDevice device, const VkSemaphoreCreateInfo *pCreateInfo,
                                                  const VkAllocationCallbacks *pAllocator, VkSemaphore *pSemaphore) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         SEMAPHORE_NODE* sNode = &dev_data->semaphoreMap[*pSemaphore];
         sNode->signaled = false;
         sNode->queue = VK_NULL_HANDLE;
+        sNode->seq = 0;
         sNode->in_use.store(0);
     }
     return result;
@@ -10130,10 +10999,11 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(VkDevice device, const VkSemaph
 
 VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkEvent *pEvent) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateEvent(device, pCreateInfo, pAllocator, pEvent);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->eventMap[*pEvent].needsSignaled = false;
         dev_data->eventMap[*pEvent].in_use.store(0);
         dev_data->eventMap[*pEvent].stageMask = VkPipelineStageFlags(0);
@@ -10144,12 +11014,13 @@ vkCreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo, const VkAll
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(VkDevice device, const VkSwapchainCreateInfoKHR *pCreateInfo,
                                                                     const VkAllocationCallbacks *pAllocator,
                                                                     VkSwapchainKHR *pSwapchain) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
 
     if (VK_SUCCESS == result) {
         SWAPCHAIN_NODE *psc_node = new SWAPCHAIN_NODE(pCreateInfo);
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->device_extensions.swapchainMap[*pSwapchain] = psc_node;
     }
 
@@ -10158,24 +11029,15 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(VkDevice dev
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto swapchain_data = dev_data->device_extensions.swapchainMap.find(swapchain);
     if (swapchain_data != dev_data->device_extensions.swapchainMap.end()) {
         if (swapchain_data->second->images.size() > 0) {
             for (auto swapchain_image : swapchain_data->second->images) {
-                auto image_sub = dev_data->imageSubresourceMap.find(swapchain_image);
-                if (image_sub != dev_data->imageSubresourceMap.end()) {
-                    for (auto imgsubpair : image_sub->second) {
-                        auto image_item = dev_data->imageLayoutMap.find(imgsubpair);
-                        if (image_item != dev_data->imageLayoutMap.end()) {
-                            dev_data->imageLayoutMap.erase(image_item);
-                        }
-                    }
-                    dev_data->imageSubresourceMap.erase(image_sub);
-                }
                 skipCall = clear_object_binding(dev_data, (uint64_t)swapchain_image,
                                                 VK_DEBUG_REPORT_OBJECT_TYPE_SWAPCHAIN_KHR_EXT);
                 dev_data->imageMap.erase(swapchain_image);
@@ -10191,6 +11053,7 @@ vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocat
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCount, VkImage *pSwapchainImages) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->GetSwapchainImagesKHR(device, swapchain, pCount, pSwapchainImages);
 
@@ -10198,7 +11061,7 @@ vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCo
         // This should never happen and is checked by param checker.
         if (!pCount)
             return result;
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         const size_t count = *pCount;
         auto swapchain_node = dev_data->device_extensions.swapchainMap[swapchain];
         if (!swapchain_node->images.empty()) {
@@ -10215,19 +11078,17 @@ vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCo
             }
         }
         for (uint32_t i = 0; i < *pCount; ++i) {
-            IMAGE_LAYOUT_NODE image_layout_node;
-            image_layout_node.layout = VK_IMAGE_LAYOUT_UNDEFINED;
-            image_layout_node.format = swapchain_node->createInfo.imageFormat;
             auto &image_node = dev_data->imageMap[pSwapchainImages[i]];
             image_node.createInfo.mipLevels = 1;
             image_node.createInfo.arrayLayers = swapchain_node->createInfo.imageArrayLayers;
             image_node.createInfo.usage = swapchain_node->createInfo.imageUsage;
+            image_node.createInfo.format = swapchain_node->createInfo.imageFormat;
+            image_node.createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            if (!image_node.layouts.levels())
+                image_node.layouts.init(1, image_node.createInfo.arrayLayers, VK_IMAGE_LAYOUT_MAX_ENUM);
             image_node.valid = false;
             image_node.mem = MEMTRACKER_SWAP_CHAIN_IMAGE_KEY;
             swapchain_node->images.push_back(pSwapchainImages[i]);
-            ImageSubresourcePair subpair = {pSwapchainImages[i], false, VkImageSubresource()};
-            dev_data->imageSubresourceMap[pSwapchainImages[i]].push_back(subpair);
-            dev_data->imageLayoutMap[subpair] = image_layout_node;
             dev_data->device_extensions.imageToSwapchainMap[pSwapchainImages[i]] = swapchain;
         }
     }
@@ -10235,12 +11096,13 @@ vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCo
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skip_call = false;
 
     if (pPresentInfo) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         for (uint32_t i = 0; i < pPresentInfo->waitSemaphoreCount; ++i) {
             const VkSemaphore &semaphore = pPresentInfo->pWaitSemaphores[i];
             if (dev_data->semaphoreMap.find(semaphore) != dev_data->semaphoreMap.end()) {
@@ -10291,11 +11153,12 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue,
 
 VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapchain, uint64_t timeout,
                                                      VkSemaphore semaphore, VkFence fence, uint32_t *pImageIndex) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skipCall = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     if (semaphore != VK_NULL_HANDLE &&
         dev_data->semaphoreMap.find(semaphore) != dev_data->semaphoreMap.end()) {
         if (dev_data->semaphoreMap[semaphore].signaled) {
@@ -10304,6 +11167,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(VkDevice device, VkSwapchai
                                "vkAcquireNextImageKHR: Semaphore must not be currently signaled or in a wait state");
         }
         dev_data->semaphoreMap[semaphore].signaled = true;
+        dev_data->semaphoreMap[semaphore].queue = VK_NULL_HANDLE;
     }
     auto fence_data = dev_data->fenceMap.find(fence);
     if (fence_data != dev_data->fenceMap.end()) {
@@ -10322,11 +11186,12 @@ VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(VkDevice device, VkSwapchai
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 vkCreateDebugReportCallbackEXT(VkInstance instance, const VkDebugReportCallbackCreateInfoEXT *pCreateInfo,
                                const VkAllocationCallbacks *pAllocator, VkDebugReportCallbackEXT *pMsgCallback) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(instance), layer_data_map);
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     VkResult res = pTable->CreateDebugReportCallbackEXT(instance, pCreateInfo, pAllocator, pMsgCallback);
     if (VK_SUCCESS == res) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         res = layer_create_msg_callback(my_data->report_data, pCreateInfo, pAllocator, pMsgCallback);
     }
     return res;
@@ -10335,258 +11200,157 @@ vkCreateDebugReportCallbackEXT(VkInstance instance, const VkDebugReportCallbackC
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyDebugReportCallbackEXT(VkInstance instance,
                                                                            VkDebugReportCallbackEXT msgCallback,
                                                                            const VkAllocationCallbacks *pAllocator) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(instance), layer_data_map);
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyDebugReportCallbackEXT(instance, msgCallback, pAllocator);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     layer_destroy_msg_callback(my_data->report_data, msgCallback, pAllocator);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL
 vkDebugReportMessageEXT(VkInstance instance, VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT objType, uint64_t object,
                         size_t location, int32_t msgCode, const char *pLayerPrefix, const char *pMsg) {
+    VK_LAYER_PROFILE_FUNCTION(validation_profiler);
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(instance), layer_data_map);
     my_data->instance_dispatch_table->DebugReportMessageEXT(instance, flags, objType, object, location, msgCode, pLayerPrefix,
                                                             pMsg);
 }
 
-VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice dev, const char *funcName) {
-    if (!strcmp(funcName, "vkGetDeviceProcAddr"))
-        return (PFN_vkVoidFunction)vkGetDeviceProcAddr;
-    if (!strcmp(funcName, "vkDestroyDevice"))
-        return (PFN_vkVoidFunction)vkDestroyDevice;
-    if (!strcmp(funcName, "vkQueueSubmit"))
-        return (PFN_vkVoidFunction)vkQueueSubmit;
-    if (!strcmp(funcName, "vkWaitForFences"))
-        return (PFN_vkVoidFunction)vkWaitForFences;
-    if (!strcmp(funcName, "vkGetFenceStatus"))
-        return (PFN_vkVoidFunction)vkGetFenceStatus;
-    if (!strcmp(funcName, "vkQueueWaitIdle"))
-        return (PFN_vkVoidFunction)vkQueueWaitIdle;
-    if (!strcmp(funcName, "vkDeviceWaitIdle"))
-        return (PFN_vkVoidFunction)vkDeviceWaitIdle;
-    if (!strcmp(funcName, "vkGetDeviceQueue"))
-        return (PFN_vkVoidFunction)vkGetDeviceQueue;
-    if (!strcmp(funcName, "vkDestroyInstance"))
-        return (PFN_vkVoidFunction)vkDestroyInstance;
-    if (!strcmp(funcName, "vkDestroyDevice"))
-        return (PFN_vkVoidFunction)vkDestroyDevice;
-    if (!strcmp(funcName, "vkDestroyFence"))
-        return (PFN_vkVoidFunction)vkDestroyFence;
-    if (!strcmp(funcName, "vkResetFences"))
-        return (PFN_vkVoidFunction)vkResetFences;
-    if (!strcmp(funcName, "vkDestroySemaphore"))
-        return (PFN_vkVoidFunction)vkDestroySemaphore;
-    if (!strcmp(funcName, "vkDestroyEvent"))
-        return (PFN_vkVoidFunction)vkDestroyEvent;
-    if (!strcmp(funcName, "vkDestroyQueryPool"))
-        return (PFN_vkVoidFunction)vkDestroyQueryPool;
-    if (!strcmp(funcName, "vkDestroyBuffer"))
-        return (PFN_vkVoidFunction)vkDestroyBuffer;
-    if (!strcmp(funcName, "vkDestroyBufferView"))
-        return (PFN_vkVoidFunction)vkDestroyBufferView;
-    if (!strcmp(funcName, "vkDestroyImage"))
-        return (PFN_vkVoidFunction)vkDestroyImage;
-    if (!strcmp(funcName, "vkDestroyImageView"))
-        return (PFN_vkVoidFunction)vkDestroyImageView;
-    if (!strcmp(funcName, "vkDestroyShaderModule"))
-        return (PFN_vkVoidFunction)vkDestroyShaderModule;
-    if (!strcmp(funcName, "vkDestroyPipeline"))
-        return (PFN_vkVoidFunction)vkDestroyPipeline;
-    if (!strcmp(funcName, "vkDestroyPipelineLayout"))
-        return (PFN_vkVoidFunction)vkDestroyPipelineLayout;
-    if (!strcmp(funcName, "vkDestroySampler"))
-        return (PFN_vkVoidFunction)vkDestroySampler;
-    if (!strcmp(funcName, "vkDestroyDescriptorSetLayout"))
-        return (PFN_vkVoidFunction)vkDestroyDescriptorSetLayout;
-    if (!strcmp(funcName, "vkDestroyDescriptorPool"))
-        return (PFN_vkVoidFunction)vkDestroyDescriptorPool;
-    if (!strcmp(funcName, "vkDestroyFramebuffer"))
-        return (PFN_vkVoidFunction)vkDestroyFramebuffer;
-    if (!strcmp(funcName, "vkDestroyRenderPass"))
-        return (PFN_vkVoidFunction)vkDestroyRenderPass;
-    if (!strcmp(funcName, "vkCreateBuffer"))
-        return (PFN_vkVoidFunction)vkCreateBuffer;
-    if (!strcmp(funcName, "vkCreateBufferView"))
-        return (PFN_vkVoidFunction)vkCreateBufferView;
-    if (!strcmp(funcName, "vkCreateImage"))
-        return (PFN_vkVoidFunction)vkCreateImage;
-    if (!strcmp(funcName, "vkCreateImageView"))
-        return (PFN_vkVoidFunction)vkCreateImageView;
-    if (!strcmp(funcName, "vkCreateFence"))
-        return (PFN_vkVoidFunction)vkCreateFence;
-    if (!strcmp(funcName, "CreatePipelineCache"))
-        return (PFN_vkVoidFunction)vkCreatePipelineCache;
-    if (!strcmp(funcName, "DestroyPipelineCache"))
-        return (PFN_vkVoidFunction)vkDestroyPipelineCache;
-    if (!strcmp(funcName, "GetPipelineCacheData"))
-        return (PFN_vkVoidFunction)vkGetPipelineCacheData;
-    if (!strcmp(funcName, "MergePipelineCaches"))
-        return (PFN_vkVoidFunction)vkMergePipelineCaches;
-    if (!strcmp(funcName, "vkCreateGraphicsPipelines"))
-        return (PFN_vkVoidFunction)vkCreateGraphicsPipelines;
-    if (!strcmp(funcName, "vkCreateComputePipelines"))
-        return (PFN_vkVoidFunction)vkCreateComputePipelines;
-    if (!strcmp(funcName, "vkCreateSampler"))
-        return (PFN_vkVoidFunction)vkCreateSampler;
-    if (!strcmp(funcName, "vkCreateDescriptorSetLayout"))
-        return (PFN_vkVoidFunction)vkCreateDescriptorSetLayout;
-    if (!strcmp(funcName, "vkCreatePipelineLayout"))
-        return (PFN_vkVoidFunction)vkCreatePipelineLayout;
-    if (!strcmp(funcName, "vkCreateDescriptorPool"))
-        return (PFN_vkVoidFunction)vkCreateDescriptorPool;
-    if (!strcmp(funcName, "vkResetDescriptorPool"))
-        return (PFN_vkVoidFunction)vkResetDescriptorPool;
-    if (!strcmp(funcName, "vkAllocateDescriptorSets"))
-        return (PFN_vkVoidFunction)vkAllocateDescriptorSets;
-    if (!strcmp(funcName, "vkFreeDescriptorSets"))
-        return (PFN_vkVoidFunction)vkFreeDescriptorSets;
-    if (!strcmp(funcName, "vkUpdateDescriptorSets"))
-        return (PFN_vkVoidFunction)vkUpdateDescriptorSets;
-    if (!strcmp(funcName, "vkCreateCommandPool"))
-        return (PFN_vkVoidFunction)vkCreateCommandPool;
-    if (!strcmp(funcName, "vkDestroyCommandPool"))
-        return (PFN_vkVoidFunction)vkDestroyCommandPool;
-    if (!strcmp(funcName, "vkResetCommandPool"))
-        return (PFN_vkVoidFunction)vkResetCommandPool;
-    if (!strcmp(funcName, "vkCreateQueryPool"))
-        return (PFN_vkVoidFunction)vkCreateQueryPool;
-    if (!strcmp(funcName, "vkAllocateCommandBuffers"))
-        return (PFN_vkVoidFunction)vkAllocateCommandBuffers;
-    if (!strcmp(funcName, "vkFreeCommandBuffers"))
-        return (PFN_vkVoidFunction)vkFreeCommandBuffers;
-    if (!strcmp(funcName, "vkBeginCommandBuffer"))
-        return (PFN_vkVoidFunction)vkBeginCommandBuffer;
-    if (!strcmp(funcName, "vkEndCommandBuffer"))
-        return (PFN_vkVoidFunction)vkEndCommandBuffer;
-    if (!strcmp(funcName, "vkResetCommandBuffer"))
-        return (PFN_vkVoidFunction)vkResetCommandBuffer;
-    if (!strcmp(funcName, "vkCmdBindPipeline"))
-        return (PFN_vkVoidFunction)vkCmdBindPipeline;
-    if (!strcmp(funcName, "vkCmdSetViewport"))
-        return (PFN_vkVoidFunction)vkCmdSetViewport;
-    if (!strcmp(funcName, "vkCmdSetScissor"))
-        return (PFN_vkVoidFunction)vkCmdSetScissor;
-    if (!strcmp(funcName, "vkCmdSetLineWidth"))
-        return (PFN_vkVoidFunction)vkCmdSetLineWidth;
-    if (!strcmp(funcName, "vkCmdSetDepthBias"))
-        return (PFN_vkVoidFunction)vkCmdSetDepthBias;
-    if (!strcmp(funcName, "vkCmdSetBlendConstants"))
-        return (PFN_vkVoidFunction)vkCmdSetBlendConstants;
-    if (!strcmp(funcName, "vkCmdSetDepthBounds"))
-        return (PFN_vkVoidFunction)vkCmdSetDepthBounds;
-    if (!strcmp(funcName, "vkCmdSetStencilCompareMask"))
-        return (PFN_vkVoidFunction)vkCmdSetStencilCompareMask;
-    if (!strcmp(funcName, "vkCmdSetStencilWriteMask"))
-        return (PFN_vkVoidFunction)vkCmdSetStencilWriteMask;
-    if (!strcmp(funcName, "vkCmdSetStencilReference"))
-        return (PFN_vkVoidFunction)vkCmdSetStencilReference;
-    if (!strcmp(funcName, "vkCmdBindDescriptorSets"))
-        return (PFN_vkVoidFunction)vkCmdBindDescriptorSets;
-    if (!strcmp(funcName, "vkCmdBindVertexBuffers"))
-        return (PFN_vkVoidFunction)vkCmdBindVertexBuffers;
-    if (!strcmp(funcName, "vkCmdBindIndexBuffer"))
-        return (PFN_vkVoidFunction)vkCmdBindIndexBuffer;
-    if (!strcmp(funcName, "vkCmdDraw"))
-        return (PFN_vkVoidFunction)vkCmdDraw;
-    if (!strcmp(funcName, "vkCmdDrawIndexed"))
-        return (PFN_vkVoidFunction)vkCmdDrawIndexed;
-    if (!strcmp(funcName, "vkCmdDrawIndirect"))
-        return (PFN_vkVoidFunction)vkCmdDrawIndirect;
-    if (!strcmp(funcName, "vkCmdDrawIndexedIndirect"))
-        return (PFN_vkVoidFunction)vkCmdDrawIndexedIndirect;
-    if (!strcmp(funcName, "vkCmdDispatch"))
-        return (PFN_vkVoidFunction)vkCmdDispatch;
-    if (!strcmp(funcName, "vkCmdDispatchIndirect"))
-        return (PFN_vkVoidFunction)vkCmdDispatchIndirect;
-    if (!strcmp(funcName, "vkCmdCopyBuffer"))
-        return (PFN_vkVoidFunction)vkCmdCopyBuffer;
-    if (!strcmp(funcName, "vkCmdCopyImage"))
-        return (PFN_vkVoidFunction)vkCmdCopyImage;
-    if (!strcmp(funcName, "vkCmdBlitImage"))
-        return (PFN_vkVoidFunction)vkCmdBlitImage;
-    if (!strcmp(funcName, "vkCmdCopyBufferToImage"))
-        return (PFN_vkVoidFunction)vkCmdCopyBufferToImage;
-    if (!strcmp(funcName, "vkCmdCopyImageToBuffer"))
-        return (PFN_vkVoidFunction)vkCmdCopyImageToBuffer;
-    if (!strcmp(funcName, "vkCmdUpdateBuffer"))
-        return (PFN_vkVoidFunction)vkCmdUpdateBuffer;
-    if (!strcmp(funcName, "vkCmdFillBuffer"))
-        return (PFN_vkVoidFunction)vkCmdFillBuffer;
-    if (!strcmp(funcName, "vkCmdClearColorImage"))
-        return (PFN_vkVoidFunction)vkCmdClearColorImage;
-    if (!strcmp(funcName, "vkCmdClearDepthStencilImage"))
-        return (PFN_vkVoidFunction)vkCmdClearDepthStencilImage;
-    if (!strcmp(funcName, "vkCmdClearAttachments"))
-        return (PFN_vkVoidFunction)vkCmdClearAttachments;
-    if (!strcmp(funcName, "vkCmdResolveImage"))
-        return (PFN_vkVoidFunction)vkCmdResolveImage;
-    if (!strcmp(funcName, "vkCmdSetEvent"))
-        return (PFN_vkVoidFunction)vkCmdSetEvent;
-    if (!strcmp(funcName, "vkCmdResetEvent"))
-        return (PFN_vkVoidFunction)vkCmdResetEvent;
-    if (!strcmp(funcName, "vkCmdWaitEvents"))
-        return (PFN_vkVoidFunction)vkCmdWaitEvents;
-    if (!strcmp(funcName, "vkCmdPipelineBarrier"))
-        return (PFN_vkVoidFunction)vkCmdPipelineBarrier;
-    if (!strcmp(funcName, "vkCmdBeginQuery"))
-        return (PFN_vkVoidFunction)vkCmdBeginQuery;
-    if (!strcmp(funcName, "vkCmdEndQuery"))
-        return (PFN_vkVoidFunction)vkCmdEndQuery;
-    if (!strcmp(funcName, "vkCmdResetQueryPool"))
-        return (PFN_vkVoidFunction)vkCmdResetQueryPool;
-    if (!strcmp(funcName, "vkCmdCopyQueryPoolResults"))
-        return (PFN_vkVoidFunction)vkCmdCopyQueryPoolResults;
-    if (!strcmp(funcName, "vkCmdPushConstants"))
-        return (PFN_vkVoidFunction)vkCmdPushConstants;
-    if (!strcmp(funcName, "vkCmdWriteTimestamp"))
-        return (PFN_vkVoidFunction)vkCmdWriteTimestamp;
-    if (!strcmp(funcName, "vkCreateFramebuffer"))
-        return (PFN_vkVoidFunction)vkCreateFramebuffer;
-    if (!strcmp(funcName, "vkCreateShaderModule"))
-        return (PFN_vkVoidFunction)vkCreateShaderModule;
-    if (!strcmp(funcName, "vkCreateRenderPass"))
-        return (PFN_vkVoidFunction)vkCreateRenderPass;
-    if (!strcmp(funcName, "vkCmdBeginRenderPass"))
-        return (PFN_vkVoidFunction)vkCmdBeginRenderPass;
-    if (!strcmp(funcName, "vkCmdNextSubpass"))
-        return (PFN_vkVoidFunction)vkCmdNextSubpass;
-    if (!strcmp(funcName, "vkCmdEndRenderPass"))
-        return (PFN_vkVoidFunction)vkCmdEndRenderPass;
-    if (!strcmp(funcName, "vkCmdExecuteCommands"))
-        return (PFN_vkVoidFunction)vkCmdExecuteCommands;
-    if (!strcmp(funcName, "vkSetEvent"))
-        return (PFN_vkVoidFunction)vkSetEvent;
-    if (!strcmp(funcName, "vkMapMemory"))
-        return (PFN_vkVoidFunction)vkMapMemory;
+static const layer_intercept_table device_intercepts = {
+    {"vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(vkGetDeviceProcAddr)},
+    {"vkDestroyDevice", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyDevice)},
+    {"vkQueueSubmit", reinterpret_cast<PFN_vkVoidFunction>(vkQueueSubmit)},
+    {"vkWaitForFences", reinterpret_cast<PFN_vkVoidFunction>(vkWaitForFences)},
+    {"vkGetFenceStatus", reinterpret_cast<PFN_vkVoidFunction>(vkGetFenceStatus)},
+    {"vkQueueWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(vkQueueWaitIdle)},
+    {"vkDeviceWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(vkDeviceWaitIdle)},
+    {"vkGetDeviceQueue", reinterpret_cast<PFN_vkVoidFunction>(vkGetDeviceQueue)},
+    {"vkDestroyInstance", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyInstance)},
+    {"vkDestroyDevice", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyDevice)},
+    {"vkDestroyFence", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyFence)},
+    {"vkResetFences", reinterpret_cast<PFN_vkVoidFunction>(vkResetFences)},
+    {"vkDestroySemaphore", reinterpret_cast<PFN_vkVoidFunction>(vkDestroySemaphore)},
+    {"vkDestroyEvent", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyEvent)},
+    {"vkDestroyQueryPool", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyQueryPool)},
+    {"vkDestroyBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyBuffer)},
+    {"vkDestroyBufferView", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyBufferView)},
+    {"vkDestroyImage", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyImage)},
+    {"vkDestroyImageView", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyImageView)},
+    {"vkDestroyShaderModule", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyShaderModule)},
+    {"vkDestroyPipeline", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyPipeline)},
+    {"vkDestroyPipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyPipelineLayout)},
+    {"vkDestroySampler", reinterpret_cast<PFN_vkVoidFunction>(vkDestroySampler)},
+    {"vkDestroyDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyDescriptorSetLayout)},
+    {"vkDestroyDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyDescriptorPool)},
+    {"vkDestroyFramebuffer", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyFramebuffer)},
+    {"vkDestroyRenderPass", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyRenderPass)},
+    {"vkCreateBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCreateBuffer)},
+    {"vkCreateBufferView", reinterpret_cast<PFN_vkVoidFunction>(vkCreateBufferView)},
+    {"vkCreateImage", reinterpret_cast<PFN_vkVoidFunction>(vkCreateImage)},
+    {"vkCreateImageView", reinterpret_cast<PFN_vkVoidFunction>(vkCreateImageView)},
+    {"vkCreateFence", reinterpret_cast<PFN_vkVoidFunction>(vkCreateFence)},
+    {"vkCreatePipelineCache", reinterpret_cast<PFN_vkVoidFunction>(vkCreatePipelineCache)},
+    {"vkDestroyPipelineCache", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyPipelineCache)},
+    {"vkGetPipelineCacheData", reinterpret_cast<PFN_vkVoidFunction>(vkGetPipelineCacheData)},
+    {"vkMergePipelineCaches", reinterpret_cast<PFN_vkVoidFunction>(vkMergePipelineCaches)},
+    {"vkCreateGraphicsPipelines", reinterpret_cast<PFN_vkVoidFunction>(vkCreateGraphicsPipelines)},
+    {"vkCreateComputePipelines", reinterpret_cast<PFN_vkVoidFunction>(vkCreateComputePipelines)},
+    {"vkCreateSampler", reinterpret_cast<PFN_vkVoidFunction>(vkCreateSampler)},
+    {"vkCreateDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(vkCreateDescriptorSetLayout)},
+    {"vkCreatePipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(vkCreatePipelineLayout)},
+    {"vkCreateDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(vkCreateDescriptorPool)},
+    {"vkResetDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(vkResetDescriptorPool)},
+    {"vkAllocateDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(vkAllocateDescriptorSets)},
+    {"vkFreeDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(vkFreeDescriptorSets)},
+    {"vkUpdateDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(vkUpdateDescriptorSets)},
+    {"vkCreateCommandPool", reinterpret_cast<PFN_vkVoidFunction>(vkCreateCommandPool)},
+    {"vkDestroyCommandPool", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyCommandPool)},
+    {"vkResetCommandPool", reinterpret_cast<PFN_vkVoidFunction>(vkResetCommandPool)},
+    {"vkCreateQueryPool", reinterpret_cast<PFN_vkVoidFunction>(vkCreateQueryPool)},
+    {"vkAllocateCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(vkAllocateCommandBuffers)},
+    {"vkFreeCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(vkFreeCommandBuffers)},
+    {"vkBeginCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkBeginCommandBuffer)},
+    {"vkEndCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkEndCommandBuffer)},
+    {"vkResetCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkResetCommandBuffer)},
+    {"vkCmdBindPipeline", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBindPipeline)},
+    {"vkCmdSetViewport", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetViewport)},
+    {"vkCmdSetScissor", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetScissor)},
+    {"vkCmdSetLineWidth", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetLineWidth)},
+    {"vkCmdSetDepthBias", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetDepthBias)},
+    {"vkCmdSetBlendConstants", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetBlendConstants)},
+    {"vkCmdSetDepthBounds", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetDepthBounds)},
+    {"vkCmdSetStencilCompareMask", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetStencilCompareMask)},
+    {"vkCmdSetStencilWriteMask", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetStencilWriteMask)},
+    {"vkCmdSetStencilReference", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetStencilReference)},
+    {"vkCmdBindDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBindDescriptorSets)},
+    {"vkCmdBindVertexBuffers", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBindVertexBuffers)},
+    {"vkCmdBindIndexBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBindIndexBuffer)},
+    {"vkCmdDraw", reinterpret_cast<PFN_vkVoidFunction>(vkCmdDraw)},
+    {"vkCmdDrawIndexed", reinterpret_cast<PFN_vkVoidFunction>(vkCmdDrawIndexed)},
+    {"vkCmdDrawIndirect", reinterpret_cast<PFN_vkVoidFunction>(vkCmdDrawIndirect)},
+    {"vkCmdDrawIndexedIndirect", reinterpret_cast<PFN_vkVoidFunction>(vkCmdDrawIndexedIndirect)},
+    {"vkCmdDispatch", reinterpret_cast<PFN_vkVoidFunction>(vkCmdDispatch)},
+    {"vkCmdDispatchIndirect", reinterpret_cast<PFN_vkVoidFunction>(vkCmdDispatchIndirect)},
+    {"vkCmdCopyBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCmdCopyBuffer)},
+    {"vkCmdCopyImage", reinterpret_cast<PFN_vkVoidFunction>(vkCmdCopyImage)},
+    {"vkCmdBlitImage", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBlitImage)},
+    {"vkCmdCopyBufferToImage", reinterpret_cast<PFN_vkVoidFunction>(vkCmdCopyBufferToImage)},
+    {"vkCmdCopyImageToBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCmdCopyImageToBuffer)},
+    {"vkCmdUpdateBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCmdUpdateBuffer)},
+    {"vkCmdFillBuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCmdFillBuffer)},
+    {"vkCmdClearColorImage", reinterpret_cast<PFN_vkVoidFunction>(vkCmdClearColorImage)},
+    {"vkCmdClearDepthStencilImage", reinterpret_cast<PFN_vkVoidFunction>(vkCmdClearDepthStencilImage)},
+    {"vkCmdClearAttachments", reinterpret_cast<PFN_vkVoidFunction>(vkCmdClearAttachments)},
+    {"vkCmdResolveImage", reinterpret_cast<PFN_vkVoidFunction>(vkCmdResolveImage)},
+    {"vkCmdSetEvent", reinterpret_cast<PFN_vkVoidFunction>(vkCmdSetEvent)},
+    {"vkCmdResetEvent", reinterpret_cast<PFN_vkVoidFunction>(vkCmdResetEvent)},
+    {"vkCmdWaitEvents", reinterpret_cast<PFN_vkVoidFunction>(vkCmdWaitEvents)},
+    {"vkCmdPipelineBarrier", reinterpret_cast<PFN_vkVoidFunction>(vkCmdPipelineBarrier)},
+    {"vkCmdBeginQuery", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBeginQuery)},
+    {"vkCmdEndQuery", reinterpret_cast<PFN_vkVoidFunction>(vkCmdEndQuery)},
+    {"vkCmdResetQueryPool", reinterpret_cast<PFN_vkVoidFunction>(vkCmdResetQueryPool)},
+    {"vkCmdCopyQueryPoolResults", reinterpret_cast<PFN_vkVoidFunction>(vkCmdCopyQueryPoolResults)},
+    {"vkCmdPushConstants", reinterpret_cast<PFN_vkVoidFunction>(vkCmdPushConstants)},
+    {"vkCmdWriteTimestamp", reinterpret_cast<PFN_vkVoidFunction>(vkCmdWriteTimestamp)},
+    {"vkCreateFramebuffer", reinterpret_cast<PFN_vkVoidFunction>(vkCreateFramebuffer)},
+    {"vkCreateShaderModule", reinterpret_cast<PFN_vkVoidFunction>(vkCreateShaderModule)},
+    {"vkCreateRenderPass", reinterpret_cast<PFN_vkVoidFunction>(vkCreateRenderPass)},
+    {"vkCmdBeginRenderPass", reinterpret_cast<PFN_vkVoidFunction>(vkCmdBeginRenderPass)},
+    {"vkCmdNextSubpass", reinterpret_cast<PFN_vkVoidFunction>(vkCmdNextSubpass)},
+    {"vkCmdEndRenderPass", reinterpret_cast<PFN_vkVoidFunction>(vkCmdEndRenderPass)},
+    {"vkCmdExecuteCommands", reinterpret_cast<PFN_vkVoidFunction>(vkCmdExecuteCommands)},
+    {"vkSetEvent", reinterpret_cast<PFN_vkVoidFunction>(vkSetEvent)},
+    {"vkMapMemory", reinterpret_cast<PFN_vkVoidFunction>(vkMapMemory)},
 #if MTMERGESOURCE
-    if (!strcmp(funcName, "vkUnmapMemory"))
-        return (PFN_vkVoidFunction)vkUnmapMemory;
-    if (!strcmp(funcName, "vkAllocateMemory"))
-        return (PFN_vkVoidFunction)vkAllocateMemory;
-    if (!strcmp(funcName, "vkFreeMemory"))
-        return (PFN_vkVoidFunction)vkFreeMemory;
-    if (!strcmp(funcName, "vkFlushMappedMemoryRanges"))
-        return (PFN_vkVoidFunction)vkFlushMappedMemoryRanges;
-    if (!strcmp(funcName, "vkInvalidateMappedMemoryRanges"))
-        return (PFN_vkVoidFunction)vkInvalidateMappedMemoryRanges;
-    if (!strcmp(funcName, "vkBindBufferMemory"))
-        return (PFN_vkVoidFunction)vkBindBufferMemory;
-    if (!strcmp(funcName, "vkGetBufferMemoryRequirements"))
-        return (PFN_vkVoidFunction)vkGetBufferMemoryRequirements;
-    if (!strcmp(funcName, "vkGetImageMemoryRequirements"))
-        return (PFN_vkVoidFunction)vkGetImageMemoryRequirements;
+    {"vkUnmapMemory", reinterpret_cast<PFN_vkVoidFunction>(vkUnmapMemory)},
+    {"vkAllocateMemory", reinterpret_cast<PFN_vkVoidFunction>(vkAllocateMemory)},
+    {"vkFreeMemory", reinterpret_cast<PFN_vkVoidFunction>(vkFreeMemory)},
+    {"vkFlushMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(vkFlushMappedMemoryRanges)},
+    {"vkInvalidateMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(vkInvalidateMappedMemoryRanges)},
+    {"vkBindBufferMemory", reinterpret_cast<PFN_vkVoidFunction>(vkBindBufferMemory)},
+    {"vkGetBufferMemoryRequirements", reinterpret_cast<PFN_vkVoidFunction>(vkGetBufferMemoryRequirements)},
+    {"vkGetImageMemoryRequirements", reinterpret_cast<PFN_vkVoidFunction>(vkGetImageMemoryRequirements)},
 #endif
-    if (!strcmp(funcName, "vkGetQueryPoolResults"))
-        return (PFN_vkVoidFunction)vkGetQueryPoolResults;
-    if (!strcmp(funcName, "vkBindImageMemory"))
-        return (PFN_vkVoidFunction)vkBindImageMemory;
-    if (!strcmp(funcName, "vkQueueBindSparse"))
-        return (PFN_vkVoidFunction)vkQueueBindSparse;
-    if (!strcmp(funcName, "vkCreateSemaphore"))
-        return (PFN_vkVoidFunction)vkCreateSemaphore;
-    if (!strcmp(funcName, "vkCreateEvent"))
-        return (PFN_vkVoidFunction)vkCreateEvent;
+    {"vkGetQueryPoolResults", reinterpret_cast<PFN_vkVoidFunction>(vkGetQueryPoolResults)},
+    {"vkBindImageMemory", reinterpret_cast<PFN_vkVoidFunction>(vkBindImageMemory)},
+    {"vkQueueBindSparse", reinterpret_cast<PFN_vkVoidFunction>(vkQueueBindSparse)},
+    {"vkCreateSemaphore", reinterpret_cast<PFN_vkVoidFunction>(vkCreateSemaphore)},
+    {"vkCreateEvent", reinterpret_cast<PFN_vkVoidFunction>(vkCreateEvent)},
+};
+
+static const layer_intercept_table wsi_device_intercepts = {
+    {"vkCreateSwapchainKHR", reinterpret_cast<PFN_vkVoidFunction>(vkCreateSwapchainKHR)},
+    {"vkDestroySwapchainKHR", reinterpret_cast<PFN_vkVoidFunction>(vkDestroySwapchainKHR)},
+    {"vkGetSwapchainImagesKHR", reinterpret_cast<PFN_vkVoidFunction>(vkGetSwapchainImagesKHR)},
+    {"vkAcquireNextImageKHR", reinterpret_cast<PFN_vkVoidFunction>(vkAcquireNextImageKHR)},
+    {"vkQueuePresentKHR", reinterpret_cast<PFN_vkVoidFunction>(vkQueuePresentKHR)},
+};
+
+VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice dev, const char *funcName) {
+    PFN_vkVoidFunction addr = device_intercepts.find(funcName);
+    if (addr)
+        return addr;
 
     if (dev == NULL)
         return NULL;
@@ -10595,16 +11359,9 @@ VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkD
     dev_data = get_my_data_ptr(get_dispatch_key(dev), layer_data_map);
 
     if (dev_data->device_extensions.wsi_enabled) {
-        if (!strcmp(funcName, "vkCreateSwapchainKHR"))
-            return (PFN_vkVoidFunction)vkCreateSwapchainKHR;
-        if (!strcmp(funcName, "vkDestroySwapchainKHR"))
-            return (PFN_vkVoidFunction)vkDestroySwapchainKHR;
-        if (!strcmp(funcName, "vkGetSwapchainImagesKHR"))
-            return (PFN_vkVoidFunction)vkGetSwapchainImagesKHR;
-        if (!strcmp(funcName, "vkAcquireNextImageKHR"))
-            return (PFN_vkVoidFunction)vkAcquireNextImageKHR;
-        if (!strcmp(funcName, "vkQueuePresentKHR"))
-            return (PFN_vkVoidFunction)vkQueuePresentKHR;
+        addr = wsi_device_intercepts.find(funcName);
+        if (addr)
+            return addr;
     }
 
     VkLayerDispatchTable *pTable = dev_data->device_dispatch_table;
@@ -10615,25 +11372,22 @@ VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkD
     }
 }
 
+static const layer_intercept_table instance_intercepts = {
+    {"vkGetInstanceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(vkGetInstanceProcAddr)},
+    {"vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(vkGetDeviceProcAddr)},
+    {"vkCreateInstance", reinterpret_cast<PFN_vkVoidFunction>(vkCreateInstance)},
+    {"vkCreateDevice", reinterpret_cast<PFN_vkVoidFunction>(vkCreateDevice)},
+    {"vkDestroyInstance", reinterpret_cast<PFN_vkVoidFunction>(vkDestroyInstance)},
+    {"vkEnumerateInstanceLayerProperties", reinterpret_cast<PFN_vkVoidFunction>(vkEnumerateInstanceLayerProperties)},
+    {"vkEnumerateInstanceExtensionProperties", reinterpret_cast<PFN_vkVoidFunction>(vkEnumerateInstanceExtensionProperties)},
+    {"vkEnumerateDeviceLayerProperties", reinterpret_cast<PFN_vkVoidFunction>(vkEnumerateDeviceLayerProperties)},
+    {"vkEnumerateDeviceExtensionProperties", reinterpret_cast<PFN_vkVoidFunction>(vkEnumerateDeviceExtensionProperties)},
+};
+
 VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(VkInstance instance, const char *funcName) {
-    if (!strcmp(funcName, "vkGetInstanceProcAddr"))
-        return (PFN_vkVoidFunction)vkGetInstanceProcAddr;
-    if (!strcmp(funcName, "vkGetDeviceProcAddr"))
-        return (PFN_vkVoidFunction)vkGetDeviceProcAddr;
-    if (!strcmp(funcName, "vkCreateInstance"))
-        return (PFN_vkVoidFunction)vkCreateInstance;
-    if (!strcmp(funcName, "vkCreateDevice"))
-        return (PFN_vkVoidFunction)vkCreateDevice;
-    if (!strcmp(funcName, "vkDestroyInstance"))
-        return (PFN_vkVoidFunction)vkDestroyInstance;
-    if (!strcmp(funcName, "vkEnumerateInstanceLayerProperties"))
-        return (PFN_vkVoidFunction)vkEnumerateInstanceLayerProperties;
-    if (!strcmp(funcName, "vkEnumerateInstanceExtensionProperties"))
-        return (PFN_vkVoidFunction)vkEnumerateInstanceExtensionProperties;
-    if (!strcmp(funcName, "vkEnumerateDeviceLayerProperties"))
-        return (PFN_vkVoidFunction)vkEnumerateDeviceLayerProperties;
-    if (!strcmp(funcName, "vkEnumerateDeviceExtensionProperties"))
-        return (PFN_vkVoidFunction)vkEnumerateDeviceExtensionProperties;
+    PFN_vkVoidFunction addr = instance_intercepts.find(funcName);
+    if (addr)
+        return addr;
 
     if (instance == NULL)
         return NULL;
@@ -48,10 +48,14 @@
 #pragma once
 #include "core_validation_error_enums.h"
 #include "descriptor_sets.h"
+#include "image_layout_map.h"
+#include "memory_range_tree.h"
 #include "vk_layer_logging.h"
+#include "vk_layer_rw_lock.h"
 #include "vk_safe_struct.h"
 #include "vulkan/vk_layer.h"
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <unordered_map>
@@ -118,13 +122,6 @@ namespace std {
     };
 }
 
-struct MEMORY_RANGE {
-    uint64_t handle;
-    VkDeviceMemory memory;
-    VkDeviceSize start;
-    VkDeviceSize end;
-};
-
 // Data struct for tracking memory object
 struct DEVICE_MEM_INFO {
     void *object;      // Dispatchable object used to create this memory (device of swapchain)
@@ -133,11 +130,17 @@ struct DEVICE_MEM_INFO {
     VkMemoryAllocateInfo allocInfo;
     unordered_set<MT_OBJ_HANDLE_TYPE> objBindings; // objects bound to this memory
     unordered_set<VkCommandBuffer> commandBufferBindings; // cmd buffers referencing this memory
-    vector<MEMORY_RANGE> bufferRanges;
-    vector<MEMORY_RANGE> imageRanges;
+    MEMORY_RANGE_TREE bufferRanges;
+    MEMORY_RANGE_TREE imageRanges;
     VkImage image; // If memory is bound to image, this will have VkImage handle, else VK_NULL_HANDLE
     MemRange memRange;
     void *pData, *pDriverData;
+    // Layout of the shadow copy at pData handed out when non-coherent memory is mapped:
+    //  [guard pages][fill][app data][fill][guard pages]
+    VkDeviceSize shadowSize; // Bytes mapped, with VK_WHOLE_SIZE resolved
+    size_t shadowPad;        // Offset of the app's pointer from pData
+    size_t shadowGuardSize;  // Bytes of inaccessible pages at each end, 0 for a malloc'd copy
+    size_t shadowAllocSize;  // Total bytes at pData
 };
 
 struct MT_FB_ATTACHMENT_INFO {
@@ -268,23 +271,28 @@ class IMAGE_NODE : public BASE_NODE {
     bool valid; // If this is a swapchain image backing memory track valid here as it doesn't have DEVICE_MEM_INFO
     VkDeviceSize memOffset;
     VkDeviceSize memSize;
+    // Layout of each subresource after the command buffers submitted so far. VK_IMAGE_LAYOUT_MAX_ENUM marks subresources
+    //  no submitted command buffer has used yet, which are still in createInfo.initialLayout.
+    SUBRESOURCE_LAYOUT_MAP<VkImageLayout> layouts;
 };
 
-typedef struct _IMAGE_LAYOUT_NODE {
-    VkImageLayout layout;
-    VkFormat format;
-} IMAGE_LAYOUT_NODE;
-
 class IMAGE_CMD_BUF_LAYOUT_NODE {
   public:
     IMAGE_CMD_BUF_LAYOUT_NODE() {}
     IMAGE_CMD_BUF_LAYOUT_NODE(VkImageLayout initialLayoutInput, VkImageLayout layoutInput)
         : initialLayout(initialLayoutInput), layout(layoutInput) {}
 
+    bool operator==(const IMAGE_CMD_BUF_LAYOUT_NODE &other) const {
+        return initialLayout == other.initialLayout && layout == other.layout;
+    }
+
     VkImageLayout initialLayout;
     VkImageLayout layout;
 };
 
+// Layouts of one image within a command buffer
+typedef SUBRESOURCE_LAYOUT_MAP<IMAGE_CMD_BUF_LAYOUT_NODE> CB_IMAGE_LAYOUT_MAP;
+
 class BUFFER_NODE : public BASE_NODE {
   public:
     using BASE_NODE::in_use;
@@ -350,19 +358,19 @@ class FENCE_NODE : public BASE_NODE {
     bool firstTimeFlag;       // Fence was created in signaled state, avoid warnings for first use
     VkFenceCreateInfo createInfo;
     VkQueue queue;
-    vector<VkCommandBuffer> cmdBuffers;
+    uint64_t seq; // Submission on queue that signals this fence
     bool needsSignaled;
-    vector<VkFence> priorFences;
 
     // Default constructor
-    FENCE_NODE() : queue(VK_NULL_HANDLE), needsSignaled(false){};
+    FENCE_NODE() : queue(VK_NULL_HANDLE), seq(0), needsSignaled(false){};
 };
 
 class SEMAPHORE_NODE : public BASE_NODE {
   public:
     using BASE_NODE::in_use;
     bool signaled;
-    VkQueue queue;
+    VkQueue queue; // Queue whose submission seq signals this semaphore, or VK_NULL_HANDLE
+    uint64_t seq;
 };
 
 class EVENT_NODE : public BASE_NODE {
@@ -372,16 +380,36 @@ class EVENT_NODE : public BASE_NODE {
     VkPipelineStageFlags stageMask;
 };
 
+// A wait on a semaphore that submission seq on queue signals
+struct SEMAPHORE_WAIT {
+    VkSemaphore semaphore;
+    VkQueue queue;
+    uint64_t seq;
+};
+
+// One batch of work submitted to a queue: its command buffers (secondaries included), the
+//  semaphores it waits on and the fence signaled once it completes, if any
+struct CB_SUBMISSION {
+    CB_SUBMISSION(vector<VkCommandBuffer> const &cbs, vector<SEMAPHORE_WAIT> const &waitSemaphores, VkFence fence)
+        : cbs(cbs), waitSemaphores(waitSemaphores), fence(fence) {}
+    vector<VkCommandBuffer> cbs;
+    vector<SEMAPHORE_WAIT> waitSemaphores;
+    VkFence fence;
+};
+
+// Each submission to a queue gets the next sequence number.  Submissions up to and including
+//  seq have retired; submissions holds the rest in order, so the front one is number seq + 1.
 class QUEUE_NODE {
   public:
+    QUEUE_NODE() : device(VK_NULL_HANDLE), seq(0) {}
     VkDevice device;
-    vector<VkFence> lastFences;
+    uint64_t seq;
+    std::deque<CB_SUBMISSION> submissions;
 #if MTMERGE
     // MTMTODO : merge cmd_buffer data structs here
     list<VkCommandBuffer> pQueueCommandBuffers;
     list<VkDeviceMemory> pMemRefList;
 #endif
-    vector<VkCommandBuffer> untrackedCmdBuffers;
     unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
 };
 
@@ -546,35 +574,6 @@ typedef struct stencil_data {
 
 typedef struct _DRAW_DATA { vector<VkBuffer> buffers; } DRAW_DATA;
 
-struct ImageSubresourcePair {
-    VkImage image;
-    bool hasSubresource;
-    VkImageSubresource subresource;
-};
-
-bool operator==(const ImageSubresourcePair &img1, const ImageSubresourcePair &img2) {
-    if (img1.image != img2.image || img1.hasSubresource != img2.hasSubresource)
-        return false;
-    return !img1.hasSubresource ||
-           (img1.subresource.aspectMask == img2.subresource.aspectMask && img1.subresource.mipLevel == img2.subresource.mipLevel &&
-            img1.subresource.arrayLayer == img2.subresource.arrayLayer);
-}
-
-namespace std {
-template <> struct hash<ImageSubresourcePair> {
-    size_t operator()(ImageSubresourcePair img) const throw() {
-        size_t hashVal = hash<uint64_t>()(reinterpret_cast<uint64_t &>(img.image));
-        hashVal ^= hash<bool>()(img.hasSubresource);
-        if (img.hasSubresource) {
-            hashVal ^= hash<uint32_t>()(reinterpret_cast<uint32_t &>(img.subresource.aspectMask));
-            hashVal ^= hash<uint32_t>()(img.subresource.mipLevel);
-            hashVal ^= hash<uint32_t>()(img.subresource.arrayLayer);
-        }
-        return hashVal;
-    }
-};
-}
-
 struct QueryObject {
     VkQueryPool pool;
     uint32_t index;
@@ -591,6 +590,19 @@ template <> struct hash<QueryObject> {
     }
 };
 }
+// Last bound dirty -- bound state that changed since the draw time checks on it last passed
+typedef VkFlags LastBoundDirtyFlags;
+typedef enum _LastBoundDirtyFlagBits {
+    // clang-format off
+    LAST_BOUND_DIRTY_NONE            = 0x00000000,   // Draw time checks are up to date
+    LAST_BOUND_DIRTY_PIPELINE        = 0x00000001,   // A different pipeline has been bound
+    LAST_BOUND_DIRTY_DESCRIPTOR_SETS = 0x00000002,   // Bound descriptor sets or their contents changed
+    LAST_BOUND_DIRTY_DYNAMIC_OFFSETS = 0x00000004,   // Dynamic offsets have been bound
+    LAST_BOUND_DIRTY_DYNAMIC_STATE   = 0x00000008,   // Dynamic state has been set
+    LAST_BOUND_DIRTY_ALL             = 0x0000000F,   // Everything must be checked
+    // clang-format on
+} LastBoundDirtyFlagBits;
+
 // Track last states that are bound per pipeline bind point (Gfx & Compute)
 struct LAST_BOUND_STATE {
     VkPipeline pipeline;
@@ -602,12 +614,21 @@ struct LAST_BOUND_STATE {
     vector<VkDescriptorSet> boundDescriptorSets;
     // one dynamic offset per dynamic descriptor bound to this CB
     vector<uint32_t> dynamicOffsets;
+    // What changed since the draw time checks last passed, and the device's drawStateGeneration then. Draws
+    //  only redo the checks whose inputs are dirty.
+    LastBoundDirtyFlags dirty;
+    uint64_t validatedGeneration;
+    // Bound sets the pipeline uses and the bindings it uses in each, as of the last descriptor set check
+    vector<std::pair<SET_NODE *, unordered_set<uint32_t>>> activeSetBindingsPairs;
     void reset() {
         pipeline = VK_NULL_HANDLE;
         pipelineLayout = VK_NULL_HANDLE;
         uniqueBoundSets.clear();
         boundDescriptorSets.clear();
         dynamicOffsets.clear();
+        dirty = LAST_BOUND_DIRTY_ALL;
+        validatedGeneration = 0;
+        activeSetBindingsPairs.clear();
     }
 };
 // Cmd Buffer Wrapper Struct
@@ -659,11 +680,18 @@ struct GLOBAL_CB_NODE : public BASE_NODE {
     unordered_map<QueryObject, bool> queryToStateMap; // 0 is unavailable, 1 is available
     unordered_set<QueryObject> activeQueries;
     unordered_set<QueryObject> startedQueries;
-    unordered_map<ImageSubresourcePair, IMAGE_CMD_BUF_LAYOUT_NODE> imageLayoutMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
+    // Layouts of the subresources of each image the recorded commands use. Subresources they have not used yet are
+    //  {VK_IMAGE_LAYOUT_MAX_ENUM, VK_IMAGE_LAYOUT_MAX_ENUM}; at submit the rest are checked against and applied to
+    //  IMAGE_NODE::layouts.
+    unordered_map<VkImage, CB_IMAGE_LAYOUT_MAP> imageLayoutMap;
     unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
     vector<DRAW_DATA> drawData;
     DRAW_DATA currentDrawData;
+    // Buffer, descriptor set and event nodes referenced by the recorded commands, each once, gathered
+    //  when recording ends so submit and retirement adjust in_use without looking anything up. Only
+    //  valid while inFlightResourceGeneration matches the device's stateNodeGeneration.
+    vector<BASE_NODE *> inFlightResources;
+    uint64_t inFlightResourceGeneration;
     VkCommandBuffer primaryCommandBuffer;
     // Track images and buffers that are updated by this CB at the point of a draw
     unordered_set<VkImageView> updateImages;
@@ -0,0 +1,104 @@
+/* Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CORE_VALIDATION_IMAGE_LAYOUT_MAP_H_
+#define CORE_VALIDATION_IMAGE_LAYOUT_MAP_H_
+
+#include "vulkan/vulkan.h"
+#include <stdint.h>
+#include <vector>
+
+/*
+ * SUBRESOURCE_LAYOUT_MAP
+ *
+ * One value per subresource of an image, for each of the color, depth, stencil
+ *  and metadata aspects.  Aspect i is the one whose VkImageAspectFlagBits is
+ *  1 << i.  An aspect whose subresources all hold the same value stores just
+ *  that value; it only gets an array, indexed by mipLevel * arrayLayers +
+ *  arrayLayer, once part of it is set on its own.  Setting the whole aspect
+ *  at once drops the array again but keeps its capacity.
+ */
+template <typename T> class SUBRESOURCE_LAYOUT_MAP {
+  public:
+    static const uint32_t ASPECT_COUNT = 4;
+
+    SUBRESOURCE_LAYOUT_MAP() : levels_(0), layers_(0) {}
+
+    // Size the map for an image and put every subresource of every aspect in value
+    void init(uint32_t levels, uint32_t layers, const T &value) {
+        levels_ = levels;
+        layers_ = layers;
+        for (uint32_t aspect = 0; aspect < ASPECT_COUNT; ++aspect) {
+            uniform_[aspect] = value;
+            values_[aspect].clear();
+        }
+    }
+
+    uint32_t levels() const { return levels_; }
+    uint32_t layers() const { return layers_; }
+
+    bool contains(uint32_t level, uint32_t layer) const { return level < levels_ && layer < layers_; }
+
+    // Whether the levels and layers given cover every subresource
+    bool covers(uint32_t baseLevel, uint32_t levelCount, uint32_t baseLayer, uint32_t layerCount) const {
+        return baseLevel == 0 && baseLayer == 0 && levelCount >= levels_ && layerCount >= layers_;
+    }
+
+    // Whether every subresource of each aspect in aspectMask holds that aspect's uniform value
+    bool isUniform(VkImageAspectFlags aspectMask) const {
+        for (uint32_t aspect = 0; aspect < ASPECT_COUNT; ++aspect) {
+            if ((aspectMask & (1u << aspect)) && !values_[aspect].empty())
+                return false;
+        }
+        return true;
+    }
+
+    const T &uniformValue(uint32_t aspect) const { return uniform_[aspect]; }
+
+    // Only valid for contained subresources
+    const T &get(uint32_t aspect, uint32_t level, uint32_t layer) const {
+        const std::vector<T> &values = values_[aspect];
+        return values.empty() ? uniform_[aspect] : values[level * layers_ + layer];
+    }
+
+    // Only valid for contained subresources
+    void set(uint32_t aspect, uint32_t level, uint32_t layer, const T &value) {
+        std::vector<T> &values = values_[aspect];
+        if (values.empty()) {
+            if (uniform_[aspect] == value)
+                return;
+            if (levels_ * layers_ == 1) {
+                uniform_[aspect] = value;
+                return;
+            }
+            values.assign(levels_ * layers_, uniform_[aspect]);
+        }
+        values[level * layers_ + layer] = value;
+    }
+
+    void setAll(uint32_t aspect, const T &value) {
+        values_[aspect].clear();
+        uniform_[aspect] = value;
+    }
+
+  private:
+    uint32_t levels_;
+    uint32_t layers_;
+    T uniform_[ASPECT_COUNT];
+    std::vector<T> values_[ASPECT_COUNT];
+};
+
+#endif // CORE_VALIDATION_IMAGE_LAYOUT_MAP_H_
@@ -0,0 +1,228 @@
+/* Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CORE_VALIDATION_MEMORY_RANGE_TREE_H_
+#define CORE_VALIDATION_MEMORY_RANGE_TREE_H_
+
+#include "vulkan/vulkan.h"
+#include <algorithm>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// Inclusive [start, end] byte range of a VkDeviceMemory bound to one object
+struct MEMORY_RANGE {
+    uint64_t handle;
+    VkDeviceMemory memory;
+    VkDeviceSize start;
+    VkDeviceSize end;
+};
+
+/*
+ * MEMORY_RANGE_TREE
+ *
+ * Set of the ranges bound to one memory object, kept in an AVL tree ordered on
+ *  (start, handle) where each node also records the largest end in its subtree.
+ *  Insert and remove are O(log n); an overlap query is O(log n + k) for k hits,
+ *  so binding many sub-allocations into one large VkDeviceMemory no longer
+ *  scans every range already bound to it.
+ *
+ * Nodes live in a vector and refer to each other by index so the whole tree
+ *  can be copied along with the DEVICE_MEM_INFO that owns it.
+ */
+class MEMORY_RANGE_TREE {
+  public:
+    MEMORY_RANGE_TREE() : root_(NIL), free_(NIL) {}
+
+    size_t size() const { return starts_.size(); }
+    bool empty() const { return starts_.empty(); }
+
+    // Add a range.  An object binds at most one range per memory, so a second
+    //  insert for the same handle replaces the first.
+    void insert(const MEMORY_RANGE &range) {
+        erase(range.handle);
+        starts_[range.handle] = range.start;
+        root_ = insert(root_, range);
+    }
+
+    // Remove the range bound for handle, if any
+    void erase(uint64_t handle) {
+        auto it = starts_.find(handle);
+        if (it == starts_.end())
+            return;
+        root_ = erase(root_, it->second, handle);
+        starts_.erase(it);
+    }
+
+    // Call fn(range) for every range intersecting the inclusive [lo, hi]
+    template <typename Fn> void for_each_overlap(VkDeviceSize lo, VkDeviceSize hi, Fn fn) const {
+        for_each_overlap(root_, lo, hi, fn);
+    }
+
+  private:
+    static const uint32_t NIL = UINT32_MAX;
+
+    struct NODE {
+        MEMORY_RANGE range;
+        VkDeviceSize max_end;
+        uint32_t left;
+        uint32_t right;
+        int32_t height;
+    };
+
+    static bool less(VkDeviceSize start_a, uint64_t handle_a, VkDeviceSize start_b, uint64_t handle_b) {
+        return start_a < start_b || (start_a == start_b && handle_a < handle_b);
+    }
+
+    int32_t height(uint32_t n) const { return n == NIL ? 0 : nodes_[n].height; }
+
+    void update(uint32_t n) {
+        NODE &node = nodes_[n];
+        node.height = 1 + std::max(height(node.left), height(node.right));
+        node.max_end = node.range.end;
+        if (node.left != NIL)
+            node.max_end = std::max(node.max_end, nodes_[node.left].max_end);
+        if (node.right != NIL)
+            node.max_end = std::max(node.max_end, nodes_[node.right].max_end);
+    }
+
+    uint32_t rotate_right(uint32_t n) {
+        uint32_t l = nodes_[n].left;
+        nodes_[n].left = nodes_[l].right;
+        nodes_[l].right = n;
+        update(n);
+        update(l);
+        return l;
+    }
+
+    uint32_t rotate_left(uint32_t n) {
+        uint32_t r = nodes_[n].right;
+        nodes_[n].right = nodes_[r].left;
+        nodes_[r].left = n;
+        update(n);
+        update(r);
+        return r;
+    }
+
+    uint32_t balance(uint32_t n) {
+        update(n);
+        int32_t diff = height(nodes_[n].left) - height(nodes_[n].right);
+        if (diff > 1) {
+            uint32_t l = nodes_[n].left;
+            if (height(nodes_[l].left) < height(nodes_[l].right))
+                nodes_[n].left = rotate_left(l);
+            return rotate_right(n);
+        }
+        if (diff < -1) {
+            uint32_t r = nodes_[n].right;
+            if (height(nodes_[r].right) < height(nodes_[r].left))
+                nodes_[n].right = rotate_right(r);
+            return rotate_left(n);
+        }
+        return n;
+    }
+
+    uint32_t new_node(const MEMORY_RANGE &range) {
+        uint32_t n;
+        if (free_ != NIL) {
+            n = free_;
+            free_ = nodes_[n].left;
+        } else {
+            n = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        NODE &node = nodes_[n];
+        node.range = range;
+        node.max_end = range.end;
+        node.left = NIL;
+        node.right = NIL;
+        node.height = 1;
+        return n;
+    }
+
+    void free_node(uint32_t n) {
+        nodes_[n].left = free_;
+        free_ = n;
+    }
+
+    uint32_t insert(uint32_t n, const MEMORY_RANGE &range) {
+        if (n == NIL)
+            return new_node(range);
+        if (less(range.start, range.handle, nodes_[n].range.start, nodes_[n].range.handle)) {
+            uint32_t child = insert(nodes_[n].left, range);
+            nodes_[n].left = child;
+        } else {
+            uint32_t child = insert(nodes_[n].right, range);
+            nodes_[n].right = child;
+        }
+        return balance(n);
+    }
+
+    // Unlink the leftmost node below n, returning it through min
+    uint32_t erase_min(uint32_t n, uint32_t *min) {
+        if (nodes_[n].left == NIL) {
+            *min = n;
+            return nodes_[n].right;
+        }
+        uint32_t child = erase_min(nodes_[n].left, min);
+        nodes_[n].left = child;
+        return balance(n);
+    }
+
+    uint32_t erase(uint32_t n, VkDeviceSize start, uint64_t handle) {
+        if (n == NIL)
+            return NIL;
+        const MEMORY_RANGE &here = nodes_[n].range;
+        if (less(start, handle, here.start, here.handle)) {
+            uint32_t child = erase(nodes_[n].left, start, handle);
+            nodes_[n].left = child;
+        } else if (less(here.start, here.handle, start, handle)) {
+            uint32_t child = erase(nodes_[n].right, start, handle);
+            nodes_[n].right = child;
+        } else {
+            uint32_t left = nodes_[n].left;
+            uint32_t right = nodes_[n].right;
+            free_node(n);
+            if (right == NIL)
+                return left;
+            uint32_t min;
+            right = erase_min(right, &min);
+            nodes_[min].left = left;
+            nodes_[min].right = right;
+            return balance(min);
+        }
+        return balance(n);
+    }
+
+    template <typename Fn> void for_each_overlap(uint32_t n, VkDeviceSize lo, VkDeviceSize hi, Fn &fn) const {
+        if (n == NIL || nodes_[n].max_end < lo)
+            return;
+        const NODE &node = nodes_[n];
+        for_each_overlap(node.left, lo, hi, fn);
+        if (node.range.start > hi)
+            return;
+        if (node.range.end >= lo)
+            fn(node.range);
+        for_each_overlap(node.right, lo, hi, fn);
+    }
+
+    std::vector<NODE> nodes_;
+    std::unordered_map<uint64_t, VkDeviceSize> starts_; // handle -> start, to find a node on removal
+    uint32_t root_;
+    uint32_t free_; // Head of the free list, chained through NODE::left
+};
+
+#endif // CORE_VALIDATION_MEMORY_RANGE_TREE_H_
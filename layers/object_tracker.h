@@ -92,7 +92,7 @@ struct instExts {
 };
 
 static std::unordered_map<void *, struct instExts> instanceExtMap;
-static std::unordered_map<void *, layer_data *> layer_data_map;
+static dispatch_key_map<layer_data> layer_data_map;
 static device_table_map object_tracker_device_table_map;
 static instance_table_map object_tracker_instance_table_map;
 
@@ -113,7 +113,7 @@ static uint64_t numTotalObjs = 0;
 static VkQueueFamilyProperties *queueInfo = NULL;
 static uint32_t queueCount = 0;
 
-template layer_data *get_my_data_ptr<layer_data>(void *data_key, std::unordered_map<void *, layer_data *> &data_map);
+template layer_data *get_my_data_ptr<layer_data>(void *data_key, dispatch_key_map<layer_data> &data_map);
 
 //
 // Internal Object Tracker Functions
@@ -20,11 +20,15 @@
 
 #ifndef THREADING_H
 #define THREADING_H
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 #include "vk_layer_config.h"
 #include "vk_layer_logging.h"
+#include "vk_layer_rw_lock.h"
 
 #if defined(__LP64__) || defined(_WIN64) || defined(__x86_64__) || defined(_M_X64) || defined(__ia64) || defined(_M_IA64) ||       \
     defined(__aarch64__) || defined(__powerpc64__)
@@ -40,151 +44,208 @@ typedef enum _THREADING_CHECKER_ERROR {
     THREADING_CHECKER_SINGLE_THREAD_REUSE, // Object used simultaneously by recursion in single thread
 } THREADING_CHECKER_ERROR;
 
+// Use of one object.  The counts and the thread that recorded the use are
+// packed in one word so the uncontended start and finish are a single
+// compare-and-swap each:
+//   bits  0-15 reader count
+//   bits 16-31 writer count
+//   bits 32-63 tag of the recorded thread (see get_thread_tag)
+// thread holds the platform id matching the tag, for messages only.
 struct object_use_data {
-    loader_platform_thread_id thread;
-    int reader_count;
-    int writer_count;
+    std::atomic<uint64_t> state;
+    std::atomic<loader_platform_thread_id> thread;
+    object_use_data() : state(0), thread() {}
 };
 
-struct layer_data;
+static const uint64_t USE_READER = 1;
+static const uint64_t USE_WRITER = 1 << 16;
+static const uint64_t USE_READER_MASK = 0xffff;
+static const uint64_t USE_WRITER_MASK = 0xffff0000;
+static const uint64_t USE_COUNT_MASK = USE_READER_MASK | USE_WRITER_MASK;
+
+static inline uint32_t use_thread_tag(uint64_t state) { return static_cast<uint32_t>(state >> 32); }
+static inline uint64_t use_with_thread_tag(uint64_t state, uint32_t tag) {
+    return (state & USE_COUNT_MASK) | (static_cast<uint64_t>(tag) << 32);
+}
 
-static std::mutex global_lock;
-static std::condition_variable global_condition;
+// Small nonzero id for the calling thread, so it fits beside the counts
+static std::atomic<uint32_t> next_thread_tag(1);
+static THREAD_LOCAL_DECL uint32_t thread_tag;
+static inline uint32_t get_thread_tag() {
+    if (thread_tag == 0)
+        thread_tag = next_thread_tag++;
+    return thread_tag;
+}
+
+struct layer_data;
 
 template <typename T> class counter {
   public:
     const char *typeName;
     VkDebugReportObjectTypeEXT objectType;
-    std::unordered_map<T, object_use_data> uses;
-    void startWrite(debug_report_data *report_data, T object) {
-        bool skipCall = false;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
-        std::unique_lock<std::mutex> lock(global_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record writer thread.
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 0;
-            use_data->writer_count = 1;
-            use_data->thread = tid;
-        } else {
-            struct object_use_data *use_data = &uses[object];
-            if (use_data->reader_count == 0) {
-                // There are no readers.  Two writers just collided.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            global_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *use_data = &uses[object];
-                        use_data->thread = tid;
-                        use_data->reader_count = 0;
-                        use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
-                }
+
+    void startWrite(debug_report_data *report_data, T object) { start(report_data, object, true); }
+    void finishWrite(T object) { finish(object, USE_WRITER); }
+    void startRead(debug_report_data *report_data, T object) { start(report_data, object, false); }
+    void finishRead(T object) { finish(object, USE_READER); }
+
+    counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
+        typeName = name;
+        objectType = type;
+    }
+
+  private:
+    // Objects are spread over shards so that threads using unrelated objects
+    // never share a lock.  Lookups hold the shard lock shared; it is only
+    // taken exclusively to add an object or to drop unused ones.
+    static const size_t SHARD_COUNT = 32;
+    static const size_t MIN_PRUNE_SIZE = 64;
+    struct shard {
+        rw_lock lock;
+        std::unordered_map<T, std::unique_ptr<object_use_data>> uses;
+        size_t prune_size;
+        // Only threads waiting out a reported collision block here
+        std::mutex wait_lock;
+        std::condition_variable condition;
+        std::atomic<uint32_t> waiters;
+        shard() : prune_size(MIN_PRUNE_SIZE), waiters(0) {}
+    };
+    shard shards[SHARD_COUNT];
+
+    // Handles are often aligned pointers, so mix the hash before picking a shard
+    shard &shard_for(T object) {
+        uint64_t h = static_cast<uint64_t>(std::hash<T>()(object)) * 0x9e3779b97f4a7c15ull;
+        return shards[(h >> 32) % SHARD_COUNT];
+    }
+
+    // Apply one start of a use to *use.  Returns false, leaving the use alone,
+    // if another thread holds it in a conflicting way and unsafe is not set;
+    // other_thread is then the thread to report.
+    bool try_start(object_use_data *use, bool write, bool unsafe, loader_platform_thread_id tid,
+                   loader_platform_thread_id *other_thread) {
+        const uint32_t tag = get_thread_tag();
+        uint64_t cur = use->state.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t next;
+            bool record_thread = false;
+            if ((cur & USE_COUNT_MASK) == 0) {
+                // There is no current use of the object.  Record this thread.
+                next = use_with_thread_tag(write ? USE_WRITER : USE_READER, tag);
+                record_thread = true;
+            } else if (use_thread_tag(cur) == tag) {
+                // This is either safe multiple use in one call, or recursive use.
+                // There is no way to make recursion safe.  Just forge ahead.
+                next = cur + (write ? USE_WRITER : USE_READER);
+            } else if (!write && (cur & USE_WRITER_MASK) == 0) {
+                // There are other readers of the object.  Increase reader count.
+                next = cur + USE_READER;
+            } else if (!unsafe) {
+                *other_thread = use->thread.load(std::memory_order_relaxed);
+                return false;
+            } else if (write) {
+                // Continue with an unsafe use of the object.
+                next = use_with_thread_tag(cur + USE_WRITER, tag);
+                record_thread = true;
             } else {
-                // There are readers.  This writer collided with them.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            global_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *use_data = &uses[object];
-                        use_data->thread = tid;
-                        use_data->reader_count = 0;
-                        use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
-                }
+                next = cur + USE_READER;
+            }
+            if (use->state.compare_exchange_weak(cur, next, std::memory_order_acquire, std::memory_order_relaxed)) {
+                if (record_thread)
+                    use->thread.store(tid, std::memory_order_relaxed);
+                return true;
             }
         }
     }
 
-    void finishWrite(T object) {
-        // Object is no longer in use
-        std::unique_lock<std::mutex> lock(global_lock);
-        uses[object].writer_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+    // Run try_start on object's use with the shard lock held, adding the
+    // object on first use
+    bool locked_try_start(shard &sh, T object, bool write, bool unsafe, loader_platform_thread_id tid,
+                          loader_platform_thread_id *other_thread) {
+        {
+            shared_lock<rw_lock> lock(sh.lock);
+            auto it = sh.uses.find(object);
+            if (it != sh.uses.end())
+                return try_start(it->second.get(), write, unsafe, tid, other_thread);
+        }
+        std::lock_guard<rw_lock> lock(sh.lock);
+        if (sh.uses.size() >= sh.prune_size)
+            prune(sh);
+        std::unique_ptr<object_use_data> &use = sh.uses[object];
+        if (!use)
+            use.reset(new object_use_data);
+        return try_start(use.get(), write, unsafe, tid, other_thread);
+    }
+
+    // Drop objects nobody is using.  Called with the shard lock held exclusively.
+    void prune(shard &sh) {
+        for (auto it = sh.uses.begin(); it != sh.uses.end();) {
+            if ((it->second->state.load(std::memory_order_relaxed) & USE_COUNT_MASK) == 0)
+                it = sh.uses.erase(it);
+            else
+                ++it;
         }
-        // Notify any waiting threads that this object may be safe to use
-        lock.unlock();
-        global_condition.notify_all();
+        const size_t live = sh.uses.size() * 2;
+        sh.prune_size = live > MIN_PRUNE_SIZE ? live : MIN_PRUNE_SIZE;
+    }
+
+    bool in_use(shard &sh, T object) {
+        shared_lock<rw_lock> lock(sh.lock);
+        auto it = sh.uses.find(object);
+        return it != sh.uses.end() && (it->second->state.load() & USE_COUNT_MASK) != 0;
     }
 
-    void startRead(debug_report_data *report_data, T object) {
-        bool skipCall = false;
+    void start(debug_report_data *report_data, T object, bool write) {
         loader_platform_thread_id tid = loader_platform_get_thread_id();
-        std::unique_lock<std::mutex> lock(global_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record reader count
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 1;
-            use_data->writer_count = 0;
-            use_data->thread = tid;
-        } else if (uses[object].writer_count > 0 && uses[object].thread != tid) {
-            // There is a writer of the object.
-            skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld", typeName,
-                                uses[object].thread, tid);
-            if (skipCall) {
-                // Wait for thread-safe access to object instead of skipping call.
-                while (uses.find(object) != uses.end()) {
-                    global_condition.wait(lock);
+        loader_platform_thread_id other_thread;
+        shard &sh = shard_for(object);
+        bool unsafe = false;
+        bool reported = false;
+        while (!locked_try_start(sh, object, write, unsafe, tid, &other_thread)) {
+            if (!reported) {
+                reported = true;
+                bool skipCall = log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
+                                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
+                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
+                                        typeName, other_thread, tid);
+                if (!skipCall) {
+                    // Continue with an unsafe use of the object.
+                    unsafe = true;
+                    continue;
                 }
-                // There is no current use of the object.  Record reader count
-                struct object_use_data *use_data = &uses[object];
-                use_data->reader_count = 1;
-                use_data->writer_count = 0;
-                use_data->thread = tid;
-            } else {
-                uses[object].reader_count += 1;
             }
-        } else {
-            // There are other readers of the object.  Increase reader count
-            uses[object].reader_count += 1;
+            // Wait for thread-safe access to object instead of skipping call.
+            std::unique_lock<std::mutex> lock(sh.wait_lock);
+            sh.waiters++;
+            while (in_use(sh, object)) {
+                sh.condition.wait(lock);
+            }
+            sh.waiters--;
         }
     }
-    void finishRead(T object) {
-        std::unique_lock<std::mutex> lock(global_lock);
-        uses[object].reader_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+
+    void finish(T object, uint64_t unit) {
+        shard &sh = shard_for(object);
+        uint64_t next = 0;
+        {
+            shared_lock<rw_lock> lock(sh.lock);
+            auto it = sh.uses.find(object);
+            if (it == sh.uses.end())
+                return;
+            std::atomic<uint64_t> &state = it->second->state;
+            // Sequentially consistent, so a thread that has just registered as a waiter either
+            //  sees the object free or is seen in waiters below
+            uint64_t cur = state.load(std::memory_order_relaxed);
+            do {
+                next = cur - unit;
+                if ((next & USE_COUNT_MASK) == 0)
+                    next = 0;
+            } while (!state.compare_exchange_weak(cur, next));
+        }
+        // Object is no longer in use.  Notify any waiting threads that it may be safe to use.
+        if (next == 0 && sh.waiters.load() != 0) {
+            { std::lock_guard<std::mutex> lock(sh.wait_lock); }
+            sh.condition.notify_all();
         }
-        // Notify and waiting threads that this object may be safe to use
-        lock.unlock();
-        global_condition.notify_all();
-    }
-    counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
-        typeName = name;
-        objectType = type;
     }
 };
 
@@ -299,40 +360,36 @@ WRAPPER(VkDebugReportCallbackEXT)
 WRAPPER(uint64_t)
 #endif // DISTINCT_NONDISPATCHABLE_HANDLES
 
-static std::unordered_map<void *, layer_data *> layer_data_map;
+static dispatch_key_map<layer_data> layer_data_map;
 static std::unordered_map<VkCommandBuffer, VkCommandPool> command_pool_map;
+// Guards command_pool_map, which is read for every command buffer use
+static rw_lock command_pool_lock;
+
+static VkCommandPool get_command_pool(VkCommandBuffer object) {
+    shared_lock<rw_lock> lock(command_pool_lock);
+    auto it = command_pool_map.find(object);
+    return it == command_pool_map.end() ? VK_NULL_HANDLE : it->second;
+}
 
 // VkCommandBuffer needs check for implicit use of command pool
 static void startWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool = true) {
     if (lockPool) {
-        std::unique_lock<std::mutex> lock(global_lock);
-        VkCommandPool pool = command_pool_map[object];
-        lock.unlock();
-        startWriteObject(my_data, pool);
+        startWriteObject(my_data, get_command_pool(object));
     }
     my_data->c_VkCommandBuffer.startWrite(my_data->report_data, object);
 }
 static void finishWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool = true) {
     my_data->c_VkCommandBuffer.finishWrite(object);
     if (lockPool) {
-        std::unique_lock<std::mutex> lock(global_lock);
-        VkCommandPool pool = command_pool_map[object];
-        lock.unlock();
-        finishWriteObject(my_data, pool);
+        finishWriteObject(my_data, get_command_pool(object));
     }
 }
 static void startReadObject(struct layer_data *my_data, VkCommandBuffer object) {
-    std::unique_lock<std::mutex> lock(global_lock);
-    VkCommandPool pool = command_pool_map[object];
-    lock.unlock();
-    startReadObject(my_data, pool);
+    startReadObject(my_data, get_command_pool(object));
     my_data->c_VkCommandBuffer.startRead(my_data->report_data, object);
 }
 static void finishReadObject(struct layer_data *my_data, VkCommandBuffer object) {
     my_data->c_VkCommandBuffer.finishRead(object);
-    std::unique_lock<std::mutex> lock(global_lock);
-    VkCommandPool pool = command_pool_map[object];
-    lock.unlock();
-    finishReadObject(my_data, pool);
+    finishReadObject(my_data, get_command_pool(object));
 }
 #endif // THREADING_H
@@ -20,6 +20,9 @@
 #ifndef LAYER_DATA_H
 #define LAYER_DATA_H
 
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
 #include <unordered_map>
 #include "vk_layer_table.h"
 
@@ -40,4 +43,100 @@ template <typename DATA_T> DATA_T *get_my_data_ptr(void *data_key, std::unordere
     return debug_data;
 }
 
+/*
+ * dispatch_key_map
+ *
+ * Map from dispatch key to a layer's per-instance or per-device data, for the
+ *  lookup every intercepted call makes.  A process rarely has more than a few
+ *  instances and devices, so a small direct-mapped cache indexed by the key's
+ *  address answers almost every lookup with a few loads and no hashing or
+ *  locking.  Each cache slot is a seqlock: readers retry through the map if a
+ *  writer changed the slot while they read it.  Misses, inserts and erases go
+ *  through the map under a mutex.
+ */
+template <typename DATA_T> class dispatch_key_map {
+  public:
+    dispatch_key_map() {
+        for (uint32_t i = 0; i < CACHE_SIZE; i++) {
+            cache_[i].seq.store(0, std::memory_order_relaxed);
+            cache_[i].key.store(nullptr, std::memory_order_relaxed);
+            cache_[i].data.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    dispatch_key_map(const dispatch_key_map &) = delete;
+    dispatch_key_map &operator=(const dispatch_key_map &) = delete;
+
+    // Data for key, or a newly allocated DATA_T if key has none yet
+    DATA_T *get(void *key) {
+        cache_slot &slot = cache_[slot_index(key)];
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        if (!(seq & 1)) {
+            void *cached_key = slot.key.load(std::memory_order_relaxed);
+            DATA_T *cached_data = slot.data.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (cached_key == key && slot.seq.load(std::memory_order_relaxed) == seq)
+                return cached_data;
+        }
+
+        std::lock_guard<std::mutex> lock(lock_);
+        DATA_T *&data = map_[key];
+        if (!data)
+            data = new DATA_T;
+        fill(slot, key, data);
+        return data;
+    }
+
+    // Forget key.  The data itself is owned, and freed, by the layer.
+    void erase(void *key) {
+        std::lock_guard<std::mutex> lock(lock_);
+        cache_slot &slot = cache_[slot_index(key)];
+        if (slot.key.load(std::memory_order_relaxed) == key)
+            fill(slot, nullptr, nullptr);
+        map_.erase(key);
+    }
+
+    bool empty() {
+        std::lock_guard<std::mutex> lock(lock_);
+        return map_.empty();
+    }
+    size_t size() {
+        std::lock_guard<std::mutex> lock(lock_);
+        return map_.size();
+    }
+
+  private:
+    static const uint32_t CACHE_BITS = 4;
+    static const uint32_t CACHE_SIZE = 1 << CACHE_BITS;
+
+    struct cache_slot {
+        std::atomic<uint32_t> seq; // Odd while a writer is updating the slot
+        std::atomic<void *> key;
+        std::atomic<DATA_T *> data;
+    };
+
+    // Dispatch keys are heap pointers; a multiplicative hash spreads their low bits
+    static uint32_t slot_index(void *key) {
+        uint64_t k = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key));
+        return static_cast<uint32_t>((k * 0x9e3779b97f4a7c15ull) >> (64 - CACHE_BITS));
+    }
+
+    // Called with lock_ held
+    static void fill(cache_slot &slot, void *key, DATA_T *data) {
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    cache_slot cache_[CACHE_SIZE];
+    std::mutex lock_;
+    std::unordered_map<void *, DATA_T *> map_;
+};
+
+template <typename DATA_T> DATA_T *get_my_data_ptr(void *data_key, dispatch_key_map<DATA_T> &layer_data_map) {
+    return layer_data_map.get(data_key);
+}
+
 #endif // LAYER_DATA_H
@@ -31,14 +31,99 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A message as counted by the duplicate message limit: the same code means different things in different layers and
+//  at different severities, so all four have to match for a message to repeat another
+struct debug_report_repeat_key {
+    int32_t msgCode;
+    uint64_t srcObject;
+    VkFlags msgFlags;
+    std::string layerPrefix;
+
+    bool operator==(const debug_report_repeat_key &other) const {
+        return msgCode == other.msgCode && srcObject == other.srcObject && msgFlags == other.msgFlags &&
+               layerPrefix == other.layerPrefix;
+    }
+};
+
+struct debug_report_repeat_key_hash {
+    size_t operator()(const debug_report_repeat_key &key) const {
+        size_t hash = std::hash<uint64_t>()(key.srcObject);
+        hash = hash * 31 + std::hash<int32_t>()(key.msgCode);
+        hash = hash * 31 + std::hash<uint32_t>()(key.msgFlags);
+        return hash * 31 + std::hash<std::string>()(key.layerPrefix);
+    }
+};
+
+typedef struct _debug_report_repeat {
+    VkDebugReportObjectTypeEXT objectType;
+    uint32_t reported;   // times it was passed to the callbacks
+    uint64_t suppressed; // repeats dropped since the last summary of them
+    bool bail;           // what the callbacks returned the last time it was reported
+} debug_report_repeat;
+
+// Messages counted before the counts are reported and forgotten. Handles are recycled once their object is destroyed,
+//  and the layers do not tell the filter when that happens, so this keeps a new object from inheriting the count of an
+//  old one for longer than it takes this many other messages to come along, and keeps the map from growing unbounded.
+#define DEBUG_REPORT_REPEAT_MAX_ENTRIES 65536
+
+// Opt-in limit on how often the same message is reported for the same object. Repeats past the limit are dropped
+//  before they are formatted; a summary of how many were dropped is reported every summary_interval repeats (0 for
+//  none), when the counts are forgotten and when a device or the instance is destroyed.
+typedef struct _debug_report_repeat_filter {
+    uint32_t limit;
+    uint64_t summary_interval;
+    std::mutex lock;
+    std::unordered_map<debug_report_repeat_key, debug_report_repeat, debug_report_repeat_key_hash> repeats;
+} debug_report_repeat_filter;
 
 typedef struct _debug_report_data {
     VkLayerDbgFunctionNode *g_pDbgFunctionHead;
     VkFlags active_flags;
     bool g_DEBUG_REPORT;
+    debug_report_repeat_filter *repeat_filter; // NULL reports every message
 } debug_report_data;
 
+// Messages some callback wanted on this thread, whether reported or dropped as a repeat. A check compares it before and
+//  after to tell whether it logged anything, even when no callback asked for the call to be skipped; other threads'
+//  messages don't count.
+static THREAD_LOCAL_DECL uint64_t debug_report_thread_logged;
+
+// A message logged while its thread was deferring messages, formatted but not yet passed to the callbacks
+struct debug_report_deferred_message {
+    VkFlags msgFlags;
+    VkDebugReportObjectTypeEXT objectType;
+    uint64_t srcObject;
+    size_t location;
+    int32_t msgCode;
+    const char *pLayerPrefix;
+    std::string msg;
+};
+
+// Where log_msg keeps this thread's messages while a debug_report_defer is in scope, NULL otherwise
+static THREAD_LOCAL_DECL std::vector<debug_report_deferred_message> *debug_report_deferred;
+
+// While in scope, the messages logged on this thread are kept in *messages instead of being passed to the callbacks,
+//  and log_msg returns false for them. Checks run on worker threads use it so the caller can pass the messages on
+//  with debug_report_log_deferred, on its own thread and in its own order, and take the callbacks' answers from there.
+class debug_report_defer {
+  public:
+    explicit debug_report_defer(std::vector<debug_report_deferred_message> *messages) : previous_(debug_report_deferred) {
+        debug_report_deferred = messages;
+    }
+    ~debug_report_defer() { debug_report_deferred = previous_; }
+    debug_report_defer(const debug_report_defer &) = delete;
+    debug_report_defer &operator=(const debug_report_defer &) = delete;
+
+  private:
+    std::vector<debug_report_deferred_message> *previous_;
+};
+
 template debug_report_data *get_my_data_ptr<debug_report_data>(void *data_key,
                                                                std::unordered_map<void *, debug_report_data *> &data_map);
 
@@ -60,6 +145,113 @@ static inline bool debug_report_log_msg(debug_report_data *debug_data, VkFlags m
     return bail;
 }
 
+// Report how many repeats of one message were dropped
+static inline bool debug_report_log_suppressed(debug_report_data *debug_data, const debug_report_repeat_key &key,
+                                               VkDebugReportObjectTypeEXT objectType, uint64_t suppressed, uint32_t limit) {
+    char msg[160];
+    snprintf(msg, sizeof(msg), "%" PRIu64 " more repeats of message code %d for this object were suppressed after the first %u.",
+             suppressed, key.msgCode, limit);
+    return debug_report_log_msg(debug_data, key.msgFlags, objectType, key.srcObject, 0, key.msgCode, key.layerPrefix.c_str(),
+                                msg);
+}
+
+typedef std::vector<std::pair<debug_report_repeat_key, debug_report_repeat>> debug_report_pending_repeats;
+
+// Move the counts of dropped repeats not reported yet into pending. The filter's lock must be held.
+static inline void debug_report_take_suppressed(debug_report_repeat_filter *filter, debug_report_pending_repeats *pending) {
+    for (auto &entry : filter->repeats) {
+        if (entry.second.suppressed) {
+            pending->push_back(entry);
+            entry.second.suppressed = 0;
+        }
+    }
+}
+
+// Report counts taken by debug_report_take_suppressed, without the filter's lock held as the callbacks may log
+static inline void debug_report_log_pending(debug_report_data *debug_data, const debug_report_pending_repeats &pending,
+                                            uint32_t limit) {
+    for (auto &entry : pending) {
+        debug_report_log_suppressed(debug_data, entry.first, entry.second.objectType, entry.second.suppressed, limit);
+    }
+}
+
+// Report the repeats dropped by the duplicate message limit that have not been reported yet. Layers call this from
+//  vkDestroyDevice; the counts are kept per instance, so it covers messages about every device of the instance.
+static inline void debug_report_flush_suppressed(debug_report_data *debug_data) {
+    if (!debug_data || !debug_data->repeat_filter) {
+        return;
+    }
+    debug_report_repeat_filter *filter = debug_data->repeat_filter;
+    debug_report_pending_repeats pending;
+    {
+        std::lock_guard<std::mutex> lock(filter->lock);
+        debug_report_take_suppressed(filter, &pending);
+    }
+    debug_report_log_pending(debug_data, pending, filter->limit);
+}
+
+// Turn the duplicate message limit on, or off with a limit of 0
+static inline void debug_report_set_repeat_limit(debug_report_data *debug_data, uint32_t limit, uint64_t summary_interval) {
+    debug_report_flush_suppressed(debug_data);
+    delete debug_data->repeat_filter;
+    debug_data->repeat_filter = NULL;
+    if (limit) {
+        debug_data->repeat_filter = new debug_report_repeat_filter;
+        debug_data->repeat_filter->limit = limit;
+        debug_data->repeat_filter->summary_interval = summary_interval;
+    }
+}
+
+// Count a message against the duplicate message limit. Returns true if it is to be dropped, with *bail set to what the
+//  callbacks returned when it was last reported.
+static inline bool debug_report_suppress_repeat(debug_report_data *debug_data, VkFlags msgFlags,
+                                                VkDebugReportObjectTypeEXT objectType, uint64_t srcObject, int32_t msgCode,
+                                                const char *pLayerPrefix, bool *bail) {
+    debug_report_repeat_filter *filter = debug_data->repeat_filter;
+    debug_report_repeat_key key = {msgCode, srcObject, msgFlags, pLayerPrefix ? pLayerPrefix : ""};
+    std::unique_lock<std::mutex> lock(filter->lock);
+    auto it = filter->repeats.find(key);
+    if (it == filter->repeats.end()) {
+        if (filter->repeats.size() >= DEBUG_REPORT_REPEAT_MAX_ENTRIES) {
+            debug_report_pending_repeats pending;
+            debug_report_take_suppressed(filter, &pending);
+            filter->repeats.clear();
+            lock.unlock();
+            debug_report_log_pending(debug_data, pending, filter->limit);
+            lock.lock();
+        }
+        it = filter->repeats.emplace(key, debug_report_repeat()).first;
+    }
+    debug_report_repeat &repeat = it->second;
+    if (repeat.reported < filter->limit) {
+        repeat.objectType = objectType;
+        repeat.reported++;
+        return false;
+    }
+    *bail = repeat.bail;
+    if (++repeat.suppressed == filter->summary_interval) {
+        const VkDebugReportObjectTypeEXT summaryObjectType = repeat.objectType;
+        const uint64_t suppressed = repeat.suppressed;
+        repeat.suppressed = 0;
+        lock.unlock();
+        debug_report_log_suppressed(debug_data, key, summaryObjectType, suppressed, filter->limit);
+    }
+    return true;
+}
+
+// Remember what the callbacks returned for a message the duplicate message limit let through
+static inline void debug_report_record_repeat(debug_report_data *debug_data, VkFlags msgFlags, uint64_t srcObject,
+                                              int32_t msgCode, const char *pLayerPrefix, bool bail) {
+    debug_report_repeat_filter *filter = debug_data->repeat_filter;
+    debug_report_repeat_key key = {msgCode, srcObject, msgFlags, pLayerPrefix ? pLayerPrefix : ""};
+    std::lock_guard<std::mutex> lock(filter->lock);
+    // The counts may have been forgotten since the message was let through
+    auto it = filter->repeats.find(key);
+    if (it != filter->repeats.end()) {
+        it->second.bail = bail;
+    }
+}
+
 static inline debug_report_data *
 debug_report_create_instance(VkLayerInstanceDispatchTable *table, VkInstance inst, uint32_t extension_count,
                              const char *const *ppEnabledExtensions) // layer or extension name to be enabled
@@ -93,6 +285,8 @@ static inline void layer_debug_report_destroy_instance(debug_report_data *debug_
         return;
     }
 
+    debug_report_set_repeat_limit(debug_data, 0, 0);
+
     pTrav = debug_data->g_pDbgFunctionHead;
     /* Clear out any leftover callbacks */
     while (pTrav) {
@@ -116,7 +310,10 @@ static inline debug_report_data *layer_debug_report_create_device(debug_report_d
     return instance_debug_data;
 }
 
-static inline void layer_debug_report_destroy_device(VkDevice device) { /* Nothing to do since we're using instance data record */ }
+// Callbacks live in the instance data record; only the repeats dropped by the duplicate message limit need reporting
+static inline void layer_debug_report_destroy_device(debug_report_data *debug_data, VkDevice device) {
+    debug_report_flush_suppressed(debug_data);
+}
 
 static inline VkResult layer_create_msg_callback(debug_report_data *debug_data,
                                                  const VkDebugReportCallbackCreateInfoEXT *pCreateInfo,
@@ -320,6 +517,15 @@ static inline bool log_msg(debug_report_data *debug_data, VkFlags msgFlags, VkDe
         return false;
     }
 
+    bool result = false;
+    if (!debug_report_deferred) {
+        debug_report_thread_logged++;
+        if (debug_data->repeat_filter &&
+            debug_report_suppress_repeat(debug_data, msgFlags, objectType, srcObject, msgCode, pLayerPrefix, &result)) {
+            return result;
+        }
+    }
+
     va_list argptr;
     va_start(argptr, format);
     char *str;
@@ -328,9 +534,43 @@ static inline bool log_msg(debug_report_data *debug_data, VkFlags msgFlags, VkDe
         str = nullptr;
     }
     va_end(argptr);
-    bool result = debug_report_log_msg(debug_data, msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix,
-                                       str ? str : "Allocation failure");
+    if (debug_report_deferred) {
+        // Counted against the duplicate message limit when it is passed on
+        debug_report_deferred_message message = {msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix,
+                                                 str ? str : "Allocation failure"};
+        free(str);
+        debug_report_deferred->push_back(std::move(message));
+        return false;
+    }
+    result = debug_report_log_msg(debug_data, msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix,
+                                  str ? str : "Allocation failure");
     free(str);
+    if (debug_data->repeat_filter) {
+        debug_report_record_repeat(debug_data, msgFlags, srcObject, msgCode, pLayerPrefix, result);
+    }
+    return result;
+}
+
+// Pass a message kept by debug_report_defer to the callbacks, as log_msg would have. Returns true if the call it was
+//  logged for is to be skipped.
+static inline bool debug_report_log_deferred(debug_report_data *debug_data, const debug_report_deferred_message &message) {
+    if (!debug_data || !(debug_data->active_flags & message.msgFlags)) {
+        return false;
+    }
+
+    debug_report_thread_logged++;
+    bool result = false;
+    if (debug_data->repeat_filter && debug_report_suppress_repeat(debug_data, message.msgFlags, message.objectType,
+                                                                  message.srcObject, message.msgCode, message.pLayerPrefix,
+                                                                  &result)) {
+        return result;
+    }
+    result = debug_report_log_msg(debug_data, message.msgFlags, message.objectType, message.srcObject, message.location,
+                                  message.msgCode, message.pLayerPrefix, message.msg.c_str());
+    if (debug_data->repeat_filter) {
+        debug_report_record_repeat(debug_data, message.msgFlags, message.srcObject, message.msgCode, message.pLayerPrefix,
+                                   result);
+    }
     return result;
 }
 
@@ -0,0 +1,193 @@
+/* Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VK_LAYER_PROFILE_H
+#define VK_LAYER_PROFILE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Call count and time spent in one profiled scope. Every duration is also counted in a power-of-two bucket of
+// nanoseconds, so the tail can be estimated to within a factor of two without keeping the samples.
+class profile_counter {
+  public:
+    static const uint32_t BUCKET_COUNT = 64;
+
+    explicit profile_counter(const char *name) : name_(name), calls_(0), total_ns_(0), max_ns_(0) {
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            buckets_[i] = 0;
+        }
+    }
+    profile_counter(const profile_counter &) = delete;
+    profile_counter &operator=(const profile_counter &) = delete;
+
+    void add(uint64_t ns) {
+        calls_.fetch_add(1, std::memory_order_relaxed);
+        total_ns_.fetch_add(ns, std::memory_order_relaxed);
+        buckets_[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+        while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    const std::string &name() const { return name_; }
+    uint64_t calls() const { return calls_.load(std::memory_order_relaxed); }
+    uint64_t total_ns() const { return total_ns_.load(std::memory_order_relaxed); }
+    uint64_t max_ns() const { return max_ns_.load(std::memory_order_relaxed); }
+
+    // Upper bound of the duration under which the given fraction of the calls finished
+    uint64_t percentile_ns(double fraction) const {
+        const uint64_t calls = this->calls();
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKET_COUNT - 1; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen && seen >= fraction * calls)
+                return std::min((uint64_t(2) << i) - 1, max_ns());
+        }
+        return max_ns();
+    }
+
+  private:
+    static uint32_t bucket(uint64_t ns) {
+        uint32_t index = 0;
+        while (ns >>= 1) {
+            index++;
+        }
+        return index;
+    }
+
+    const std::string name_;
+    std::atomic<uint64_t> calls_;
+    std::atomic<uint64_t> total_ns_;
+    std::atomic<uint64_t> max_ns_;
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+};
+
+// The counters of one layer. Scopes only read the clock while the profiler is enabled; counters themselves are
+// created whether or not it is, the first time their scope is entered, and live as long as the profiler.
+class profiler {
+  public:
+    profiler() : enabled_(false) {}
+    profiler(const profiler &) = delete;
+    profiler &operator=(const profiler &) = delete;
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void enable() { enabled_.store(true, std::memory_order_relaxed); }
+
+    // The counter for name, shared by every scope that uses the same name
+    profile_counter *counter(const char *name) {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::unique_ptr<profile_counter> &counter = counters_[name];
+        if (!counter) {
+            counter.reset(new profile_counter(name));
+        }
+        return counter.get();
+    }
+
+    // Write the counters that were entered at least once, by descending total time, as text to <base>.txt and as
+    // JSON to <base>.json. Returns false if either file could not be written.
+    bool write_report(const char *title, const std::string &base) {
+        std::vector<const profile_counter *> counters;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            for (auto &entry : counters_) {
+                if (entry.second->calls())
+                    counters.push_back(entry.second.get());
+            }
+        }
+        std::sort(counters.begin(), counters.end(), [](const profile_counter *a, const profile_counter *b) {
+            return a->total_ns() > b->total_ns();
+        });
+
+        bool ok = false;
+        FILE *text = fopen((base + ".txt").c_str(), "w");
+        if (text) {
+            fprintf(text, "%s profile: time inside each scope, including the scopes it calls\n", title);
+            fprintf(text, "%-48s %12s %12s %10s %10s %10s %10s\n", "scope", "calls", "total ms", "mean us", "p50 us", "p99 us",
+                    "max us");
+            for (const profile_counter *c : counters) {
+                fprintf(text, "%-48s %12llu %12.3f %10.2f %10.2f %10.2f %10.2f\n", c->name().c_str(),
+                        (unsigned long long)c->calls(), c->total_ns() / 1e6, c->total_ns() / 1e3 / c->calls(),
+                        c->percentile_ns(0.5) / 1e3, c->percentile_ns(0.99) / 1e3, c->max_ns() / 1e3);
+            }
+            ok = fclose(text) == 0;
+        }
+        FILE *json = fopen((base + ".json").c_str(), "w");
+        if (json) {
+            fprintf(json, "{\n  \"layer\": \"%s\",\n  \"scopes\": [", title);
+            for (size_t i = 0; i < counters.size(); i++) {
+                const profile_counter *c = counters[i];
+                fprintf(json,
+                        "%s\n    {\"name\": \"%s\", \"calls\": %llu, \"total_ns\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+                        "\"max_ns\": %llu}",
+                        i ? "," : "", c->name().c_str(), (unsigned long long)c->calls(), (unsigned long long)c->total_ns(),
+                        (unsigned long long)c->percentile_ns(0.5), (unsigned long long)c->percentile_ns(0.99),
+                        (unsigned long long)c->max_ns());
+            }
+            fprintf(json, "\n  ]\n}\n");
+            ok = (fclose(json) == 0) && ok;
+        } else {
+            ok = false;
+        }
+        return ok;
+    }
+
+  private:
+    std::atomic<bool> enabled_;
+    std::mutex lock_;
+    std::map<std::string, std::unique_ptr<profile_counter>> counters_;
+};
+
+// Adds the time from its construction to its destruction to a counter, if the profiler was enabled when it was
+// constructed
+class profile_scope {
+  public:
+    profile_scope(const profiler &prof, profile_counter *counter) : counter_(prof.enabled() ? counter : nullptr) {
+        if (counter_)
+            start_ = std::chrono::steady_clock::now();
+    }
+    ~profile_scope() {
+        if (counter_)
+            counter_->add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+    profile_scope(const profile_scope &) = delete;
+    profile_scope &operator=(const profile_scope &) = delete;
+
+  private:
+    profile_counter *counter_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define VK_LAYER_PROFILE_CONCAT_(a, b) a##b
+#define VK_LAYER_PROFILE_CONCAT(a, b) VK_LAYER_PROFILE_CONCAT_(a, b)
+
+// Profile the rest of the enclosing block under name
+#define VK_LAYER_PROFILE_SCOPE(prof, name)                                                                                         \
+    static profile_counter *const VK_LAYER_PROFILE_CONCAT(profile_counter_, __LINE__) = (prof).counter(name);                      \
+    profile_scope VK_LAYER_PROFILE_CONCAT(profile_scope_, __LINE__)((prof), VK_LAYER_PROFILE_CONCAT(profile_counter_, __LINE__))
+
+// Profile the rest of the enclosing function under its own name
+#define VK_LAYER_PROFILE_FUNCTION(prof) VK_LAYER_PROFILE_SCOPE(prof, __func__)
+
+#endif // VK_LAYER_PROFILE_H
@@ -0,0 +1,142 @@
+/* Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VK_LAYER_RW_LOCK_H
+#define VK_LAYER_RW_LOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+
+#include "vk_layer_profile.h"
+
+// Reader/writer lock for layer state that is read on hot paths. Readers only touch an atomic word in the uncontended
+// case, so threads working on unrelated objects do not serialize on each other. Writers are preferred: once a
+// writer is waiting no new readers are admitted until it has run.
+class rw_lock {
+  public:
+    rw_lock() : state_(0), exclusive_waits_(nullptr), shared_waits_(nullptr) {}
+    rw_lock(const rw_lock &) = delete;
+    rw_lock &operator=(const rw_lock &) = delete;
+
+    // Count the acquisitions that had to block, and how long they waited, in these counters. Uncontended
+    // acquisitions are not counted and do not read the clock.
+    void set_wait_counters(profile_counter *exclusive_waits, profile_counter *shared_waits) {
+        exclusive_waits_.store(exclusive_waits, std::memory_order_relaxed);
+        shared_waits_.store(shared_waits, std::memory_order_relaxed);
+    }
+
+    void lock() {
+        profile_counter *waits = nullptr;
+        std::chrono::steady_clock::time_point wait_start;
+        if (!writer_lock_.try_lock()) {
+            waits = start_wait(exclusive_waits_, &wait_start);
+            writer_lock_.lock();
+        }
+        uint32_t prev = state_.fetch_or(kWriterBit, std::memory_order_acquire);
+        if (prev & kReaderMask) {
+            if (!waits)
+                waits = start_wait(exclusive_waits_, &wait_start);
+            std::unique_lock<std::mutex> lock(wait_lock_);
+            cv_.wait(lock, [this] { return (state_.load(std::memory_order_acquire) & kReaderMask) == 0; });
+        }
+        if (waits)
+            finish_wait(waits, wait_start);
+    }
+    void unlock() {
+        {
+            std::lock_guard<std::mutex> lock(wait_lock_);
+            state_.fetch_and(~kWriterBit, std::memory_order_release);
+        }
+        cv_.notify_all();
+        writer_lock_.unlock();
+    }
+    void lock_shared() {
+        uint32_t cur = state_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (!(cur & kWriterBit)) {
+                if (state_.compare_exchange_weak(cur, cur + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+            } else {
+                std::chrono::steady_clock::time_point wait_start;
+                profile_counter *waits = start_wait(shared_waits_, &wait_start);
+                {
+                    std::unique_lock<std::mutex> lock(wait_lock_);
+                    cv_.wait(lock, [this] { return (state_.load(std::memory_order_relaxed) & kWriterBit) == 0; });
+                }
+                if (waits)
+                    finish_wait(waits, wait_start);
+                cur = state_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    void unlock_shared() {
+        // The last reader out wakes a writer that is waiting for the reader count to drain
+        if (state_.fetch_sub(1, std::memory_order_release) == (kWriterBit | 1)) {
+            std::lock_guard<std::mutex> lock(wait_lock_);
+            cv_.notify_all();
+        }
+    }
+
+  private:
+    static profile_counter *start_wait(const std::atomic<profile_counter *> &counter,
+                                       std::chrono::steady_clock::time_point *start) {
+        profile_counter *waits = counter.load(std::memory_order_relaxed);
+        if (waits)
+            *start = std::chrono::steady_clock::now();
+        return waits;
+    }
+    static void finish_wait(profile_counter *waits, std::chrono::steady_clock::time_point start) {
+        waits->add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    static const uint32_t kWriterBit = 0x80000000u;
+    static const uint32_t kReaderMask = ~kWriterBit;
+    std::atomic<uint32_t> state_;
+    std::atomic<profile_counter *> exclusive_waits_;
+    std::atomic<profile_counter *> shared_waits_;
+    std::mutex writer_lock_;
+    std::mutex wait_lock_;
+    std::condition_variable cv_;
+};
+
+// Scoped shared ownership of a rw_lock, mirroring the subset of std::unique_lock used by the intercepts
+template <typename LOCK> class shared_lock {
+  public:
+    explicit shared_lock(LOCK &l) : lock_(l), owns_(true) { lock_.lock_shared(); }
+    ~shared_lock() {
+        if (owns_)
+            lock_.unlock_shared();
+    }
+    shared_lock(const shared_lock &) = delete;
+    shared_lock &operator=(const shared_lock &) = delete;
+    void lock() {
+        lock_.lock_shared();
+        owns_ = true;
+    }
+    void unlock() {
+        lock_.unlock_shared();
+        owns_ = false;
+    }
+
+  private:
+    LOCK &lock_;
+    bool owns_;
+};
+
+#endif // VK_LAYER_RW_LOCK_H
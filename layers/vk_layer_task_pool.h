@@ -0,0 +1,123 @@
+/* Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VK_LAYER_TASK_POOL_H
+#define VK_LAYER_TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// Small pool of worker threads that run the iterations of a loop in parallel. The workers are started by the first
+// loop that needs them and joined when the pool is destroyed, so the owner must destroy it from an ordinary API call
+// rather than from library unload. One loop runs on the pool at a time; a thread that finds the pool busy runs its
+// own loop by itself instead of waiting.
+class task_pool {
+  public:
+    explicit task_pool(uint32_t worker_count)
+        : worker_count_(worker_count), generation_(0), shutdown_(false), task_(nullptr), task_count_(0), next_(0),
+          busy_workers_(0) {}
+    task_pool(const task_pool &) = delete;
+    task_pool &operator=(const task_pool &) = delete;
+
+    ~task_pool() {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            shutdown_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Call fn(i) for every i in [0, count), on the workers and the calling thread, and return once all calls are done
+    void parallel_for(uint32_t count, const std::function<void(uint32_t)> &fn) {
+        std::unique_lock<std::mutex> owner(run_lock_, std::try_to_lock);
+        if (count < 2 || worker_count_ == 0 || !owner.owns_lock()) {
+            for (uint32_t i = 0; i < count; i++) {
+                fn(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (workers_.empty()) {
+                for (uint32_t i = 0; i < worker_count_; i++) {
+                    workers_.emplace_back(&task_pool::worker_main, this);
+                }
+            }
+            task_ = &fn;
+            task_count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            busy_workers_ = worker_count_;
+            generation_++;
+        }
+        wake_.notify_all();
+        run_iterations();
+        // fn must outlive every call the workers make, so wait for all of them to leave the loop
+        std::unique_lock<std::mutex> lock(lock_);
+        done_.wait(lock, [this] { return busy_workers_ == 0; });
+        task_ = nullptr;
+    }
+
+  private:
+    void run_iterations() {
+        for (;;) {
+            uint32_t i = next_.fetch_add(1, std::memory_order_relaxed);
+            if (i >= task_count_)
+                return;
+            (*task_)(i);
+        }
+    }
+
+    void worker_main() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                wake_.wait(lock, [this, seen] { return shutdown_ || generation_ != seen; });
+                if (shutdown_)
+                    return;
+                seen = generation_;
+            }
+            run_iterations();
+            std::lock_guard<std::mutex> lock(lock_);
+            if (--busy_workers_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    const uint32_t worker_count_;
+    std::vector<std::thread> workers_;
+    std::mutex run_lock_; // Held by the thread whose loop is running on the pool
+    std::mutex lock_;     // Guards everything below but next_
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_; // Bumped for each loop handed to the workers
+    bool shutdown_;
+    const std::function<void(uint32_t)> *task_;
+    uint32_t task_count_;
+    std::atomic<uint32_t> next_;
+    uint32_t busy_workers_;
+};
+
+#endif // VK_LAYER_TASK_POOL_H
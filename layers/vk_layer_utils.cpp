@@ -18,6 +18,7 @@
  *
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <string>
 #include <vector>
@@ -614,14 +615,25 @@ void layer_debug_actions(debug_report_data *report_data, std::vector<VkDebugRepo
     std::string report_flags_key = layer_identifier;
     std::string debug_action_key = layer_identifier;
     std::string log_filename_key = layer_identifier;
+    std::string repeat_limit_key = layer_identifier;
+    std::string repeat_interval_key = layer_identifier;
     report_flags_key.append(".report_flags");
     debug_action_key.append(".debug_action");
     log_filename_key.append(".log_filename");
+    repeat_limit_key.append(".duplicate_message_limit");
+    repeat_interval_key.append(".duplicate_message_summary_interval");
 
     // initialize layer options
     report_flags = getLayerOptionFlags(report_flags_key.c_str(), 0);
     getLayerOptionEnum(debug_action_key.c_str(), (uint32_t *)&debug_action);
 
+    const char *repeat_limit = getLayerOption(repeat_limit_key.c_str());
+    if (repeat_limit) {
+        const char *repeat_interval = getLayerOption(repeat_interval_key.c_str());
+        debug_report_set_repeat_limit(report_data, (uint32_t)strtoul(repeat_limit, NULL, 0),
+                                      repeat_interval ? strtoull(repeat_interval, NULL, 0) : 100000);
+    }
+
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG) {
         const char *log_filename = getLayerOption(log_filename_key.c_str());
         FILE *log_output = getLayerLogOutput(log_filename, layer_identifier);
@@ -34,8 +34,10 @@
 #include <limits.h>
 #include <ctype.h>
 #include "cJSON.h"
+#include "vk_loader_platform.h"
 
-static const char *ep;
+/* Per thread, as the loader parses manifests on several threads at once */
+static THREAD_LOCAL_DECL const char *ep;
 
 const char *cJSON_GetErrorPtr(void) { return ep; }
 
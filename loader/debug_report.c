@@ -60,30 +60,72 @@ void debug_report_create_instance(struct loader_instance *ptr_instance,
     }
 }
 
+/* Publishes list as the instance's callbacks and retires the list it
+ * replaces. Retired lists are freed once no message is being delivered, which
+ * a writer checks after publishing, so a reader that starts later can only see
+ * the new list. Called with loader_lock held, or before the instance is
+ * visible to other threads. */
+static void
+util_PublishDebugReportCallbacks(struct loader_instance *inst,
+                                 struct loader_dbg_callback_list *list) {
+    struct loader_dbg_callback_list *old = inst->dbg_callbacks;
+
+    loader_platform_atomic_store_ptr((void **)&inst->dbg_callbacks, list);
+    if (old) {
+        old->next_retired = inst->dbg_callbacks_retired;
+        inst->dbg_callbacks_retired = old;
+    }
+    if (loader_platform_atomic_load_u32(&inst->dbg_callback_readers) == 0) {
+        while (inst->dbg_callbacks_retired) {
+            old = inst->dbg_callbacks_retired;
+            inst->dbg_callbacks_retired = old->next_retired;
+            loader_heap_free(inst, old);
+        }
+    }
+}
+
+/* A copy of the instance's callbacks with room for extra more at the end */
+static struct loader_dbg_callback_list *
+util_CopyDebugReportCallbacks(struct loader_instance *inst, uint32_t extra) {
+    const struct loader_dbg_callback_list *cur = inst->dbg_callbacks;
+    const uint32_t count = (cur ? cur->count : 0) + extra;
+    struct loader_dbg_callback_list *list;
+
+    list = loader_heap_alloc(inst,
+                             sizeof(*list) +
+                                 count * sizeof(VkLayerDbgFunctionNode),
+                             VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    if (!list)
+        return NULL;
+    list->count = count;
+    list->callbacks = (VkLayerDbgFunctionNode *)(list + 1);
+    list->next_retired = NULL;
+    if (cur) {
+        memcpy(list->callbacks, cur->callbacks,
+               cur->count * sizeof(VkLayerDbgFunctionNode));
+    }
+    return list;
+}
+
 VkResult
 util_CreateDebugReportCallback(struct loader_instance *inst,
                                VkDebugReportCallbackCreateInfoEXT *pCreateInfo,
                                const VkAllocationCallbacks *pAllocator,
                                VkDebugReportCallbackEXT callback) {
-    VkLayerDbgFunctionNode *pNewDbgFuncNode;
-    if (pAllocator != NULL) {
-        pNewDbgFuncNode = (VkLayerDbgFunctionNode *)pAllocator->pfnAllocation(
-            pAllocator->pUserData, sizeof(VkLayerDbgFunctionNode),
-            sizeof(int *), VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    } else {
-        pNewDbgFuncNode = (VkLayerDbgFunctionNode *)loader_heap_alloc(
-            inst, sizeof(VkLayerDbgFunctionNode),
-            VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
-    }
-    if (!pNewDbgFuncNode)
+    // NOTE: The lists outlive the calls that replace them, so they always come
+    // from the instance's allocator rather than pAllocator.
+    struct loader_dbg_callback_list *list =
+        util_CopyDebugReportCallbacks(inst, 1);
+    if (!list)
         return VK_ERROR_OUT_OF_HOST_MEMORY;
 
+    VkLayerDbgFunctionNode *pNewDbgFuncNode = &list->callbacks[list->count - 1];
     pNewDbgFuncNode->msgCallback = callback;
     pNewDbgFuncNode->pfnMsgCallback = pCreateInfo->pfnCallback;
     pNewDbgFuncNode->msgFlags = pCreateInfo->flags;
     pNewDbgFuncNode->pUserData = pCreateInfo->pUserData;
-    pNewDbgFuncNode->pNext = inst->DbgFunctionHead;
-    inst->DbgFunctionHead = pNewDbgFuncNode;
+    pNewDbgFuncNode->pNext = NULL;
+    util_PublishDebugReportCallbacks(inst, list);
 
     return VK_SUCCESS;
 }
@@ -103,7 +145,7 @@ static VKAPI_ATTR VkResult VKAPI_CALL debug_report_CreateDebugReportCallback(
     return result;
 }
 
-// Utility function to handle reporting
+// Utility function to handle reporting, without loader_lock
 VkBool32 util_DebugReportMessage(const struct loader_instance *inst,
                                  VkFlags msgFlags,
                                  VkDebugReportObjectTypeEXT objectType,
@@ -111,8 +153,13 @@ VkBool32 util_DebugReportMessage(const struct loader_instance *inst,
                                  int32_t msgCode, const char *pLayerPrefix,
                                  const char *pMsg) {
     VkBool32 bail = false;
-    VkLayerDbgFunctionNode *pTrav = inst->DbgFunctionHead;
-    while (pTrav) {
+    uint32_t *readers = (uint32_t *)&inst->dbg_callback_readers;
+    const struct loader_dbg_callback_list *list;
+
+    loader_platform_atomic_increment(readers);
+    list = loader_platform_atomic_load_ptr((void *const *)&inst->dbg_callbacks);
+    for (uint32_t i = 0; list && i < list->count; i++) {
+        const VkLayerDbgFunctionNode *pTrav = &list->callbacks[i];
         if (pTrav->msgFlags & msgFlags) {
             if (pTrav->pfnMsgCallback(msgFlags, objectType, srcObject, location,
                                       msgCode, pLayerPrefix, pMsg,
@@ -120,8 +167,8 @@ VkBool32 util_DebugReportMessage(const struct loader_instance *inst,
                 bail = true;
             }
         }
-        pTrav = pTrav->pNext;
     }
+    loader_platform_atomic_decrement(readers);
 
     return bail;
 }
@@ -129,23 +176,46 @@ VkBool32 util_DebugReportMessage(const struct loader_instance *inst,
 void util_DestroyDebugReportCallback(struct loader_instance *inst,
                                      VkDebugReportCallbackEXT callback,
                                      const VkAllocationCallbacks *pAllocator) {
-    VkLayerDbgFunctionNode *pTrav = inst->DbgFunctionHead;
-    VkLayerDbgFunctionNode *pPrev = pTrav;
-
-    while (pTrav) {
-        if (pTrav->msgCallback == callback) {
-            pPrev->pNext = pTrav->pNext;
-            if (inst->DbgFunctionHead == pTrav)
-                inst->DbgFunctionHead = pTrav->pNext;
-            if (pAllocator != NULL) {
-                pAllocator->pfnFree(pAllocator->pUserData, pTrav);
-            } else {
-                loader_heap_free(inst, pTrav);
-            }
+    const struct loader_dbg_callback_list *cur = inst->dbg_callbacks;
+    struct loader_dbg_callback_list *list = NULL;
+    uint32_t i;
+
+    if (!cur)
+        return;
+    for (i = 0; i < cur->count; i++) {
+        if (cur->callbacks[i].msgCallback == callback)
             break;
+    }
+    if (i == cur->count)
+        return;
+
+    if (cur->count > 1) {
+        list = util_CopyDebugReportCallbacks(inst, 0);
+        if (!list) {
+            // Out of memory: stop delivering to the callback in place, as it
+            // can't be removed
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                       "Out of memory removing debug report callback");
+            ((VkLayerDbgFunctionNode *)&cur->callbacks[i])->msgFlags = 0;
+            return;
         }
-        pPrev = pTrav;
-        pTrav = pTrav->pNext;
+        list->count--;
+        memmove(&list->callbacks[i], &list->callbacks[i + 1],
+                (list->count - i) * sizeof(VkLayerDbgFunctionNode));
+    }
+    util_PublishDebugReportCallbacks(inst, list);
+}
+
+/* Frees the instance's callback lists when it is destroyed */
+void util_FreeDebugReportCallbacks(struct loader_instance *inst) {
+    struct loader_dbg_callback_list *list;
+
+    loader_heap_free(inst, inst->dbg_callbacks);
+    inst->dbg_callbacks = NULL;
+    while (inst->dbg_callbacks_retired) {
+        list = inst->dbg_callbacks_retired;
+        inst->dbg_callbacks_retired = list->next_retired;
+        loader_heap_free(inst, list);
     }
 }
 
@@ -357,7 +427,9 @@ terminator_DebugReportMessage(VkInstance instance, VkDebugReportFlagsEXT flags,
 
     struct loader_instance *inst = (struct loader_instance *)instance;
 
-    loader_platform_thread_lock_mutex(&loader_lock);
+    /* The ICDs don't change until the instance is destroyed, and the
+     * callbacks are read without the lock, so messages from different threads
+     * don't wait on loader_lock or each other. */
     for (icd = inst->icds; icd; icd = icd->next) {
         if (icd->DebugReportMessageEXT != NULL) {
             icd->DebugReportMessageEXT(icd->instance, flags, objType, object,
@@ -373,8 +445,6 @@ terminator_DebugReportMessage(VkInstance instance, VkDebugReportFlagsEXT flags,
 
     util_DebugReportMessage(inst, flags, objType, object, location, msgCode,
                             pLayerPrefix, pMsg);
-
-    loader_platform_thread_unlock_mutex(&loader_lock);
 }
 
 bool debug_report_instance_gpa(struct loader_instance *ptr_instance,
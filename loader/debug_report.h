@@ -135,6 +135,8 @@ void util_DestroyDebugReportCallback(struct loader_instance *inst,
                                      VkDebugReportCallbackEXT callback,
                                      const VkAllocationCallbacks *pAllocator);
 
+void util_FreeDebugReportCallbacks(struct loader_instance *inst);
+
 VkResult util_CopyDebugReportCreateInfos(
     const void *pChain, const VkAllocationCallbacks *pAllocator,
     uint32_t *num_callbacks, VkDebugReportCallbackCreateInfoEXT **infos,
@@ -45,6 +45,7 @@
 #include "vulkan/vk_icd.h"
 #include "cJSON.h"
 #include "murmurhash.h"
+#include "manifest_cache.h"
 
 #if defined(__GNUC__)
 #if __GNUC__ < 2 || (__GNUC__ == 2 && __GNUC_MINOR__ < 17)
@@ -78,8 +79,25 @@ uint32_t g_loader_log_msgs = 0;
 // thread safety lock for accessing global data structures such as "loader"
 // all entrypoints on the instance chain need to be locked except GPA
 // additionally CreateDevice and DestroyDevice needs to be locked
+// CreateInstance and DestroyInstance only hold it while calling down the
+// instance chain, not while finding, parsing and loading layers and ICDs
 loader_platform_thread_mutex loader_lock;
+// guards the manifest cache; manifests themselves are parsed without it
 loader_platform_thread_mutex loader_json_lock;
+// guards loader_libs
+static loader_platform_thread_mutex loader_lib_lock;
+
+// Layer and ICD libraries opened by the loader, shared by every instance and
+// scan that uses them.  A library another instance has open is found here
+// without calling into the platform's library loader, which serializes all of
+// its callers.
+struct loader_lib {
+    char *path;
+    loader_platform_dl_handle handle;
+    uint32_t ref_count;
+    struct loader_lib *next;
+};
+static struct loader_lib *loader_libs;
 
 const char *std_validation_str = "VK_LAYER_LUNARG_standard_validation";
 
@@ -524,13 +542,18 @@ loader_get_next_layer_property(const struct loader_instance *inst,
     // ensure enough room to add an entry
     if ((layer_list->count + 1) * sizeof(struct loader_layer_properties) >
         layer_list->capacity) {
-        layer_list->list = loader_heap_realloc(
+        struct loader_layer_properties *list = loader_heap_realloc(
             inst, layer_list->list, layer_list->capacity,
             layer_list->capacity * 2, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-        if (layer_list->list == NULL) {
+        if (list == NULL) {
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "realloc failed for layer list");
+            return NULL;
         }
+        // Callers expect a zeroed entry, same as the initial allocation
+        memset((uint8_t *)list + layer_list->capacity, 0,
+               layer_list->capacity);
+        layer_list->list = list;
         layer_list->capacity *= 2;
     }
 
@@ -695,7 +718,7 @@ VkResult loader_add_device_extensions(const struct loader_instance *inst,
             if (res != VK_SUCCESS)
                 return res;
         }
-    } else {
+    } else if (res != VK_SUCCESS) {
         loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                    "Error getting physical device extension info count from "
                    "library %s",
@@ -1071,8 +1094,66 @@ struct loader_icd *loader_get_icd_and_device(const VkDevice device,
     return NULL;
 }
 
+static VkResult vkDevExtError(VkDevice dev) {
+    struct loader_device *found_dev;
+    struct loader_icd *icd = loader_get_icd_and_device(dev, &found_dev);
+
+    if (icd)
+        loader_log(icd->this_instance, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "Bad destination in loader trampoline dispatch,"
+                   "Are layers and extensions that you are calling enabled?");
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+}
+
+// Every device's dev ext dispatch banks start out as this one, which is
+// filled with vkDevExtError by loader_initialize()
+PFN_vkDevExt loader_dev_ext_error_bank[DEV_EXT_BANK_SIZE];
+
+static void loader_init_dev_ext_error_bank(void) {
+    for (uint32_t i = 0; i < DEV_EXT_BANK_SIZE; i++)
+        loader_dev_ext_error_bank[i] = (PFN_vkDevExt)vkDevExtError;
+}
+
+/**
+ * Set entry idx of dev's ext dispatch table, giving it its own copy of the
+ * bank the entry is in the first time one of the bank's entries is set.
+ * If that fails the entry stays vkDevExtError.
+ */
+static void loader_set_dev_ext_entry(const struct loader_instance *inst,
+                                     struct loader_device *dev, uint32_t idx,
+                                     void *func) {
+    PFN_vkDevExt **bank =
+        &dev->loader_dispatch.ext_dispatch.DevExt[idx / DEV_EXT_BANK_SIZE];
+
+    if (*bank == loader_dev_ext_error_bank) {
+        PFN_vkDevExt *new_bank =
+            loader_heap_alloc(inst, sizeof(loader_dev_ext_error_bank),
+                              VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+        if (new_bank == NULL) {
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                       "loader_set_dev_ext_entry() can't allocate memory for "
+                       "dispatch bank");
+            return;
+        }
+        memcpy(new_bank, loader_dev_ext_error_bank,
+               sizeof(loader_dev_ext_error_bank));
+        *bank = new_bank;
+    }
+    (*bank)[idx % DEV_EXT_BANK_SIZE] = (PFN_vkDevExt)func;
+}
+
+static void loader_free_dev_ext_banks(const struct loader_instance *inst,
+                                      struct loader_device *dev) {
+    for (uint32_t i = 0; i < MAX_NUM_DEV_EXT_BANKS; i++) {
+        if (dev->loader_dispatch.ext_dispatch.DevExt[i] !=
+            loader_dev_ext_error_bank)
+            loader_heap_free(inst, dev->loader_dispatch.ext_dispatch.DevExt[i]);
+    }
+}
+
 static void loader_destroy_logical_device(const struct loader_instance *inst,
                                           struct loader_device *dev) {
+    loader_free_dev_ext_banks(inst, dev);
     loader_heap_free(inst, dev->app_extension_props);
     loader_deactivate_layers(inst, &dev->activated_layer_list);
     loader_heap_free(inst, dev);
@@ -1212,12 +1293,102 @@ bool loader_get_icd_interface_version(
     return true;
 }
 
+static struct loader_lib *loader_find_lib(const char *path) {
+    struct loader_lib *lib;
+    for (lib = loader_libs; lib; lib = lib->next) {
+        if (!strcmp(lib->path, path))
+            return lib;
+    }
+    return NULL;
+}
+
+/* Open the library at path, or take another reference to it if the loader
+ * already has it open.  Neither opening nor closing a library happens under a
+ * loader lock: two threads opening the same library at once both open it, and
+ * the one that records it second closes its own handle again.  Returns NULL if
+ * the library can't be opened, leaving the platform's error message to
+ * loader_platform_open_library_error(). */
+static loader_platform_dl_handle loader_open_lib(const char *path) {
+    struct loader_lib *lib;
+    loader_platform_dl_handle handle;
+
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    lib = loader_find_lib(path);
+    if (lib) {
+        lib->ref_count++;
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        return lib->handle;
+    }
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
+
+    handle = loader_platform_open_library(path);
+    if (!handle)
+        return NULL;
+
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    lib = loader_find_lib(path);
+    if (lib) {
+        lib->ref_count++;
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        loader_platform_close_library(handle);
+        return lib->handle;
+    }
+    lib = loader_heap_alloc(NULL, sizeof(struct loader_lib),
+                            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (lib) {
+        lib->path = loader_heap_alloc(NULL, strlen(path) + 1,
+                                      VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (!lib->path) {
+            loader_heap_free(NULL, lib);
+            lib = NULL;
+        }
+    }
+    if (!lib) {
+        // Still usable, just not shared
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        return handle;
+    }
+    strcpy(lib->path, path);
+    lib->handle = handle;
+    lib->ref_count = 1;
+    lib->next = loader_libs;
+    loader_libs = lib;
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
+    return handle;
+}
+
+/* Drop a reference taken by loader_open_lib(), closing the library with the
+ * last one */
+static void loader_close_lib(loader_platform_dl_handle handle) {
+    struct loader_lib *lib, **prev;
+
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    for (prev = &loader_libs; *prev; prev = &(*prev)->next) {
+        if ((*prev)->handle == handle)
+            break;
+    }
+    lib = *prev;
+    if (lib && --lib->ref_count) {
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        return;
+    }
+    if (lib)
+        *prev = lib->next;
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
+
+    loader_platform_close_library(handle);
+    if (lib) {
+        loader_heap_free(NULL, lib->path);
+        loader_heap_free(NULL, lib);
+    }
+}
+
 void loader_scanned_icd_clear(const struct loader_instance *inst,
                               struct loader_icd_libs *icd_libs) {
     if (icd_libs->capacity == 0)
         return;
     for (uint32_t i = 0; i < icd_libs->count; i++) {
-        loader_platform_close_library(icd_libs->list[i].handle);
+        loader_close_lib(icd_libs->list[i].handle);
         loader_heap_free(inst, icd_libs->list[i].lib_name);
     }
     loader_heap_free(inst, icd_libs->list);
@@ -1245,9 +1416,8 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
     struct loader_scanned_icds *new_node;
     uint32_t interface_vers;
 
-    /* TODO implement smarter opening/closing of libraries. For now this
-     * function leaves libraries open and the scanned_icd_clear closes them */
-    handle = loader_platform_open_library(filename);
+    /* The library stays open until loader_scanned_icd_clear() */
+    handle = loader_open_lib(filename);
     if (!handle) {
         loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                    loader_platform_open_library_error(filename));
@@ -1263,6 +1433,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
                     loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "ICD (%s) doesn't support interface version compatible"
                        "with loader, skip this ICD %s", filename);
+            loader_close_lib(handle);
             return;
     }
 
@@ -1277,6 +1448,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        loader_platform_get_proc_address_error(
                            "vk_icdGetInstanceProcAddr"));
+            loader_close_lib(handle);
             return;
         } else {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
@@ -1291,6 +1463,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
                 inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                 "Couldn't get vkCreateInstance via dlsym/loadlibrary for ICD %s",
                     filename);
+            loader_close_lib(handle);
             return;
         }
         fp_get_inst_ext_props = loader_platform_get_proc_address(
@@ -1299,6 +1472,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Couldn't get vkEnumerateInstanceExtensionProperties "
                        "via dlsym/loadlibrary for ICD %s", filename);
+            loader_close_lib(handle);
             return;
         }
     } else {
@@ -1312,6 +1486,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Couldn't get vkCreateInstance via "
                        "vk_icdGetInstanceProcAddr for ICD %s", filename);
+            loader_close_lib(handle);
             return;
         }
         fp_get_inst_ext_props =
@@ -1321,6 +1496,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Couldn't get vkEnumerateInstanceExtensionProperties "
                        "via vk_icdGetInstanceProcAddr for ICD %s", filename);
+            loader_close_lib(handle);
             return;
         }
     }
@@ -1349,6 +1525,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
     if (!new_node->lib_name) {
         loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                    "Out of memory can't add icd");
+        loader_close_lib(handle);
         return;
     }
     strcpy(new_node->lib_name, filename);
@@ -1469,6 +1646,7 @@ void loader_initialize(void) {
     // initialize mutexs
     loader_platform_thread_create_mutex(&loader_lock);
     loader_platform_thread_create_mutex(&loader_json_lock);
+    loader_platform_thread_create_mutex(&loader_lib_lock);
 
     // initialize logging
     loader_debug_init();
@@ -1478,6 +1656,8 @@ void loader_initialize(void) {
         .malloc_fn = loader_tls_heap_alloc, .free_fn = loader_tls_heap_free,
     };
     cJSON_InitHooks(&alloc_fns);
+
+    loader_init_dev_ext_error_bank();
 }
 
 struct loader_manifest_files {
@@ -2156,6 +2336,272 @@ loader_add_layer_properties(const struct loader_instance *inst,
     return;
 }
 
+/**
+ * Serialize the layers parsed from one manifest for the manifest cache.
+ * Only fields filled in by loader_add_layer_properties are written; library
+ * handles and function pointers are resolved later and never cached.
+ */
+static void loader_encode_layer_list(struct loader_cache_writer *w,
+                                     const struct loader_layer_list *list) {
+    uint32_t i, j, k;
+
+    loader_cache_write_u32(w, list->count);
+    for (i = 0; i < list->count; i++) {
+        const struct loader_layer_properties *props = &list->list[i];
+        loader_cache_write_u32(w, props->type);
+        loader_cache_write(w, &props->info, sizeof(props->info));
+        loader_cache_write_str(w, props->lib_name);
+        loader_cache_write_str(w, props->functions.str_gipa);
+        loader_cache_write_str(w, props->functions.str_gdpa);
+        loader_cache_write_str(w, props->disable_env_var.name);
+        loader_cache_write_str(w, props->disable_env_var.value);
+        loader_cache_write_str(w, props->enable_env_var.name);
+        loader_cache_write_str(w, props->enable_env_var.value);
+
+        loader_cache_write_u32(w, props->instance_extension_list.count);
+        loader_cache_write(w, props->instance_extension_list.list,
+                           props->instance_extension_list.count *
+                               sizeof(VkExtensionProperties));
+
+        loader_cache_write_u32(w, props->device_extension_list.count);
+        for (j = 0; j < props->device_extension_list.count; j++) {
+            const struct loader_dev_ext_props *ext =
+                &props->device_extension_list.list[j];
+            loader_cache_write(w, &ext->props, sizeof(ext->props));
+            loader_cache_write_u32(w, ext->entrypoint_count);
+            for (k = 0; k < ext->entrypoint_count; k++)
+                loader_cache_write_str(w, ext->entrypoints[k]);
+        }
+    }
+}
+
+static bool loader_decode_layer_list(const struct loader_instance *inst,
+                                     struct loader_cache_reader *r,
+                                     struct loader_layer_list *list) {
+    uint32_t count, i, j, k, ext_count, entry_count;
+    VkExtensionProperties ext_prop;
+    char entry[MAX_STRING_SIZE];
+    char **entry_array;
+
+    count = loader_cache_read_u32(r);
+    for (i = 0; i < count && !r->failed; i++) {
+        struct loader_layer_properties *props =
+            loader_get_next_layer_property(inst, list);
+        if (props == NULL)
+            return false;
+        props->type = (enum layer_type)loader_cache_read_u32(r);
+        loader_cache_read(r, &props->info, sizeof(props->info));
+        loader_cache_read_str(r, props->lib_name, sizeof(props->lib_name));
+        loader_cache_read_str(r, props->functions.str_gipa,
+                              sizeof(props->functions.str_gipa));
+        loader_cache_read_str(r, props->functions.str_gdpa,
+                              sizeof(props->functions.str_gdpa));
+        loader_cache_read_str(r, props->disable_env_var.name,
+                              sizeof(props->disable_env_var.name));
+        loader_cache_read_str(r, props->disable_env_var.value,
+                              sizeof(props->disable_env_var.value));
+        loader_cache_read_str(r, props->enable_env_var.name,
+                              sizeof(props->enable_env_var.name));
+        loader_cache_read_str(r, props->enable_env_var.value,
+                              sizeof(props->enable_env_var.value));
+
+        ext_count = loader_cache_read_u32(r);
+        for (j = 0; j < ext_count && !r->failed; j++) {
+            loader_cache_read(r, &ext_prop, sizeof(ext_prop));
+            loader_add_to_ext_list(inst, &props->instance_extension_list, 1,
+                                   &ext_prop);
+        }
+
+        ext_count = loader_cache_read_u32(r);
+        for (j = 0; j < ext_count && !r->failed; j++) {
+            loader_cache_read(r, &ext_prop, sizeof(ext_prop));
+            entry_count = loader_cache_read_u32(r);
+            if (r->failed || entry_count > r->size - r->pos)
+                return false;
+            entry_array = NULL;
+            if (entry_count) {
+                entry_array = (char **)loader_stack_alloc(sizeof(char *) *
+                                                          entry_count);
+                for (k = 0; k < entry_count; k++) {
+                    loader_cache_read_str(r, entry, sizeof(entry));
+                    entry_array[k] = loader_stack_alloc(strlen(entry) + 1);
+                    strcpy(entry_array[k], entry);
+                }
+            }
+            if (!r->failed)
+                loader_add_to_dev_ext_list(inst, &props->device_extension_list,
+                                           &ext_prop, entry_count,
+                                           entry_array);
+        }
+    }
+    return !r->failed;
+}
+
+/**
+ * Move layers parsed from a single manifest (into scratch lists that are
+ * both non-NULL) over to the caller's lists, using the same placement rules
+ * as loader_add_layer_properties applies when handed the caller's lists
+ * directly.  Entries that aren't moved are freed with the scratch lists.
+ */
+static void
+loader_move_manifest_layers(const struct loader_instance *inst,
+                            struct loader_layer_list *scratch_instance,
+                            struct loader_layer_list *scratch_device,
+                            struct loader_layer_list *layer_instance_list,
+                            struct loader_layer_list *layer_device_list) {
+    struct loader_layer_properties *src, *dst;
+    struct loader_layer_list *target;
+    uint32_t i;
+
+    for (i = 0; i < scratch_instance->count; i++) {
+        src = &scratch_instance->list[i];
+        if (src->type == VK_LAYER_TYPE_GLOBAL_EXPLICIT ||
+            src->type == VK_LAYER_TYPE_GLOBAL_IMPLICIT)
+            target = layer_instance_list ? layer_instance_list
+                                         : layer_device_list;
+        else
+            target = layer_instance_list;
+        if (target == NULL)
+            continue;
+        dst = loader_get_next_layer_property(inst, target);
+        if (dst == NULL)
+            continue;
+        memcpy(dst, src, sizeof(*src));
+        memset(src, 0, sizeof(*src));
+    }
+    for (i = 0; i < scratch_device->count; i++) {
+        src = &scratch_device->list[i];
+        // The device copy of a global layer only exists when both lists do
+        if (src->type == VK_LAYER_TYPE_GLOBAL_EXPLICIT ||
+            src->type == VK_LAYER_TYPE_GLOBAL_IMPLICIT)
+            target = layer_instance_list ? layer_device_list : NULL;
+        else
+            target = layer_device_list;
+        if (target == NULL)
+            continue;
+        dst = loader_get_next_layer_property(inst, target);
+        if (dst == NULL)
+            continue;
+        memcpy(dst, src, sizeof(*src));
+        memset(src, 0, sizeof(*src));
+    }
+    loader_delete_layer_properties(inst, scratch_instance);
+    loader_delete_layer_properties(inst, scratch_device);
+}
+
+/**
+ * Set up the instance/device scratch lists for one manifest.  Nearly every
+ * manifest holds a single layer, so size them for one entry rather than the
+ * 64 loader_get_next_layer_property would allocate and zero.
+ */
+static bool
+loader_init_manifest_scratch(const struct loader_instance *inst,
+                             struct loader_layer_list scratch[2]) {
+    uint32_t i;
+
+    memset(scratch, 0, 2 * sizeof(struct loader_layer_list));
+    for (i = 0; i < 2; i++) {
+        scratch[i].list =
+            loader_heap_alloc(inst, sizeof(struct loader_layer_properties),
+                              VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (scratch[i].list == NULL) {
+            loader_delete_layer_properties(inst, &scratch[0]);
+            return false;
+        }
+        memset(scratch[i].list, 0, sizeof(struct loader_layer_properties));
+        scratch[i].capacity = sizeof(struct loader_layer_properties);
+    }
+    return true;
+}
+
+/**
+ * Read one layer manifest file into the layer lists, going through the
+ * manifest cache when it is enabled.
+ */
+static void loader_read_layer_manifest(
+    const struct loader_instance *inst,
+    struct loader_layer_list *layer_instance_list,
+    struct loader_layer_list *layer_device_list, char *filename,
+    bool is_implicit) {
+    enum loader_manifest_kind kind = is_implicit
+                                         ? LOADER_MANIFEST_IMPLICIT_LAYER
+                                         : LOADER_MANIFEST_EXPLICIT_LAYER;
+    struct loader_layer_list scratch[2]; // [0] = instance, [1] = device
+    struct loader_cache_writer w;
+    struct loader_cache_reader r;
+    const void *data;
+    size_t size;
+    cJSON *json;
+    bool cache_enabled, found, cached = false;
+
+    loader_platform_thread_lock_mutex(&loader_json_lock);
+    cache_enabled = loader_manifest_cache_enabled();
+    loader_platform_thread_unlock_mutex(&loader_json_lock);
+    if (!cache_enabled) {
+        json = loader_get_json(inst, filename);
+        if (!json)
+            return;
+        // TODO error if device layers expose instance_extensions
+        // TODO error if instance layers expose device extensions
+        loader_add_layer_properties(inst, layer_instance_list,
+                                    layer_device_list, json, is_implicit,
+                                    filename);
+        cJSON_Delete(json);
+        return;
+    }
+
+    if (!loader_init_manifest_scratch(inst, scratch))
+        return;
+    // The payload belongs to the cache, so it's decoded under the lock
+    loader_platform_thread_lock_mutex(&loader_json_lock);
+    found = loader_manifest_cache_lookup(filename, kind, &data, &size);
+    if (found) {
+        r.data = data;
+        r.size = size;
+        r.pos = 0;
+        r.failed = false;
+        cached = loader_decode_layer_list(inst, &r, &scratch[0]) &&
+                 loader_decode_layer_list(inst, &r, &scratch[1]);
+    }
+    loader_platform_thread_unlock_mutex(&loader_json_lock);
+    if (cached) {
+        loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
+                   "Using cached layer manifest %s", filename);
+        loader_move_manifest_layers(inst, &scratch[0], &scratch[1],
+                                    layer_instance_list, layer_device_list);
+        return;
+    }
+    if (found) {
+        loader_delete_layer_properties(inst, &scratch[0]);
+        loader_delete_layer_properties(inst, &scratch[1]);
+        if (!loader_init_manifest_scratch(inst, scratch))
+            return;
+    }
+
+    json = loader_get_json(inst, filename);
+    if (!json) {
+        loader_delete_layer_properties(inst, &scratch[0]);
+        loader_delete_layer_properties(inst, &scratch[1]);
+        return;
+    }
+    loader_add_layer_properties(inst, &scratch[0], &scratch[1], json,
+                                is_implicit, filename);
+    cJSON_Delete(json);
+
+    memset(&w, 0, sizeof(w));
+    loader_encode_layer_list(&w, &scratch[0]);
+    loader_encode_layer_list(&w, &scratch[1]);
+    if (!w.failed) {
+        loader_platform_thread_lock_mutex(&loader_json_lock);
+        loader_manifest_cache_store(filename, kind, w.data, w.size);
+        loader_platform_thread_unlock_mutex(&loader_json_lock);
+    }
+    loader_cache_writer_free(&w);
+
+    loader_move_manifest_layers(inst, &scratch[0], &scratch[1],
+                                layer_instance_list, layer_device_list);
+}
+
 /**
  * Find the Vulkan library manifest files.
  *
@@ -2420,12 +2866,33 @@ void loader_icd_scan(const struct loader_instance *inst,
                               &manifest_files);
     if (manifest_files.count == 0)
         return;
-    loader_platform_thread_lock_mutex(&loader_json_lock);
     for (uint32_t i = 0; i < manifest_files.count; i++) {
         file_str = manifest_files.filename_list[i];
         if (file_str == NULL)
             continue;
 
+        const void *cache_data;
+        size_t cache_size;
+        char cached_path[MAX_STRING_SIZE];
+        uint32_t cached_vers;
+        bool cached = false;
+        loader_platform_thread_lock_mutex(&loader_json_lock);
+        if (loader_manifest_cache_lookup(file_str, LOADER_MANIFEST_ICD,
+                                         &cache_data, &cache_size)) {
+            struct loader_cache_reader r = {cache_data, cache_size, 0, false};
+            loader_cache_read_str(&r, cached_path, sizeof(cached_path));
+            cached_vers = loader_cache_read_u32(&r);
+            cached = !r.failed;
+        }
+        loader_platform_thread_unlock_mutex(&loader_json_lock);
+        if (cached) {
+            loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
+                       "Using cached ICD manifest %s", file_str);
+            loader_scanned_icd_add(inst, icds, cached_path, cached_vers);
+            loader_heap_free(inst, file_str);
+            continue;
+        }
+
         cJSON *json;
         json = loader_get_json(inst, file_str);
         if (!json)
@@ -2433,7 +2900,6 @@ void loader_icd_scan(const struct loader_instance *inst,
         cJSON *item, *itemICD;
         item = cJSON_GetObjectItem(json, "file_format_version");
         if (item == NULL) {
-            loader_platform_thread_unlock_mutex(&loader_json_lock);
             return;
         }
         char *file_vers = cJSON_Print(item);
@@ -2500,6 +2966,17 @@ void loader_icd_scan(const struct loader_instance *inst,
                     vers = loader_make_version(temp);
                     loader_tls_heap_free(temp);
                 }
+                loader_platform_thread_lock_mutex(&loader_json_lock);
+                if (loader_manifest_cache_enabled()) {
+                    struct loader_cache_writer w = {NULL, 0, 0, false};
+                    loader_cache_write_str(&w, fullpath);
+                    loader_cache_write_u32(&w, vers);
+                    if (!w.failed)
+                        loader_manifest_cache_store(
+                            file_str, LOADER_MANIFEST_ICD, w.data, w.size);
+                    loader_cache_writer_free(&w);
+                }
+                loader_platform_thread_unlock_mutex(&loader_json_lock);
                 loader_scanned_icd_add(inst, icds, fullpath, vers);
             } else
                 loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
@@ -2516,6 +2993,8 @@ void loader_icd_scan(const struct loader_instance *inst,
         cJSON_Delete(json);
     }
     loader_heap_free(inst, manifest_files.filename_list);
+    loader_platform_thread_lock_mutex(&loader_json_lock);
+    loader_manifest_cache_flush();
     loader_platform_thread_unlock_mutex(&loader_json_lock);
 }
 
@@ -2525,7 +3004,6 @@ void loader_layer_scan(const struct loader_instance *inst,
     char *file_str;
     struct loader_manifest_files
         manifest_files[2]; // [0] = explicit, [1] = implicit
-    cJSON *json;
     uint32_t i;
     uint32_t implicit;
 
@@ -2544,26 +3022,15 @@ void loader_layer_scan(const struct loader_instance *inst,
     loader_delete_layer_properties(inst, instance_layers);
     loader_delete_layer_properties(inst, device_layers);
 
-    loader_platform_thread_lock_mutex(&loader_json_lock);
     for (implicit = 0; implicit < 2; implicit++) {
         for (i = 0; i < manifest_files[implicit].count; i++) {
             file_str = manifest_files[implicit].filename_list[i];
             if (file_str == NULL)
                 continue;
 
-            // parse file into JSON struct
-            json = loader_get_json(inst, file_str);
-            if (!json) {
-                continue;
-            }
-
-            // TODO error if device layers expose instance_extensions
-            // TODO error if instance layers expose device extensions
-            loader_add_layer_properties(inst, instance_layers, device_layers,
-                                        json, (implicit == 1), file_str);
-
+            loader_read_layer_manifest(inst, instance_layers, device_layers,
+                                       file_str, (implicit == 1));
             loader_heap_free(inst, file_str);
-            cJSON_Delete(json);
         }
     }
     if (manifest_files[0].count != 0)
@@ -2577,6 +3044,8 @@ void loader_layer_scan(const struct loader_instance *inst,
         inst, sizeof(std_validation_names) / sizeof(std_validation_names[0]),
         std_validation_names, instance_layers, device_layers);
 
+    loader_platform_thread_lock_mutex(&loader_json_lock);
+    loader_manifest_cache_flush();
     loader_platform_thread_unlock_mutex(&loader_json_lock);
 }
 
@@ -2585,7 +3054,6 @@ void loader_implicit_layer_scan(const struct loader_instance *inst,
                                 struct loader_layer_list *device_layers) {
     char *file_str;
     struct loader_manifest_files manifest_files;
-    cJSON *json;
     uint32_t i;
 
     // Pass NULL for environment variable override - implicit layers are not
@@ -2600,25 +3068,15 @@ void loader_implicit_layer_scan(const struct loader_instance *inst,
     loader_delete_layer_properties(inst, instance_layers);
     loader_delete_layer_properties(inst, device_layers);
 
-    loader_platform_thread_lock_mutex(&loader_json_lock);
-
     for (i = 0; i < manifest_files.count; i++) {
         file_str = manifest_files.filename_list[i];
         if (file_str == NULL) {
             continue;
         }
 
-        // parse file into JSON struct
-        json = loader_get_json(inst, file_str);
-        if (!json) {
-            continue;
-        }
-
-        loader_add_layer_properties(inst, instance_layers, device_layers, json,
-                                    true, file_str);
-
+        loader_read_layer_manifest(inst, instance_layers, device_layers,
+                                   file_str, true);
         loader_heap_free(inst, file_str);
-        cJSON_Delete(json);
     }
 
     if (manifest_files.count != 0) {
@@ -2630,6 +3088,8 @@ void loader_implicit_layer_scan(const struct loader_instance *inst,
         inst, sizeof(std_validation_names) / sizeof(std_validation_names[0]),
         std_validation_names, instance_layers, device_layers);
 
+    loader_platform_thread_lock_mutex(&loader_json_lock);
+    loader_manifest_cache_flush();
     loader_platform_thread_unlock_mutex(&loader_json_lock);
 }
 
@@ -2693,19 +3153,16 @@ static void loader_init_dispatch_dev_ext_entry(struct loader_instance *inst,
         gdpa_value = dev->loader_dispatch.core_dispatch.GetDeviceProcAddr(
             dev->device, funcName);
         if (gdpa_value != NULL)
-            dev->loader_dispatch.ext_dispatch.DevExt[idx] =
-                (PFN_vkDevExt)gdpa_value;
+            loader_set_dev_ext_entry(inst, dev, idx, gdpa_value);
     } else {
-        for (uint32_t i = 0; i < inst->total_icd_count; i++) {
-            struct loader_icd *icd = &inst->icds[i];
+        for (struct loader_icd *icd = inst->icds; icd; icd = icd->next) {
             struct loader_device *ldev = icd->logical_device_list;
             while (ldev) {
                 gdpa_value =
                     ldev->loader_dispatch.core_dispatch.GetDeviceProcAddr(
                         ldev->device, funcName);
                 if (gdpa_value != NULL)
-                    ldev->loader_dispatch.ext_dispatch.DevExt[idx] =
-                        (PFN_vkDevExt)gdpa_value;
+                    loader_set_dev_ext_entry(inst, ldev, idx, gdpa_value);
                 ldev = ldev->next;
             }
         }
@@ -2715,15 +3172,13 @@ static void loader_init_dispatch_dev_ext_entry(struct loader_instance *inst,
 /**
  * Find all dev extension in the hash table  and initialize the dispatch table
  * for dev  for each of those extension entrypoints found in hash table.
-
+ * Called with loader_lock held.
  */
 void loader_init_dispatch_dev_ext(struct loader_instance *inst,
                                   struct loader_device *dev) {
-    for (uint32_t i = 0; i < MAX_NUM_DEV_EXTS; i++) {
-        if (inst->disp_hash[i].func_name != NULL)
-            loader_init_dispatch_dev_ext_entry(inst, dev, i,
-                                               inst->disp_hash[i].func_name);
-    }
+    const struct loader_dev_ext_table *table = &inst->dev_ext_table;
+    for (uint32_t i = 0; i < table->count; i++)
+        loader_init_dispatch_dev_ext_entry(inst, dev, i, table->names[i]);
 }
 
 static bool loader_check_icds_for_address(struct loader_instance *inst,
@@ -2781,105 +3236,124 @@ loader_check_layers_for_address(const struct loader_instance *const inst,
 }
 
 static void loader_free_dev_ext_table(struct loader_instance *inst) {
-    for (uint32_t i = 0; i < MAX_NUM_DEV_EXTS; i++) {
-        loader_heap_free(inst, inst->disp_hash[i].func_name);
-        loader_heap_free(inst, inst->disp_hash[i].list.index);
+    struct loader_dev_ext_table *table = &inst->dev_ext_table;
+    for (uint32_t i = 0; i < table->count; i++)
+        loader_heap_free(inst, table->names[i]);
+    loader_heap_free(inst, table->names);
+    loader_heap_free(inst, table->slots);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Find the slot for funcName in a hash of slot_count (a power of two) slots:
+ * either the one holding it or the empty one where it belongs.  Probes
+ * triangular numbers apart, which visits every slot of a power of two sized
+ * hash.
+ */
+static struct loader_dev_ext_hash_slot *
+loader_find_dev_ext_slot(const struct loader_dev_ext_table *table,
+                         struct loader_dev_ext_hash_slot *slots,
+                         uint32_t slot_count, uint32_t hash,
+                         const char *funcName) {
+    const uint32_t mask = slot_count - 1;
+    uint32_t i = hash & mask;
+    for (uint32_t step = 1;; step++) {
+        struct loader_dev_ext_hash_slot *slot = &slots[i];
+        if (slot->index == 0)
+            return slot;
+        if (slot->hash == hash && funcName &&
+            !strcmp(table->names[slot->index - 1], funcName))
+            return slot;
+        i = (i + step) & mask;
     }
-    memset(inst->disp_hash, 0, sizeof(inst->disp_hash));
 }
 
+// Double the hash's slots, or create them, to keep at most 3/4 of them used
+static bool loader_grow_dev_ext_slots(struct loader_instance *inst,
+                                      struct loader_dev_ext_table *table) {
+    const uint32_t slot_count = table->slot_count ? table->slot_count * 2 : 64;
+    struct loader_dev_ext_hash_slot *slots;
+
+    slots = loader_heap_alloc(inst, slot_count * sizeof(*slots),
+                              VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (slots == NULL)
+        return false;
+    memset(slots, 0, slot_count * sizeof(*slots));
+    for (uint32_t i = 0; i < table->slot_count; i++) {
+        if (table->slots[i].index == 0)
+            continue;
+        // names are unique, so there's no need to compare them
+        *loader_find_dev_ext_slot(table, slots, slot_count,
+                                  table->slots[i].hash, NULL) = table->slots[i];
+    }
+    loader_heap_free(inst, table->slots);
+    table->slots = slots;
+    table->slot_count = slot_count;
+    return true;
+}
+
+/**
+ * Give funcName the next trampoline index and store it in the empty slot
+ * loader_find_dev_ext_slot() found for it, growing the table as needed.
+ */
 static bool loader_add_dev_ext_table(struct loader_instance *inst,
-                                     uint32_t *ptr_idx, const char *funcName) {
-    uint32_t i;
-    uint32_t idx = *ptr_idx;
-    struct loader_dispatch_hash_list *list = &inst->disp_hash[idx].list;
-
-    if (!inst->disp_hash[idx].func_name) {
-        // no entry here at this idx, so use it
-        assert(list->capacity == 0);
-        inst->disp_hash[idx].func_name = (char *)loader_heap_alloc(
-            inst, strlen(funcName) + 1, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-        if (inst->disp_hash[idx].func_name == NULL) {
-            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                       "loader_add_dev_ext_table() can't allocate memory for "
-                       "func_name");
-            return false;
-        }
-        strncpy(inst->disp_hash[idx].func_name, funcName, strlen(funcName) + 1);
-        return true;
+                                     struct loader_dev_ext_hash_slot *slot,
+                                     uint32_t hash, uint32_t *ptr_idx,
+                                     const char *funcName) {
+    struct loader_dev_ext_table *table = &inst->dev_ext_table;
+    char *name;
+
+    if (table->count == MAX_NUM_DEV_EXTS) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "loader_add_dev_ext_table() can't add %s, all %d unknown "
+                   "device entrypoint trampolines are in use",
+                   funcName, MAX_NUM_DEV_EXTS);
+        return false;
     }
 
-    // check for enough capacity
-    if (list->capacity == 0) {
-        list->index = loader_heap_alloc(inst, 8 * sizeof(*(list->index)),
-                                        VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-        if (list->index == NULL) {
+    if (table->count == table->name_capacity) {
+        const uint32_t capacity =
+            table->name_capacity ? table->name_capacity * 2 : 32;
+        char **names = loader_heap_realloc(
+            inst, table->names, table->name_capacity * sizeof(*names),
+            capacity * sizeof(*names), VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (names == NULL) {
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                       "loader_add_dev_ext_table() can't allocate list memory");
+                       "loader_add_dev_ext_table() can't reallocate names "
+                       "memory");
             return false;
         }
-        list->capacity = 8 * sizeof(*(list->index));
-    } else if (list->capacity < (list->count + 1) * sizeof(*(list->index))) {
-        list->index = loader_heap_realloc(inst, list->index, list->capacity,
-                                          list->capacity * 2,
-                                          VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-        if (list->index == NULL) {
-            loader_log(
-                inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                "loader_add_dev_ext_table() can't reallocate list memory");
-            return false;
-        }
-        list->capacity *= 2;
+        table->names = names;
+        table->name_capacity = capacity;
     }
 
-    // find an unused index in the hash table and use it
-    i = (idx + 1) % MAX_NUM_DEV_EXTS;
-    do {
-        if (!inst->disp_hash[i].func_name) {
-            assert(inst->disp_hash[i].list.capacity == 0);
-            inst->disp_hash[i].func_name =
-                (char *)loader_heap_alloc(inst, strlen(funcName) + 1,
-                                          VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-            if (inst->disp_hash[i].func_name == NULL) {
-                loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                           "loader_add_dev_ext_table() can't rallocate "
-                           "func_name memory");
-                return false;
-            }
-            strncpy(inst->disp_hash[i].func_name, funcName,
-                    strlen(funcName) + 1);
-            list->index[list->count] = i;
-            list->count++;
-            *ptr_idx = i;
-            return true;
-        }
-        i = (i + 1) % MAX_NUM_DEV_EXTS;
-    } while (i != idx);
-
-    loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-               "loader_add_dev_ext_table() couldn't insert into hash table; is "
-               "it full?");
-    return false;
-}
-
-static bool loader_name_in_dev_ext_table(struct loader_instance *inst,
-                                         uint32_t *idx, const char *funcName) {
-    uint32_t alt_idx;
-    if (inst->disp_hash[*idx].func_name &&
-        !strcmp(inst->disp_hash[*idx].func_name, funcName))
-        return true;
+    name = loader_heap_alloc(inst, strlen(funcName) + 1,
+                             VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (name == NULL) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "loader_add_dev_ext_table() can't allocate memory for "
+                   "func_name");
+        return false;
+    }
+    strcpy(name, funcName);
 
-    // funcName wasn't at the primary spot in the hash table
-    // search the list of secondary locations (shallow search, not deep search)
-    for (uint32_t i = 0; i < inst->disp_hash[*idx].list.count; i++) {
-        alt_idx = inst->disp_hash[*idx].list.index[i];
-        if (!strcmp(inst->disp_hash[*idx].func_name, funcName)) {
-            *idx = alt_idx;
-            return true;
+    if ((table->count + 1) * 4 > table->slot_count * 3) {
+        if (!loader_grow_dev_ext_slots(inst, table)) {
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                       "loader_add_dev_ext_table() can't reallocate hash "
+                       "memory");
+            loader_heap_free(inst, name);
+            return false;
         }
+        slot = loader_find_dev_ext_slot(table, table->slots, table->slot_count,
+                                        hash, NULL);
     }
 
-    return false;
+    table->names[table->count] = name;
+    slot->hash = hash;
+    slot->index = ++table->count;
+    *ptr_idx = table->count - 1;
+    return true;
 }
 
 /**
@@ -2897,18 +3371,34 @@ static bool loader_name_in_dev_ext_table(struct loader_instance *inst,
  * has not been seen yet. Next check if a layer or ICD supports it.  If so then
  * a
  * new entry in the hash table is initialized and that trampoline address for
- * the new entry is returned. Null is returned if the hash table is full or
+ * the new entry is returned. Null is returned if all trampolines are in use or
  * if no discovered layer or ICD returns a non-NULL GetProcAddr for it.
  */
 void *loader_dev_ext_gpa(struct loader_instance *inst, const char *funcName) {
+    struct loader_dev_ext_table *table = &inst->dev_ext_table;
+    struct loader_dev_ext_hash_slot *slot = NULL;
+    const uint32_t hash = murmurhash(funcName, strlen(funcName), 0);
+    void *addr = NULL;
     uint32_t idx;
-    uint32_t seed = 0;
 
-    idx = murmurhash(funcName, strlen(funcName), seed) % MAX_NUM_DEV_EXTS;
-
-    if (loader_name_in_dev_ext_table(inst, &idx, funcName))
-        // found funcName already in hash
-        return loader_get_dev_ext_trampoline(idx);
+    // The table is shared by every thread using the instance, so it's only
+    // looked at and added to with loader_lock held.  The ICDs and layers are
+    // asked whether they support funcName without it, as their
+    // GetInstanceProcAddrs may call back into the loader.  The devices are
+    // asked for it with the lock held, as that keeps vkDestroyDevice from
+    // freeing them meanwhile.
+    loader_platform_thread_lock_mutex(&loader_lock);
+    if (table->slot_count) {
+        slot = loader_find_dev_ext_slot(table, table->slots, table->slot_count,
+                                        hash, funcName);
+        if (slot->index != 0) {
+            // found funcName already in hash
+            addr = loader_get_dev_ext_trampoline(slot->index - 1);
+            loader_platform_thread_unlock_mutex(&loader_lock);
+            return addr;
+        }
+    }
+    loader_platform_thread_unlock_mutex(&loader_lock);
 
     // Check if funcName is supported in either ICDs or a layer library
     if (!loader_check_icds_for_address(inst, funcName) &&
@@ -2917,40 +3407,46 @@ void *loader_dev_ext_gpa(struct loader_instance *inst, const char *funcName) {
         return NULL;
     }
 
-    if (loader_add_dev_ext_table(inst, &idx, funcName)) {
+    // Another thread may have added funcName, or grown the hash, meanwhile
+    loader_platform_thread_lock_mutex(&loader_lock);
+    slot = NULL;
+    if (table->slot_count) {
+        slot = loader_find_dev_ext_slot(table, table->slots, table->slot_count,
+                                        hash, funcName);
+    }
+    if (slot != NULL && slot->index != 0) {
+        addr = loader_get_dev_ext_trampoline(slot->index - 1);
+    } else if (loader_add_dev_ext_table(inst, slot, hash, &idx, funcName)) {
         // successfully added new table entry
         // init any dev dispatch table entrys as needed
         loader_init_dispatch_dev_ext_entry(inst, NULL, idx, funcName);
-        return loader_get_dev_ext_trampoline(idx);
+        addr = loader_get_dev_ext_trampoline(idx);
     }
+    loader_platform_thread_unlock_mutex(&loader_lock);
 
-    return NULL;
+    return addr;
 }
 
 struct loader_instance *loader_get_instance(const VkInstance instance) {
-    /* look up the loader_instance in our list by comparing dispatch tables, as
-     * there is no guarantee the instance is still a loader_instance* after any
-     * layers which wrap the instance object.
+    /* there is no guarantee the instance is still a loader_instance* after any
+     * layers which wrap the instance object, but every wrapper shares the
+     * loader's dispatch table, which points back to the loader_instance.
      */
-    const VkLayerInstanceDispatchTable *disp;
-    struct loader_instance *ptr_instance = NULL;
-    disp = loader_get_instance_dispatch(instance);
-    for (struct loader_instance *inst = loader.instances; inst;
-         inst = inst->next) {
-        if (inst->disp == disp) {
-            ptr_instance = inst;
-            break;
-        }
+    const struct loader_instance_dispatch_table *disp;
+    disp = (const struct loader_instance_dispatch_table *)
+        loader_get_instance_dispatch(instance);
+    if (disp == NULL) {
+        return NULL;
     }
-    return ptr_instance;
+    assert(disp->instance->disp == &disp->layer_inst_disp);
+    return disp->instance;
 }
 
 static loader_platform_dl_handle
 loader_open_layer_lib(const struct loader_instance *inst, const char *chain_type,
                      struct loader_layer_properties *prop) {
 
-    if ((prop->lib_handle = loader_platform_open_library(prop->lib_name)) ==
-        NULL) {
+    if ((prop->lib_handle = loader_open_lib(prop->lib_name)) == NULL) {
         loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                    loader_platform_open_library_error(prop->lib_name));
     } else {
@@ -2967,7 +3463,7 @@ loader_close_layer_lib(const struct loader_instance *inst,
                         struct loader_layer_properties *prop) {
 
     if (prop->lib_handle) {
-        loader_platform_close_library(prop->lib_handle);
+        loader_close_lib(prop->lib_handle);
         loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
                    "Unloading layer library %s", prop->lib_name);
         prop->lib_handle = NULL;
@@ -3108,8 +3604,17 @@ loader_enable_instance_layers(struct loader_instance *inst,
     err = loader_add_layer_names_to_list(
         inst, &inst->activated_layer_list, pCreateInfo->enabledLayerCount,
         pCreateInfo->ppEnabledLayerNames, instance_layers);
+    if (err != VK_SUCCESS)
+        return err;
 
-    return err;
+    /* Load the libraries now, so that loader_create_instance_chain() doesn't
+     * have to while vkCreateInstance holds loader_lock. A layer whose library
+     * can't be loaded is left out of the chain. */
+    for (uint32_t i = 0; i < inst->activated_layer_list.count; i++)
+        loader_open_layer_lib(inst, "instance",
+                              &inst->activated_layer_list.list[i]);
+
+    return VK_SUCCESS;
 }
 
 /*
@@ -3165,9 +3670,9 @@ VkResult loader_create_instance_chain(const VkInstanceCreateInfo *pCreateInfo,
         for (int32_t i = inst->activated_layer_list.count - 1; i >= 0; i--) {
             struct loader_layer_properties *layer_prop =
                 &inst->activated_layer_list.list[i];
-            loader_platform_dl_handle lib_handle;
+            loader_platform_dl_handle lib_handle = layer_prop->lib_handle;
 
-            lib_handle = loader_open_layer_lib(inst, "instance", layer_prop);
+            // Opened by loader_enable_instance_layers()
             if (!lib_handle)
                 continue;
             if ((fpGIPA = layer_prop->functions.get_instance_proc_addr) ==
@@ -3680,7 +4185,6 @@ terminator_DestroyInstance(VkInstance instance,
                                    &ptr_instance->device_layer_list);
     loader_delete_layer_properties(ptr_instance,
                                    &ptr_instance->instance_layer_list);
-    loader_scanned_icd_clear(ptr_instance, &ptr_instance->icd_libs);
     loader_destroy_generic_list(
         ptr_instance, (struct loader_generic_list *)&ptr_instance->ext_list);
     if (ptr_instance->phys_devs_term)
@@ -3777,18 +4281,20 @@ terminator_CreateDevice(VkPhysicalDevice physicalDevice,
     return res;
 }
 
-VKAPI_ATTR VkResult VKAPI_CALL
-terminator_EnumeratePhysicalDevices(VkInstance instance,
-                                    uint32_t *pPhysicalDeviceCount,
-                                    VkPhysicalDevice *pPhysicalDevices) {
-    uint32_t i;
-    struct loader_instance *inst = (struct loader_instance *)instance;
-    VkResult res = VK_SUCCESS;
-
+/* Ask every ICD for its physical devices and wrap them in inst->phys_devs_term.
+ * This happens once per instance: the wrappers are the handles the layers and
+ * the trampoline see, so they have to stay the same for the life of the
+ * instance, and later enumerations are answered from them without calling
+ * into the drivers. A failed enumeration leaves nothing behind, so the next
+ * call asks the drivers again. */
+static VkResult
+loader_enumerate_icd_physical_devices(struct loader_instance *inst) {
+    uint32_t i, j, idx = 0;
+    uint32_t total_count = 0;
     struct loader_icd *icd;
     struct loader_phys_dev_per_icd *phys_devs;
+    VkResult res;
 
-    inst->total_gpu_count = 0;
     phys_devs = (struct loader_phys_dev_per_icd *)loader_stack_alloc(
         sizeof(struct loader_phys_dev_per_icd) * inst->total_icd_count);
     if (!phys_devs)
@@ -3797,75 +4303,77 @@ terminator_EnumeratePhysicalDevices(VkInstance instance,
     icd = inst->icds;
     for (i = 0; i < inst->total_icd_count; i++) {
         assert(icd);
+        phys_devs[i].this_icd = icd;
+        phys_devs[i].phys_devs = NULL;
         res = icd->EnumeratePhysicalDevices(icd->instance, &phys_devs[i].count,
                                             NULL);
         if (res != VK_SUCCESS)
             return res;
+        if (phys_devs[i].count) {
+            phys_devs[i].phys_devs = (VkPhysicalDevice *)loader_stack_alloc(
+                phys_devs[i].count * sizeof(VkPhysicalDevice));
+            if (!phys_devs[i].phys_devs)
+                return VK_ERROR_OUT_OF_HOST_MEMORY;
+            res = icd->EnumeratePhysicalDevices(
+                icd->instance, &phys_devs[i].count, phys_devs[i].phys_devs);
+            if (res != VK_SUCCESS)
+                return res;
+        }
+        total_count += phys_devs[i].count;
         icd = icd->next;
     }
 
-    icd = inst->icds;
-    for (i = 0; i < inst->total_icd_count; i++) {
-        assert(icd);
-        phys_devs[i].phys_devs = (VkPhysicalDevice *)loader_stack_alloc(
-            phys_devs[i].count * sizeof(VkPhysicalDevice));
-        if (!phys_devs[i].phys_devs) {
+    if (total_count) {
+        inst->phys_devs_term = loader_heap_alloc(
+            inst, sizeof(struct loader_physical_device) * total_count,
+            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (!inst->phys_devs_term)
             return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    for (i = 0; i < inst->total_icd_count; i++) {
+        for (j = 0; j < phys_devs[i].count; j++) {
+            loader_set_dispatch((void *)&inst->phys_devs_term[idx], inst->disp);
+            inst->phys_devs_term[idx].this_icd = phys_devs[i].this_icd;
+            inst->phys_devs_term[idx].phys_dev = phys_devs[i].phys_devs[j];
+            idx++;
         }
-        res = icd->EnumeratePhysicalDevices(
-            icd->instance, &(phys_devs[i].count), phys_devs[i].phys_devs);
-        if ((res == VK_SUCCESS)) {
-            inst->total_gpu_count += phys_devs[i].count;
-        } else {
+    }
+    inst->total_gpu_count = total_count;
+    inst->phys_devs_term_valid = true;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+terminator_EnumeratePhysicalDevices(VkInstance instance,
+                                    uint32_t *pPhysicalDeviceCount,
+                                    VkPhysicalDevice *pPhysicalDevices) {
+    uint32_t i;
+    uint32_t copy_count;
+    struct loader_instance *inst = (struct loader_instance *)instance;
+    VkResult res;
+
+    if (!inst->phys_devs_term_valid) {
+        res = loader_enumerate_icd_physical_devices(inst);
+        if (res != VK_SUCCESS)
             return res;
-        }
-        phys_devs[i].this_icd = icd;
-        icd = icd->next;
     }
 
-    *pPhysicalDeviceCount = inst->total_gpu_count;
     if (!pPhysicalDevices) {
-        return res;
+        *pPhysicalDeviceCount = inst->total_gpu_count;
+        return VK_SUCCESS;
     }
 
-    /* Initialize the output pPhysicalDevices  with wrapped loader terminator
-     * physicalDevice objects; save this list of wrapped objects in instance
-     * struct for later cleanup and use by trampoline code */
-    uint32_t j, idx = 0;
-    uint32_t copy_count = 0;
-
     copy_count = (inst->total_gpu_count < *pPhysicalDeviceCount)
                      ? inst->total_gpu_count
                      : *pPhysicalDeviceCount;
-
-    if (inst->phys_devs_term)
-        loader_heap_free(inst, inst->phys_devs_term);
-    inst->phys_devs_term = loader_heap_alloc(
-        inst, sizeof(struct loader_physical_device) * copy_count,
-        VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    if (!inst->phys_devs_term)
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
-
-    for (i = 0; idx < copy_count && i < inst->total_icd_count; i++) {
-
-        for (j = 0; j < phys_devs[i].count && idx < copy_count; j++) {
-            loader_set_dispatch((void *)&inst->phys_devs_term[idx], inst->disp);
-            inst->phys_devs_term[idx].this_icd = phys_devs[i].this_icd;
-            inst->phys_devs_term[idx].phys_dev = phys_devs[i].phys_devs[j];
-            pPhysicalDevices[idx] =
-                (VkPhysicalDevice)&inst->phys_devs_term[idx];
-            idx++;
-        }
+    for (i = 0; i < copy_count; i++) {
+        pPhysicalDevices[i] = (VkPhysicalDevice)&inst->phys_devs_term[i];
     }
     *pPhysicalDeviceCount = copy_count;
 
-    // TODO: Is phys_devs being leaked?
-
-    if (copy_count < inst->total_gpu_count) {
-        inst->total_gpu_count = copy_count;
+    if (copy_count < inst->total_gpu_count)
         return VK_INCOMPLETE;
-    }
-    return res;
+    return VK_SUCCESS;
 }
 
 VKAPI_ATTR void VKAPI_CALL terminator_GetPhysicalDeviceProperties(
@@ -137,25 +137,36 @@ struct loader_layer_list {
     struct loader_layer_properties *list;
 };
 
-struct loader_dispatch_hash_list {
-    size_t capacity;
-    uint32_t count;
-    uint32_t *index; // index into the dev_ext dispatch table
+// Unknown device entrypoints, such as those of device extensions the loader
+// doesn't know about, are each given one of MAX_NUM_DEV_EXTS generic
+// trampolines, which vk-loader-generate.py generates into
+// dev_ext_trampoline.c at build time.  Trampoline i calls entry i of the
+// device's loader_dev_ext_dispatch_table.  Its entries are split into banks of
+// DEV_EXT_BANK_SIZE so that a device only allocates the banks in use, and so
+// that entries never move while other threads call through them.
+#define DEV_EXT_BANK_SIZE 256
+#define MAX_NUM_DEV_EXT_BANKS 16
+#define MAX_NUM_DEV_EXTS (DEV_EXT_BANK_SIZE * MAX_NUM_DEV_EXT_BANKS)
+
+// One slot of loader_dev_ext_table's open-addressed hash
+struct loader_dev_ext_hash_slot {
+    uint32_t hash;
+    uint32_t index; // trampoline index + 1, 0 if the slot is empty
 };
 
-#define MAX_NUM_DEV_EXTS 250
-// loader_dispatch_hash_entry and loader_dev_ext_dispatch_table.DevExt have one
-// to one
-// correspondence; one loader_dispatch_hash_entry for one DevExt dispatch entry.
-// Also have a one to one correspondence with functions in dev_ext_trampoline.c
-struct loader_dispatch_hash_entry {
-    char *func_name;
-    struct loader_dispatch_hash_list list; // to handle hashing collisions
+// The unknown device entrypoints an instance has handed out trampolines for
+struct loader_dev_ext_table {
+    uint32_t count;         // names, and the next trampoline index to give out
+    uint32_t name_capacity;
+    char **names;           // by trampoline index
+    uint32_t slot_count;    // power of two, at most 3/4 used
+    struct loader_dev_ext_hash_slot *slots;
 };
 
 typedef void(VKAPI_PTR *PFN_vkDevExt)(VkDevice device);
 struct loader_dev_ext_dispatch_table {
-    PFN_vkDevExt DevExt[MAX_NUM_DEV_EXTS];
+    // Banks not in use point to the shared loader_dev_ext_error_bank
+    PFN_vkDevExt *DevExt[MAX_NUM_DEV_EXT_BANKS];
 };
 
 struct loader_dev_dispatch_table {
@@ -248,11 +259,22 @@ struct loader_icd_libs {
     struct loader_scanned_icds *list;
 };
 
+/* The app's debug report callbacks. A list is never changed once it is
+ * published in loader_instance::dbg_callbacks; creating or destroying a
+ * callback publishes a changed copy, so messages are delivered without
+ * loader_lock. */
+struct loader_dbg_callback_list {
+    uint32_t count;
+    VkLayerDbgFunctionNode *callbacks;
+    struct loader_dbg_callback_list *next_retired;
+};
+
 /* per instance structure */
 struct loader_instance {
     VkLayerInstanceDispatchTable *disp; // must be first entry in structure
 
     uint32_t total_gpu_count; // count of the next two arrays
+    bool phys_devs_term_valid; // the ICDs' devices are enumerated and wrapped
     struct loader_physical_device *phys_devs_term;
     struct loader_physical_device_tramp *
         phys_devs; // tramp wrapped physDev obj list
@@ -263,7 +285,7 @@ struct loader_instance {
     struct loader_icd_libs icd_libs;
     struct loader_layer_list instance_layer_list;
     struct loader_layer_list device_layer_list;
-    struct loader_dispatch_hash_entry disp_hash[MAX_NUM_DEV_EXTS];
+    struct loader_dev_ext_table dev_ext_table;
 
     struct loader_msg_callback_map_entry *icd_msg_callback_map;
 
@@ -272,7 +294,12 @@ struct loader_instance {
     VkInstance instance; // layers/ICD instance returned to trampoline
 
     bool debug_report_enabled;
-    VkLayerDbgFunctionNode *DbgFunctionHead;
+    /* Replaced under loader_lock. Readers load it atomically between
+     * incrementing and decrementing dbg_callback_readers; lists it replaced
+     * wait on dbg_callbacks_retired until a writer sees no readers. */
+    struct loader_dbg_callback_list *dbg_callbacks;
+    struct loader_dbg_callback_list *dbg_callbacks_retired;
+    uint32_t dbg_callback_readers;
     uint32_t num_tmp_callbacks;
     VkDebugReportCallbackCreateInfoEXT *tmp_dbg_create_infos;
     VkDebugReportCallbackEXT *tmp_callbacks;
@@ -301,6 +328,15 @@ struct loader_instance {
     bool wsi_display_enabled;
 };
 
+/* The instance dispatch table the loader allocates for each instance. Every
+ * object that dispatches through it, including layers' wrappers of the
+ * instance, points to it, so loader_get_instance() finds the instance from any
+ * of them without searching loader.instances. */
+struct loader_instance_dispatch_table {
+    VkLayerInstanceDispatchTable layer_inst_disp; // must be first entry
+    struct loader_instance *instance;
+};
+
 /* VkPhysicalDevice requires special treatment by loader.  Firstly, terminator
  * code must be able to get the struct loader_icd  to call into the proper
  * driver  (multiple ICD/gpu case). This can be accomplished by wrapping the
@@ -492,6 +528,7 @@ void loader_init_dispatch_dev_ext(struct loader_instance *inst,
                                   struct loader_device *dev);
 void *loader_dev_ext_gpa(struct loader_instance *inst, const char *funcName);
 void *loader_get_dev_ext_trampoline(uint32_t index);
+extern PFN_vkDevExt loader_dev_ext_error_bank[DEV_EXT_BANK_SIZE];
 struct loader_instance *loader_get_instance(const VkInstance instance);
 void loader_deactivate_layers(const struct loader_instance *instance,
                               struct loader_layer_list *list);
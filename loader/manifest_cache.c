@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// for st_mtim
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "vk_loader_platform.h"
+#include "loader.h"
+#include "manifest_cache.h"
+#include "murmurhash.h"
+
+#define MANIFEST_CACHE_ENV "VK_LOADER_MANIFEST_CACHE"
+#define MANIFEST_CACHE_MAGIC 0x434d4b56 /* "VKMC" */
+#define MANIFEST_CACHE_FORMAT 1
+// Bound the file so stale paths from old environments can't grow it forever
+#define MANIFEST_CACHE_MAX_ENTRIES 4096
+
+struct manifest_cache_entry {
+    char *path;
+    uint32_t kind;
+    int64_t mtime_sec;
+    uint32_t mtime_nsec;
+    uint64_t file_size;
+    // Wall-clock second the manifest was parsed.  A file modified in that
+    // same second may have changed after we read it, so it is not trusted.
+    int64_t recorded_at;
+    uint8_t *data;
+    uint32_t data_size;
+    bool used;
+};
+
+static struct {
+    bool initialized;
+    char *file;
+    struct manifest_cache_entry *entries;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *index; // open addressing, entry index + 1, 0 when empty
+    uint32_t index_size;
+    bool dirty;
+} g_manifest_cache;
+
+/* Writer / reader helpers */
+
+void loader_cache_write(struct loader_cache_writer *w, const void *src,
+                        size_t size) {
+    if (w->failed)
+        return;
+    if (w->size + size > w->capacity) {
+        size_t capacity = w->capacity ? w->capacity : 256;
+        while (capacity < w->size + size)
+            capacity *= 2;
+        uint8_t *data = realloc(w->data, capacity);
+        if (data == NULL) {
+            w->failed = true;
+            return;
+        }
+        w->data = data;
+        w->capacity = capacity;
+    }
+    memcpy(w->data + w->size, src, size);
+    w->size += size;
+}
+
+void loader_cache_write_u32(struct loader_cache_writer *w, uint32_t value) {
+    loader_cache_write(w, &value, sizeof(value));
+}
+
+void loader_cache_write_str(struct loader_cache_writer *w, const char *str) {
+    uint32_t len = (uint32_t)strlen(str);
+    loader_cache_write_u32(w, len);
+    loader_cache_write(w, str, len);
+}
+
+void loader_cache_writer_free(struct loader_cache_writer *w) {
+    free(w->data);
+    memset(w, 0, sizeof(*w));
+}
+
+void loader_cache_read(struct loader_cache_reader *r, void *dst, size_t size) {
+    if (r->failed || r->size - r->pos < size) {
+        r->failed = true;
+        memset(dst, 0, size);
+        return;
+    }
+    memcpy(dst, r->data + r->pos, size);
+    r->pos += size;
+}
+
+uint32_t loader_cache_read_u32(struct loader_cache_reader *r) {
+    uint32_t value;
+    loader_cache_read(r, &value, sizeof(value));
+    return value;
+}
+
+void loader_cache_read_str(struct loader_cache_reader *r, char *dst,
+                           size_t dst_size) {
+    uint32_t len = loader_cache_read_u32(r);
+    if (r->failed || r->size - r->pos < len) {
+        r->failed = true;
+        dst[0] = '\0';
+        return;
+    }
+    size_t copy = (len < dst_size - 1) ? len : dst_size - 1;
+    memcpy(dst, r->data + r->pos, copy);
+    dst[copy] = '\0';
+    r->pos += len;
+}
+
+/* In-memory table */
+
+static uint32_t manifest_cache_hash(const char *path, uint32_t kind) {
+    return murmurhash(path, strlen(path), kind);
+}
+
+static void manifest_cache_rebuild_index(uint32_t index_size) {
+    uint32_t *index = calloc(index_size, sizeof(uint32_t));
+    if (index == NULL)
+        return;
+    free(g_manifest_cache.index);
+    g_manifest_cache.index = index;
+    g_manifest_cache.index_size = index_size;
+    for (uint32_t i = 0; i < g_manifest_cache.count; i++) {
+        struct manifest_cache_entry *e = &g_manifest_cache.entries[i];
+        uint32_t slot =
+            manifest_cache_hash(e->path, e->kind) & (index_size - 1);
+        while (index[slot])
+            slot = (slot + 1) & (index_size - 1);
+        index[slot] = i + 1;
+    }
+}
+
+static struct manifest_cache_entry *manifest_cache_find(const char *path,
+                                                        uint32_t kind) {
+    if (g_manifest_cache.index_size == 0)
+        return NULL;
+    uint32_t mask = g_manifest_cache.index_size - 1;
+    uint32_t slot = manifest_cache_hash(path, kind) & mask;
+    while (g_manifest_cache.index[slot]) {
+        struct manifest_cache_entry *e =
+            &g_manifest_cache.entries[g_manifest_cache.index[slot] - 1];
+        if (e->kind == kind && !strcmp(e->path, path))
+            return e;
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+static struct manifest_cache_entry *manifest_cache_add(const char *path,
+                                                       uint32_t kind) {
+    if (g_manifest_cache.count == g_manifest_cache.capacity) {
+        uint32_t capacity =
+            g_manifest_cache.capacity ? g_manifest_cache.capacity * 2 : 64;
+        struct manifest_cache_entry *entries = realloc(
+            g_manifest_cache.entries, capacity * sizeof(*entries));
+        if (entries == NULL)
+            return NULL;
+        g_manifest_cache.entries = entries;
+        g_manifest_cache.capacity = capacity;
+    }
+    struct manifest_cache_entry *e =
+        &g_manifest_cache.entries[g_manifest_cache.count];
+    memset(e, 0, sizeof(*e));
+    e->path = malloc(strlen(path) + 1);
+    if (e->path == NULL)
+        return NULL;
+    strcpy(e->path, path);
+    e->kind = kind;
+    g_manifest_cache.count++;
+
+    if (g_manifest_cache.count * 2 > g_manifest_cache.index_size) {
+        uint32_t index_size =
+            g_manifest_cache.index_size ? g_manifest_cache.index_size * 2 : 128;
+        manifest_cache_rebuild_index(index_size);
+    } else {
+        uint32_t mask = g_manifest_cache.index_size - 1;
+        uint32_t slot = manifest_cache_hash(path, kind) & mask;
+        while (g_manifest_cache.index[slot])
+            slot = (slot + 1) & mask;
+        g_manifest_cache.index[slot] = g_manifest_cache.count;
+    }
+    return e;
+}
+
+static void manifest_cache_clear(void) {
+    for (uint32_t i = 0; i < g_manifest_cache.count; i++) {
+        free(g_manifest_cache.entries[i].path);
+        free(g_manifest_cache.entries[i].data);
+    }
+    g_manifest_cache.count = 0;
+    if (g_manifest_cache.index)
+        memset(g_manifest_cache.index, 0,
+               g_manifest_cache.index_size * sizeof(uint32_t));
+}
+
+static bool manifest_cache_stat(const char *path, int64_t *sec, uint32_t *nsec,
+                                uint64_t *size) {
+#if defined(_WIN32)
+    struct _stat64 st;
+    if (_stat64(path, &st) != 0)
+        return false;
+    *nsec = 0;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return false;
+#if defined(__linux__)
+    *nsec = (uint32_t)st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    *nsec = (uint32_t)st.st_mtimespec.tv_nsec;
+#else
+    *nsec = 0;
+#endif
+#endif
+    *sec = (int64_t)st.st_mtime;
+    *size = (uint64_t)st.st_size;
+    return true;
+}
+
+/* File I/O */
+
+static void manifest_cache_load(void) {
+    FILE *file = fopen(g_manifest_cache.file, "rb");
+    if (!file)
+        return;
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (len <= 0) {
+        fclose(file);
+        return;
+    }
+    uint8_t *buf = malloc(len);
+    if (buf == NULL || fread(buf, 1, len, file) != (size_t)len) {
+        free(buf);
+        fclose(file);
+        return;
+    }
+    fclose(file);
+
+    struct loader_cache_reader r = {buf, (size_t)len, 0, false};
+    uint32_t magic = loader_cache_read_u32(&r);
+    uint32_t format = loader_cache_read_u32(&r);
+    uint32_t header_version = loader_cache_read_u32(&r);
+    uint32_t count = loader_cache_read_u32(&r);
+    if (r.failed || magic != MANIFEST_CACHE_MAGIC ||
+        format != MANIFEST_CACHE_FORMAT ||
+        header_version != VK_HEADER_VERSION) {
+        loader_log(NULL, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
+                   "Ignoring manifest cache %s from a different loader",
+                   g_manifest_cache.file);
+        free(buf);
+        return;
+    }
+
+    char path[MAX_STRING_SIZE];
+    for (uint32_t i = 0; i < count && !r.failed; i++) {
+        uint32_t kind = loader_cache_read_u32(&r);
+        loader_cache_read_str(&r, path, sizeof(path));
+        struct manifest_cache_entry tmp;
+        loader_cache_read(&r, &tmp.mtime_sec, sizeof(tmp.mtime_sec));
+        tmp.mtime_nsec = loader_cache_read_u32(&r);
+        loader_cache_read(&r, &tmp.file_size, sizeof(tmp.file_size));
+        loader_cache_read(&r, &tmp.recorded_at, sizeof(tmp.recorded_at));
+        tmp.data_size = loader_cache_read_u32(&r);
+        if (r.failed || r.size - r.pos < tmp.data_size)
+            break;
+        struct manifest_cache_entry *e = manifest_cache_add(path, kind);
+        if (e == NULL)
+            break;
+        e->mtime_sec = tmp.mtime_sec;
+        e->mtime_nsec = tmp.mtime_nsec;
+        e->file_size = tmp.file_size;
+        e->recorded_at = tmp.recorded_at;
+        e->data_size = tmp.data_size;
+        e->data = malloc(tmp.data_size ? tmp.data_size : 1);
+        if (e->data == NULL)
+            break;
+        loader_cache_read(&r, e->data, tmp.data_size);
+    }
+    if (r.failed || g_manifest_cache.count != count) {
+        loader_log(NULL, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
+                   "Manifest cache %s is corrupt, ignoring it",
+                   g_manifest_cache.file);
+        manifest_cache_clear();
+    }
+    free(buf);
+}
+
+static void manifest_cache_init(void) {
+    char *env;
+
+    if (g_manifest_cache.initialized)
+        return;
+    g_manifest_cache.initialized = true;
+
+    env = loader_getenv(MANIFEST_CACHE_ENV);
+    if (env == NULL || *env == '\0') {
+        loader_free_getenv(env);
+        return;
+    }
+#if !defined(_WIN32)
+    if (geteuid() != getuid() || getegid() != getgid()) {
+        /* Don't allow setuid apps to use the env var: */
+        loader_free_getenv(env);
+        return;
+    }
+#endif
+    g_manifest_cache.file = malloc(strlen(env) + 1);
+    if (g_manifest_cache.file)
+        strcpy(g_manifest_cache.file, env);
+    loader_free_getenv(env);
+    if (g_manifest_cache.file)
+        manifest_cache_load();
+}
+
+bool loader_manifest_cache_enabled(void) {
+    manifest_cache_init();
+    return g_manifest_cache.file != NULL;
+}
+
+bool loader_manifest_cache_lookup(const char *path,
+                                  enum loader_manifest_kind kind,
+                                  const void **data, size_t *size) {
+    int64_t sec;
+    uint32_t nsec;
+    uint64_t file_size;
+
+    if (!loader_manifest_cache_enabled())
+        return false;
+    struct manifest_cache_entry *e = manifest_cache_find(path, kind);
+    if (e == NULL || e->data == NULL)
+        return false;
+    if (!manifest_cache_stat(path, &sec, &nsec, &file_size) ||
+        sec != e->mtime_sec || nsec != e->mtime_nsec ||
+        file_size != e->file_size || sec >= e->recorded_at)
+        return false;
+
+    e->used = true;
+    *data = e->data;
+    *size = e->data_size;
+    return true;
+}
+
+void loader_manifest_cache_store(const char *path,
+                                 enum loader_manifest_kind kind,
+                                 const void *data, size_t size) {
+    int64_t sec;
+    uint32_t nsec;
+    uint64_t file_size;
+
+    if (!loader_manifest_cache_enabled())
+        return;
+    if (!manifest_cache_stat(path, &sec, &nsec, &file_size))
+        return;
+    struct manifest_cache_entry *e = manifest_cache_find(path, kind);
+    if (e == NULL)
+        e = manifest_cache_add(path, kind);
+    if (e == NULL)
+        return;
+    uint8_t *copy = malloc(size ? size : 1);
+    if (copy == NULL)
+        return;
+    memcpy(copy, data, size);
+    free(e->data);
+    e->data = copy;
+    e->data_size = (uint32_t)size;
+    e->mtime_sec = sec;
+    e->mtime_nsec = nsec;
+    e->file_size = file_size;
+    e->recorded_at = (int64_t)time(NULL);
+    e->used = true;
+    g_manifest_cache.dirty = true;
+}
+
+void loader_manifest_cache_flush(void) {
+    struct loader_cache_writer w = {NULL, 0, 0, false};
+    uint32_t count = 0;
+    bool only_used;
+    char *tmp_name;
+    FILE *file;
+
+    if (!g_manifest_cache.file || !g_manifest_cache.dirty)
+        return;
+    g_manifest_cache.dirty = false;
+
+    only_used = g_manifest_cache.count > MANIFEST_CACHE_MAX_ENTRIES;
+    for (uint32_t i = 0; i < g_manifest_cache.count; i++) {
+        if (g_manifest_cache.entries[i].data &&
+            (!only_used || g_manifest_cache.entries[i].used))
+            count++;
+    }
+
+    loader_cache_write_u32(&w, MANIFEST_CACHE_MAGIC);
+    loader_cache_write_u32(&w, MANIFEST_CACHE_FORMAT);
+    loader_cache_write_u32(&w, VK_HEADER_VERSION);
+    loader_cache_write_u32(&w, count);
+    for (uint32_t i = 0; i < g_manifest_cache.count; i++) {
+        struct manifest_cache_entry *e = &g_manifest_cache.entries[i];
+        if (!e->data || (only_used && !e->used))
+            continue;
+        loader_cache_write_u32(&w, e->kind);
+        loader_cache_write_str(&w, e->path);
+        loader_cache_write(&w, &e->mtime_sec, sizeof(e->mtime_sec));
+        loader_cache_write_u32(&w, e->mtime_nsec);
+        loader_cache_write(&w, &e->file_size, sizeof(e->file_size));
+        loader_cache_write(&w, &e->recorded_at, sizeof(e->recorded_at));
+        loader_cache_write_u32(&w, e->data_size);
+        loader_cache_write(&w, e->data, e->data_size);
+    }
+    if (w.failed) {
+        loader_cache_writer_free(&w);
+        return;
+    }
+
+    // Write a private temporary and rename it over the cache so concurrent
+    // processes never see a partially written file.
+    tmp_name = malloc(strlen(g_manifest_cache.file) + 32);
+    if (tmp_name == NULL) {
+        loader_cache_writer_free(&w);
+        return;
+    }
+#if defined(_WIN32)
+    sprintf(tmp_name, "%s.%d.tmp", g_manifest_cache.file, _getpid());
+#else
+    sprintf(tmp_name, "%s.%d.tmp", g_manifest_cache.file, (int)getpid());
+#endif
+    file = fopen(tmp_name, "wb");
+    if (file) {
+        bool ok = fwrite(w.data, 1, w.size, file) == w.size;
+        ok = (fclose(file) == 0) && ok;
+#if defined(_WIN32)
+        if (ok)
+            remove(g_manifest_cache.file);
+#endif
+        if (!ok || rename(tmp_name, g_manifest_cache.file) != 0) {
+            loader_log(NULL, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
+                       "Couldn't write manifest cache %s",
+                       g_manifest_cache.file);
+            remove(tmp_name);
+        }
+    } else {
+        loader_log(NULL, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
+                   "Couldn't open %s to write the manifest cache", tmp_name);
+    }
+    free(tmp_name);
+    loader_cache_writer_free(&w);
+}
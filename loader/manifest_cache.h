@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LOADER_MANIFEST_CACHE_H
+#define LOADER_MANIFEST_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Opt-in persistent cache of parsed ICD and layer manifests.
+ *
+ * Setting VK_LOADER_MANIFEST_CACHE to a writable file path enables it.  Each
+ * entry is keyed on the manifest's full path (which already reflects any
+ * VK_ICD_FILENAMES / VK_LAYER_PATH override) and how it was read, and is
+ * revalidated against the file's mtime and size with a single stat() before
+ * use.  The payload is an opaque blob built by the caller with the
+ * loader_cache_writer helpers below.
+ *
+ * None of these functions lock; callers hold loader_json_lock, and copy what
+ * they need out of a looked up payload before releasing it.
+ */
+
+enum loader_manifest_kind {
+    LOADER_MANIFEST_ICD = 0,
+    LOADER_MANIFEST_EXPLICIT_LAYER = 1,
+    LOADER_MANIFEST_IMPLICIT_LAYER = 2,
+};
+
+bool loader_manifest_cache_enabled(void);
+
+// Returns true and points data at the cached payload when path has an entry
+// of the given kind whose recorded mtime and size still match the file.
+bool loader_manifest_cache_lookup(const char *path,
+                                  enum loader_manifest_kind kind,
+                                  const void **data, size_t *size);
+
+// Record (or replace) the payload for path; the data is copied.
+void loader_manifest_cache_store(const char *path,
+                                 enum loader_manifest_kind kind,
+                                 const void *data, size_t size);
+
+// Write the cache file back if anything was stored since the last flush.
+void loader_manifest_cache_flush(void);
+
+struct loader_cache_writer {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+};
+
+void loader_cache_write(struct loader_cache_writer *w, const void *src,
+                        size_t size);
+void loader_cache_write_u32(struct loader_cache_writer *w, uint32_t value);
+void loader_cache_write_str(struct loader_cache_writer *w, const char *str);
+void loader_cache_writer_free(struct loader_cache_writer *w);
+
+struct loader_cache_reader {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    bool failed;
+};
+
+void loader_cache_read(struct loader_cache_reader *r, void *dst, size_t size);
+uint32_t loader_cache_read_u32(struct loader_cache_reader *r);
+// Reads a string written by loader_cache_write_str into dst, truncating to
+// dst_size.  Always NUL terminates.
+void loader_cache_read_str(struct loader_cache_reader *r, char *dst,
+                           size_t dst_size);
+
+#endif // LOADER_MANIFEST_CACHE_H
@@ -28,24 +28,14 @@
 #include <string.h>
 #include "loader.h"
 #include "vk_loader_platform.h"
-
-static VkResult vkDevExtError(VkDevice dev) {
-    struct loader_device *found_dev;
-    struct loader_icd *icd = loader_get_icd_and_device(dev, &found_dev);
-
-    if (icd)
-        loader_log(icd->this_instance, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                   "Bad destination in loader trampoline dispatch,"
-                   "Are layers and extensions that you are calling enabled?");
-    return VK_ERROR_EXTENSION_NOT_PRESENT;
-}
+#include "loader_entrypoint_hash.h"
 
 static inline void
 loader_init_device_dispatch_table(struct loader_dev_dispatch_table *dev_table,
                                   PFN_vkGetDeviceProcAddr gpa, VkDevice dev) {
     VkLayerDispatchTable *table = &dev_table->core_dispatch;
-    for (uint32_t i = 0; i < MAX_NUM_DEV_EXTS; i++)
-        dev_table->ext_dispatch.DevExt[i] = (PFN_vkDevExt)vkDevExtError;
+    for (uint32_t i = 0; i < MAX_NUM_DEV_EXT_BANKS; i++)
+        dev_table->ext_dispatch.DevExt[i] = loader_dev_ext_error_bank;
 
     table->GetDeviceProcAddr =
         (PFN_vkGetDeviceProcAddr)gpa(dev, "vkGetDeviceProcAddr");
@@ -272,254 +262,12 @@ static inline void loader_init_device_extension_dispatch_table(
 static inline void *
 loader_lookup_device_dispatch_table(const VkLayerDispatchTable *table,
                                     const char *name) {
-    if (!name || name[0] != 'v' || name[1] != 'k')
+    int id = loader_entrypoint_lookup(name);
+    if (id < 0 || loader_device_dispatch_offsets[id] == LOADER_EP_NO_OFFSET)
         return NULL;
 
-    name += 2;
-    if (!strcmp(name, "GetDeviceProcAddr"))
-        return (void *)table->GetDeviceProcAddr;
-    if (!strcmp(name, "DestroyDevice"))
-        return (void *)table->DestroyDevice;
-    if (!strcmp(name, "GetDeviceQueue"))
-        return (void *)table->GetDeviceQueue;
-    if (!strcmp(name, "QueueSubmit"))
-        return (void *)table->QueueSubmit;
-    if (!strcmp(name, "QueueWaitIdle"))
-        return (void *)table->QueueWaitIdle;
-    if (!strcmp(name, "DeviceWaitIdle"))
-        return (void *)table->DeviceWaitIdle;
-    if (!strcmp(name, "AllocateMemory"))
-        return (void *)table->AllocateMemory;
-    if (!strcmp(name, "FreeMemory"))
-        return (void *)table->FreeMemory;
-    if (!strcmp(name, "MapMemory"))
-        return (void *)table->MapMemory;
-    if (!strcmp(name, "UnmapMemory"))
-        return (void *)table->UnmapMemory;
-    if (!strcmp(name, "FlushMappedMemoryRanges"))
-        return (void *)table->FlushMappedMemoryRanges;
-    if (!strcmp(name, "InvalidateMappedMemoryRanges"))
-        return (void *)table->InvalidateMappedMemoryRanges;
-    if (!strcmp(name, "GetDeviceMemoryCommitment"))
-        return (void *)table->GetDeviceMemoryCommitment;
-    if (!strcmp(name, "GetImageSparseMemoryRequirements"))
-        return (void *)table->GetImageSparseMemoryRequirements;
-    if (!strcmp(name, "GetBufferMemoryRequirements"))
-        return (void *)table->GetBufferMemoryRequirements;
-    if (!strcmp(name, "GetImageMemoryRequirements"))
-        return (void *)table->GetImageMemoryRequirements;
-    if (!strcmp(name, "BindBufferMemory"))
-        return (void *)table->BindBufferMemory;
-    if (!strcmp(name, "BindImageMemory"))
-        return (void *)table->BindImageMemory;
-    if (!strcmp(name, "QueueBindSparse"))
-        return (void *)table->QueueBindSparse;
-    if (!strcmp(name, "CreateFence"))
-        return (void *)table->CreateFence;
-    if (!strcmp(name, "DestroyFence"))
-        return (void *)table->DestroyFence;
-    if (!strcmp(name, "ResetFences"))
-        return (void *)table->ResetFences;
-    if (!strcmp(name, "GetFenceStatus"))
-        return (void *)table->GetFenceStatus;
-    if (!strcmp(name, "WaitForFences"))
-        return (void *)table->WaitForFences;
-    if (!strcmp(name, "CreateSemaphore"))
-        return (void *)table->CreateSemaphore;
-    if (!strcmp(name, "DestroySemaphore"))
-        return (void *)table->DestroySemaphore;
-    if (!strcmp(name, "CreateEvent"))
-        return (void *)table->CreateEvent;
-    if (!strcmp(name, "DestroyEvent"))
-        return (void *)table->DestroyEvent;
-    if (!strcmp(name, "GetEventStatus"))
-        return (void *)table->GetEventStatus;
-    if (!strcmp(name, "SetEvent"))
-        return (void *)table->SetEvent;
-    if (!strcmp(name, "ResetEvent"))
-        return (void *)table->ResetEvent;
-    if (!strcmp(name, "CreateQueryPool"))
-        return (void *)table->CreateQueryPool;
-    if (!strcmp(name, "DestroyQueryPool"))
-        return (void *)table->DestroyQueryPool;
-    if (!strcmp(name, "GetQueryPoolResults"))
-        return (void *)table->GetQueryPoolResults;
-    if (!strcmp(name, "CreateBuffer"))
-        return (void *)table->CreateBuffer;
-    if (!strcmp(name, "DestroyBuffer"))
-        return (void *)table->DestroyBuffer;
-    if (!strcmp(name, "CreateBufferView"))
-        return (void *)table->CreateBufferView;
-    if (!strcmp(name, "DestroyBufferView"))
-        return (void *)table->DestroyBufferView;
-    if (!strcmp(name, "CreateImage"))
-        return (void *)table->CreateImage;
-    if (!strcmp(name, "DestroyImage"))
-        return (void *)table->DestroyImage;
-    if (!strcmp(name, "GetImageSubresourceLayout"))
-        return (void *)table->GetImageSubresourceLayout;
-    if (!strcmp(name, "CreateImageView"))
-        return (void *)table->CreateImageView;
-    if (!strcmp(name, "DestroyImageView"))
-        return (void *)table->DestroyImageView;
-    if (!strcmp(name, "CreateShaderModule"))
-        return (void *)table->CreateShaderModule;
-    if (!strcmp(name, "DestroyShaderModule"))
-        return (void *)table->DestroyShaderModule;
-    if (!strcmp(name, "CreatePipelineCache"))
-        return (void *)vkCreatePipelineCache;
-    if (!strcmp(name, "DestroyPipelineCache"))
-        return (void *)vkDestroyPipelineCache;
-    if (!strcmp(name, "GetPipelineCacheData"))
-        return (void *)vkGetPipelineCacheData;
-    if (!strcmp(name, "MergePipelineCaches"))
-        return (void *)vkMergePipelineCaches;
-    if (!strcmp(name, "CreateGraphicsPipelines"))
-        return (void *)vkCreateGraphicsPipelines;
-    if (!strcmp(name, "CreateComputePipelines"))
-        return (void *)vkCreateComputePipelines;
-    if (!strcmp(name, "DestroyPipeline"))
-        return (void *)table->DestroyPipeline;
-    if (!strcmp(name, "CreatePipelineLayout"))
-        return (void *)table->CreatePipelineLayout;
-    if (!strcmp(name, "DestroyPipelineLayout"))
-        return (void *)table->DestroyPipelineLayout;
-    if (!strcmp(name, "CreateSampler"))
-        return (void *)table->CreateSampler;
-    if (!strcmp(name, "DestroySampler"))
-        return (void *)table->DestroySampler;
-    if (!strcmp(name, "CreateDescriptorSetLayout"))
-        return (void *)table->CreateDescriptorSetLayout;
-    if (!strcmp(name, "DestroyDescriptorSetLayout"))
-        return (void *)table->DestroyDescriptorSetLayout;
-    if (!strcmp(name, "CreateDescriptorPool"))
-        return (void *)table->CreateDescriptorPool;
-    if (!strcmp(name, "DestroyDescriptorPool"))
-        return (void *)table->DestroyDescriptorPool;
-    if (!strcmp(name, "ResetDescriptorPool"))
-        return (void *)table->ResetDescriptorPool;
-    if (!strcmp(name, "AllocateDescriptorSets"))
-        return (void *)table->AllocateDescriptorSets;
-    if (!strcmp(name, "FreeDescriptorSets"))
-        return (void *)table->FreeDescriptorSets;
-    if (!strcmp(name, "UpdateDescriptorSets"))
-        return (void *)table->UpdateDescriptorSets;
-    if (!strcmp(name, "CreateFramebuffer"))
-        return (void *)table->CreateFramebuffer;
-    if (!strcmp(name, "DestroyFramebuffer"))
-        return (void *)table->DestroyFramebuffer;
-    if (!strcmp(name, "CreateRenderPass"))
-        return (void *)table->CreateRenderPass;
-    if (!strcmp(name, "DestroyRenderPass"))
-        return (void *)table->DestroyRenderPass;
-    if (!strcmp(name, "GetRenderAreaGranularity"))
-        return (void *)table->GetRenderAreaGranularity;
-    if (!strcmp(name, "CreateCommandPool"))
-        return (void *)table->CreateCommandPool;
-    if (!strcmp(name, "DestroyCommandPool"))
-        return (void *)table->DestroyCommandPool;
-    if (!strcmp(name, "ResetCommandPool"))
-        return (void *)table->ResetCommandPool;
-    if (!strcmp(name, "AllocateCommandBuffers"))
-        return (void *)table->AllocateCommandBuffers;
-    if (!strcmp(name, "FreeCommandBuffers"))
-        return (void *)table->FreeCommandBuffers;
-    if (!strcmp(name, "BeginCommandBuffer"))
-        return (void *)table->BeginCommandBuffer;
-    if (!strcmp(name, "EndCommandBuffer"))
-        return (void *)table->EndCommandBuffer;
-    if (!strcmp(name, "ResetCommandBuffer"))
-        return (void *)table->ResetCommandBuffer;
-    if (!strcmp(name, "CmdBindPipeline"))
-        return (void *)table->CmdBindPipeline;
-    if (!strcmp(name, "CmdSetViewport"))
-        return (void *)table->CmdSetViewport;
-    if (!strcmp(name, "CmdSetScissor"))
-        return (void *)table->CmdSetScissor;
-    if (!strcmp(name, "CmdSetLineWidth"))
-        return (void *)table->CmdSetLineWidth;
-    if (!strcmp(name, "CmdSetDepthBias"))
-        return (void *)table->CmdSetDepthBias;
-    if (!strcmp(name, "CmdSetBlendConstants"))
-        return (void *)table->CmdSetBlendConstants;
-    if (!strcmp(name, "CmdSetDepthBounds"))
-        return (void *)table->CmdSetDepthBounds;
-    if (!strcmp(name, "CmdSetStencilCompareMask"))
-        return (void *)table->CmdSetStencilCompareMask;
-    if (!strcmp(name, "CmdSetStencilwriteMask"))
-        return (void *)table->CmdSetStencilWriteMask;
-    if (!strcmp(name, "CmdSetStencilReference"))
-        return (void *)table->CmdSetStencilReference;
-    if (!strcmp(name, "CmdBindDescriptorSets"))
-        return (void *)table->CmdBindDescriptorSets;
-    if (!strcmp(name, "CmdBindVertexBuffers"))
-        return (void *)table->CmdBindVertexBuffers;
-    if (!strcmp(name, "CmdBindIndexBuffer"))
-        return (void *)table->CmdBindIndexBuffer;
-    if (!strcmp(name, "CmdDraw"))
-        return (void *)table->CmdDraw;
-    if (!strcmp(name, "CmdDrawIndexed"))
-        return (void *)table->CmdDrawIndexed;
-    if (!strcmp(name, "CmdDrawIndirect"))
-        return (void *)table->CmdDrawIndirect;
-    if (!strcmp(name, "CmdDrawIndexedIndirect"))
-        return (void *)table->CmdDrawIndexedIndirect;
-    if (!strcmp(name, "CmdDispatch"))
-        return (void *)table->CmdDispatch;
-    if (!strcmp(name, "CmdDispatchIndirect"))
-        return (void *)table->CmdDispatchIndirect;
-    if (!strcmp(name, "CmdCopyBuffer"))
-        return (void *)table->CmdCopyBuffer;
-    if (!strcmp(name, "CmdCopyImage"))
-        return (void *)table->CmdCopyImage;
-    if (!strcmp(name, "CmdBlitImage"))
-        return (void *)table->CmdBlitImage;
-    if (!strcmp(name, "CmdCopyBufferToImage"))
-        return (void *)table->CmdCopyBufferToImage;
-    if (!strcmp(name, "CmdCopyImageToBuffer"))
-        return (void *)table->CmdCopyImageToBuffer;
-    if (!strcmp(name, "CmdUpdateBuffer"))
-        return (void *)table->CmdUpdateBuffer;
-    if (!strcmp(name, "CmdFillBuffer"))
-        return (void *)table->CmdFillBuffer;
-    if (!strcmp(name, "CmdClearColorImage"))
-        return (void *)table->CmdClearColorImage;
-    if (!strcmp(name, "CmdClearDepthStencilImage"))
-        return (void *)table->CmdClearDepthStencilImage;
-    if (!strcmp(name, "CmdClearAttachments"))
-        return (void *)table->CmdClearAttachments;
-    if (!strcmp(name, "CmdResolveImage"))
-        return (void *)table->CmdResolveImage;
-    if (!strcmp(name, "CmdSetEvent"))
-        return (void *)table->CmdSetEvent;
-    if (!strcmp(name, "CmdResetEvent"))
-        return (void *)table->CmdResetEvent;
-    if (!strcmp(name, "CmdWaitEvents"))
-        return (void *)table->CmdWaitEvents;
-    if (!strcmp(name, "CmdPipelineBarrier"))
-        return (void *)table->CmdPipelineBarrier;
-    if (!strcmp(name, "CmdBeginQuery"))
-        return (void *)table->CmdBeginQuery;
-    if (!strcmp(name, "CmdEndQuery"))
-        return (void *)table->CmdEndQuery;
-    if (!strcmp(name, "CmdResetQueryPool"))
-        return (void *)table->CmdResetQueryPool;
-    if (!strcmp(name, "CmdWriteTimestamp"))
-        return (void *)table->CmdWriteTimestamp;
-    if (!strcmp(name, "CmdCopyQueryPoolResults"))
-        return (void *)table->CmdCopyQueryPoolResults;
-    if (!strcmp(name, "CmdPushConstants"))
-        return (void *)table->CmdPushConstants;
-    if (!strcmp(name, "CmdBeginRenderPass"))
-        return (void *)table->CmdBeginRenderPass;
-    if (!strcmp(name, "CmdNextSubpass"))
-        return (void *)table->CmdNextSubpass;
-    if (!strcmp(name, "CmdEndRenderPass"))
-        return (void *)table->CmdEndRenderPass;
-    if (!strcmp(name, "CmdExecuteCommands"))
-        return (void *)table->CmdExecuteCommands;
-
-    return NULL;
+    return *(void *const *)((const char *)table +
+                            loader_device_dispatch_offsets[id]);
 }
 
 static inline void
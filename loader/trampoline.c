@@ -96,10 +96,14 @@ vkGetDeviceProcAddr(VkDevice device, const char *pName) {
     /* Although CreateDevice is on device chain it's dispatchable object isn't
      * a VkDevice or child of VkDevice so return NULL.
      */
-    if (!strcmp(pName, "CreateDevice"))
+    if (!strcmp(pName, "vkCreateDevice"))
         return NULL;
 
-    /* return the dispatch table entrypoint for the fastest case */
+    /* return the dispatch table entrypoint for the fastest case: the top
+     * layer's function, or the ICD's when no layers are enabled, so calls
+     * through it skip the loader's trampoline. Every other device command
+     * passes straight through the loader, so this is what its trampoline
+     * would call anyway. */
     const VkLayerDispatchTable *disp_table = *(VkLayerDispatchTable **)device;
     if (disp_table == NULL)
         return NULL;
@@ -265,6 +269,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
                  const VkAllocationCallbacks *pAllocator,
                  VkInstance *pInstance) {
     struct loader_instance *ptr_instance = NULL;
+    struct loader_instance_dispatch_table *inst_disp;
     VkInstance created_instance = VK_NULL_HANDLE;
     VkResult res = VK_ERROR_INITIALIZATION_FAILED;
 
@@ -287,7 +292,6 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
     }
 
     tls_instance = ptr_instance;
-    loader_platform_thread_lock_mutex(&loader_lock);
     memset(ptr_instance, 0, sizeof(struct loader_instance));
 #if 0
     if (pAllocator) {
@@ -309,7 +313,6 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
         // One or more were found, but allocation failed.  Therefore, clean up
         // and fail this function:
         loader_heap_free(ptr_instance, ptr_instance);
-        loader_platform_thread_unlock_mutex(&loader_lock);
         return VK_ERROR_OUT_OF_HOST_MEMORY;
     } else if (ptr_instance->num_tmp_callbacks > 0) {
         // Setup the temporary callback(s) here to catch early issues:
@@ -323,7 +326,6 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
                                             ptr_instance->tmp_dbg_create_infos,
                                             ptr_instance->tmp_callbacks);
             loader_heap_free(ptr_instance, ptr_instance);
-            loader_platform_thread_unlock_mutex(&loader_lock);
             return VK_ERROR_OUT_OF_HOST_MEMORY;
         }
     }
@@ -352,7 +354,6 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
                                             ptr_instance->tmp_dbg_create_infos,
                                             ptr_instance->tmp_callbacks);
             loader_heap_free(ptr_instance, ptr_instance);
-            loader_platform_thread_unlock_mutex(&loader_lock);
             return res;
         }
     }
@@ -390,15 +391,14 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
         util_FreeDebugReportCreateInfos(pAllocator,
                                         ptr_instance->tmp_dbg_create_infos,
                                         ptr_instance->tmp_callbacks);
-        loader_platform_thread_unlock_mutex(&loader_lock);
         loader_heap_free(ptr_instance, ptr_instance);
         return res;
     }
 
-    ptr_instance->disp =
-        loader_heap_alloc(ptr_instance, sizeof(VkLayerInstanceDispatchTable),
-                          VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    if (ptr_instance->disp == NULL) {
+    inst_disp = loader_heap_alloc(ptr_instance,
+                                  sizeof(struct loader_instance_dispatch_table),
+                                  VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (inst_disp == NULL) {
         loader_delete_shadow_inst_layer_names(ptr_instance, pCreateInfo, &ici);
         loader_delete_layer_properties(ptr_instance,
                                        &ptr_instance->device_layer_list);
@@ -414,13 +414,12 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
         util_FreeDebugReportCreateInfos(pAllocator,
                                         ptr_instance->tmp_dbg_create_infos,
                                         ptr_instance->tmp_callbacks);
-        loader_platform_thread_unlock_mutex(&loader_lock);
         loader_heap_free(ptr_instance, ptr_instance);
         return VK_ERROR_OUT_OF_HOST_MEMORY;
     }
-    memcpy(ptr_instance->disp, &instance_disp, sizeof(instance_disp));
-    ptr_instance->next = loader.instances;
-    loader.instances = ptr_instance;
+    memcpy(&inst_disp->layer_inst_disp, &instance_disp, sizeof(instance_disp));
+    inst_disp->instance = ptr_instance;
+    ptr_instance->disp = &inst_disp->layer_inst_disp;
 
     /* activate any layers on instance chain */
     res = loader_enable_instance_layers(ptr_instance, &ici,
@@ -435,19 +434,28 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
         loader_destroy_generic_list(
             ptr_instance,
             (struct loader_generic_list *)&ptr_instance->ext_list);
-        loader.instances = ptr_instance->next;
+        loader_deactivate_layers(ptr_instance,
+                                 &ptr_instance->activated_layer_list);
         util_DestroyDebugReportCallbacks(ptr_instance, pAllocator,
                                          ptr_instance->num_tmp_callbacks,
                                          ptr_instance->tmp_callbacks);
         util_FreeDebugReportCreateInfos(pAllocator,
                                         ptr_instance->tmp_dbg_create_infos,
                                         ptr_instance->tmp_callbacks);
-        loader_platform_thread_unlock_mutex(&loader_lock);
         loader_heap_free(ptr_instance, ptr_instance->disp);
         loader_heap_free(ptr_instance, ptr_instance);
         return res;
     }
 
+    /* Everything above only touched this instance and the libraries it uses,
+     * and ran without loader_lock so that threads can create instances
+     * concurrently. Layers expect the calls down the chain to be serialized
+     * with the loader's other chain calls, and to find the instance in
+     * loader.instances, so the rest holds it. */
+    loader_platform_thread_lock_mutex(&loader_lock);
+    ptr_instance->next = loader.instances;
+    loader.instances = ptr_instance;
+
     created_instance = (VkInstance)ptr_instance;
     res = loader_create_instance_chain(&ici, pAllocator, ptr_instance,
                                        &created_instance);
@@ -468,13 +476,13 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
     } else {
         // TODO: cleanup here.
     }
+    loader_platform_thread_unlock_mutex(&loader_lock);
 
     /* Remove temporary debug_report callback */
     util_DestroyDebugReportCallbacks(ptr_instance, pAllocator,
                                      ptr_instance->num_tmp_callbacks,
                                      ptr_instance->tmp_callbacks);
     loader_delete_shadow_inst_layer_names(ptr_instance, pCreateInfo, &ici);
-    loader_platform_thread_unlock_mutex(&loader_lock);
     return res;
 }
 
@@ -506,7 +514,11 @@ vkDestroyInstance(VkInstance instance,
     }
 
     disp->DestroyInstance(instance, pAllocator);
+    loader_platform_thread_unlock_mutex(&loader_lock);
 
+    /* The instance is off loader.instances, so closing its libraries and
+     * freeing it doesn't need the lock */
+    loader_scanned_icd_clear(ptr_instance, &ptr_instance->icd_libs);
     loader_deactivate_layers(ptr_instance, &ptr_instance->activated_layer_list);
     if (ptr_instance->phys_devs)
         loader_heap_free(ptr_instance, ptr_instance->phys_devs);
@@ -518,9 +530,9 @@ vkDestroyInstance(VkInstance instance,
                                         ptr_instance->tmp_dbg_create_infos,
                                         ptr_instance->tmp_callbacks);
     }
+    util_FreeDebugReportCallbacks(ptr_instance);
     loader_heap_free(ptr_instance, ptr_instance->disp);
     loader_heap_free(ptr_instance, ptr_instance);
-    loader_platform_thread_unlock_mutex(&loader_lock);
 }
 
 LOADER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
@@ -556,16 +568,19 @@ vkEnumeratePhysicalDevices(VkInstance instance, uint32_t *pPhysicalDeviceCount,
                 ? inst->total_gpu_count
                 : *pPhysicalDeviceCount;
     *pPhysicalDeviceCount = count;
-    if (!inst->phys_devs) {
+    // The terminator enumerates the ICDs once per instance, so total_gpu_count
+    // is fixed and the wrappers, like the handles they wrap, are reused by
+    // every call
+    if (!inst->phys_devs && inst->total_gpu_count) {
         inst->phys_devs =
             (struct loader_physical_device_tramp *)loader_heap_alloc(
                 inst, inst->total_gpu_count *
                           sizeof(struct loader_physical_device_tramp),
                 VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    }
-    if (!inst->phys_devs) {
-        loader_platform_thread_unlock_mutex(&loader_lock);
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+        if (!inst->phys_devs) {
+            loader_platform_thread_unlock_mutex(&loader_lock);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
     }
 
     for (i = 0; i < count; i++) {
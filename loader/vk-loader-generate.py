@@ -27,6 +27,7 @@ main_path = os.path.abspath(ld_path + "/../")
 sys.path.append(main_path)
 
 import vulkan
+import entrypoint_hash
 
 def generate_get_proc_addr_check(name):
     return "    if (!%s || %s[0] != 'v' || %s[1] != 'k')\n" \
@@ -116,6 +117,10 @@ class Subcommand(object):
         pass
 
 class DevExtTrampolineSubcommand(Subcommand):
+    # Must match DEV_EXT_BANK_SIZE and MAX_NUM_DEV_EXT_BANKS in loader.h
+    bank_size = 256
+    bank_count = 16
+
     def generate_header(self):
         lines = []
         lines.append("#include \"vk_loader_platform.h\"")
@@ -123,22 +128,29 @@ class DevExtTrampolineSubcommand(Subcommand):
         lines.append("#if defined(__linux__)")
         lines.append("#pragma GCC optimize(3)  // force gcc to use tail-calls")
         lines.append("#endif")
+        lines.append("")
+        lines.append("#if DEV_EXT_BANK_SIZE != %s || MAX_NUM_DEV_EXT_BANKS != %s" % (self.bank_size, self.bank_count))
+        lines.append("#error \"vk-loader-generate.py dev-ext-trampoline doesn't match loader.h\"")
+        lines.append("#endif")
         return "\n".join(lines)
 
     def generate_body(self):
         lines = []
-        for i in range(250):
-            lines.append('\nVKAPI_ATTR void VKAPI_CALL vkDevExt%s(VkDevice device)' % i)
+        count = self.bank_size * self.bank_count
+        for i in range(count):
+            lines.append('\nstatic VKAPI_ATTR void VKAPI_CALL vkDevExt%s(VkDevice device)' % i)
             lines.append('{')
             lines.append('    const struct loader_dev_dispatch_table *disp;')
             lines.append('    disp = loader_get_dev_dispatch(device);')
-            lines.append('    disp->ext_dispatch.DevExt[%s](device);' % i)
+            lines.append('    disp->ext_dispatch.DevExt[%s][%s](device);' % (i // self.bank_size, i % self.bank_size))
             lines.append('}')
         lines.append('')
+        # A switch rather than a table of pointers, which would need a
+        # relocation per trampoline when the loader is loaded
         lines.append('void *loader_get_dev_ext_trampoline(uint32_t index)')
         lines.append('{')
         lines.append('    switch (index) {')
-        for i in range(250):
+        for i in range(count):
             lines.append('        case %s:' % i)
             lines.append('            return vkDevExt%s;' % i)
         lines.append('    }')
@@ -431,6 +443,75 @@ class LoaderGetProcAddrSubcommand(Subcommand):
 
         return "\n".join(body)
 
+class EntrypointHashSubcommand(Subcommand):
+    # Builds a perfect hash over every entrypoint name the loader knows about
+    # (core plus all WSI and debug report extensions) so a GetProcAddr lookup
+    # costs one pass over the string and a single strcmp.
+    def run(self):
+        self.ext_protos = []
+        seen = set()
+        for ext in vulkan.extensions_all:
+            for proto in ext.protos:
+                if proto.name in seen:
+                    continue
+                seen.add(proto.name)
+                self.ext_protos.append((ext, proto))
+        self.core_count = len([p for (e, p) in self.ext_protos if e.name == "VK_CORE"])
+        self.hash = entrypoint_hash.EntrypointHash(["vk" + p.name for (e, p) in self.ext_protos],
+                                                   "entrypoint-hash")
+        super().run()
+
+    def generate_header(self):
+        return "\n".join(["#ifndef LOADER_ENTRYPOINT_HASH_H",
+                          "#define LOADER_ENTRYPOINT_HASH_H",
+                          "",
+                          "#include <stddef.h>",
+                          "#include <stdint.h>",
+                          "#include <string.h>",
+                          "#include <vulkan/vulkan.h>",
+                          "#include <vulkan/vk_layer.h>"])
+
+    def generate_body(self):
+        body = []
+        body.append("// Core entrypoints come first so ids below LOADER_EP_CORE_COUNT index the")
+        body.append("// per-core tables directly.")
+        body.append("enum loader_entrypoint_id {")
+        body.append("    LOADER_EP_UNKNOWN = -1,")
+        for i, (ext, proto) in enumerate(self.ext_protos):
+            body.append("    LOADER_EP_%s = %d," % (proto.name, i))
+        body.append("};")
+        body.append("")
+        body.append("#define LOADER_EP_CORE_COUNT %d" % self.core_count)
+        body.append("#define LOADER_EP_COUNT %d" % len(self.ext_protos))
+        body.extend(self.hash.generate("loader_entrypoint", "LOADER_EP", "loader_entrypoint_id"))
+
+        core = [p for (e, p) in self.ext_protos[:self.core_count]]
+        body.append("// Loader trampolines for core entrypoints; global entrypoints are NULL since")
+        body.append("// they are never returned for a non-NULL instance.")
+        body.append("static const PFN_vkVoidFunction loader_core_trampolines[LOADER_EP_CORE_COUNT] = {")
+        for proto in core:
+            if self.is_dispatchable_object_first_param(proto):
+                body.append("    (PFN_vkVoidFunction)vk%s," % proto.name)
+            else:
+                body.append("    NULL, /* vk%s is global */" % proto.name)
+        body.append("};")
+        body.append("")
+        body.append("// Byte offset of each device-level entrypoint, core or WSI, in")
+        body.append("// VkLayerDispatchTable, or LOADER_EP_NO_OFFSET for instance-level and global")
+        body.append("// entrypoints.")
+        body.append("#define LOADER_EP_NO_OFFSET 0xffff")
+        body.append("static const uint16_t loader_device_dispatch_offsets[LOADER_EP_COUNT] = {")
+        for (ext, proto) in self.ext_protos:
+            if proto.params[0].ty in ["VkDevice", "VkQueue", "VkCommandBuffer"]:
+                body.append("    offsetof(VkLayerDispatchTable, %s)," % proto.name)
+            else:
+                body.append("    LOADER_EP_NO_OFFSET, /* vk%s */" % proto.name)
+        body.append("};")
+        return "\n".join(body)
+
+    def generate_footer(self):
+        return "#endif // LOADER_ENTRYPOINT_HASH_H"
+
 def main():
 
     wsi = {
@@ -448,6 +529,7 @@ def main():
             "dispatch-table-ops": DispatchTableOpsSubcommand,
             "win-def-file": WinDefFileSubcommand,
             "loader-get-proc-addr": LoaderGetProcAddrSubcommand,
+            "entrypoint-hash": EntrypointHashSubcommand,
     }
 
     if len(sys.argv) < 3 or sys.argv[1] not in wsi or sys.argv[2] not in subcommands:
@@ -220,6 +220,23 @@ loader_platform_thread_cond_broadcast(loader_platform_thread_cond *pCond) {
     pthread_cond_broadcast(pCond);
 }
 
+// Atomics (all sequentially consistent):
+static inline void *loader_platform_atomic_load_ptr(void *const *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+static inline void loader_platform_atomic_store_ptr(void **ptr, void *val) {
+    __atomic_store_n(ptr, val, __ATOMIC_SEQ_CST);
+}
+static inline uint32_t loader_platform_atomic_load_u32(const uint32_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+static inline void loader_platform_atomic_increment(uint32_t *ptr) {
+    __atomic_add_fetch(ptr, 1, __ATOMIC_SEQ_CST);
+}
+static inline void loader_platform_atomic_decrement(uint32_t *ptr) {
+    __atomic_sub_fetch(ptr, 1, __ATOMIC_SEQ_CST);
+}
+
 #define loader_stack_alloc(size) alloca(size)
 
 #elif defined(_WIN32) // defined(__linux__)
@@ -352,7 +369,8 @@ loader_platform_open_library(const char *libPath) {
     return LoadLibrary(libPath);
 }
 static char *loader_platform_open_library_error(const char *libPath) {
-    static char errorMsg[120];
+    // Per thread, as libraries are loaded on several threads at once
+    static __declspec(thread) char errorMsg[120];
     snprintf(errorMsg, 119, "Failed to open dynamic library \"%s\"", libPath);
     return errorMsg;
 }
@@ -430,6 +448,24 @@ loader_platform_thread_cond_broadcast(loader_platform_thread_cond *pCond) {
     WakeAllConditionVariable(pCond);
 }
 
+// Atomics (all sequentially consistent):
+static void *loader_platform_atomic_load_ptr(void *const *ptr) {
+    return InterlockedCompareExchangePointer((PVOID volatile *)ptr, NULL,
+                                             NULL);
+}
+static void loader_platform_atomic_store_ptr(void **ptr, void *val) {
+    InterlockedExchangePointer((PVOID volatile *)ptr, val);
+}
+static uint32_t loader_platform_atomic_load_u32(const uint32_t *ptr) {
+    return (uint32_t)InterlockedCompareExchange((LONG volatile *)ptr, 0, 0);
+}
+static void loader_platform_atomic_increment(uint32_t *ptr) {
+    InterlockedIncrement((LONG volatile *)ptr);
+}
+static void loader_platform_atomic_decrement(uint32_t *ptr) {
+    InterlockedDecrement((LONG volatile *)ptr);
+}
+
 // Windows Registry:
 char *loader_get_registry_string(const HKEY hive, const LPCTSTR sub_key,
                                  const char *value);
@@ -27,11 +27,14 @@
 #include "test_common.h"
 #include "vkrenderframework.h"
 #include "vk_layer_config.h"
+#include "vk_layer_logging.h"
 #include "icd-spv.h"
 
 #define GLM_FORCE_RADIANS
 #include "glm/glm.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <sstream>
+#include <thread>
 
 #define MEM_TRACKER_TESTS 1
 #define OBJ_TRACKER_TESTS 1
@@ -40,6 +43,7 @@
 #define SHADER_CHECKER_TESTS 1
 #define DEVICE_LIMITS_TESTS 1
 #define IMAGE_TESTS 1
+#define DEBUG_REPORT_TESTS 1
 
 //--------------------------------------------------------------------------------------
 // Mesh and VertexFormat Data
@@ -1115,6 +1119,72 @@ TEST_F(VkLayerTest, MapMemWithoutHostVisibleBit) {
     vkDestroyImage(m_device->device(), image, NULL);
 }
 
+TEST_F(VkLayerTest, MappedMemoryOverflowNoncoherent) {
+    TEST_DESCRIPTION("Write past the end of mapped non-coherent memory: a "
+                     "flush reaching the end of the mapping reports it, and "
+                     "unmapping reports an overflow too far out for a flush.");
+    VkResult err;
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    const VkDeviceSize size = 4096;
+    VkMemoryAllocateInfo mem_alloc = {};
+    mem_alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_alloc.allocationSize = size;
+    if (!m_device->phy().set_memory_type(0xffffffff, &mem_alloc,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+        // Coherent memory is not shadowed, so there is nothing to test
+        return;
+    }
+    VkDeviceMemory mem;
+    err = vkAllocateMemory(m_device->device(), &mem_alloc, NULL, &mem);
+    ASSERT_VK_SUCCESS(err);
+
+    VkMappedMemoryRange range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = mem;
+
+    // Well past the end: flushes don't look that far, unmapping does
+    char *data;
+    err = vkMapMemory(m_device->device(), mem, 0, VK_WHOLE_SIZE, 0,
+                      (void **)&data);
+    ASSERT_VK_SUCCESS(err);
+    data[size + 1024] = 0;
+    m_errorMonitor->ExpectSuccess();
+    range.offset = 0;
+    range.size = VK_WHOLE_SIZE;
+    vkFlushMappedMemoryRanges(m_device->device(), 1, &range);
+    m_errorMonitor->VerifyNotFound();
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "Memory overflow was detected");
+    vkUnmapMemory(m_device->device(), mem);
+    m_errorMonitor->VerifyFound();
+
+    // Just past the end: found by a flush of the last bytes, but not by one
+    // that stops short of the end
+    err = vkMapMemory(m_device->device(), mem, 0, VK_WHOLE_SIZE, 0,
+                      (void **)&data);
+    ASSERT_VK_SUCCESS(err);
+    data[size] = 0;
+    m_errorMonitor->ExpectSuccess();
+    range.offset = 0;
+    range.size = 64;
+    vkFlushMappedMemoryRanges(m_device->device(), 1, &range);
+    m_errorMonitor->VerifyNotFound();
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "Memory overflow was detected");
+    range.offset = size - 64;
+    vkFlushMappedMemoryRanges(m_device->device(), 1, &range);
+    m_errorMonitor->VerifyFound();
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "Memory overflow was detected");
+    vkUnmapMemory(m_device->device(), mem);
+    m_errorMonitor->VerifyFound();
+
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
 TEST_F(VkLayerTest, RebindMemory) {
     VkResult err;
     bool pass;
@@ -2462,6 +2532,54 @@ TEST_F(VkLayerTest, DynamicStatesNotBound) {
     m_errorMonitor->VerifyFound();
 }
 
+TEST_F(VkLayerTest, DynamicStateNotBoundEveryDraw) {
+    TEST_DESCRIPTION("A draw-time error the callback does not skip the draw "
+                     "for is reported again at the next draw with the same "
+                     "state");
+
+    // The monitor asks for the call to be skipped only for the message it is
+    // looking for. Look for one that never comes, so the draws go ahead and
+    // every report ends up in the other messages.
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "no such message");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+
+    const float data[16] = {};
+    VkConstantBufferObj constantBuffer(m_device, 16, sizeof(float), data);
+    VkShaderObj vs(m_device, bindStateVertShaderText,
+                   VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj ps(m_device, bindStateFragShaderText,
+                   VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+    VkPipelineObj pipelineobj(m_device);
+    pipelineobj.AddColorAttachment();
+    pipelineobj.AddShader(&vs);
+    pipelineobj.AddShader(&ps);
+    pipelineobj.MakeDynamic(VK_DYNAMIC_STATE_DEPTH_BOUNDS);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendBuffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                               constantBuffer);
+
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+    ASSERT_VK_SUCCESS(BeginCommandBuffer());
+    GenericDrawPreparation(pipelineobj, descriptorSet, BsoFailDepthBounds);
+    Draw(3, 1, 0, 0);
+    Draw(3, 1, 0, 0);
+    EndCommandBuffer();
+
+    vector<string> msgs = m_errorMonitor->GetOtherFailureMsgs();
+    size_t reports = 0;
+    for (auto &msg : msgs) {
+        if (msg.find("Dynamic depth bounds state not set for this command "
+                     "buffer") != string::npos)
+            reports++;
+    }
+    EXPECT_EQ(2u, reports);
+}
+
 TEST_F(VkLayerTest, CommandBufferTwoSubmits) {
     vk_testing::Fence testFence;
 
@@ -3752,6 +3870,109 @@ TEST_F(VkLayerTest, InvalidPipelineCreateState) {
     vkDestroyDescriptorSetLayout(m_device->device(), ds_layout, NULL);
     vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
 }
+
+// Error messages a debug report callback received, and whether all of them
+// arrived on the thread that made the API call
+struct CallingThreadMessages {
+    std::thread::id caller;
+    bool all_on_caller;
+    vector<string> messages;
+};
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL
+RecordCallingThreadMessage(VkFlags msgFlags, VkDebugReportObjectTypeEXT objType,
+                           uint64_t srcObject, size_t location, int32_t msgCode,
+                           const char *pLayerPrefix, const char *pMsg,
+                           void *pUserData) {
+    CallingThreadMessages *record =
+        static_cast<CallingThreadMessages *>(pUserData);
+    if (std::this_thread::get_id() != record->caller)
+        record->all_on_caller = false;
+    record->messages.push_back(pMsg);
+    return VK_FALSE;
+}
+
+TEST_F(VkLayerTest, PipelineBatchMessagesInOrder) {
+    TEST_DESCRIPTION("The messages about a batch of pipelines validated in "
+                     "parallel reach the callbacks on the calling thread, "
+                     "in pipeline order.");
+    VkResult err;
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    CallingThreadMessages record;
+    record.caller = std::this_thread::get_id();
+    record.all_on_caller = true;
+    VkDebugReportCallbackCreateInfoEXT callback_info = {};
+    callback_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+    callback_info.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT;
+    callback_info.pfnCallback = RecordCallingThreadMessage;
+    callback_info.pUserData = &record;
+    VkDebugReportCallbackEXT callback;
+    err = m_CreateDebugReportCallback(instance(), &callback_info, NULL,
+                                      &callback);
+    ASSERT_VK_SUCCESS(err);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_ci = {};
+    pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    VkPipelineLayout pipeline_layout;
+    err = vkCreatePipelineLayout(m_device->device(), &pipeline_layout_ci, NULL,
+                                 &pipeline_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    VkViewport vp = {};
+    VkRect2D sc = {};
+    VkPipelineViewportStateCreateInfo vp_state_ci = {};
+    vp_state_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    vp_state_ci.scissorCount = 1;
+    vp_state_ci.pScissors = &sc;
+    vp_state_ci.viewportCount = 1;
+    vp_state_ci.pViewports = &vp;
+
+    VkPipelineRasterizationStateCreateInfo rs_state_ci = {};
+    rs_state_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rs_state_ci.polygonMode = VK_POLYGON_MODE_FILL;
+    rs_state_ci.cullMode = VK_CULL_MODE_BACK_BIT;
+    rs_state_ci.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    // The render pass has one subpass, so each pipeline's subpass index is
+    // out of range, and each by a different amount.  Enough pipelines that
+    // the workers, if any, validate some of them.
+    const uint32_t count = 2048;
+    vector<VkGraphicsPipelineCreateInfo> gp_ci(count);
+    for (uint32_t i = 0; i < count; i++) {
+        gp_ci[i].sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        gp_ci[i].pViewportState = &vp_state_ci;
+        gp_ci[i].pRasterizationState = &rs_state_ci;
+        gp_ci[i].layout = pipeline_layout;
+        gp_ci[i].renderPass = renderPass();
+        gp_ci[i].subpass = i + 1;
+    }
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "is out of range for this renderpass");
+    vector<VkPipeline> pipelines(count);
+    vkCreateGraphicsPipelines(m_device->device(), VK_NULL_HANDLE, count,
+                              gp_ci.data(), NULL, pipelines.data());
+    m_errorMonitor->VerifyFound();
+
+    EXPECT_TRUE(record.all_on_caller);
+    uint32_t next = 0;
+    for (auto &message : record.messages) {
+        if (message.find("is out of range for this renderpass") ==
+            string::npos)
+            continue;
+        std::ostringstream expected;
+        expected << "Subpass index " << next + 1 << " is out of range";
+        EXPECT_NE(string::npos, message.find(expected.str())) << message;
+        next++;
+    }
+    EXPECT_EQ(count, next);
+
+    m_DestroyDebugReportCallback(instance(), callback, NULL);
+    vkDestroyPipelineLayout(m_device->device(), pipeline_layout, NULL);
+}
 /*// TODO : This test should be good, but needs Tess support in compiler to run
 TEST_F(VkLayerTest, InvalidPatchControlPoints)
 {
@@ -5044,6 +5265,216 @@ TEST_F(VkLayerTest, InvalidBarriers) {
     m_errorMonitor->VerifyFound();
 }
 
+// Create an image with memory bound, initially in VK_IMAGE_LAYOUT_UNDEFINED.
+static void CreateLayoutTestImage(VkDeviceObj *device, VkFormat format,
+                                  VkImageUsageFlags usage, uint32_t levels,
+                                  uint32_t layers, VkImage *image,
+                                  VkDeviceMemory *mem) {
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = format;
+    image_create_info.extent.width = 32;
+    image_create_info.extent.height = 32;
+    image_create_info.extent.depth = 1;
+    image_create_info.mipLevels = levels;
+    image_create_info.arrayLayers = layers;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.usage = usage;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkResult err = vkCreateImage(device->device(), &image_create_info, NULL,
+                                 image);
+    ASSERT_VK_SUCCESS(err);
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device->device(), *image, &memReqs);
+    VkMemoryAllocateInfo memAlloc = {};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    bool pass =
+        device->phy().set_memory_type(memReqs.memoryTypeBits, &memAlloc, 0);
+    ASSERT_TRUE(pass);
+    err = vkAllocateMemory(device->device(), &memAlloc, NULL, mem);
+    ASSERT_VK_SUCCESS(err);
+    err = vkBindImageMemory(device->device(), *image, *mem, 0);
+    ASSERT_VK_SUCCESS(err);
+}
+
+static VkAccessFlags LayoutTestAccess(VkImageLayout layout) {
+    switch (layout) {
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        return VK_ACCESS_TRANSFER_READ_BIT;
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        return VK_ACCESS_TRANSFER_WRITE_BIT;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    default:
+        return 0;
+    }
+}
+
+// Record one layout transition of range into a command buffer of its own and
+// submit it, so the layer checks it against the image's layouts at submit.
+// Returns what vkQueueSubmit returned.
+static VkResult SubmitLayoutTransition(VkDeviceObj *device, VkCommandPool pool,
+                                       VkImage image,
+                                       VkImageSubresourceRange range,
+                                       VkImageLayout oldLayout,
+                                       VkImageLayout newLayout) {
+    VkCommandBufferObj cmd(device, pool);
+    VkImageMemoryBarrier img_barrier = {};
+    img_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    img_barrier.srcAccessMask = LayoutTestAccess(oldLayout);
+    img_barrier.dstAccessMask = LayoutTestAccess(newLayout);
+    img_barrier.oldLayout = oldLayout;
+    img_barrier.newLayout = newLayout;
+    img_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier.image = image;
+    img_barrier.subresourceRange = range;
+    cmd.BeginCommandBuffer();
+    cmd.PipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                        nullptr, 1, &img_barrier);
+    cmd.EndCommandBuffer();
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &cmd.handle();
+    VkResult err =
+        vkQueueSubmit(device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(device->m_queue);
+    return err;
+}
+
+TEST_F(VkLayerTest, ImageLayoutPartialTransitionThenWholeImage) {
+    TEST_DESCRIPTION("After one mip level is moved on its own, a transition of "
+                     "the whole image is checked against each level's own "
+                     "layout");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkImage image;
+    VkDeviceMemory mem;
+    CreateLayoutTestImage(m_device, VK_FORMAT_B8G8R8A8_UNORM,
+                          VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                              VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                          2, 1, &image, &mem);
+
+    m_errorMonitor->ExpectSuccess();
+    VkImageSubresourceRange level1 = {VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, 0, 1};
+    SubmitLayoutTransition(m_device, m_commandPool, image, level1,
+                           VK_IMAGE_LAYOUT_UNDEFINED,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    m_errorMonitor->VerifyNotFound();
+
+    // Level 1 is in TRANSFER_DST, but level 0 was never transitioned
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "[sub-resource: array layer 0, mip level 0], with layout "
+        "VK_IMAGE_LAYOUT_UNDEFINED when first use is "
+        "VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL");
+    VkImageSubresourceRange whole = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 2, 0, 1};
+    SubmitLayoutTransition(m_device, m_commandPool, image, whole,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           VK_IMAGE_LAYOUT_GENERAL);
+    m_errorMonitor->VerifyFound();
+    EXPECT_TRUE(m_errorMonitor->GetOtherFailureMsgs().empty());
+
+    vkDestroyImage(m_device->device(), image, NULL);
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
+TEST_F(VkLayerTest, ImageLayoutDepthStencilAspects) {
+    TEST_DESCRIPTION("The depth and stencil aspects of a depth/stencil image "
+                     "are each checked against their own layouts");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkImage image;
+    VkDeviceMemory mem;
+    CreateLayoutTestImage(m_device, VK_FORMAT_D24_UNORM_S8_UINT,
+                          VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 2, 1,
+                          &image, &mem);
+    const VkImageAspectFlags aspects =
+        VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+    m_errorMonitor->ExpectSuccess();
+    VkImageSubresourceRange level1 = {aspects, 1, 1, 0, 1};
+    SubmitLayoutTransition(m_device, m_commandPool, image, level1,
+                           VK_IMAGE_LAYOUT_UNDEFINED,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    m_errorMonitor->VerifyNotFound();
+
+    // Level 0 of both the depth and the stencil aspect was never transitioned
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "[sub-resource: array layer 0, mip level 0], with layout "
+        "VK_IMAGE_LAYOUT_UNDEFINED when first use is "
+        "VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL");
+    VkImageSubresourceRange whole = {aspects, 0, 2, 0, 1};
+    SubmitLayoutTransition(m_device, m_commandPool, image, whole,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                           VK_IMAGE_LAYOUT_GENERAL);
+    m_errorMonitor->VerifyFound();
+    EXPECT_EQ(1u, m_errorMonitor->GetOtherFailureMsgs().size());
+
+    // Both aspects of both levels are now in GENERAL
+    m_errorMonitor->ExpectSuccess();
+    SubmitLayoutTransition(m_device, m_commandPool, image, whole,
+                           VK_IMAGE_LAYOUT_GENERAL,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    m_errorMonitor->VerifyNotFound();
+
+    vkDestroyImage(m_device->device(), image, NULL);
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
+TEST_F(VkLayerTest, ImageLayoutWholeImageAfterPartial) {
+    TEST_DESCRIPTION("Moving a whole image after moving part of it puts every "
+                     "subresource in the new layout");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkImage image;
+    VkDeviceMemory mem;
+    CreateLayoutTestImage(m_device, VK_FORMAT_B8G8R8A8_UNORM,
+                          VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                              VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                          2, 2, &image, &mem);
+
+    m_errorMonitor->ExpectSuccess();
+    VkImageSubresourceRange level1 = {VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, 0, 2};
+    SubmitLayoutTransition(m_device, m_commandPool, image, level1,
+                           VK_IMAGE_LAYOUT_UNDEFINED,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    VkImageSubresourceRange whole = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 2, 0, 2};
+    SubmitLayoutTransition(m_device, m_commandPool, image, whole,
+                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    SubmitLayoutTransition(m_device, m_commandPool, image, whole,
+                           VK_IMAGE_LAYOUT_GENERAL,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    m_errorMonitor->VerifyNotFound();
+
+    // Every subresource, including level 1, is now in TRANSFER_SRC
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "[sub-resource: array layer 1, mip level 1], with layout "
+        "VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL when first use is "
+        "VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL");
+    VkImageSubresourceRange level1_layer1 = {VK_IMAGE_ASPECT_COLOR_BIT, 1, 1,
+                                             1, 1};
+    SubmitLayoutTransition(m_device, m_commandPool, image, level1_layer1,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           VK_IMAGE_LAYOUT_GENERAL);
+    m_errorMonitor->VerifyFound();
+
+    vkDestroyImage(m_device->device(), image, NULL);
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
 TEST_F(VkLayerTest, IdxBufferAlignmentError) {
     // Bind a BeginRenderPass within an active RenderPass
     VkResult err;
@@ -6337,6 +6768,91 @@ TEST_F(VkLayerTest, ThreadCommandBufferCollision) {
 #endif // THREADING_TESTS
 
 #if SHADER_CHECKER_TESTS
+// Hand-assembled SPIR-V, for tests that need exact control over ids and
+// decorations rather than whatever a GLSL compiler emits.
+enum {
+    SPV_OP_MEMORY_MODEL = 14,
+    SPV_OP_ENTRY_POINT = 15,
+    SPV_OP_EXECUTION_MODE = 16,
+    SPV_OP_CAPABILITY = 17,
+    SPV_OP_TYPE_VOID = 19,
+    SPV_OP_TYPE_FLOAT = 22,
+    SPV_OP_TYPE_VECTOR = 23,
+    SPV_OP_TYPE_STRUCT = 30,
+    SPV_OP_TYPE_POINTER = 32,
+    SPV_OP_TYPE_FUNCTION = 33,
+    SPV_OP_FUNCTION = 54,
+    SPV_OP_FUNCTION_END = 56,
+    SPV_OP_VARIABLE = 59,
+    SPV_OP_DECORATE = 71,
+    SPV_OP_MEMBER_DECORATE = 72,
+    SPV_OP_LABEL = 248,
+    SPV_OP_RETURN = 253,
+
+    SPV_DECORATION_BLOCK = 2,
+    SPV_DECORATION_BUILTIN = 11,
+    SPV_DECORATION_LOCATION = 30,
+    SPV_DECORATION_COMPONENT = 31,
+    SPV_BUILTIN_POSITION = 0,
+    SPV_STORAGE_INPUT = 1,
+    SPV_STORAGE_OUTPUT = 3,
+    SPV_MODEL_VERTEX = 0,
+    SPV_MODEL_FRAGMENT = 4,
+    SPV_MODE_ORIGIN_UPPER_LEFT = 7,
+};
+
+static void SpvInsn(std::vector<uint32_t> &spv, uint32_t opcode,
+                    std::vector<uint32_t> const &operands) {
+    spv.push_back((uint32_t)(operands.size() + 1) << 16 | opcode);
+    spv.insert(spv.end(), operands.begin(), operands.end());
+}
+
+// The header, capabilities and memory model, then an entrypoint "main" with
+// id main for the given execution model and interface variables.
+static std::vector<uint32_t> SpvBegin(uint32_t bound, uint32_t model,
+                                      uint32_t main,
+                                      std::vector<uint32_t> const &interface) {
+    std::vector<uint32_t> spv = {0x07230203, 0x00010000, 0, bound, 0};
+    SpvInsn(spv, SPV_OP_CAPABILITY, {1 /* Shader */});
+    SpvInsn(spv, SPV_OP_MEMORY_MODEL, {0 /* Logical */, 1 /* GLSL450 */});
+    std::vector<uint32_t> entrypoint = {model, main, 0x6e69616d /* "main" */,
+                                        0};
+    entrypoint.insert(entrypoint.end(), interface.begin(), interface.end());
+    SpvInsn(spv, SPV_OP_ENTRY_POINT, entrypoint);
+    if (model == SPV_MODEL_FRAGMENT)
+        SpvInsn(spv, SPV_OP_EXECUTION_MODE, {main, SPV_MODE_ORIGIN_UPPER_LEFT});
+    return spv;
+}
+
+// An empty main, of type fn returning void.
+static void SpvEmptyMain(std::vector<uint32_t> &spv, uint32_t main,
+                         uint32_t void_type, uint32_t fn, uint32_t label) {
+    SpvInsn(spv, SPV_OP_FUNCTION, {void_type, main, 0, fn});
+    SpvInsn(spv, SPV_OP_LABEL, {label});
+    SpvInsn(spv, SPV_OP_RETURN, {});
+    SpvInsn(spv, SPV_OP_FUNCTION_END, {});
+}
+
+// A fragment shader reading a vec4 at location 0 into a vec4 output at
+// location 0, to pair with the vertex shaders below.
+static std::vector<uint32_t> SpvFragmentShaderReadingLocation0(uint32_t bound) {
+    enum { MAIN = 1, VOID, FN, FLOAT, VEC4, IN_PTR, IN, OUT_PTR, OUT, LABEL };
+    std::vector<uint32_t> spv =
+        SpvBegin(bound, SPV_MODEL_FRAGMENT, MAIN, {IN, OUT});
+    SpvInsn(spv, SPV_OP_DECORATE, {IN, SPV_DECORATION_LOCATION, 0});
+    SpvInsn(spv, SPV_OP_DECORATE, {OUT, SPV_DECORATION_LOCATION, 0});
+    SpvInsn(spv, SPV_OP_TYPE_VOID, {VOID});
+    SpvInsn(spv, SPV_OP_TYPE_FUNCTION, {FN, VOID});
+    SpvInsn(spv, SPV_OP_TYPE_FLOAT, {FLOAT, 32});
+    SpvInsn(spv, SPV_OP_TYPE_VECTOR, {VEC4, FLOAT, 4});
+    SpvInsn(spv, SPV_OP_TYPE_POINTER, {IN_PTR, SPV_STORAGE_INPUT, VEC4});
+    SpvInsn(spv, SPV_OP_VARIABLE, {IN_PTR, IN, SPV_STORAGE_INPUT});
+    SpvInsn(spv, SPV_OP_TYPE_POINTER, {OUT_PTR, SPV_STORAGE_OUTPUT, VEC4});
+    SpvInsn(spv, SPV_OP_VARIABLE, {OUT_PTR, OUT, SPV_STORAGE_OUTPUT});
+    SpvEmptyMain(spv, MAIN, VOID, FN, LABEL);
+    return spv;
+}
+
 TEST_F(VkLayerTest, InvalidSPIRVCodeSize) {
     m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
                                          "Invalid SPIR-V header");
@@ -6765,6 +7281,152 @@ TEST_F(VkLayerTest, CreatePipelineVsFsMismatchByComponent) {
     m_errorMonitor->VerifyFound();
 }
 
+TEST_F(VkLayerTest, CreatePipelineSpirvBuiltinBlockPositive) {
+    TEST_DESCRIPTION("Members of a vertex shader's gl_PerVertex block are "
+                     "builtins, so only its location 0 output meets the "
+                     "fragment shader's input");
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    enum {
+        MAIN = 1, VOID, FN, FLOAT, VEC4, PER_VERTEX, PER_VERTEX_PTR,
+        PER_VERTEX_VAR, OUT_PTR, OUT, LABEL, BOUND
+    };
+    std::vector<uint32_t> vs =
+        SpvBegin(BOUND, SPV_MODEL_VERTEX, MAIN, {PER_VERTEX_VAR, OUT});
+    SpvInsn(vs, SPV_OP_MEMBER_DECORATE,
+            {PER_VERTEX, 0, SPV_DECORATION_BUILTIN, SPV_BUILTIN_POSITION});
+    SpvInsn(vs, SPV_OP_DECORATE, {PER_VERTEX, SPV_DECORATION_BLOCK});
+    SpvInsn(vs, SPV_OP_DECORATE, {OUT, SPV_DECORATION_LOCATION, 0});
+    SpvInsn(vs, SPV_OP_TYPE_VOID, {VOID});
+    SpvInsn(vs, SPV_OP_TYPE_FUNCTION, {FN, VOID});
+    SpvInsn(vs, SPV_OP_TYPE_FLOAT, {FLOAT, 32});
+    SpvInsn(vs, SPV_OP_TYPE_VECTOR, {VEC4, FLOAT, 4});
+    SpvInsn(vs, SPV_OP_TYPE_STRUCT, {PER_VERTEX, VEC4});
+    SpvInsn(vs, SPV_OP_TYPE_POINTER,
+            {PER_VERTEX_PTR, SPV_STORAGE_OUTPUT, PER_VERTEX});
+    SpvInsn(vs, SPV_OP_VARIABLE,
+            {PER_VERTEX_PTR, PER_VERTEX_VAR, SPV_STORAGE_OUTPUT});
+    SpvInsn(vs, SPV_OP_TYPE_POINTER, {OUT_PTR, SPV_STORAGE_OUTPUT, VEC4});
+    SpvInsn(vs, SPV_OP_VARIABLE, {OUT_PTR, OUT, SPV_STORAGE_OUTPUT});
+    SpvEmptyMain(vs, MAIN, VOID, FN, LABEL);
+
+    VkShaderObj vso(m_device, vs, VK_SHADER_STAGE_VERTEX_BIT);
+    VkShaderObj fso(m_device, SpvFragmentShaderReadingLocation0(11),
+                    VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vso);
+    pipe.AddShader(&fso);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendDummy();
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+TEST_F(VkLayerTest, CreatePipelineSpirvBlockMemberLocation) {
+    TEST_DESCRIPTION("The location of an output block member comes from its "
+                     "OpMemberDecorate, not from the block variable");
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "location 0.0 which is not written by vertex shader");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    // out block { layout(location=1, component=0) vec4 x; } outs;
+    enum {
+        MAIN = 1, VOID, FN, FLOAT, VEC4, BLOCK, BLOCK_PTR, BLOCK_VAR, LABEL,
+        BOUND
+    };
+    std::vector<uint32_t> vs =
+        SpvBegin(BOUND, SPV_MODEL_VERTEX, MAIN, {BLOCK_VAR});
+    SpvInsn(vs, SPV_OP_MEMBER_DECORATE,
+            {BLOCK, 0, SPV_DECORATION_LOCATION, 1});
+    SpvInsn(vs, SPV_OP_MEMBER_DECORATE,
+            {BLOCK, 0, SPV_DECORATION_COMPONENT, 0});
+    SpvInsn(vs, SPV_OP_DECORATE, {BLOCK, SPV_DECORATION_BLOCK});
+    SpvInsn(vs, SPV_OP_TYPE_VOID, {VOID});
+    SpvInsn(vs, SPV_OP_TYPE_FUNCTION, {FN, VOID});
+    SpvInsn(vs, SPV_OP_TYPE_FLOAT, {FLOAT, 32});
+    SpvInsn(vs, SPV_OP_TYPE_VECTOR, {VEC4, FLOAT, 4});
+    SpvInsn(vs, SPV_OP_TYPE_STRUCT, {BLOCK, VEC4});
+    SpvInsn(vs, SPV_OP_TYPE_POINTER, {BLOCK_PTR, SPV_STORAGE_OUTPUT, BLOCK});
+    SpvInsn(vs, SPV_OP_VARIABLE, {BLOCK_PTR, BLOCK_VAR, SPV_STORAGE_OUTPUT});
+    SpvEmptyMain(vs, MAIN, VOID, FN, LABEL);
+
+    VkShaderObj vso(m_device, vs, VK_SHADER_STAGE_VERTEX_BIT);
+    VkShaderObj fso(m_device, SpvFragmentShaderReadingLocation0(11),
+                    VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vso);
+    pipe.AddShader(&fso);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendDummy();
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+
+    m_errorMonitor->VerifyFound();
+}
+
+TEST_F(VkLayerTest, CreatePipelineSpirvIdsOutOfRange) {
+    TEST_DESCRIPTION("Decorations of ids past a module's bound are ignored, "
+                     "and a bound past SPIR-V's limit does not size the "
+                     "module's index");
+    // spvValidate may also reject both modules; the interface is still
+    // checked.
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "location 0.0 which is not written by vertex shader");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    enum { MAIN = 1, VOID, FN, FLOAT, VEC4, OUT_PTR, OUT, LABEL, BOUND };
+    std::vector<uint32_t> vs = SpvBegin(BOUND, SPV_MODEL_VERTEX, MAIN, {OUT});
+    SpvInsn(vs, SPV_OP_DECORATE, {OUT, SPV_DECORATION_LOCATION, 1});
+    SpvInsn(vs, SPV_OP_DECORATE, {BOUND, SPV_DECORATION_LOCATION, 0});
+    SpvInsn(vs, SPV_OP_DECORATE,
+            {0xffffffff, SPV_DECORATION_BUILTIN, SPV_BUILTIN_POSITION});
+    SpvInsn(vs, SPV_OP_MEMBER_DECORATE,
+            {BOUND + 100, 0, SPV_DECORATION_LOCATION, 0});
+    SpvInsn(vs, SPV_OP_TYPE_VOID, {VOID});
+    SpvInsn(vs, SPV_OP_TYPE_FUNCTION, {FN, VOID});
+    SpvInsn(vs, SPV_OP_TYPE_FLOAT, {FLOAT, 32});
+    SpvInsn(vs, SPV_OP_TYPE_VECTOR, {VEC4, FLOAT, 4});
+    SpvInsn(vs, SPV_OP_TYPE_POINTER, {OUT_PTR, SPV_STORAGE_OUTPUT, VEC4});
+    SpvInsn(vs, SPV_OP_VARIABLE, {OUT_PTR, OUT, SPV_STORAGE_OUTPUT});
+    SpvEmptyMain(vs, MAIN, VOID, FN, LABEL);
+
+    VkShaderObj vso(m_device, vs, VK_SHADER_STAGE_VERTEX_BIT);
+    VkShaderObj fso(m_device, SpvFragmentShaderReadingLocation0(0xffffffff),
+                    VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vso);
+    pipe.AddShader(&fso);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendDummy();
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+
+    m_errorMonitor->VerifyFound();
+}
+
 TEST_F(VkLayerTest, CreatePipelineAttribNotConsumed) {
     m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
                                          "location 0 not consumed by VS");
@@ -8857,6 +9519,79 @@ TEST_F(VkLayerTest, DepthStencilImageViewWithColorAspectBitError) {
 }
 #endif // IMAGE_TESTS
 
+#if DEBUG_REPORT_TESTS
+struct LoggedMessage {
+    VkFlags flags;
+    std::string prefix;
+    std::string msg;
+};
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL RecordMessage(VkFlags msgFlags, VkDebugReportObjectTypeEXT objType, uint64_t srcObject,
+                                                    size_t location, int32_t msgCode, const char *pLayerPrefix,
+                                                    const char *pMsg, void *pUserData) {
+    LoggedMessage message = {msgFlags, pLayerPrefix, pMsg};
+    static_cast<std::vector<LoggedMessage> *>(pUserData)->push_back(message);
+    return VK_FALSE;
+}
+
+TEST(VkDebugReportTest, DuplicateMessageLimit) {
+    TEST_DESCRIPTION("Log the same message more often than the duplicate "
+                     "message limit allows, and check that the repeats are "
+                     "dropped and summarized, that a different severity or "
+                     "layer counts as a different message, and that the counts "
+                     "are forgotten once too many messages are counted.");
+
+    std::vector<LoggedMessage> messages;
+    debug_report_data *data = (debug_report_data *)calloc(1, sizeof(debug_report_data));
+    ASSERT_NE(nullptr, data);
+    VkDebugReportCallbackCreateInfoEXT callback_info = {};
+    callback_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+    callback_info.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT;
+    callback_info.pfnCallback = RecordMessage;
+    callback_info.pUserData = &messages;
+    VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+    ASSERT_EQ(VK_SUCCESS, layer_create_msg_callback(data, &callback_info, NULL, &callback));
+
+    // Report each message twice, and how many more were dropped every 3
+    debug_report_set_repeat_limit(data, 2, 3);
+    const uint64_t object = 0x10;
+    for (int i = 0; i < 10; i++) {
+        log_msg(data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, object, 0, 7, "DS", "error %d", i);
+    }
+    log_msg(data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, object, 0, 7, "DS",
+            "warning");
+    log_msg(data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, object, 0, 7, "MEM", "other layer");
+    debug_report_flush_suppressed(data);
+
+    const char *summary = "3 more repeats of message code 7 for this object were suppressed after the first 2.";
+    ASSERT_EQ(7u, messages.size());
+    EXPECT_EQ("error 0", messages[0].msg);
+    EXPECT_EQ("error 1", messages[1].msg);
+    EXPECT_EQ(summary, messages[2].msg);
+    EXPECT_EQ(summary, messages[3].msg);
+    EXPECT_EQ("warning", messages[4].msg);
+    EXPECT_EQ("other layer", messages[5].msg);
+    EXPECT_EQ("2 more repeats of message code 7 for this object were suppressed after the first 2.", messages[6].msg);
+    for (size_t i : {2u, 3u, 6u}) {
+        EXPECT_EQ(VK_DEBUG_REPORT_ERROR_BIT_EXT, messages[i].flags);
+        EXPECT_EQ("DS", messages[i].prefix);
+    }
+
+    // Counting a message for each of enough other objects forgets the count of the first
+    messages.clear();
+    for (uint64_t other = 1; other <= DEBUG_REPORT_REPEAT_MAX_ENTRIES; other++) {
+        log_msg(data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, object + other, 0, 7, "DS",
+                "other object");
+    }
+    log_msg(data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, object, 0, 7, "DS", "error again");
+    ASSERT_EQ(DEBUG_REPORT_REPEAT_MAX_ENTRIES + 1u, messages.size());
+    EXPECT_EQ("error again", messages.back().msg);
+
+    layer_destroy_msg_callback(data, callback, NULL);
+    layer_debug_report_destroy_instance(data);
+}
+#endif // DEBUG_REPORT_TESTS
+
 int main(int argc, char **argv) {
     int result;
 
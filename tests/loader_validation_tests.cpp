@@ -26,10 +26,17 @@
  */
 
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 #include <vulkan/vulkan.h>
 #include "test_common.h"
 
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+
 // Test groups:
 // LX = lunar exchange
 // LVLGH = loader and validation github
@@ -64,6 +71,196 @@ TEST(LX475, DestroyDeviceNullHandle)
     vkDestroyDevice(VK_NULL_HANDLE, nullptr);
 }
 
+#if defined(NULL_ICD_MANIFEST) && defined(NULL_ICD_LIBRARY)
+
+// Runs each test against two copies of the null ICD, listed twice in
+// VK_ICD_FILENAMES, and counts the driver's vkEnumeratePhysicalDevices calls
+// through a hook it exports for tests.
+class NullIcdPair : public ::testing::Test
+{
+protected:
+    typedef uint64_t (VKAPI_PTR *PFN_callCount)();
+
+    virtual void SetUp()
+    {
+        const char *previous = getenv("VK_ICD_FILENAMES");
+        hadPrevious = previous != nullptr;
+        if (hadPrevious)
+        {
+            previousIcdFilenames = previous;
+        }
+#if defined(_WIN32)
+        const std::string manifests = std::string(NULL_ICD_MANIFEST) + ";" + NULL_ICD_MANIFEST;
+        _putenv_s("VK_ICD_FILENAMES", manifests.c_str());
+        library = LoadLibraryA(NULL_ICD_LIBRARY);
+        ASSERT_NE(library, nullptr);
+        callCount = (PFN_callCount)GetProcAddress(library, "vk_nullDriverEnumeratePhysicalDevicesCalls");
+#else
+        const std::string manifests = std::string(NULL_ICD_MANIFEST) + ":" + NULL_ICD_MANIFEST;
+        setenv("VK_ICD_FILENAMES", manifests.c_str(), 1);
+        library = dlopen(NULL_ICD_LIBRARY, RTLD_NOW | RTLD_LOCAL);
+        ASSERT_NE(library, nullptr);
+        callCount = (PFN_callCount)dlsym(library, "vk_nullDriverEnumeratePhysicalDevicesCalls");
+#endif
+        ASSERT_NE(callCount, nullptr);
+
+        VkInstanceCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        ASSERT_EQ(vkCreateInstance(&info, nullptr, &instance), VK_SUCCESS);
+    }
+
+    virtual void TearDown()
+    {
+        if (instance != VK_NULL_HANDLE)
+        {
+            vkDestroyInstance(instance, nullptr);
+        }
+#if defined(_WIN32)
+        _putenv_s("VK_ICD_FILENAMES", hadPrevious ? previousIcdFilenames.c_str() : "");
+        if (library)
+        {
+            FreeLibrary(library);
+        }
+#else
+        if (hadPrevious)
+        {
+            setenv("VK_ICD_FILENAMES", previousIcdFilenames.c_str(), 1);
+        }
+        else
+        {
+            unsetenv("VK_ICD_FILENAMES");
+        }
+        if (library)
+        {
+            dlclose(library);
+        }
+#endif
+    }
+
+    std::vector<VkPhysicalDevice> enumerate()
+    {
+        uint32_t count = 0;
+        EXPECT_EQ(vkEnumeratePhysicalDevices(instance, &count, nullptr), VK_SUCCESS);
+        std::vector<VkPhysicalDevice> physicalDevices(count);
+        EXPECT_EQ(vkEnumeratePhysicalDevices(instance, &count, physicalDevices.data()), VK_SUCCESS);
+        physicalDevices.resize(count);
+        return physicalDevices;
+    }
+
+    VkInstance instance = VK_NULL_HANDLE;
+#if defined(_WIN32)
+    HMODULE library = nullptr;
+#else
+    void *library = nullptr;
+#endif
+    PFN_callCount callCount = nullptr;
+    bool hadPrevious = false;
+    std::string previousIcdFilenames;
+};
+
+TEST_F(NullIcdPair, EnumeratePhysicalDevicesStableHandles)
+{
+    const std::vector<VkPhysicalDevice> first = enumerate();
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_NE(first[0], first[1]);
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(enumerate(), first);
+    }
+
+    for (VkPhysicalDevice physicalDevice : first)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        EXPECT_EQ(VK_VERSION_MAJOR(properties.apiVersion), 1u);
+    }
+}
+
+TEST_F(NullIcdPair, EnumeratePhysicalDevicesQueriesDriversOnce)
+{
+    const uint64_t before = callCount();
+    const std::vector<VkPhysicalDevice> first = enumerate();
+    ASSERT_EQ(first.size(), 2u);
+    const uint64_t afterFirst = callCount();
+    EXPECT_GT(afterFirst, before);
+
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(enumerate(), first);
+    }
+    EXPECT_EQ(callCount(), afterFirst);
+}
+
+TEST_F(NullIcdPair, EnumeratePhysicalDevicesIncomplete)
+{
+    uint32_t count = 1;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    EXPECT_EQ(vkEnumeratePhysicalDevices(instance, &count, &physicalDevice), VK_INCOMPLETE);
+    EXPECT_EQ(count, 1u);
+
+    // A short array must not shrink the device list or change the handles
+    const std::vector<VkPhysicalDevice> all = enumerate();
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[0], physicalDevice);
+}
+
+// Looks up thousands of device entrypoints the loader doesn't know, half before
+// and half after creating a device, and checks that each gets a trampoline of
+// its own that reaches the null driver's function for that name.
+TEST_F(NullIcdPair, UnknownDeviceEntrypoints)
+{
+    typedef void (VKAPI_PTR *PFN_testEntrypoint)(VkDevice device, uint32_t *pValue);
+    const uint32_t entrypointCount = 3000;
+    const uint32_t driverFunctionCount = 8;
+    std::vector<PFN_testEntrypoint> entrypoints(entrypointCount);
+    auto lookup = [this](uint32_t i)
+    {
+        const std::string name = "vkNullDriverTestEntrypoint" + std::to_string(i);
+        return (PFN_testEntrypoint)vkGetInstanceProcAddr(instance, name.c_str());
+    };
+
+    for (uint32_t i = 0; i < entrypointCount / 2; i++)
+    {
+        entrypoints[i] = lookup(i);
+        ASSERT_NE(entrypoints[i], nullptr);
+    }
+
+    const std::vector<VkPhysicalDevice> physicalDevices = enumerate();
+    ASSERT_FALSE(physicalDevices.empty());
+    const float priority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo = {};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+    VkDeviceCreateInfo deviceInfo = {};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    VkDevice device = VK_NULL_HANDLE;
+    ASSERT_EQ(vkCreateDevice(physicalDevices[0], &deviceInfo, nullptr, &device), VK_SUCCESS);
+
+    for (uint32_t i = entrypointCount / 2; i < entrypointCount; i++)
+    {
+        entrypoints[i] = lookup(i);
+        ASSERT_NE(entrypoints[i], nullptr);
+    }
+
+    EXPECT_EQ(std::set<PFN_testEntrypoint>(entrypoints.begin(), entrypoints.end()).size(), entrypointCount);
+    for (uint32_t i = 0; i < entrypointCount; i++)
+    {
+        EXPECT_EQ(lookup(i), entrypoints[i]);
+        uint32_t value = UINT32_MAX;
+        entrypoints[i](device, &value);
+        EXPECT_EQ(value, i % driverFunctionCount) << "vkNullDriverTestEntrypoint" << i;
+    }
+    EXPECT_EQ(vkGetInstanceProcAddr(instance, "vkNullDriverTestEntrypoint"), nullptr);
+
+    vkDestroyDevice(device, nullptr);
+}
+
+#endif // NULL_ICD_MANIFEST && NULL_ICD_LIBRARY
+
 int main(int argc, char **argv)
 {
     int result;
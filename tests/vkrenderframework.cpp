@@ -1131,6 +1131,25 @@ VkShaderObj::VkShaderObj(VkDeviceObj *device, const char *shader_code,
     assert(VK_SUCCESS == err);
 }
 
+VkShaderObj::VkShaderObj(VkDeviceObj *device, std::vector<uint32_t> const &spv,
+                         VkShaderStageFlagBits stage, char const *name) {
+    VkResult U_ASSERT_ONLY err = VK_SUCCESS;
+    VkShaderModuleCreateInfo moduleCreateInfo;
+
+    m_stage = stage;
+    m_device = device;
+    m_name = name;
+
+    moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleCreateInfo.pNext = NULL;
+    moduleCreateInfo.pCode = spv.data();
+    moduleCreateInfo.codeSize = spv.size() * sizeof(uint32_t);
+    moduleCreateInfo.flags = 0;
+
+    err = init_try(*m_device, moduleCreateInfo);
+    assert(VK_SUCCESS == err);
+}
+
 VkPipelineObj::VkPipelineObj(VkDeviceObj *device) {
     m_device = device;
 
@@ -396,6 +396,9 @@ class VkShaderObj : public vk_testing::ShaderModule {
     VkShaderObj(VkDeviceObj *device, const char *shaderText,
                 VkShaderStageFlagBits stage, VkRenderFramework *framework,
                 char const *name = "main");
+    // For hand-assembled SPIR-V, passed to the driver as is
+    VkShaderObj(VkDeviceObj *device, std::vector<uint32_t> const &spv,
+                VkShaderStageFlagBits stage, char const *name = "main");
     VkPipelineShaderStageCreateInfo GetStageCreateInfo() const;
 
   protected:
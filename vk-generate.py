@@ -148,12 +148,123 @@ class DispatchTableOpsSubcommand(Subcommand):
 
         return "\n\n".join(body)
 
+class NullDriverEntrypointsSubcommand(Subcommand):
+    # Implemented by hand in icd/null_driver.cpp; everything else gets a
+    # generated body that only fills in new handles and zero counts.
+    custom_protos = [
+        "CreateInstance",
+        "DestroyInstance",
+        "EnumeratePhysicalDevices",
+        "GetPhysicalDeviceFeatures",
+        "GetPhysicalDeviceFormatProperties",
+        "GetPhysicalDeviceImageFormatProperties",
+        "GetPhysicalDeviceProperties",
+        "GetPhysicalDeviceQueueFamilyProperties",
+        "GetPhysicalDeviceMemoryProperties",
+        "GetInstanceProcAddr",
+        "GetDeviceProcAddr",
+        "CreateDevice",
+        "DestroyDevice",
+        "EnumerateInstanceExtensionProperties",
+        "EnumerateDeviceExtensionProperties",
+        "EnumerateInstanceLayerProperties",
+        "EnumerateDeviceLayerProperties",
+        "GetDeviceQueue",
+        "AllocateMemory",
+        "FreeMemory",
+        "MapMemory",
+        "GetDeviceMemoryCommitment",
+        "GetBufferMemoryRequirements",
+        "GetImageMemoryRequirements",
+        "GetEventStatus",
+        "GetQueryPoolResults",
+        "CreateBuffer",
+        "DestroyBuffer",
+        "CreateImage",
+        "DestroyImage",
+        "GetImageSubresourceLayout",
+        "GetPipelineCacheData",
+        "CreateGraphicsPipelines",
+        "CreateComputePipelines",
+        "AllocateDescriptorSets",
+        "GetRenderAreaGranularity",
+        "CreateCommandPool",
+        "DestroyCommandPool",
+        "AllocateCommandBuffers",
+        "FreeCommandBuffers",
+    ]
+
+    def generate_header(self):
+        return "\n".join(["#include <vulkan/vulkan.h>",
+                          "#include <string.h>"])
+
+    def _generate_stub(self, proto):
+        stmts = []
+        zero_count = False
+        for param in proto.params:
+            if param.ty.startswith("const") or not param.ty.endswith("*"):
+                continue
+            ty = param.ty[:-1]
+            if ty in vulkan.object_non_dispatch_list:
+                stmts.append("*%s = null_new_handle<%s>();" % (param.name, ty))
+            elif ty == "uint32_t" and param.name.endswith("Count"):
+                stmts.append("*%s = 0;" % param.name)
+                zero_count = True
+            elif zero_count:
+                # array sized by the count we just reported as zero
+                pass
+            else:
+                raise Exception("vk%s: no default for output %s %s, "
+                                "implement it in null_driver.cpp" %
+                                (proto.name, param.ty, param.name))
+        if proto.ret == "VkResult":
+            stmts.append("return VK_SUCCESS;")
+        elif proto.ret != "void":
+            raise Exception("vk%s: no default for return type %s" %
+                            (proto.name, proto.ret))
+
+        func = []
+        func.append("static %s {" % proto.c_func(prefix="null_", attr="VKAPI"))
+        if stmts:
+            func.append("    %s" % "\n    ".join(stmts))
+        func.append("}")
+        return "\n".join(func)
+
+    def generate_body(self):
+        body = []
+        for proto in vulkan.core.protos:
+            if proto.name not in self.custom_protos:
+                body.append(self._generate_stub(proto))
+
+        table = []
+        table.append("struct null_entrypoint {")
+        table.append("    const char *name;")
+        table.append("    PFN_vkVoidFunction func;")
+        table.append("    bool is_device;")
+        table.append("};")
+        table.append("")
+        table.append("static const null_entrypoint null_entrypoints[] = {")
+        for proto in vulkan.core.protos:
+            is_device = (proto.params[0].ty in ["VkDevice", "VkQueue", "VkCommandBuffer"])
+            table.append("    {\"vk%s\", reinterpret_cast<PFN_vkVoidFunction>(null_%s), %s}," %
+                         (proto.name, proto.name, "true" if is_device else "false"))
+        table.append("};")
+        body.append("\n".join(table))
+
+        return "\n\n".join(body)
+
 class WinDefFileSubcommand(Subcommand):
     def run(self):
         library_exports = {
                 "all": [],
                 "icd": [
                     "vk_icdGetInstanceProcAddr",
+                    "vk_icdNegotiateLoaderICDInterfaceVersion",
+                ],
+                "icd_null": [
+                    "vk_icdGetInstanceProcAddr",
+                    "vk_icdNegotiateLoaderICDInterfaceVersion",
+                    "vk_nullDriverEnumeratePhysicalDevicesCalls",
                 ],
                 "layer": [
                     "vkGetInstanceProcAddr",
@@ -175,6 +286,8 @@ class WinDefFileSubcommand(Subcommand):
         self.library = self.argv[0]
         if self.library == "VkLayer_multi":
             self.exports = library_exports["layer_multi"]
+        elif self.library == "VkICD_null_driver":
+            self.exports = library_exports["icd_null"]
         else:
             self.exports = library_exports[self.argv[1]]
 
@@ -232,6 +345,7 @@ def main():
     subcommands = {
             "dispatch-table-ops": DispatchTableOpsSubcommand,
             "win-def-file": WinDefFileSubcommand,
+            "null-driver-entrypoints": NullDriverEntrypointsSubcommand,
     }
 
     if len(sys.argv) < 3 or sys.argv[1] not in wsi or sys.argv[2] not in subcommands:
@@ -33,6 +33,7 @@ import os
 import re
 
 import vulkan
+import entrypoint_hash
 import vk_helper
 from source_line_info import sourcelineinfo
 from collections import defaultdict
@@ -453,21 +454,20 @@ class Subcommand(object):
         prefix="vk"
         lookups = []
         for proto in intercepted:
-            lookups.append("if (!strcmp(name, \"%s\"))" % proto.name)
-            lookups.append("    return (PFN_vkVoidFunction) %s%s;" %
-                    (prefix, proto.name))
+            lookups.append("    {\"%s%s\", (PFN_vkVoidFunction) %s%s}," %
+                    (prefix, proto.name, prefix, proto.name))
+        lookups.append("    {\"vkGetDeviceProcAddr\", (PFN_vkVoidFunction) vkGetDeviceProcAddr},")
 
         # add customized layer_intercept_proc
         body = []
         body.append('%s' % self.lineinfo.get())
+        body.append("static const layer_intercept_table layer_intercepts = {")
+        body.append("\n".join(lookups))
+        body.append("};")
+        body.append("")
         body.append("static inline PFN_vkVoidFunction layer_intercept_proc(const char *name)")
         body.append("{")
-        body.append(generate_get_proc_addr_check("name"))
-        body.append("")
-        body.append("    name += 2;")
-        body.append("    %s" % "\n    ".join(lookups))
-        body.append("")
-        body.append("    return NULL;")
+        body.append("    return layer_intercepts.find(name);")
         body.append("}")
         # add layer_intercept_instance_proc
         lookups = []
@@ -481,17 +481,17 @@ class Subcommand(object):
                 continue
             if proto.name == "CreateDevice":
                 continue
-            lookups.append("if (!strcmp(name, \"%s\"))" % proto.name)
-            lookups.append("    return (PFN_vkVoidFunction) %s%s;" % (prefix, proto.name))
+            lookups.append("    {\"%s%s\", (PFN_vkVoidFunction) %s%s}," % (prefix, proto.name, prefix, proto.name))
+        for name in ["GetInstanceProcAddr", "CreateInstance", "CreateDevice"]:
+            lookups.append("    {\"%s%s\", (PFN_vkVoidFunction) %s%s}," % (prefix, name, prefix, name))
 
+        body.append("static const layer_intercept_table layer_instance_intercepts = {")
+        body.append("\n".join(lookups))
+        body.append("};")
+        body.append("")
         body.append("static inline PFN_vkVoidFunction layer_intercept_instance_proc(const char *name)")
         body.append("{")
-        body.append(generate_get_proc_addr_check("name"))
-        body.append("")
-        body.append("    name += 2;")
-        body.append("    %s" % "\n    ".join(lookups))
-        body.append("")
-        body.append("    return NULL;")
+        body.append("    return layer_instance_intercepts.find(name);")
         body.append("}")
 
         funcs.append("\n".join(body))
@@ -511,12 +511,25 @@ class Subcommand(object):
 # New style of GPA Functions for the new layer_data/layer_logging changes
 #
         if self.layer_name in ['object_tracker', 'unique_objects']:
+            for (ext_enable, ext_list) in extensions:
+                func_body.append('static const layer_intercept_table %s_device_intercepts = {' % ext_enable)
+                for ext_name in ext_list:
+                    func_body.append('    {"%s", reinterpret_cast<PFN_vkVoidFunction>(%s)},' % (ext_name, ext_name))
+                func_body.append('};\n')
+            for (ext_enable, ext_list) in instance_extensions:
+                if ext_enable == 'msg_callback_get_proc_addr':
+                    continue
+                func_body.append('static const layer_intercept_table %s_instance_intercepts = {' % ext_enable)
+                for ext_name in ext_list:
+                    if wsi_name(ext_name):
+                        func_body.append('%s' % wsi_ifdef(ext_name))
+                    func_body.append('    {"%s", reinterpret_cast<PFN_vkVoidFunction>(%s)},' % (ext_name, ext_name))
+                    if wsi_name(ext_name):
+                        func_body.append('%s' % wsi_endif(ext_name))
+                func_body.append('};\n')
             func_body.append("VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice device, const char* funcName)\n"
                              "{\n"
                              "    PFN_vkVoidFunction addr;\n"
-                             "    if (!strcmp(\"vkGetDeviceProcAddr\", funcName)) {\n"
-                             "        return (PFN_vkVoidFunction) vkGetDeviceProcAddr;\n"
-                             "    }\n\n"
                              "    addr = layer_intercept_proc(funcName);\n"
                              "    if (addr)\n"
                              "        return addr;\n"
@@ -527,15 +540,11 @@ class Subcommand(object):
                 func_body.append('%s' % self.lineinfo.get())
                 func_body.append('    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);')
                 for (ext_enable, ext_list) in extensions:
-                    extra_space = ""
-                    if 0 != len(ext_enable):
-                        func_body.append('    if (my_device_data->%s) {' % ext_enable)
-                        extra_space = "    "
-                    for ext_name in ext_list:
-                        func_body.append('    %sif (!strcmp("%s", funcName))\n'
-                                         '        %sreturn reinterpret_cast<PFN_vkVoidFunction>(%s);' % (extra_space, ext_name, extra_space, ext_name))
-                    if 0 != len(ext_enable):
-                        func_body.append('    }\n')
+                    func_body.append('    if (my_device_data->%s) {\n'
+                                     '        addr = %s_device_intercepts.find(funcName);\n'
+                                     '        if (addr)\n'
+                                     '            return addr;\n'
+                                     '    }\n' % (ext_enable, ext_enable))
             func_body.append("\n    if (get_dispatch_table(%s_device_table_map, device)->GetDeviceProcAddr == NULL)\n"
                              "        return NULL;\n"
                              "    return get_dispatch_table(%s_device_table_map, device)->GetDeviceProcAddr(device, funcName);\n"
@@ -543,15 +552,9 @@ class Subcommand(object):
             func_body.append("VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(VkInstance instance, const char* funcName)\n"
                              "{\n"
                              "    PFN_vkVoidFunction addr;\n"
-                             "    if (!strcmp(funcName, \"vkGetInstanceProcAddr\"))\n"
-                             "        return (PFN_vkVoidFunction) vkGetInstanceProcAddr;\n"
-                             "    if (!strcmp(funcName, \"vkCreateInstance\"))\n"
-                             "        return (PFN_vkVoidFunction) vkCreateInstance;\n"
-                             "    if (!strcmp(funcName, \"vkCreateDevice\"))\n"
-                             "        return (PFN_vkVoidFunction) vkCreateDevice;\n"
                              "    addr = layer_intercept_instance_proc(funcName);\n"
                              "    if (addr) {\n"
-                             "        return addr;"
+                             "        return addr;\n"
                              "    }\n"
                              "    if (instance == VK_NULL_HANDLE) {\n"
                              "        return NULL;\n"
@@ -575,16 +578,10 @@ class Subcommand(object):
                                 table_declared = True
                             func_body.append('    if (instanceExtMap.size() != 0 && instanceExtMap[pTable].%s)' % ext_enable)
                             func_body.append('    {')
-                            extra_space = "    "
-                            for ext_name in ext_list:
-                                if wsi_name(ext_name):
-                                    func_body.append('%s' % wsi_ifdef(ext_name))
-                                func_body.append('    %sif (!strcmp("%s", funcName))\n'
-                                                 '            return reinterpret_cast<PFN_vkVoidFunction>(%s);' % (extra_space, ext_name, ext_name))
-                                if wsi_name(ext_name):
-                                    func_body.append('%s' % wsi_endif(ext_name))
-                            if 0 != len(ext_enable):
-                               func_body.append('    }\n')
+                            func_body.append('        addr = %s_instance_intercepts.find(funcName);' % ext_enable)
+                            func_body.append('        if (addr)')
+                            func_body.append('            return addr;')
+                            func_body.append('    }\n')
 
             func_body.append("    if (get_dispatch_table(%s_instance_table_map, instance)->GetInstanceProcAddr == NULL) {\n"
                              "        return NULL;\n"
@@ -724,6 +721,7 @@ class ObjectTrackerSubcommand(Subcommand):
         header_txt.append('#include "vk_layer_table.h"')
         header_txt.append('#include "vk_layer_data.h"')
         header_txt.append('#include "vk_layer_logging.h"')
+        header_txt.append('#include "vk_layer_entrypoint_table.h"')
         header_txt.append('')
 #       NOTE:  The non-autoGenerated code is in the object_tracker.h header file
         header_txt.append('#include "object_tracker.h"')
@@ -1059,6 +1057,7 @@ class ObjectTrackerSubcommand(Subcommand):
         gedd_txt.append("    // Clean up Queue's MemRef Linked Lists")
         gedd_txt.append('    destroyQueueMemRefLists();')
         gedd_txt.append('')
+        gedd_txt.append('    layer_debug_report_destroy_device(mdd(device), device);')
         gedd_txt.append('    lock.unlock();')
         gedd_txt.append('')
         gedd_txt.append('    dispatch_key key = get_dispatch_key(device);')
@@ -1429,6 +1428,7 @@ class UniqueObjectsSubcommand(Subcommand):
         header_txt = []
         header_txt.append('%s' % self.lineinfo.get())
         header_txt.append('#include "unique_objects.h"')
+        header_txt.append('#include "vk_layer_entrypoint_table.h"')
         return "\n".join(header_txt)
 
     # Generate UniqueObjects code for given struct_uses dict of objects that need to be unwrapped
@@ -1724,6 +1724,89 @@ class UniqueObjectsSubcommand(Subcommand):
                                                   instance_extensions)]
         return "\n\n".join(body)
 
+class EntrypointTableSubcommand(Subcommand):
+    # Emits a perfect hash over every entrypoint name in the registry plus the
+    # layer_intercept_table class the layers build their GetProcAddr tables
+    # from, so resolving a name costs one pass over the string and one strcmp
+    # no matter how many entrypoints a layer intercepts.  The hash comes from
+    # entrypoint_hash.py, as does the loader's entrypoint-hash.
+    def run(self):
+        self.names = []
+        seen = set()
+        for ext in vulkan.extensions_all:
+            for proto in ext.protos:
+                if proto.name in seen:
+                    continue
+                seen.add(proto.name)
+                self.names.append(proto.name)
+        self.hash = entrypoint_hash.EntrypointHash(["vk" + n for n in self.names], "entrypoint_table")
+        super().run()
+
+    def generate_header(self):
+        return "\n".join(["#ifndef VK_LAYER_ENTRYPOINT_TABLE_H",
+                          "#define VK_LAYER_ENTRYPOINT_TABLE_H",
+                          "",
+                          "#include <stdint.h>",
+                          "#include <string.h>",
+                          "#include <initializer_list>",
+                          "#include <vector>",
+                          "#include \"vulkan/vulkan.h\""])
+
+    def generate_body(self):
+        body = []
+        body.append("enum layer_entrypoint_id {")
+        body.append("    LAYER_EP_UNKNOWN = -1,")
+        for i, name in enumerate(self.names):
+            body.append("    LAYER_EP_%s = %d," % (name, i))
+        body.append("};")
+        body.append("")
+        body.append("#define LAYER_EP_COUNT %d" % len(self.names))
+        body.extend(self.hash.generate("layer_entrypoint", "LAYER_EP", "layer_entrypoint_id"))
+        body.append("struct layer_intercept {")
+        body.append("    const char *name;")
+        body.append("    PFN_vkVoidFunction proc;")
+        body.append("};")
+        body.append("")
+        body.append("// Name -> function table for a layer's GetProcAddr.  Entrypoints the registry")
+        body.append("//  knows about are found through the perfect hash; anything else a layer")
+        body.append("//  intercepts is kept on a short list that is searched linearly.")
+        body.append("class layer_intercept_table {")
+        body.append("  public:")
+        body.append("    layer_intercept_table(std::initializer_list<layer_intercept> intercepts) {")
+        body.append("        for (uint32_t i = 0; i < LAYER_EP_COUNT; i++)")
+        body.append("            procs_[i] = nullptr;")
+        body.append("        for (auto &intercept : intercepts) {")
+        body.append("            int id = layer_entrypoint_lookup(intercept.name);")
+        body.append("            if (id != LAYER_EP_UNKNOWN)")
+        body.append("                procs_[id] = intercept.proc;")
+        body.append("            else")
+        body.append("                others_.push_back(intercept);")
+        body.append("        }")
+        body.append("    }")
+        body.append("")
+        body.append("    // Returns the intercept for name, or NULL if this table does not have one")
+        body.append("    PFN_vkVoidFunction find(const char *name) const {")
+        body.append("        int id = layer_entrypoint_lookup(name);")
+        body.append("        if (id != LAYER_EP_UNKNOWN)")
+        body.append("            return procs_[id];")
+        body.append("        if (!name)")
+        body.append("            return nullptr;")
+        body.append("        for (auto &intercept : others_) {")
+        body.append("            if (!strcmp(intercept.name, name))")
+        body.append("                return intercept.proc;")
+        body.append("        }")
+        body.append("        return nullptr;")
+        body.append("    }")
+        body.append("")
+        body.append("  private:")
+        body.append("    PFN_vkVoidFunction procs_[LAYER_EP_COUNT];")
+        body.append("    std::vector<layer_intercept> others_;")
+        body.append("};")
+        return "\n".join(body)
+
+    def generate_footer(self):
+        return "#endif // VK_LAYER_ENTRYPOINT_TABLE_H"
+
 def main():
     wsi = {
             "Win32",
@@ -1737,6 +1820,7 @@ def main():
     subcommands = {
             "object_tracker" : ObjectTrackerSubcommand,
             "unique_objects" : UniqueObjectsSubcommand,
+            "entrypoint_table" : EntrypointTableSubcommand,
     }
 
     if len(sys.argv) < 4 or sys.argv[1] not in wsi or sys.argv[2] not in subcommands or not os.path.exists(sys.argv[3]):